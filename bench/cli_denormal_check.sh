@@ -0,0 +1,48 @@
+#!/bin/sh
+# Time the command line tool on a single impulse followed by silence against the same length of random noise. The
+# impulse leaves the IIR tails subnormal, so without flushing it runs several times slower than the noise does.
+# Usage: cli_denormal_check.sh <filter_example> [rows], fails if an impulse run takes more than 1.5 times the noise run
+
+EXAMPLE=${1:?usage: cli_denormal_check.sh <filter_example> [rows]}
+ROWS=${2:-400000}
+RUNS=3
+DIR=$(mktemp -d) || exit 1
+trap 'rm -rf "$DIR"' EXIT
+
+awk -v rows="$ROWS" 'BEGIN { print "time,x"; for (i = 0; i < rows; i++) print i "," (i == 10 ? 50 : 0) }' > "$DIR/impulse.log"
+awk -v rows="$ROWS" 'BEGIN { srand(1); print "time,x"; for (i = 0; i < rows; i++) printf "%d,%.4f\n", i, 200 * rand() - 100 }' > "$DIR/noise.log"
+
+# Fastest of RUNS runs in milliseconds
+best_ms()
+{
+    best=
+    for run in $(seq $RUNS); do
+        start=$(date +%s%N)
+        "$EXAMPLE" -i "$DIR/$2.log" -o "$DIR/$2.csv" -f "$1" -s lowpass > /dev/null || return 1
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+failures=0
+for filter in iir iir-biquad iir-biquad-df2t; do
+    impulse=$(best_ms "$filter" impulse) || { echo "$filter: run failed"; exit 1; }
+    noise=$(best_ms "$filter" noise) || { echo "$filter: run failed"; exit 1; }
+    if [ $(( 2 * impulse )) -gt $(( 3 * noise )) ]; then
+        result=FAIL
+        failures=$(( failures + 1 ))
+    else
+        result=ok
+    fi
+    printf "%-16s impulse %5d ms, noise %5d ms: %s\n" "$filter" "$impulse" "$noise" "$result"
+done
+
+if [ "$failures" -ne 0 ]; then
+    echo FAILED
+    exit 1
+fi
+echo PASSED
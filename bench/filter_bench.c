@@ -0,0 +1,967 @@
+#include "../impl/filter_types.h"
+#include "../impl/sma_filter/sma_filter.h"
+#include "../impl/cic_filter/cic_filter.h"
+#include "../impl/ema_filter/ema_filter.h"
+#include "../impl/median_filter/median_filter.h"
+#include "../impl/fir_filter/fir_filter.h"
+#include "../impl/fir_filter/fir_fft_filter.h"
+#include "../impl/fir_filter/fir_polyphase.h"
+#include "../impl/iir_filter/iir_filter.h"
+#include "../impl/filter_bank/filter_bank.h"
+#include "../impl/filter_chain/filter_chain.h"
+#include "../impl/resampler/resampler.h"
+#include "../impl/filter_arena/filter_arena.h"
+#include "../impl/filter_simd/filter_simd.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_PI 3.14159265358979323846
+
+// Samples filtered per timed run, and samples handed to each run_block call. Multi channel cases filter the same
+// number of samples spread over their channels, so every case does the same amount of work per run
+#define BENCH_NUM_SAMPLES  (1 << 20)
+#define BENCH_BLOCK_SIZE   1024
+
+// Timed runs per case, the fastest one is reported
+#define BENCH_NUM_RUNS     5
+
+// Single sample calls timed for the latency percentiles, and back to back clock reads the timer overhead is taken from
+#define BENCH_NUM_LATENCY  (1 << 16)
+#define BENCH_NUM_OVERHEAD (1 << 16)
+
+// Bytes of filter state a case may carve from the pool, every buffer starts on a cache line
+#define BENCH_POOL_SIZE    (8 << 20)
+
+// Largest FIR, biquad cascade and direct form IIR the cases use
+#define BENCH_MAX_TAPS     4096
+#define BENCH_MAX_SECTIONS 8
+#define BENCH_MAX_ORDER    (2 * BENCH_MAX_SECTIONS)
+
+// Channels of the multi channel cases
+#define BENCH_NUM_CHANNELS 8
+
+// Inputs a case is timed on, a tone mix, or a single impulse whose decaying response is all the filter sees after
+// the first sample, like a stream that goes quiet
+#define BENCH_INPUT_TONES   0
+#define BENCH_INPUT_IMPULSE 1
+
+#if defined(FILTER_USE_FLOAT_MATH)
+#define BENCH_MATH "float"
+#elif defined(FILTER_USE_FIXED_LIB)
+#define BENCH_MATH "fixed"
+#elif defined(FILTER_USE_Q15_MATH)
+#define BENCH_MATH "q15"
+#else
+#define BENCH_MATH "q31"
+#endif /* FILTER_USE_FLOAT_MATH */
+
+typedef int (*bench_block_fn)(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames);
+
+/**
+  * @brief A filter set up for one timed run
+  * @note run processes num_frames interleaved frames of num_channels values, output must hold as many values as input
+  */
+typedef struct
+{
+    void          *filter;
+    bench_block_fn run;
+    unsigned int   num_channels;
+} bench_filter_t;
+
+typedef int (*bench_setup_fn)(bench_filter_t *bench, unsigned int size, unsigned int num_channels);
+
+/**
+  * @brief One benchmark case, setup builds a fresh filter from the pool before every run
+  */
+typedef struct
+{
+    const char    *name;
+    unsigned int   size;
+    unsigned int   num_channels;
+    bench_setup_fn setup;
+    unsigned int   input;
+} bench_case_t;
+
+/**
+  * @brief Result of one case
+  */
+typedef struct
+{
+    const char  *name;
+    unsigned int size;
+    unsigned int num_channels;
+    double       samples_per_sec;
+    double       ns_per_sample;
+    double       latency_ns[5];
+} bench_result_t;
+
+static const char  *bench_percentile_names[5] = { "p50", "p90", "p99", "p999", "max" };
+static const double bench_percentiles[5] = { 0.5, 0.9, 0.99, 0.999, 1.0 };
+
+static unsigned char  bench_memory[FILTER_ARENA_BUFFER_SIZE(BENCH_POOL_SIZE)];
+static filter_arena_t bench_pool;
+
+static double bench_fir_coeffs[BENCH_MAX_TAPS];
+static double bench_sos_coeffs[6];
+
+/**
+  * @brief Carve an aligned, zeroed buffer from the pool
+  * @return Pointer to the buffer, NULL when the pool is exhausted
+  */
+static void *bench_take(size_t size)
+{
+    void *buffer = filter_arena_alloc(&bench_pool, size);
+    if (buffer) {
+        memset(buffer, 0, size);
+    }
+
+    return buffer;
+}
+
+/**
+  * @brief Convert a designed coefficient to filter_coeff_t
+  * @return 0 on success, -1 if the value does not fit the coefficient format
+  */
+static int bench_coeff(double value, filter_coeff_t *coeff)
+{
+#if defined(FILTER_USE_INTEGER_MATH)
+    double scaled = round(value * (double)FILTER_COEFF_ONE);
+    double limit = ldexp(1.0, (8 * (int)sizeof(filter_coeff_t)) - 1);
+    if (scaled >= limit || scaled < -limit) {
+        return -1;
+    }
+    *coeff = (filter_coeff_t)scaled;
+#else
+    *coeff = (filter_coeff_t)value;
+#endif /* FILTER_USE_INTEGER_MATH */
+
+    return 0;
+}
+
+/**
+  * @brief Hamming windowed sinc low pass with its cut off at a tenth of the sample rate and unity DC gain
+  */
+static void bench_design_fir(unsigned int num_taps)
+{
+    double sum = 0;
+    for (unsigned int i = 0; i < num_taps; i++) {
+        double t = (double)i - ((double)(num_taps - 1) / 2.0);
+        double sinc = (t == 0) ? 1.0 : sin(2.0 * BENCH_PI * 0.1 * t) / (2.0 * BENCH_PI * 0.1 * t);
+        double window = (num_taps > 1) ? 0.54 - (0.46 * cos(2.0 * BENCH_PI * (double)i / (double)(num_taps - 1))) : 1.0;
+        bench_fir_coeffs[i] = sinc * window;
+        sum += bench_fir_coeffs[i];
+    }
+    for (unsigned int i = 0; i < num_taps; i++) {
+        bench_fir_coeffs[i] /= sum;
+    }
+}
+
+/**
+  * @brief Butterworth Q low pass biquad with its cut off at a twentieth of the sample rate, normalized to a0 = 1
+  */
+static void bench_design_biquad(void)
+{
+    double w0 = 2.0 * BENCH_PI * 0.05;
+    double alpha = sin(w0) / (2.0 * sqrt(0.5));
+    double a0 = 1.0 + alpha;
+    bench_sos_coeffs[0] = ((1.0 - cos(w0)) / 2.0) / a0;
+    bench_sos_coeffs[1] = (1.0 - cos(w0)) / a0;
+    bench_sos_coeffs[2] = bench_sos_coeffs[0];
+    bench_sos_coeffs[3] = 1.0;
+    bench_sos_coeffs[4] = (-2.0 * cos(w0)) / a0;
+    bench_sos_coeffs[5] = (1.0 - alpha) / a0;
+}
+
+static filter_coeff_t *bench_take_fir(unsigned int num_taps)
+{
+    filter_coeff_t *b_coeffs = (filter_coeff_t *)bench_take(sizeof(filter_coeff_t) * num_taps);
+    if (!b_coeffs) {
+        return NULL;
+    }
+    for (unsigned int i = 0; i < num_taps; i++) {
+        if (bench_coeff(bench_fir_coeffs[i], &b_coeffs[i]) < 0) {
+            return NULL;
+        }
+    }
+
+    return b_coeffs;
+}
+
+static filter_coeff_t (*bench_take_sos(unsigned int num_sections))[6]
+{
+    filter_coeff_t(*sos_coeffs)[6] = (filter_coeff_t(*)[6])bench_take(sizeof(filter_coeff_t) * 6 * num_sections);
+    if (!sos_coeffs) {
+        return NULL;
+    }
+    for (unsigned int s = 0; s < num_sections; s++) {
+        for (unsigned int k = 0; k < 6; k++) {
+            if (bench_coeff(bench_sos_coeffs[k], &sos_coeffs[s][k]) < 0) {
+                return NULL;
+            }
+        }
+    }
+
+    return sos_coeffs;
+}
+
+static int bench_run_sma(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return sma_filter_run_block((sma_filter_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_sma(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    sma_filter_t  *filter = (sma_filter_t *)bench_take(sizeof(sma_filter_t));
+    filter_data_t *data = (filter_data_t *)bench_take(sizeof(filter_data_t) * size);
+    if (!filter || !data || sma_filter_init(filter, data, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_sma;
+
+    return 0;
+}
+
+static int bench_run_cic(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return cic_filter_run_block((cic_filter_t *)filter, input, output, num_frames);
+}
+
+// size is the shift, the cases run three stages
+static int bench_setup_cic(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    cic_filter_t   *filter = (cic_filter_t *)bench_take(sizeof(cic_filter_t));
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * CIC_FILTER_STATE_SIZE(3, size));
+    if (!filter || !state || cic_filter_init(filter, state, 3, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_cic;
+
+    return 0;
+}
+
+static int bench_run_ema(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return ema_filter_run_block((ema_filter_t *)filter, input, output, num_frames);
+}
+
+// size is the shift
+static int bench_setup_ema(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    ema_filter_t *filter = (ema_filter_t *)bench_take(sizeof(ema_filter_t));
+    if (!filter || ema_filter_init(filter, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_ema;
+
+    return 0;
+}
+
+static int bench_run_median(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return median_filter_run_block((median_filter_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_median(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    median_filter_t      *filter = (median_filter_t *)bench_take(sizeof(median_filter_t));
+    median_filter_node_t *nodes = (median_filter_node_t *)bench_take(sizeof(median_filter_node_t) * MEDIAN_FILTER_NUM_NODES(size));
+    if (!filter || !nodes || median_filter_init(filter, nodes, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_median;
+
+    return 0;
+}
+
+static int bench_run_hampel(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return hampel_filter_run_block((hampel_filter_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_hampel(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    hampel_filter_t      *filter = (hampel_filter_t *)bench_take(sizeof(hampel_filter_t));
+    median_filter_node_t *nodes = (median_filter_node_t *)bench_take(sizeof(median_filter_node_t) * MEDIAN_FILTER_NUM_NODES(size));
+    if (!filter || !nodes || hampel_filter_init(filter, nodes, size, HAMPEL_FILTER_THRESHOLD(3)) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_hampel;
+
+    return 0;
+}
+
+static int bench_run_fir(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return fir_filter_run_block((fir_filter_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_fir(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_design_fir(size);
+    fir_filter_t   *filter = (fir_filter_t *)bench_take(sizeof(fir_filter_t));
+    filter_coeff_t *b_coeffs = bench_take_fir(size);
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * FIR_FILTER_MIRRORED_STATE_SIZE(size));
+    if (!filter || !b_coeffs || !state || fir_filter_init_mirrored(filter, b_coeffs, state, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_fir;
+
+    return 0;
+}
+
+#if FIR_FFT_FILTER_ENABLED
+static int bench_run_fir_fft(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return fir_fft_filter_run_block((fir_fft_filter_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_fir_fft(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_design_fir(size);
+    unsigned int      block_size = fir_fft_filter_block_size(size, FIR_FFT_FILTER_MODE_PARTITIONED);
+    fir_fft_filter_t *filter = (fir_fft_filter_t *)bench_take(sizeof(fir_fft_filter_t));
+    filter_coeff_t   *b_coeffs = bench_take_fir(size);
+    double           *state = (double *)bench_take(sizeof(double) * FIR_FFT_FILTER_STATE_SIZE(size, block_size));
+    if (!filter || !b_coeffs || !state ||
+        fir_fft_filter_init(filter, b_coeffs, size, block_size, FIR_FFT_FILTER_MODE_PARTITIONED, state) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_fir_fft;
+
+    return 0;
+}
+#endif /* FIR_FFT_FILTER_ENABLED */
+
+// Decimates by BENCH_POLYPHASE_DECIMATION, the outputs are packed at the start of the output block
+#define BENCH_POLYPHASE_DECIMATION 4
+
+static int bench_run_polyphase(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    size_t num_outputs;
+    return fir_polyphase_filter_run_block((fir_polyphase_filter_t *)filter, input, num_frames, output, &num_outputs);
+}
+
+static int bench_setup_polyphase(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_design_fir(size);
+    fir_polyphase_filter_t *filter = (fir_polyphase_filter_t *)bench_take(sizeof(fir_polyphase_filter_t));
+    filter_coeff_t         *b_coeffs = bench_take_fir(size);
+    filter_accum_t         *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * FIR_POLYPHASE_FILTER_STATE_SIZE(size, 1));
+    if (!filter || !b_coeffs || !state ||
+        fir_polyphase_filter_init(filter, b_coeffs, size, 1, BENCH_POLYPHASE_DECIMATION, NULL, state) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_polyphase;
+
+    return 0;
+}
+
+static int bench_run_iir(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return iir_filter_run_block((iir_filter_t *)filter, input, output, num_frames);
+}
+
+// size is the filter order, the direct form is the product of size / 2 biquads. Orders whose coefficients do not fit
+// the coefficient format are skipped
+static int bench_setup_iir(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    double b[BENCH_MAX_ORDER + 1] = { 1.0 };
+    double a[BENCH_MAX_ORDER + 1] = { 1.0 };
+    for (unsigned int s = 0; s < size / 2; s++) {
+        // Multiply both polynomials by the section in place, highest power first so the lower terms are still unchanged
+        for (unsigned int i = (2 * s) + 3; i-- > 0;) {
+            b[i] *= bench_sos_coeffs[0];
+            for (unsigned int k = 1; k <= 2 && k <= i; k++) {
+                b[i] += bench_sos_coeffs[k] * b[i - k];
+                a[i] += bench_sos_coeffs[3 + k] * a[i - k];
+            }
+        }
+    }
+
+    iir_filter_t   *filter = (iir_filter_t *)bench_take(sizeof(iir_filter_t));
+    filter_coeff_t *b_coeffs = (filter_coeff_t *)bench_take(sizeof(filter_coeff_t) * (size + 1));
+    filter_coeff_t *a_coeffs = (filter_coeff_t *)bench_take(sizeof(filter_coeff_t) * (size + 1));
+    filter_accum_t *prev_inputs = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * size);
+    filter_accum_t *prev_outputs = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * size);
+    if (!filter || !b_coeffs || !a_coeffs || !prev_inputs || !prev_outputs) {
+        return -1;
+    }
+    for (unsigned int i = 0; i <= size; i++) {
+        if (bench_coeff(b[i], &b_coeffs[i]) < 0 || bench_coeff(a[i], &a_coeffs[i]) < 0) {
+            return -1;
+        }
+    }
+    if (iir_filter_init(filter, b_coeffs, a_coeffs, prev_inputs, prev_outputs, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_iir;
+
+    return 0;
+}
+
+static int bench_run_biquad(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return iir_biquad_filter_run_block((iir_biquad_filter_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_biquad(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    iir_biquad_filter_t *filter = (iir_biquad_filter_t *)bench_take(sizeof(iir_biquad_filter_t));
+    filter_coeff_t(*sos_coeffs)[6] = bench_take_sos(size);
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * IIR_BIQUAD_DF1_STATE_SIZE(size));
+    if (!filter || !sos_coeffs || !state || iir_biquad_filter_init(filter, sos_coeffs, state, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_biquad;
+
+    return 0;
+}
+
+static int bench_setup_biquad_df2t(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    iir_biquad_filter_t *filter = (iir_biquad_filter_t *)bench_take(sizeof(iir_biquad_filter_t));
+    filter_coeff_t(*sos_coeffs)[6] = bench_take_sos(size);
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * IIR_BIQUAD_DF2T_STATE_SIZE(size));
+    if (!filter || !sos_coeffs || !state || iir_biquad_filter_init_df2t(filter, sos_coeffs, state, size) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_biquad;
+
+    return 0;
+}
+
+// The impulse cases again with the tail snapped to zero by the kernel, and with the kernel run inside an FTZ scope
+static int bench_setup_iir_flush(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    if (bench_setup_iir(bench, size, num_channels) < 0) {
+        return -1;
+    }
+
+    return iir_filter_set_flush_denormals((iir_filter_t *)bench->filter, 1);
+}
+
+static int bench_setup_biquad_flush(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    if (bench_setup_biquad(bench, size, num_channels) < 0) {
+        return -1;
+    }
+
+    return iir_biquad_filter_set_flush_denormals((iir_biquad_filter_t *)bench->filter, 1);
+}
+
+static int bench_setup_biquad_df2t_flush(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    if (bench_setup_biquad_df2t(bench, size, num_channels) < 0) {
+        return -1;
+    }
+
+    return iir_biquad_filter_set_flush_denormals((iir_biquad_filter_t *)bench->filter, 1);
+}
+
+static int bench_run_iir_ftz(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    filter_simd_ftz_scope_t scope;
+    filter_simd_ftz_enter(&scope);
+    int ret = iir_filter_run_block((iir_filter_t *)filter, input, output, num_frames);
+    filter_simd_ftz_exit(&scope);
+
+    return ret;
+}
+
+static int bench_run_biquad_ftz(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    filter_simd_ftz_scope_t scope;
+    filter_simd_ftz_enter(&scope);
+    int ret = iir_biquad_filter_run_block((iir_biquad_filter_t *)filter, input, output, num_frames);
+    filter_simd_ftz_exit(&scope);
+
+    return ret;
+}
+
+static int bench_setup_iir_ftz(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    if (bench_setup_iir(bench, size, num_channels) < 0) {
+        return -1;
+    }
+    bench->run = bench_run_iir_ftz;
+
+    return 0;
+}
+
+static int bench_setup_biquad_ftz(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    if (bench_setup_biquad(bench, size, num_channels) < 0) {
+        return -1;
+    }
+    bench->run = bench_run_biquad_ftz;
+
+    return 0;
+}
+
+static int bench_setup_biquad_df2t_ftz(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    if (bench_setup_biquad_df2t(bench, size, num_channels) < 0) {
+        return -1;
+    }
+    bench->run = bench_run_biquad_ftz;
+
+    return 0;
+}
+
+static int bench_run_chain(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return filter_chain_run_block((filter_chain_t *)filter, input, output, num_frames);
+}
+
+// A Hampel despiker, a size tap FIR and a four section biquad low pass, the chain the CLI runs most often
+static int bench_setup_chain(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_filter_t stage;
+    filter_chain_t       *chain = (filter_chain_t *)bench_take(sizeof(filter_chain_t));
+    filter_chain_stage_t *stages = (filter_chain_stage_t *)bench_take(sizeof(filter_chain_stage_t) * 3);
+    if (!chain || !stages || filter_chain_init(chain, stages, 3) < 0) {
+        return -1;
+    }
+    if (bench_setup_hampel(&stage, 7, 1) < 0 || filter_chain_add_hampel(chain, (hampel_filter_t *)stage.filter) < 0 ||
+        bench_setup_fir(&stage, size, 1) < 0 || filter_chain_add_fir(chain, (fir_filter_t *)stage.filter) < 0 ||
+        bench_setup_biquad(&stage, 4, 1) < 0 || filter_chain_add_iir_biquad(chain, (iir_biquad_filter_t *)stage.filter) < 0) {
+        return -1;
+    }
+    bench->filter = chain;
+    bench->run = bench_run_chain;
+
+    return 0;
+}
+
+/**
+  * @brief One single channel FIR per channel, each column is gathered from the frames, filtered and scattered back
+  *        the way the command line tool ran a FIR before the bank, the reference the bank-fir cases compare against
+  */
+typedef struct
+{
+    fir_filter_t  filters[BENCH_NUM_CHANNELS];
+    unsigned int  num_channels;
+    filter_data_t column[BENCH_BLOCK_SIZE];
+} bench_fir_channels_t;
+
+static int bench_run_fir_channels(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    bench_fir_channels_t *bench = (bench_fir_channels_t *)filter;
+    unsigned int          num_channels = bench->num_channels;
+    for (unsigned int c = 0; c < num_channels; c++) {
+        for (size_t n = 0; n < num_frames; n++) {
+            bench->column[n] = input[(n * num_channels) + c];
+        }
+        fir_filter_run_block(&bench->filters[c], bench->column, bench->column, num_frames);
+        for (size_t n = 0; n < num_frames; n++) {
+            output[(n * num_channels) + c] = bench->column[n];
+        }
+    }
+
+    return 0;
+}
+
+static int bench_setup_fir_channels(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_design_fir(size);
+    bench_fir_channels_t *filter = (bench_fir_channels_t *)bench_take(sizeof(bench_fir_channels_t));
+    filter_coeff_t       *b_coeffs = bench_take_fir(size);
+    if (!filter || !b_coeffs || num_channels > BENCH_NUM_CHANNELS) {
+        return -1;
+    }
+    filter->num_channels = num_channels;
+    for (unsigned int c = 0; c < num_channels; c++) {
+        filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * FIR_FILTER_MIRRORED_STATE_SIZE(size));
+        if (!state || fir_filter_init_mirrored(&filter->filters[c], b_coeffs, state, size) < 0) {
+            return -1;
+        }
+    }
+    bench->filter = filter;
+    bench->run = bench_run_fir_channels;
+
+    return 0;
+}
+
+static int bench_run_bank(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    return filter_bank_run((filter_bank_t *)filter, input, output, num_frames);
+}
+
+static int bench_setup_bank_fir(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_design_fir(size);
+    filter_bank_t  *bank = (filter_bank_t *)bench_take(sizeof(filter_bank_t));
+    filter_coeff_t *b_coeffs = bench_take_fir(size);
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * FILTER_BANK_FIR_STATE_SIZE(size, num_channels));
+    if (!bank || !b_coeffs || !state || filter_bank_init_fir(bank, b_coeffs, state, size, num_channels) < 0) {
+        return -1;
+    }
+    bench->filter = bank;
+    bench->run = bench_run_bank;
+
+    return 0;
+}
+
+static int bench_setup_bank_biquad(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    filter_bank_t  *bank = (filter_bank_t *)bench_take(sizeof(filter_bank_t));
+    filter_coeff_t(*sos_coeffs)[6] = bench_take_sos(size);
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * FILTER_BANK_IIR_BIQUAD_STATE_SIZE(size, num_channels));
+    if (!bank || !sos_coeffs || !state || filter_bank_init_iir_biquad(bank, sos_coeffs, state, size, num_channels) < 0) {
+        return -1;
+    }
+    bench->filter = bank;
+    bench->run = bench_run_bank;
+
+    return 0;
+}
+
+static int bench_setup_bank_biquad_df2t(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    filter_bank_t  *bank = (filter_bank_t *)bench_take(sizeof(filter_bank_t));
+    filter_coeff_t(*sos_coeffs)[6] = bench_take_sos(size);
+    filter_accum_t *state = (filter_accum_t *)bench_take(sizeof(filter_accum_t) * FILTER_BANK_IIR_BIQUAD_DF2T_STATE_SIZE(size, num_channels));
+    if (!bank || !sos_coeffs || !state || filter_bank_init_iir_biquad_df2t(bank, sos_coeffs, state, size, num_channels) < 0) {
+        return -1;
+    }
+    bench->filter = bank;
+    bench->run = bench_run_bank;
+
+    return 0;
+}
+
+/**
+  * @brief Resampler on a grid of the input rate, every frame is pushed and every ready output pulled
+  */
+typedef struct
+{
+    resampler_t resampler;
+    double      time;
+} bench_resampler_t;
+
+static int bench_run_resampler(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    bench_resampler_t *bench = (bench_resampler_t *)filter;
+    unsigned int       num_channels = bench->resampler.num_channels;
+    double             time;
+    for (size_t n = 0; n < num_frames; n++) {
+        resampler_push(&bench->resampler, bench->time, &input[n * num_channels]);
+        bench->time += 1.0;
+        while (resampler_pull(&bench->resampler, &time, &output[n * num_channels]) == RESAMPLER_ERROR_OK) {
+        }
+    }
+
+    return 0;
+}
+
+// size is one of the RESAMPLER_MODE_* modes
+static int bench_setup_resampler(bench_filter_t *bench, unsigned int size, unsigned int num_channels)
+{
+    bench_resampler_t *filter = (bench_resampler_t *)bench_take(sizeof(bench_resampler_t));
+    double            *times = (double *)bench_take(sizeof(double) * RESAMPLER_HISTORY_SIZE((int)size));
+    filter_data_t     *values = (filter_data_t *)bench_take(sizeof(filter_data_t) * RESAMPLER_VALUES_SIZE((int)size, num_channels));
+    if (!filter || !times || !values || resampler_init(&filter->resampler, (int)size, num_channels, 1.0, times, values) < 0) {
+        return -1;
+    }
+    bench->filter = filter;
+    bench->run = bench_run_resampler;
+
+    return 0;
+}
+
+// Every kernel at a few representative sizes: window lengths, shifts, tap counts, filter orders, section counts and
+// resampler modes
+static const bench_case_t bench_cases[] = {
+    { "sma", 16, 1, bench_setup_sma },
+    { "sma", 256, 1, bench_setup_sma },
+    { "cic", 4, 1, bench_setup_cic },
+    { "cic", 8, 1, bench_setup_cic },
+    { "ema", 4, 1, bench_setup_ema },
+    { "median", 5, 1, bench_setup_median },
+    { "median", 31, 1, bench_setup_median },
+    { "median", 255, 1, bench_setup_median },
+    { "hampel", 7, 1, bench_setup_hampel },
+    { "hampel", 31, 1, bench_setup_hampel },
+    { "fir", 16, 1, bench_setup_fir },
+    { "fir", 64, 1, bench_setup_fir },
+    { "fir", 256, 1, bench_setup_fir },
+    { "fir", 1024, 1, bench_setup_fir },
+#if FIR_FFT_FILTER_ENABLED
+    { "fir-fft", 1024, 1, bench_setup_fir_fft },
+    { "fir-fft", 4096, 1, bench_setup_fir_fft },
+#endif /* FIR_FFT_FILTER_ENABLED */
+    { "fir-decimate", 64, 1, bench_setup_polyphase },
+    { "fir-decimate", 256, 1, bench_setup_polyphase },
+    { "iir", 2, 1, bench_setup_iir },
+    { "iir", 4, 1, bench_setup_iir },
+    { "iir-biquad", 1, 1, bench_setup_biquad },
+    { "iir-biquad", 4, 1, bench_setup_biquad },
+    { "iir-biquad", 8, 1, bench_setup_biquad },
+    { "iir-biquad-df2t", 1, 1, bench_setup_biquad_df2t },
+    { "iir-biquad-df2t", 4, 1, bench_setup_biquad_df2t },
+    { "iir-biquad-df2t", 8, 1, bench_setup_biquad_df2t },
+    { "chain", 64, 1, bench_setup_chain },
+    { "resample-linear", RESAMPLER_MODE_LINEAR, 1, bench_setup_resampler },
+    { "resample-cubic", RESAMPLER_MODE_CUBIC, 1, bench_setup_resampler },
+    { "resample-sinc", RESAMPLER_MODE_SINC, 1, bench_setup_resampler },
+    { "fir-channels", 64, BENCH_NUM_CHANNELS, bench_setup_fir_channels },
+    { "fir-channels", 256, BENCH_NUM_CHANNELS, bench_setup_fir_channels },
+    { "bank-fir", 64, BENCH_NUM_CHANNELS, bench_setup_bank_fir },
+    { "bank-fir", 256, BENCH_NUM_CHANNELS, bench_setup_bank_fir },
+    { "bank-iir-biquad", 4, BENCH_NUM_CHANNELS, bench_setup_bank_biquad },
+    { "bank-iir-biquad-df2t", 4, BENCH_NUM_CHANNELS, bench_setup_bank_biquad_df2t },
+    { "resample-cubic", RESAMPLER_MODE_CUBIC, BENCH_NUM_CHANNELS, bench_setup_resampler },
+    { "iir-impulse", 4, 1, bench_setup_iir, BENCH_INPUT_IMPULSE },
+    { "iir-impulse-flush", 4, 1, bench_setup_iir_flush, BENCH_INPUT_IMPULSE },
+    { "iir-impulse-ftz", 4, 1, bench_setup_iir_ftz, BENCH_INPUT_IMPULSE },
+    { "iir-biquad-impulse", 4, 1, bench_setup_biquad, BENCH_INPUT_IMPULSE },
+    { "iir-biquad-impulse-flush", 4, 1, bench_setup_biquad_flush, BENCH_INPUT_IMPULSE },
+    { "iir-biquad-impulse-ftz", 4, 1, bench_setup_biquad_ftz, BENCH_INPUT_IMPULSE },
+    { "iir-biquad-df2t-impulse", 4, 1, bench_setup_biquad_df2t, BENCH_INPUT_IMPULSE },
+    { "iir-biquad-df2t-impulse-flush", 4, 1, bench_setup_biquad_df2t_flush, BENCH_INPUT_IMPULSE },
+    { "iir-biquad-df2t-impulse-ftz", 4, 1, bench_setup_biquad_df2t_ftz, BENCH_INPUT_IMPULSE },
+};
+
+#define BENCH_NUM_CASES (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+  * @brief Median cost of reading the clock, subtracted from every latency sample
+  */
+static uint64_t bench_timer_overhead(uint64_t *samples)
+{
+    for (size_t i = 0; i < BENCH_NUM_OVERHEAD; i++) {
+        uint64_t start = bench_now_ns();
+        samples[i] = bench_now_ns() - start;
+    }
+    qsort(samples, BENCH_NUM_OVERHEAD, sizeof(uint64_t), bench_compare_u64);
+
+    return samples[BENCH_NUM_OVERHEAD / 2];
+}
+
+static int bench_setup(const bench_case_t *bench_case, bench_filter_t *bench)
+{
+    filter_arena_reset(&bench_pool);
+    bench->num_channels = bench_case->num_channels;
+
+    return bench_case->setup(bench, bench_case->size, bench_case->num_channels);
+}
+
+/**
+  * @brief Time one case, throughput from num_runs block runs and latency from single frame calls
+  * @return 0 on success, -1 if the case does not fit this math mode
+  */
+static int bench_run_case(const bench_case_t *bench_case, const filter_data_t *input, filter_data_t *output,
+                          size_t num_samples, unsigned int num_runs, uint64_t overhead, uint64_t *latency,
+                          bench_result_t *result)
+{
+    bench_filter_t bench;
+    size_t         num_frames = num_samples / bench_case->num_channels;
+    size_t         block_frames = BENCH_BLOCK_SIZE / bench_case->num_channels;
+    uint64_t       best = 0;
+
+    for (unsigned int r = 0; r < num_runs; r++) {
+        if (bench_setup(bench_case, &bench) < 0) {
+            return -1;
+        }
+        uint64_t start = bench_now_ns();
+        for (size_t n = 0; n < num_frames; n += block_frames) {
+            size_t count = (num_frames - n < block_frames) ? num_frames - n : block_frames;
+            bench.run(bench.filter, &input[n * bench.num_channels], &output[n * bench.num_channels], count);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    if (best == 0) {
+        best = 1;
+    }
+
+    // The latency of a call that starts cold is a property of the caller, time a filter that is already running
+    bench_setup(bench_case, &bench);
+    for (size_t i = 0; i < BENCH_NUM_LATENCY; i++) {
+        size_t   frame = (i % num_frames) * bench.num_channels;
+        uint64_t start = bench_now_ns();
+        bench.run(bench.filter, &input[frame], &output[frame], 1);
+        uint64_t elapsed = bench_now_ns() - start;
+        latency[i] = (elapsed > overhead) ? elapsed - overhead : 0;
+    }
+    qsort(latency, BENCH_NUM_LATENCY, sizeof(uint64_t), bench_compare_u64);
+
+    result->name = bench_case->name;
+    result->size = bench_case->size;
+    result->num_channels = bench_case->num_channels;
+    result->samples_per_sec = (double)num_samples * 1e9 / (double)best;
+    result->ns_per_sample = (double)best / (double)num_samples;
+    for (unsigned int p = 0; p < 5; p++) {
+        size_t index = (size_t)(bench_percentiles[p] * (double)(BENCH_NUM_LATENCY - 1));
+        result->latency_ns[p] = (double)latency[index];
+    }
+
+    return 0;
+}
+
+static int bench_write_json(const char *path, const bench_result_t *results, unsigned int num_results,
+                            size_t num_samples, unsigned int num_runs, uint64_t overhead)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return -1;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"math\": \"%s\",\n", BENCH_MATH);
+    fprintf(file, "  \"coeff_bits\": %u,\n  \"data_bits\": %u,\n  \"accum_bits\": %u,\n", (unsigned int)sizeof(filter_coeff_t) * 8,
+            (unsigned int)sizeof(filter_data_t) * 8, (unsigned int)sizeof(filter_accum_t) * 8);
+    fprintf(file, "  \"simd_level\": %u,\n", filter_simd_get_level());
+    fprintf(file, "  \"samples\": %lu,\n  \"runs\": %u,\n  \"latency_calls\": %u,\n  \"timer_overhead_ns\": %lu,\n",
+            (unsigned long)num_samples, num_runs, (unsigned int)BENCH_NUM_LATENCY, (unsigned long)overhead);
+    fprintf(file, "  \"results\": [\n");
+    for (unsigned int i = 0; i < num_results; i++) {
+        const bench_result_t *result = &results[i];
+        fprintf(file, "    {\"filter\": \"%s\", \"size\": %u, \"channels\": %u, \"samples_per_sec\": %.1f, \"ns_per_sample\": %.3f, \"latency_ns\": {",
+                result->name, result->size, result->num_channels, result->samples_per_sec, result->ns_per_sample);
+        for (unsigned int p = 0; p < 5; p++) {
+            fprintf(file, "%s\"%s\": %.0f", p ? ", " : "", bench_percentile_names[p], result->latency_ns[p]);
+        }
+        fprintf(file, "}}%s\n", (i + 1 < num_results) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) ? -1 : 0;
+}
+
+static void bench_usage(const char *name)
+{
+    printf("Usage: %s [-j <file>] [-n <samples>] [-r <runs>] [-f <filter>]\n", name);
+    printf("  -j, --json <file>      Also write the results as JSON\n");
+    printf("  -n, --samples <n>      Samples filtered per timed run, default %u\n", (unsigned int)BENCH_NUM_SAMPLES);
+    printf("  -r, --runs <n>         Timed runs per case, the fastest is reported, default %u\n", (unsigned int)BENCH_NUM_RUNS);
+    printf("  -f, --filter <name>    Only run the cases of this filter, may be repeated\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char  *json_path = NULL;
+    const char  *filters[BENCH_NUM_CASES];
+    unsigned int num_filters = 0;
+    size_t       num_samples = BENCH_NUM_SAMPLES;
+    unsigned int num_runs = BENCH_NUM_RUNS;
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if ((!strcmp(argv[i], "-j") || !strcmp(argv[i], "--json")) && value) {
+            json_path = value;
+        } else if ((!strcmp(argv[i], "-n") || !strcmp(argv[i], "--samples")) && value) {
+            num_samples = (size_t)strtoul(value, NULL, 10);
+        } else if ((!strcmp(argv[i], "-r") || !strcmp(argv[i], "--runs")) && value) {
+            num_runs = (unsigned int)strtoul(value, NULL, 10);
+        } else if ((!strcmp(argv[i], "-f") || !strcmp(argv[i], "--filter")) && value && num_filters < BENCH_NUM_CASES) {
+            filters[num_filters++] = value;
+        } else {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (num_samples < BENCH_NUM_CHANNELS || num_runs == 0) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    filter_data_t  *input = (filter_data_t *)malloc(sizeof(filter_data_t) * num_samples);
+    filter_data_t  *impulse = (filter_data_t *)calloc(num_samples, sizeof(filter_data_t));
+    filter_data_t  *output = (filter_data_t *)malloc(sizeof(filter_data_t) * num_samples);
+    uint64_t       *latency = (uint64_t *)malloc(sizeof(uint64_t) * BENCH_NUM_LATENCY);
+    bench_result_t *results = (bench_result_t *)malloc(sizeof(bench_result_t) * BENCH_NUM_CASES);
+    if (!input || !impulse || !output || !latency || !results) {
+        printf("Failed to allocate the benchmark buffers\n");
+        return 1;
+    }
+    filter_arena_init(&bench_pool, bench_memory, sizeof(bench_memory));
+
+    // Two tones and a little noise, well inside the data range of every math mode
+    srand(1);
+    for (size_t n = 0; n < num_samples; n++) {
+        double value = 50.0 * sin((double)n * 0.01) + 25.0 * sin((double)n * 0.7) + ((double)rand() / RAND_MAX) - 0.5;
+        input[n] = filter_data_from_double(value);
+    }
+    impulse[0] = filter_data_from_double(50.0);
+    bench_design_biquad();
+    uint64_t overhead = bench_timer_overhead(latency);
+
+    printf("math: %s, filter_coeff_t: %lu bits, filter_data_t: %lu bits, filter_accum_t: %lu bits, simd level: %u\n",
+           BENCH_MATH, sizeof(filter_coeff_t) * 8, sizeof(filter_data_t) * 8, sizeof(filter_accum_t) * 8, filter_simd_get_level());
+    printf("%lu samples per run, best of %u runs, latency of %u single frame calls less %lu ns timer overhead\n",
+           (unsigned long)num_samples, num_runs, (unsigned int)BENCH_NUM_LATENCY, (unsigned long)overhead);
+    printf("%-30s %5s %3s %14s %9s %8s %8s %8s %8s %8s\n", "filter", "size", "ch", "samples/s", "ns/sample",
+           "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns");
+
+    unsigned int num_results = 0;
+    for (unsigned int c = 0; c < BENCH_NUM_CASES; c++) {
+        const bench_case_t *bench_case = &bench_cases[c];
+        int                 selected = (num_filters == 0);
+        for (unsigned int f = 0; f < num_filters; f++) {
+            selected |= !strcmp(filters[f], bench_case->name);
+        }
+        if (!selected) {
+            continue;
+        }
+
+        bench_result_t *result = &results[num_results];
+        const filter_data_t *case_input = (bench_case->input == BENCH_INPUT_IMPULSE) ? impulse : input;
+        if (bench_run_case(bench_case, case_input, output, num_samples, num_runs, overhead, latency, result) < 0) {
+            printf("%-30s %5u %3u skipped, does not fit the %s coefficient format\n", bench_case->name, bench_case->size,
+                   bench_case->num_channels, BENCH_MATH);
+            continue;
+        }
+        printf("%-30s %5u %3u %14.0f %9.2f %8.0f %8.0f %8.0f %8.0f %8.0f\n", result->name, result->size, result->num_channels,
+               result->samples_per_sec, result->ns_per_sample, result->latency_ns[0], result->latency_ns[1],
+               result->latency_ns[2], result->latency_ns[3], result->latency_ns[4]);
+        num_results++;
+    }
+
+    int ret = 0;
+    if (json_path && bench_write_json(json_path, results, num_results, num_samples, num_runs, overhead) < 0) {
+        printf("Failed to write %s\n", json_path);
+        ret = 1;
+    }
+
+    free(input);
+    free(impulse);
+    free(output);
+    free(latency);
+    free(results);
+
+    return ret;
+}
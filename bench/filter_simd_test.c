@@ -0,0 +1,143 @@
+#include "../impl/filter_types.h"
+#include "../impl/filter_simd/filter_simd.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest FIR checked, every length up to it is run so every lane and tail split of each kernel is covered
+#define TEST_MAX_TAPS     300
+
+// Random windows checked per length, every other one ends in a tap that cancels the sum
+#define TEST_NUM_WINDOWS  16
+
+// Biquad shapes checked, channel counts cover partial and full lanes of every level
+#define TEST_MAX_CHANNELS 17
+#define TEST_MAX_SECTIONS 4
+#define TEST_NUM_FRAMES   257
+
+static const char *test_level_names[] = { "scalar", "sse2", "avx2", "avx512" };
+
+static double test_random(void)
+{
+    return (2.0 * (double)rand() / (double)RAND_MAX) - 1.0;
+}
+
+/**
+  * @brief Check the dot product of the current level against filter_simd_dot_scalar()
+  * @note The two sums may differ by FILTER_SIMD_FIR_ULP_TOLERANCE * num_coeffs * DBL_EPSILON * sum(|b[i] * x[i]|),
+  *       the windows that cancel make the result itself far smaller than that
+  * @return Number of failures
+  */
+static unsigned int test_dot(unsigned int level)
+{
+    static filter_coeff_t b_coeffs[TEST_MAX_TAPS];
+    static filter_accum_t window[TEST_MAX_TAPS];
+    filter_simd_dot_fn    dot = filter_simd_get_dot();
+    unsigned int          failures = 0;
+    double                worst = 0.0;
+
+    for (unsigned int num_coeffs = 1; num_coeffs <= TEST_MAX_TAPS; num_coeffs++) {
+        for (unsigned int w = 0; w < TEST_NUM_WINDOWS; w++) {
+            double sum = 0.0;
+            for (unsigned int i = 0; i < num_coeffs; i++) {
+                b_coeffs[i] = (filter_coeff_t)test_random();
+                window[i] = (filter_accum_t)(1000.0 * test_random());
+                sum += (double)b_coeffs[i] * (double)window[i];
+            }
+            if ((w & 1) && num_coeffs > 1) {
+                window[num_coeffs - 1] = (filter_accum_t)(-(sum - ((double)b_coeffs[num_coeffs - 1] * (double)window[num_coeffs - 1])) /
+                                                          (double)b_coeffs[num_coeffs - 1]);
+            }
+
+            double sum_abs = 0.0;
+            for (unsigned int i = 0; i < num_coeffs; i++) {
+                sum_abs += fabs((double)b_coeffs[i] * (double)window[i]);
+            }
+            double difference = fabs((double)dot(b_coeffs, window, num_coeffs) -
+                                     (double)filter_simd_dot_scalar(b_coeffs, window, num_coeffs));
+            double bound = FILTER_SIMD_FIR_ULP_TOLERANCE * (double)num_coeffs * DBL_EPSILON * sum_abs;
+            if (difference > bound) {
+                printf("  dot %u taps: difference %g above %g\n", num_coeffs, difference, bound);
+                failures++;
+            }
+            if (sum_abs > 0.0 && difference / ((double)num_coeffs * DBL_EPSILON * sum_abs) > worst) {
+                worst = difference / ((double)num_coeffs * DBL_EPSILON * sum_abs);
+            }
+        }
+    }
+    printf("%-7s dot:    %s, worst %.3f of %u * num_coeffs * DBL_EPSILON * sum(|b * x|)\n", test_level_names[level],
+           failures ? "FAIL" : "ok", worst, (unsigned int)FILTER_SIMD_FIR_ULP_TOLERANCE);
+
+    return failures;
+}
+
+/**
+  * @brief Check the multi channel biquad of the current level is bit exact with filter_simd_biquad_scalar()
+  * @return Number of failures
+  */
+static unsigned int test_biquad(unsigned int level)
+{
+    static filter_coeff_t sos_coeffs[TEST_MAX_SECTIONS][6];
+    static filter_accum_t state[4 * TEST_MAX_SECTIONS * TEST_MAX_CHANNELS];
+    static filter_accum_t reference_state[4 * TEST_MAX_SECTIONS * TEST_MAX_CHANNELS];
+    static filter_data_t  input[TEST_NUM_FRAMES * TEST_MAX_CHANNELS];
+    static filter_data_t  output[TEST_NUM_FRAMES * TEST_MAX_CHANNELS];
+    static filter_data_t  reference[TEST_NUM_FRAMES * TEST_MAX_CHANNELS];
+    filter_simd_biquad_fn biquad = filter_simd_get_biquad();
+    unsigned int          failures = 0;
+
+    // A stable low pass section repeated, poles at radius 0.9
+    for (unsigned int s = 0; s < TEST_MAX_SECTIONS; s++) {
+        sos_coeffs[s][0] = 0.0201;
+        sos_coeffs[s][1] = 0.0402;
+        sos_coeffs[s][2] = 0.0201;
+        sos_coeffs[s][3] = 1.0;
+        sos_coeffs[s][4] = -1.5610;
+        sos_coeffs[s][5] = 0.6414;
+    }
+    for (size_t n = 0; n < TEST_NUM_FRAMES * TEST_MAX_CHANNELS; n++) {
+        input[n] = (filter_data_t)(100.0 * test_random());
+    }
+
+    for (unsigned int num_sections = 1; num_sections <= TEST_MAX_SECTIONS; num_sections++) {
+        for (unsigned int num_channels = 1; num_channels <= TEST_MAX_CHANNELS; num_channels++) {
+            size_t state_size = sizeof(filter_accum_t) * 4 * num_sections * num_channels;
+            memset(state, 0, state_size);
+            memset(reference_state, 0, state_size);
+            biquad(sos_coeffs, num_sections, state, num_channels, input, output, TEST_NUM_FRAMES);
+            filter_simd_biquad_scalar(sos_coeffs, num_sections, reference_state, num_channels, input, reference, TEST_NUM_FRAMES);
+            if (memcmp(output, reference, sizeof(filter_data_t) * TEST_NUM_FRAMES * num_channels) ||
+                memcmp(state, reference_state, state_size)) {
+                printf("  biquad %u sections, %u channels: not bit exact\n", num_sections, num_channels);
+                failures++;
+            }
+        }
+    }
+    printf("%-7s biquad: %s\n", test_level_names[level], failures ? "FAIL" : "ok");
+
+    return failures;
+}
+
+int main(void)
+{
+    unsigned int supported = filter_simd_detect();
+    unsigned int failures = 0;
+
+    printf("simd kernels built: %d, cpu level: %s\n", FILTER_SIMD_ENABLED, test_level_names[supported]);
+    srand(1);
+    for (unsigned int level = FILTER_SIMD_SCALAR; level <= supported; level++) {
+        if (filter_simd_set_level(level) != level) {
+            printf("%-7s could not be forced\n", test_level_names[level]);
+            failures++;
+            continue;
+        }
+        failures += test_dot(level);
+        failures += test_biquad(level);
+    }
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+
+    return failures ? 1 : 0;
+}
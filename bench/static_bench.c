@@ -0,0 +1,151 @@
+#include "../impl/filter_types.h"
+#include "../impl/fir_filter/fir_filter.h"
+#include "../impl/fir_filter/fir_config.h"
+#include "../impl/fir_filter/fir_static_coefficients.h"
+#include "../impl/iir_filter/iir_filter.h"
+#include "../impl/iir_filter/iir_config.h"
+#include "../impl/iir_filter/iir_static_coefficients.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Samples filtered per timed run, and samples handed to each run_block call
+#define BENCH_NUM_SAMPLES (1 << 20)
+#define BENCH_BLOCK_SIZE  1024
+
+// Timed runs per filter, the fastest one is reported
+#define BENCH_NUM_RUNS    5
+
+typedef int (*bench_run_fn)(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+typedef void (*bench_init_fn)(void *filter);
+
+static fir_filter_t   fir_runtime;
+static filter_accum_t fir_runtime_state[FIR_FILTER_MIRRORED_STATE_SIZE(FIR_NUM_COEFFS)];
+static fir_static_filter_t fir_static;
+
+static iir_biquad_filter_t iir_runtime;
+static filter_accum_t      iir_runtime_state[IIR_BIQUAD_DF1_STATE_SIZE(IIR_BIQUAD_NUM_TERMS)];
+static iir_static_biquad_filter_t iir_static;
+
+static void bench_fir_runtime_init(void *filter)
+{
+    fir_filter_init_mirrored((fir_filter_t *)filter, _fir_b_coeffs, fir_runtime_state, FIR_NUM_COEFFS);
+}
+
+static int bench_fir_runtime_run(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return fir_filter_run_block((fir_filter_t *)filter, input, output, num_samples);
+}
+
+static void bench_fir_static_init(void *filter)
+{
+    fir_static_filter_init((fir_static_filter_t *)filter);
+}
+
+static int bench_fir_static_run(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return fir_static_filter_run_block((fir_static_filter_t *)filter, input, output, num_samples);
+}
+
+static void bench_iir_runtime_init(void *filter)
+{
+#if IIR_STATIC_BIQUAD_DF2T
+    iir_biquad_filter_init_df2t((iir_biquad_filter_t *)filter, _iir_sos_coeffs, iir_runtime_state, IIR_BIQUAD_NUM_TERMS);
+#else
+    iir_biquad_filter_init((iir_biquad_filter_t *)filter, _iir_sos_coeffs, iir_runtime_state, IIR_BIQUAD_NUM_TERMS);
+#endif /* IIR_STATIC_BIQUAD_DF2T */
+}
+
+static int bench_iir_runtime_run(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return iir_biquad_filter_run_block((iir_biquad_filter_t *)filter, input, output, num_samples);
+}
+
+static void bench_iir_static_init(void *filter)
+{
+    iir_static_biquad_filter_init((iir_static_biquad_filter_t *)filter);
+}
+
+static int bench_iir_static_run(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return iir_static_biquad_filter_run_block((iir_static_biquad_filter_t *)filter, input, output, num_samples);
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/**
+  * @brief Filter the whole input BENCH_NUM_RUNS times from a fresh state
+  * @return The fastest run in nanoseconds per sample, the output of the last run is left in output
+  */
+static double bench_filter(bench_init_fn init, bench_run_fn run, void *filter, const filter_data_t *input, filter_data_t *output)
+{
+    double best = 0;
+    for (unsigned int r = 0; r < BENCH_NUM_RUNS; r++) {
+        init(filter);
+        double start = bench_now();
+        for (size_t n = 0; n < BENCH_NUM_SAMPLES; n += BENCH_BLOCK_SIZE) {
+            run(filter, &input[n], &output[n], BENCH_BLOCK_SIZE);
+        }
+        double elapsed = (bench_now() - start) * 1e9 / BENCH_NUM_SAMPLES;
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return best;
+}
+
+static void bench_report(const char *name, unsigned int size, double runtime_ns, double static_ns,
+                         const filter_data_t *runtime_out, const filter_data_t *static_out)
+{
+    int identical = !memcmp(runtime_out, static_out, sizeof(filter_data_t) * BENCH_NUM_SAMPLES);
+    printf("%-12s %5u %12.2f %12.2f %8.2fx  %s\n", name, size, runtime_ns, static_ns, runtime_ns / static_ns,
+           identical ? "bit exact" : "OUTPUT DIFFERS");
+}
+
+int main(void)
+{
+    filter_data_t *input = (filter_data_t *)malloc(sizeof(filter_data_t) * BENCH_NUM_SAMPLES);
+    filter_data_t *runtime_out = (filter_data_t *)malloc(sizeof(filter_data_t) * BENCH_NUM_SAMPLES);
+    filter_data_t *static_out = (filter_data_t *)malloc(sizeof(filter_data_t) * BENCH_NUM_SAMPLES);
+    if (!input || !runtime_out || !static_out) {
+        printf("Failed to allocate the benchmark buffers\n");
+        return 1;
+    }
+
+    // Two tones and a little noise, well inside the data range of every math mode
+    srand(1);
+    for (size_t n = 0; n < BENCH_NUM_SAMPLES; n++) {
+        double value = 50.0 * sin((double)n * 0.01) + 25.0 * sin((double)n * 0.7) + ((double)rand() / RAND_MAX) - 0.5;
+        input[n] = filter_data_from_double(value);
+    }
+
+    // The static kernels are scalar code, compare them with the scalar runtime kernel
+    filter_simd_set_level(FILTER_SIMD_SCALAR);
+
+    printf("filter_coeff_t: %lu bits, filter_data_t: %lu bits, filter_accum_t: %lu bits\n",
+           sizeof(filter_coeff_t) * 8, sizeof(filter_data_t) * 8, sizeof(filter_accum_t) * 8);
+    printf("%-12s %5s %12s %12s %9s\n", "filter", "size", "runtime ns", "static ns", "speedup");
+
+    double runtime_ns = bench_filter(bench_fir_runtime_init, bench_fir_runtime_run, &fir_runtime, input, runtime_out);
+    double static_ns = bench_filter(bench_fir_static_init, bench_fir_static_run, &fir_static, input, static_out);
+    bench_report("fir", FIR_NUM_COEFFS, runtime_ns, static_ns, runtime_out, static_out);
+
+    runtime_ns = bench_filter(bench_iir_runtime_init, bench_iir_runtime_run, &iir_runtime, input, runtime_out);
+    static_ns = bench_filter(bench_iir_static_init, bench_iir_static_run, &iir_static, input, static_out);
+    bench_report("iir-biquad", IIR_BIQUAD_NUM_TERMS, runtime_ns, static_ns, runtime_out, static_out);
+
+    free(input);
+    free(runtime_out);
+    free(static_out);
+
+    return 0;
+}
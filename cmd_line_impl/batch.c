@@ -0,0 +1,910 @@
+#include "batch.h"
+#include "filter_runner.h"
+#include "pipeline.h"
+
+#include <dirent.h>
+#include <glob.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Task types
+#define BATCH_TASK_FILE  0
+#define BATCH_TASK_SLICE 1
+#define BATCH_TASK_CHUNK 2
+
+// Tasks a deque holds before it first grows
+#define BATCH_DEQUE_SIZE 64
+
+typedef struct batch_s batch_t;
+typedef struct batch_file_s batch_file_t;
+
+/**
+  * @brief A whole log, a slice of the columns of a log split across the workers, or a chunk of its rows
+  * @note A chunk reads num_history + num_rows rows through view, its own copy of the reader, and keeps the
+  *       filtered rows after the history in output until they are written in order
+  */
+typedef struct
+{
+    batch_file_t *file;
+    int           type;
+    unsigned int  first_channel;
+    unsigned int  num_channels;
+    size_t        num_rows;
+    size_t        num_history;
+    log_reader_t  view;
+    log_block_t   output;
+    int           done;
+} batch_task_t;
+
+/**
+  * @brief A log of the batch, a split log keeps its reader and every row until the last slice writes it, a
+  *        chunked log keeps its reader and writer until the last chunk is written
+  */
+struct batch_file_s
+{
+    char           *input_path;
+    char           *output_path;
+    uint64_t        size;
+    batch_task_t    task;
+    log_reader_t    reader;
+    log_block_t     rows;
+    batch_task_t   *slices;
+    atomic_uint     remaining;
+    atomic_int      failed;
+    pthread_mutex_t lock;
+    log_writer_t    writer;
+    size_t          num_chunks;
+    size_t          next_chunk;
+};
+
+/**
+  * @brief Tasks of one worker, the owner takes from the tail and thieves take from the head
+  */
+typedef struct
+{
+    pthread_mutex_t lock;
+    batch_task_t  **tasks;
+    size_t          capacity;
+    size_t          head;
+    size_t          tail;
+} batch_deque_t;
+
+/**
+  * @brief Worker thread, the runner and buffers are kept from one task to the next
+  */
+typedef struct
+{
+    pthread_t       thread;
+    int             started;
+    batch_t        *batch;
+    unsigned int    index;
+    batch_deque_t   deque;
+    filter_runner_t runner;
+    int             has_runner;
+    log_block_t     block;
+    filter_data_t  *scratch;
+    size_t          scratch_size;
+    uint64_t        num_tasks;
+    uint64_t        num_steals;
+    uint64_t        num_rows;
+    uint64_t        num_values;
+    unsigned int    num_failed;
+    unsigned int    num_split;
+    filter_stats_t  stats[FILTER_RUNNER_MAX_STAGES];
+} batch_worker_t;
+
+struct batch_s
+{
+    const batch_config_t *config;
+    batch_file_t         *files;
+    size_t                num_files;
+    size_t                capacity;
+    batch_worker_t       *workers;
+    unsigned int          num_workers;
+    pthread_mutex_t       lock;
+    pthread_cond_t        wake;
+    size_t                num_queued;
+    size_t                num_pending;
+    int                   history;
+};
+
+static int batch_add_file(batch_t *batch, const char *path, const char *output_dir)
+{
+    if (batch->num_files == batch->capacity) {
+        size_t        capacity = batch->capacity ? (batch->capacity * 2) : 64;
+        batch_file_t *files = (batch_file_t *)realloc(batch->files, sizeof(batch_file_t) * capacity);
+        if (!files) {
+            return BATCH_ERROR_NO_MEMORY;
+        }
+        batch->files = files;
+        batch->capacity = capacity;
+    }
+
+    // The output keeps the file name of the input
+    const char   *slash = strrchr(path, '/');
+    const char   *name = slash ? (slash + 1) : path;
+    batch_file_t *file = &batch->files[batch->num_files];
+    memset(file, 0, sizeof(batch_file_t));
+    file->input_path = strdup(path);
+    file->output_path = (char *)malloc(strlen(output_dir) + strlen(name) + 2);
+    if (!file->input_path || !file->output_path) {
+        free(file->input_path);
+        free(file->output_path);
+        return BATCH_ERROR_NO_MEMORY;
+    }
+    sprintf(file->output_path, "%s/%s", output_dir, name);
+    batch->num_files++;
+
+    // Never write over an input, e.g. when the output directory is the input directory
+    struct stat input;
+    struct stat output;
+    if (stat(path, &input) == 0) {
+        file->size = (uint64_t)input.st_size;
+        if (stat(file->output_path, &output) == 0 && input.st_dev == output.st_dev && input.st_ino == output.st_ino) {
+            printf("Output %s would overwrite its input\n", file->output_path);
+            return BATCH_ERROR_OUTPUT;
+        }
+    }
+
+    return BATCH_ERROR_OK;
+}
+
+static int batch_is_file(const char *path)
+{
+    struct stat st;
+    return (stat(path, &st) == 0) && S_ISREG(st.st_mode);
+}
+
+/**
+  * @brief Strip the blanks around a manifest line
+  * @return Pointer to the path, empty for a blank line
+  */
+static char *batch_trim_line(char *line, ssize_t length)
+{
+    char *begin = line + strspn(line, " \t");
+    char *end = line + length;
+    while (end > begin && strchr(" \t\r\n", end[-1])) {
+        end--;
+    }
+    *end = '\0';
+
+    return begin;
+}
+
+/**
+  * @brief Tell a log passed in place of a manifest from a manifest
+  * @return 1 if the file starts with LOG_FCOL_MAGIC or its first entry is not a readable file, e.g. a CSV header
+  */
+static int batch_is_log(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+    char magic[4];
+    int  is_log = (fread(magic, 1, sizeof(magic), file) == sizeof(magic)) && !memcmp(magic, LOG_FCOL_MAGIC, 4);
+    if (!is_log) {
+        char   *line = NULL;
+        size_t  line_size = 0;
+        ssize_t length;
+        rewind(file);
+        while ((length = getline(&line, &line_size, file)) >= 0) {
+            char *begin = batch_trim_line(line, length);
+            if (*begin != '\0' && *begin != '#') {
+                is_log = !batch_is_file(begin) || access(begin, R_OK) != 0;
+                break;
+            }
+        }
+        free(line);
+    }
+    fclose(file);
+
+    return is_log;
+}
+
+/**
+  * @brief Collect the logs of a directory, glob pattern or manifest, or a single log
+  */
+static int batch_collect(batch_t *batch, const char *inputs, const char *output_dir)
+{
+    struct stat st;
+    int         ret = BATCH_ERROR_OK;
+
+    if (strpbrk(inputs, "*?[")) {
+        glob_t matches;
+        if (glob(inputs, 0, NULL, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc && ret == BATCH_ERROR_OK; i++) {
+                if (batch_is_file(matches.gl_pathv[i])) {
+                    ret = batch_add_file(batch, matches.gl_pathv[i], output_dir);
+                }
+            }
+            globfree(&matches);
+        }
+    } else if (stat(inputs, &st) != 0) {
+        return BATCH_ERROR_NO_FILES;
+    } else if (S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(inputs);
+        if (!dir) {
+            return BATCH_ERROR_NO_FILES;
+        }
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL && ret == BATCH_ERROR_OK) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            char *path = (char *)malloc(strlen(inputs) + strlen(entry->d_name) + 2);
+            if (!path) {
+                ret = BATCH_ERROR_NO_MEMORY;
+                break;
+            }
+            sprintf(path, "%s/%s", inputs, entry->d_name);
+            if (batch_is_file(path)) {
+                ret = batch_add_file(batch, path, output_dir);
+            }
+            free(path);
+        }
+        closedir(dir);
+    } else if (batch_is_log(inputs)) {
+        // One log on its own rather than a manifest, so its rows are not taken as paths
+        ret = batch_add_file(batch, inputs, output_dir);
+    } else {
+        // A manifest, a log that is listed but missing fails when it is opened
+        FILE *manifest = fopen(inputs, "r");
+        if (!manifest) {
+            return BATCH_ERROR_NO_FILES;
+        }
+        char   *line = NULL;
+        size_t  line_size = 0;
+        ssize_t length;
+        while ((length = getline(&line, &line_size, manifest)) >= 0 && ret == BATCH_ERROR_OK) {
+            char *begin = batch_trim_line(line, length);
+            if (*begin != '\0' && *begin != '#') {
+                ret = batch_add_file(batch, begin, output_dir);
+            }
+        }
+        free(line);
+        fclose(manifest);
+    }
+
+    if (ret == BATCH_ERROR_OK && batch->num_files == 0) {
+        ret = BATCH_ERROR_NO_FILES;
+    }
+
+    return ret;
+}
+
+static int batch_compare_output(const void *a, const void *b)
+{
+    return strcmp(((const batch_file_t *)a)->output_path, ((const batch_file_t *)b)->output_path);
+}
+
+static int batch_compare_size(const void *a, const void *b)
+{
+    uint64_t size_a = ((const batch_file_t *)a)->size;
+    uint64_t size_b = ((const batch_file_t *)b)->size;
+    return (size_a > size_b) - (size_a < size_b);
+}
+
+/**
+  * @brief Queue a task on the deque of a worker
+  * @return 0 on success, negative if the deque can not grow
+  */
+static int batch_push(batch_worker_t *worker, batch_task_t *task)
+{
+    batch_deque_t *deque = &worker->deque;
+    batch_t       *batch = worker->batch;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->capacity) {
+        // Move the tasks back to the start, or grow the deque once it is full
+        if (deque->head > 0) {
+            memmove(deque->tasks, &deque->tasks[deque->head], sizeof(batch_task_t *) * (deque->tail - deque->head));
+            deque->tail -= deque->head;
+            deque->head = 0;
+        } else {
+            batch_task_t **tasks = (batch_task_t **)realloc(deque->tasks, sizeof(batch_task_t *) * deque->capacity * 2);
+            if (!tasks) {
+                pthread_mutex_unlock(&deque->lock);
+                return -1;
+            }
+            deque->tasks = tasks;
+            deque->capacity *= 2;
+        }
+    }
+    deque->tasks[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
+
+    pthread_mutex_lock(&batch->lock);
+    batch->num_queued++;
+    batch->num_pending++;
+    pthread_cond_signal(&batch->wake);
+    pthread_mutex_unlock(&batch->lock);
+
+    return 0;
+}
+
+static batch_task_t *batch_pop(batch_deque_t *deque, int steal)
+{
+    batch_task_t *task = NULL;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head < deque->tail) {
+        task = steal ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return task;
+}
+
+/**
+  * @brief Take the newest task of the worker, or steal the oldest task of another worker
+  * @return The task, NULL once every task has been run
+  */
+static batch_task_t *batch_take(batch_worker_t *worker)
+{
+    batch_t *batch = worker->batch;
+
+    for (;;) {
+        batch_task_t *task = batch_pop(&worker->deque, 0);
+        for (unsigned int i = 1; !task && i < batch->num_workers; i++) {
+            task = batch_pop(&batch->workers[(worker->index + i) % batch->num_workers].deque, 1);
+            worker->num_steals += task ? 1 : 0;
+        }
+
+        pthread_mutex_lock(&batch->lock);
+        if (task) {
+            batch->num_queued--;
+            pthread_mutex_unlock(&batch->lock);
+            return task;
+        }
+        if (batch->num_pending == 0) {
+            pthread_mutex_unlock(&batch->lock);
+            return NULL;
+        }
+        // A running task may still queue slices
+        if (batch->num_queued == 0) {
+            pthread_cond_wait(&batch->wake, &batch->lock);
+        }
+        pthread_mutex_unlock(&batch->lock);
+    }
+}
+
+static void batch_done(batch_t *batch)
+{
+    pthread_mutex_lock(&batch->lock);
+    if (--batch->num_pending == 0) {
+        pthread_cond_broadcast(&batch->wake);
+    }
+    pthread_mutex_unlock(&batch->lock);
+}
+
+/**
+  * @brief Get a runner for num_channels columns, the runner of the last task is reused when the width matches
+  * @return Pointer to the runner, NULL on error
+  */
+static filter_runner_t *batch_worker_runner(batch_worker_t *worker, unsigned int num_channels)
+{
+    const batch_config_t *config = worker->batch->config;
+
+    if (worker->has_runner) {
+        filter_runner_get_stats(&worker->runner, worker->stats);
+        if (worker->runner.num_channels == num_channels && filter_runner_reset(&worker->runner) == 0) {
+            return &worker->runner;
+        }
+        filter_runner_free(&worker->runner);
+        worker->has_runner = 0;
+    }
+    if (filter_runner_init(&worker->runner, config->filter_types, config->num_filters, num_channels, config->decimation)) {
+        filter_runner_free(&worker->runner);
+        return NULL;
+    }
+    worker->has_runner = 1;
+
+    return &worker->runner;
+}
+
+static int batch_open_writer(const batch_config_t *config, batch_file_t *file, log_writer_t *writer)
+{
+    if (log_writer_open(writer, file->output_path, log_format_from_path(file->output_path)) != LOG_IO_ERROR_OK) {
+        return -1;
+    }
+    if (log_writer_set_precision(writer, config->precision) != LOG_IO_ERROR_OK ||
+        log_writer_set_decimation(writer, config->decimation) != LOG_IO_ERROR_OK ||
+        log_writer_write_header(writer, &file->reader) != LOG_IO_ERROR_OK) {
+        log_writer_close(writer);
+        return -1;
+    }
+
+    return 0;
+}
+
+static void batch_process_slice(batch_worker_t *worker, batch_task_t *slice);
+static void batch_process_chunk(batch_worker_t *worker, batch_task_t *chunk);
+
+/**
+  * @brief Read a large log into memory and queue one task per slice of its columns
+  */
+static int batch_split_file(batch_worker_t *worker, batch_file_t *file)
+{
+    const unsigned int num_channels = file->reader.num_columns - 1;
+    const unsigned int num_slices = (worker->batch->num_workers < num_channels) ? worker->batch->num_workers : num_channels;
+
+    file->slices = (batch_task_t *)calloc(num_slices, sizeof(batch_task_t));
+    if (!file->slices || log_block_init(&file->rows, (size_t)file->reader.num_samples, num_channels) != LOG_IO_ERROR_OK) {
+        free(file->slices);
+        file->slices = NULL;
+        return -1;
+    }
+    log_reader_read_block(&file->reader, &file->rows);
+    worker->num_rows += file->rows.num_rows;
+    worker->num_values += file->rows.num_rows * num_channels;
+    worker->num_split++;
+
+    // Split the columns as evenly as possible, the slices run in any order
+    unsigned int first_channel = 0;
+    atomic_store(&file->remaining, num_slices);
+    for (unsigned int i = 0; i < num_slices; i++) {
+        batch_task_t *slice = &file->slices[i];
+        slice->file = file;
+        slice->type = BATCH_TASK_SLICE;
+        slice->first_channel = first_channel;
+        slice->num_channels = (num_channels / num_slices) + ((i < num_channels % num_slices) ? 1 : 0);
+        first_channel += slice->num_channels;
+    }
+    for (unsigned int i = num_slices; i-- > 0;) {
+        if (batch_push(worker, &file->slices[i])) {
+            batch_process_slice(worker, &file->slices[i]);
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief Queue one task per chunk of the rows of a large log with fewer columns than workers
+  * @note Every chunk is read straight from the mapping of the log by the worker that filters it. Like
+  *       pipeline_run_chunked(), each chunk starts the history of the filters early from a reset runner.
+  * @return 0 on success, negative if the log is not worth chunking or on error
+  */
+static int batch_chunk_file(batch_worker_t *worker, batch_file_t *file)
+{
+    const batch_config_t *config = worker->batch->config;
+    const size_t          decimation = config->decimation;
+    const size_t          history = (size_t)worker->batch->history;
+    const size_t          num_rows = (size_t)file->reader.num_samples;
+    const size_t          target = (size_t)worker->batch->num_workers * BATCH_CHUNKS_PER_WORKER;
+
+    // Chunks at least 8 times the history keep the overlap a small overhead, every chunk starts on a kept row
+    size_t chunk_rows = (num_rows + target - 1) / target;
+    if (chunk_rows < history * 8) {
+        chunk_rows = history * 8;
+    }
+    chunk_rows = ((chunk_rows + decimation - 1) / decimation) * decimation;
+    const size_t num_chunks = (num_rows + chunk_rows - 1) / chunk_rows;
+    if (num_chunks < 2) {
+        return -1;
+    }
+
+    file->slices = (batch_task_t *)calloc(num_chunks, sizeof(batch_task_t));
+    if (!file->slices || batch_open_writer(config, file, &file->writer)) {
+        free(file->slices);
+        file->slices = NULL;
+        return -1;
+    }
+    pthread_mutex_init(&file->lock, NULL);
+    file->num_chunks = num_chunks;
+    file->next_chunk = 0;
+    worker->num_split++;
+
+    // One pass over the line endings puts a copy of the reader at the start of each chunk's history
+    log_reader_t cursor = file->reader;
+    size_t       position = 0;
+    for (size_t i = 0; i < num_chunks; i++) {
+        batch_task_t *chunk = &file->slices[i];
+        const size_t  first = i * chunk_rows;
+        chunk->file = file;
+        chunk->type = BATCH_TASK_CHUNK;
+        chunk->num_history = (first < history) ? first : history;
+        chunk->num_rows = (num_rows - first < chunk_rows) ? (num_rows - first) : chunk_rows;
+        position += log_reader_skip(&cursor, first - chunk->num_history - position);
+        chunk->view = cursor;
+    }
+    for (size_t i = num_chunks; i-- > 0;) {
+        if (batch_push(worker, &file->slices[i])) {
+            batch_process_chunk(worker, &file->slices[i]);
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief Filter a log, logs too large for one worker are split instead
+  * @return 0 on success, negative on error
+  */
+static int batch_process_file(batch_worker_t *worker, batch_file_t *file)
+{
+    const batch_config_t *config = worker->batch->config;
+
+    if (log_reader_open(&file->reader, file->input_path) != LOG_IO_ERROR_OK) {
+        log_reader_close(&file->reader);
+        return -1;
+    }
+    const unsigned int num_channels = file->reader.num_columns - 1;
+    if (file->reader.num_columns < 2) {
+        log_reader_close(&file->reader);
+        return -1;
+    }
+    if (worker->batch->num_workers > 1 && file->reader.num_samples >= BATCH_SPLIT_ROWS) {
+        // Too few columns to go round the workers, cut the rows instead when the filters are exact in chunks
+        if (num_channels < worker->batch->num_workers && worker->batch->history >= 0 &&
+            batch_chunk_file(worker, file) == 0) {
+            return 0;
+        }
+        if (num_channels > 1 && file->reader.num_samples * num_channels * sizeof(filter_data_t) <= BATCH_SPLIT_MAX_BYTES &&
+            batch_split_file(worker, file) == 0) {
+            return 0;
+        }
+    }
+
+    // The block is only created again when the number of columns changes
+    if (worker->block.data && worker->block.num_channels != num_channels) {
+        log_block_free(&worker->block);
+    }
+    filter_runner_t *runner = batch_worker_runner(worker, num_channels);
+    log_writer_t     writer;
+    if (!runner || (!worker->block.data && log_block_init(&worker->block, BATCH_BLOCK_ROWS, num_channels) != LOG_IO_ERROR_OK) ||
+        batch_open_writer(config, file, &writer)) {
+        log_reader_close(&file->reader);
+        return -1;
+    }
+
+    log_block_t *block = &worker->block;
+    unsigned int phase = 0;
+    while (log_reader_read_block(&file->reader, block)) {
+        worker->num_rows += block->num_rows;
+        worker->num_values += block->num_rows * num_channels;
+        size_t num_rows = filter_runner_run(runner, block->data, block->num_rows);
+        filter_runner_decimate(block->time_stamps, sizeof(unsigned int), block->num_rows, config->decimation, &phase);
+        block->num_rows = num_rows;
+        log_writer_write_block(&writer, block);
+    }
+
+    log_writer_close(&writer);
+    log_reader_close(&file->reader);
+
+    return 0;
+}
+
+/**
+  * @brief Write a split log once every slice is filtered and release it
+  */
+static void batch_finish_split(batch_worker_t *worker, batch_file_t *file)
+{
+    const batch_config_t *config = worker->batch->config;
+    log_writer_t          writer;
+
+    if (!atomic_load(&file->failed) && batch_open_writer(config, file, &writer) == 0) {
+        // Every slice kept the same rows, drop the other time stamps to match
+        unsigned int phase = 0;
+        file->rows.num_rows = filter_runner_decimate(file->rows.time_stamps, sizeof(unsigned int), file->rows.num_rows,
+                                                     config->decimation, &phase);
+        log_writer_write_block(&writer, &file->rows);
+        log_writer_close(&writer);
+    } else {
+        printf("Failed to filter %s\n", file->input_path);
+        worker->num_failed++;
+    }
+
+    log_reader_close(&file->reader);
+    log_block_free(&file->rows);
+    free(file->slices);
+    file->slices = NULL;
+}
+
+/**
+  * @brief Filter the columns of a slice in place, the other slices only touch their own columns
+  */
+static void batch_process_slice(batch_worker_t *worker, batch_task_t *slice)
+{
+    batch_file_t      *file = slice->file;
+    const unsigned int width = slice->num_channels;
+    const unsigned int stride = file->rows.num_channels;
+    filter_runner_t   *runner = batch_worker_runner(worker, width);
+
+    if (runner && worker->scratch_size < (size_t)BATCH_BLOCK_ROWS * width) {
+        free(worker->scratch);
+        worker->scratch_size = (size_t)BATCH_BLOCK_ROWS * width;
+        worker->scratch = (filter_data_t *)malloc(sizeof(filter_data_t) * worker->scratch_size);
+        if (!worker->scratch) {
+            worker->scratch_size = 0;
+        }
+    }
+    if (!runner || !worker->scratch) {
+        atomic_store(&file->failed, 1);
+    } else {
+        // Outputs never run ahead of the inputs, so the kept rows are packed in place
+        filter_data_t *data = file->rows.data + slice->first_channel;
+        size_t         kept = 0;
+        for (size_t start = 0; start < file->rows.num_rows; start += BATCH_BLOCK_ROWS) {
+            size_t count = file->rows.num_rows - start;
+            if (count > BATCH_BLOCK_ROWS) {
+                count = BATCH_BLOCK_ROWS;
+            }
+            for (size_t n = 0; n < count; n++) {
+                memcpy(&worker->scratch[n * width], &data[(start + n) * stride], sizeof(filter_data_t) * width);
+            }
+            size_t num_rows = filter_runner_run(runner, worker->scratch, count);
+            for (size_t n = 0; n < num_rows; n++) {
+                memcpy(&data[(kept + n) * stride], &worker->scratch[n * width], sizeof(filter_data_t) * width);
+            }
+            kept += num_rows;
+        }
+    }
+
+    if (atomic_fetch_sub(&file->remaining, 1) == 1) {
+        batch_finish_split(worker, file);
+    }
+}
+
+/**
+  * @brief Mark a chunk filtered and write every chunk that is next in order, the last one closes the log
+  */
+static void batch_finish_chunk(batch_worker_t *worker, batch_task_t *chunk)
+{
+    batch_file_t *file = chunk->file;
+
+    pthread_mutex_lock(&file->lock);
+    chunk->done = 1;
+    while (file->next_chunk < file->num_chunks && file->slices[file->next_chunk].done) {
+        batch_task_t *next = &file->slices[file->next_chunk++];
+        if (!atomic_load(&file->failed)) {
+            log_writer_write_block(&file->writer, &next->output);
+        }
+        log_block_free(&next->output);
+    }
+    int finished = (file->next_chunk == file->num_chunks);
+    pthread_mutex_unlock(&file->lock);
+    if (!finished) {
+        return;
+    }
+
+    log_writer_close(&file->writer);
+    if (atomic_load(&file->failed)) {
+        printf("Failed to filter %s\n", file->input_path);
+        worker->num_failed++;
+    }
+    log_reader_close(&file->reader);
+    pthread_mutex_destroy(&file->lock);
+    free(file->slices);
+    file->slices = NULL;
+}
+
+/**
+  * @brief Filter a chunk of rows from a reset runner and keep the rows after its history
+  */
+static void batch_process_chunk(batch_worker_t *worker, batch_task_t *chunk)
+{
+    batch_file_t      *file = chunk->file;
+    const unsigned int num_channels = file->reader.num_columns - 1;
+    const unsigned int decimation = worker->batch->config->decimation;
+
+    // The block is only created again when the number of columns changes
+    if (worker->block.data && worker->block.num_channels != num_channels) {
+        log_block_free(&worker->block);
+    }
+    filter_runner_t *runner = batch_worker_runner(worker, num_channels);
+    if (!runner || (!worker->block.data && log_block_init(&worker->block, BATCH_BLOCK_ROWS, num_channels) != LOG_IO_ERROR_OK) ||
+        log_block_init(&chunk->output, (chunk->num_rows + decimation - 1) / decimation, num_channels) != LOG_IO_ERROR_OK) {
+        atomic_store(&file->failed, 1);
+    } else {
+        // The history is a multiple of the decimation, so the runner keeps the same rows a runner that filtered
+        // the whole log keeps and the first skip of them are the history
+        size_t       remaining = chunk->num_history + chunk->num_rows;
+        size_t       skip = chunk->num_history / decimation;
+        unsigned int phase = 0;
+        log_block_t  block = worker->block;
+        while (remaining > 0) {
+            block.capacity = (remaining < worker->block.capacity) ? remaining : worker->block.capacity;
+            size_t count = log_reader_read_block(&chunk->view, &block);
+            if (count == 0) {
+                break;
+            }
+            remaining -= count;
+            size_t kept = filter_runner_run(runner, block.data, count);
+            filter_runner_decimate(block.time_stamps, sizeof(unsigned int), count, decimation, &phase);
+            size_t drop = (skip < kept) ? skip : kept;
+            skip -= drop;
+            log_block_t *output = &chunk->output;
+            memcpy(&output->time_stamps[output->num_rows], &block.time_stamps[drop], sizeof(unsigned int) * (kept - drop));
+            memcpy(&output->data[output->num_rows * num_channels], &block.data[drop * num_channels],
+                   sizeof(filter_data_t) * (kept - drop) * num_channels);
+            output->num_rows += kept - drop;
+        }
+        worker->num_rows += chunk->num_rows;
+        worker->num_values += chunk->num_rows * num_channels;
+    }
+
+    batch_finish_chunk(worker, chunk);
+}
+
+static void *batch_worker_main(void *arg)
+{
+    batch_worker_t *worker = (batch_worker_t *)arg;
+    batch_task_t   *task;
+
+    while ((task = batch_take(worker)) != NULL) {
+        worker->num_tasks++;
+        if (task->type == BATCH_TASK_SLICE) {
+            batch_process_slice(worker, task);
+        } else if (task->type == BATCH_TASK_CHUNK) {
+            batch_process_chunk(worker, task);
+        } else if (batch_process_file(worker, task->file)) {
+            printf("Failed to filter %s\n", task->file->input_path);
+            worker->num_failed++;
+        }
+        batch_done(worker->batch);
+    }
+
+    if (worker->has_runner) {
+        filter_runner_get_stats(&worker->runner, worker->stats);
+        filter_runner_free(&worker->runner);
+        worker->has_runner = 0;
+    }
+
+    return NULL;
+}
+
+static void batch_free(batch_t *batch)
+{
+    if (batch->workers) {
+        for (unsigned int i = 0; i < batch->num_workers; i++) {
+            batch_worker_t *worker = &batch->workers[i];
+            free(worker->deque.tasks);
+            pthread_mutex_destroy(&worker->deque.lock);
+            log_block_free(&worker->block);
+            free(worker->scratch);
+        }
+        free(batch->workers);
+    }
+    for (size_t i = 0; i < batch->num_files; i++) {
+        free(batch->files[i].input_path);
+        free(batch->files[i].output_path);
+    }
+    free(batch->files);
+    pthread_cond_destroy(&batch->wake);
+    pthread_mutex_destroy(&batch->lock);
+}
+
+int batch_run(const char *inputs, const char *output_dir, const batch_config_t *config, batch_stats_t *stats,
+              filter_stats_t *filter_stats)
+{
+    batch_t         batch;
+    struct stat     st;
+    struct timespec start;
+    struct timespec end;
+
+    if (!inputs || !output_dir || !config || !stats || !config->filter_types || config->num_filters == 0 ||
+        config->num_filters > FILTER_RUNNER_MAX_STAGES || config->decimation == 0) {
+        return BATCH_ERROR_INVALID_PARAM;
+    }
+    memset(stats, 0, sizeof(batch_stats_t));
+    if (stat(output_dir, &st) != 0 && mkdir(output_dir, 0777) != 0) {
+        return BATCH_ERROR_OUTPUT;
+    }
+    if (stat(output_dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return BATCH_ERROR_OUTPUT;
+    }
+
+    memset(&batch, 0, sizeof(batch_t));
+    batch.config = config;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.wake, NULL);
+    int ret = batch_collect(&batch, inputs, output_dir);
+    if (ret != BATCH_ERROR_OK) {
+        batch_free(&batch);
+        return ret;
+    }
+
+    // Two inputs with the same file name would write the same output
+    qsort(batch.files, batch.num_files, sizeof(batch_file_t), batch_compare_output);
+    for (size_t i = 1; i < batch.num_files; i++) {
+        if (!strcmp(batch.files[i - 1].output_path, batch.files[i].output_path)) {
+            printf("Two inputs write %s\n", batch.files[i].output_path);
+            batch_free(&batch);
+            return BATCH_ERROR_OUTPUT;
+        }
+    }
+
+    // Logs with fewer columns than workers are cut into chunks of rows, each starting early by the history of the
+    // filters, see pipeline_run_chunked(). Unlike -T the user never asks for it, so only filters that forget their
+    // initial state exactly and round the same way in every chunk are chunked, a rounding bound of 0 rules out the
+    // IIR, biquad and EMA filters, and in the floating point build the SMA and CIC running sums
+    double rounding = 0.0;
+    batch.history = filter_runner_history_length(config->filter_types, config->num_filters, PIPELINE_SETTLE_TOLERANCE);
+    if (batch.history > PIPELINE_CHUNK_MAX_HISTORY ||
+        filter_runner_rounding_bound(config->filter_types, config->num_filters, &rounding) != 0 || rounding != 0.0) {
+        batch.history = -1;
+    } else if (batch.history > 0) {
+        batch.history = (int)(((batch.history + config->decimation - 1) / config->decimation) * config->decimation);
+    }
+
+    // One worker per online CPU by default
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    batch.num_workers = config->num_workers ? config->num_workers : ((num_cpus > 0) ? (unsigned int)num_cpus : 1);
+    batch.workers = (batch_worker_t *)calloc(batch.num_workers, sizeof(batch_worker_t));
+    if (!batch.workers) {
+        batch_free(&batch);
+        return BATCH_ERROR_NO_MEMORY;
+    }
+    for (unsigned int i = 0; i < batch.num_workers; i++) {
+        batch_worker_t *worker = &batch.workers[i];
+        worker->batch = &batch;
+        worker->index = i;
+        worker->deque.capacity = BATCH_DEQUE_SIZE;
+        worker->deque.tasks = (batch_task_t **)malloc(sizeof(batch_task_t *) * BATCH_DEQUE_SIZE);
+        pthread_mutex_init(&worker->deque.lock, NULL);
+        if (!worker->deque.tasks) {
+            batch_free(&batch);
+            return BATCH_ERROR_NO_MEMORY;
+        }
+    }
+
+    // Deal the logs out smallest first, each worker takes its newest task so the largest logs start first and the
+    // small ones left at the end are stolen to even out the finish
+    qsort(batch.files, batch.num_files, sizeof(batch_file_t), batch_compare_size);
+    for (size_t i = 0; i < batch.num_files; i++) {
+        batch_file_t *file = &batch.files[i];
+        file->task.file = file;
+        file->task.type = BATCH_TASK_FILE;
+        if (batch_push(&batch.workers[i % batch.num_workers], &file->task)) {
+            batch_free(&batch);
+            return BATCH_ERROR_NO_MEMORY;
+        }
+        stats->num_bytes += file->size;
+    }
+
+    // Workers that fail to start leave their tasks to be stolen
+    unsigned int num_started = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < batch.num_workers; i++) {
+        batch.workers[i].started = (pthread_create(&batch.workers[i].thread, NULL, batch_worker_main, &batch.workers[i]) == 0);
+        num_started += batch.workers[i].started ? 1 : 0;
+    }
+    if (num_started == 0) {
+        batch_free(&batch);
+        return BATCH_ERROR_THREAD;
+    }
+    for (unsigned int i = 0; i < batch.num_workers; i++) {
+        if (batch.workers[i].started) {
+            pthread_join(batch.workers[i].thread, NULL);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Add up the workers
+    stats->num_files = (unsigned int)batch.num_files;
+    stats->seconds = (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) / 1e9);
+    for (unsigned int i = 0; i < batch.num_workers; i++) {
+        const batch_worker_t *worker = &batch.workers[i];
+        stats->num_failed += worker->num_failed;
+        stats->num_split += worker->num_split;
+        stats->num_tasks += worker->num_tasks;
+        stats->num_steals += worker->num_steals;
+        stats->num_rows += worker->num_rows;
+        stats->num_values += worker->num_values;
+        for (unsigned int j = 0; filter_stats && j < config->num_filters; j++) {
+            filter_stats_merge(&filter_stats[j], &worker->stats[j]);
+        }
+    }
+
+    batch_free(&batch);
+
+    return stats->num_failed ? BATCH_ERROR_FAILED : BATCH_ERROR_OK;
+}
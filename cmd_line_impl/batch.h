@@ -0,0 +1,91 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "log_io.h"
+#include "../impl/filter_stats/filter_stats.h"
+
+#include <stdint.h>
+
+#define BATCH_ERROR_OK            0
+#define BATCH_ERROR_INVALID_PARAM -1
+#define BATCH_ERROR_NO_MEMORY     -2
+#define BATCH_ERROR_NO_FILES      -3
+#define BATCH_ERROR_OUTPUT        -4
+#define BATCH_ERROR_THREAD        -5
+#define BATCH_ERROR_FAILED        -6
+
+// Rows each worker reads, filters and writes as one unit
+#define BATCH_BLOCK_ROWS       1024
+
+// Logs with at least this many rows are split across the workers, by column when there are enough columns to go
+// round and by chunks of rows otherwise
+#define BATCH_SPLIT_ROWS       (1 << 16)
+
+// Chunks of rows a log with fewer columns than workers is cut into per worker, so a log still evens out when the
+// workers also run other logs
+#define BATCH_CHUNKS_PER_WORKER 4
+
+// Largest log in bytes of filter_data_t that is split, a split log is held in memory between reading and writing
+#define BATCH_SPLIT_MAX_BYTES  ((size_t)1 << 28)
+
+/**
+  * @brief Filters and output settings every log of a batch is processed with
+  */
+typedef struct
+{
+    const int   *filter_types;
+    unsigned int num_filters;
+    unsigned int decimation;
+    int          precision;
+    unsigned int num_workers;
+} batch_config_t;
+
+/**
+  * @brief Totals over every log of a batch
+  */
+typedef struct
+{
+    unsigned int num_files;
+    unsigned int num_failed;
+    unsigned int num_split;
+    uint64_t     num_tasks;
+    uint64_t     num_steals;
+    uint64_t     num_rows;
+    uint64_t     num_values;
+    uint64_t     num_bytes;
+    double       seconds;
+} batch_stats_t;
+
+/**
+  * @brief Filter many logs on a work stealing pool of threads
+  * @note The inputs are a directory, every regular file in it that does not start with '.', a glob pattern, any
+  *       argument containing '*', '?' or '[', or a manifest file listing one log per line. Empty manifest lines
+  *       and lines starting with # are skipped. A file that starts with LOG_FCOL_MAGIC, or whose first entry is not
+  *       a readable file, e.g. the header of a CSV log, is filtered as a single log instead of read as a manifest.
+  *       Each output has the file name of its input and is written to
+  *       output_dir, an output name ending in .fcol is written as a binary columnar log.
+  *       Each worker owns a deque of tasks and takes the newest of its own, an idle worker steals the oldest task
+  *       of another worker. The logs are dealt out largest first. A log of at least BATCH_SPLIT_ROWS rows with
+  *       at least as many data columns as workers is read into memory by one worker and its columns are split into
+  *       one task per worker, the worker that finishes the last slice writes it. A log of that many rows with
+  *       fewer columns is cut into BATCH_CHUNKS_PER_WORKER chunks of rows per worker instead, each read straight
+  *       from the mapping of the log by the worker that filters it and written in order as soon as the chunks
+  *       before it are. Like pipeline_run_chunked(), every chunk starts filter_runner_history_length() rows early
+  *       from a reset runner. Logs are only chunked when filter_runner_rounding_bound() is 0, i.e. FIR, SMA, CIC,
+  *       median and Hampel filters, without the SMA and CIC in the floating point build and without an FFT
+  *       convolution. Other filters fall back to the column split, or to one task per log. Every worker keeps its
+  *       filter runners and buffers from one log to the next and only creates them again when the number of
+  *       columns changes. The output of every log is identical to filtering it on its own.
+  *       A log that fails does not stop the others, it is reported and counted in num_failed.
+  * @param inputs Directory, glob pattern or manifest file
+  * @param output_dir Directory the outputs are written to, created if it does not exist
+  * @param config Pointer to the filters and output settings, num_workers 0 uses one worker per online CPU
+  * @param stats Pointer to the totals
+  * @param filter_stats Pointer to one total per filter the counters of every log are added to, see
+  *                     filter_runner_get_stats(). May be NULL
+  * @return BATCH_ERROR_OK on success, BATCH_ERROR_FAILED if any log failed, negative on error
+  */
+int batch_run(const char *inputs, const char *output_dir, const batch_config_t *config, batch_stats_t *stats,
+              filter_stats_t *filter_stats);
+
+#endif /* BATCH_H_ */
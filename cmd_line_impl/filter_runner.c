@@ -0,0 +1,1064 @@
+#include "filter_runner.h"
+#include "../impl/iir_filter/iir_config.h"
+#include "../impl/fir_filter/fir_config.h"
+#include "../impl/filter_simd/filter_simd.h"
+
+#include <ctype.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Alignment of each chain stage filter and state carved out of the arena
+#define FILTER_RUNNER_STAGE_ALIGN 16
+
+// Command line names, indexed by FILTER_RUNNER_* type
+static const char *const filter_runner_names[] = {
+    "sma", "iir", "iir-biquad", "iir-biquad-df2t", "fir", "cic", "ema", "median", "hampel"
+};
+
+#define FILTER_RUNNER_ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define FILTER_RUNNER_NUM_TYPES         FILTER_RUNNER_ARRAY_SIZE(filter_runner_names)
+
+// filter_designer.py config values, indexed by FILTER_DESIGN_* band, type and window. The filters from
+// FILTER_RUNNER_DESIGN_FIR on are FIR filters
+static const char *const filter_runner_design_filters[] = { "iir", "iir-biquad", "fir", "fir-custom" };
+static const char *const filter_runner_design_bands[] = { "lowpass", "highpass", "bandpass", "bandstop" };
+static const char *const filter_runner_design_types[] = { "butter", "cheby1", "cheby2" };
+static const char *const filter_runner_design_windows[] = { "hamming", "hann", "blackman", "bartlett", "boxcar" };
+
+#define FILTER_RUNNER_DESIGN_FIR 2
+
+// Largest IIR design, band pass and band stop filters have twice the prototype order
+#define FILTER_RUNNER_DESIGN_NUM_COEFFS   FILTER_DESIGN_NUM_COEFFS(FILTER_DESIGN_MAX_ORDER, FILTER_DESIGN_BAND_BANDPASS)
+#define FILTER_RUNNER_DESIGN_NUM_SECTIONS FILTER_DESIGN_NUM_SECTIONS(FILTER_DESIGN_MAX_ORDER, FILTER_DESIGN_BAND_BANDPASS)
+
+/**
+  * @brief Coefficients of the last filter_runner_design() call, at full precision and converted for the filters
+  */
+typedef struct
+{
+    filter_design_spec_t spec;
+    unsigned int         num_sections;
+    double               fir_b[FILTER_DESIGN_MAX_TAPS];
+    double               iir_b[FILTER_RUNNER_DESIGN_NUM_COEFFS];
+    double               iir_a[FILTER_RUNNER_DESIGN_NUM_COEFFS];
+    double               sos[FILTER_RUNNER_DESIGN_NUM_SECTIONS][6];
+    filter_coeff_t       fir_b_coeffs[FILTER_DESIGN_MAX_TAPS];
+    filter_coeff_t       iir_b_coeffs[FILTER_RUNNER_DESIGN_NUM_COEFFS];
+    filter_coeff_t       iir_a_coeffs[FILTER_RUNNER_DESIGN_NUM_COEFFS];
+    filter_coeff_t       sos_coeffs[FILTER_RUNNER_DESIGN_NUM_SECTIONS][6];
+} filter_runner_design_t;
+
+static filter_runner_design_t filter_runner_last_design;
+
+// The tables filter_designer.py generates, IIR_NUM_COEFFS counts b0 so the filter order is one less
+#define FILTER_RUNNER_GENERATED_COEFFS \
+    { _fir_b_coeffs, FIR_NUM_COEFFS, _iir_b_coeffs, _iir_a_coeffs, IIR_NUM_COEFFS - 1, _iir_sos_coeffs, IIR_BIQUAD_NUM_TERMS }
+
+// Coefficients of the runners created next
+static filter_runner_coeffs_t filter_runner_coeffs = FILTER_RUNNER_GENERATED_COEFFS;
+
+/**
+  * @brief Look up a name in a table
+  * @return Index of the name, negative if it is not in the table
+  */
+static int filter_runner_lookup(const char *const *names, unsigned int num_names, const char *name)
+{
+    for (unsigned int i = 0; i < num_names; i++) {
+        if (!strcmp(name, names[i])) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+int filter_runner_parse_type(const char *name)
+{
+    return filter_runner_lookup(filter_runner_names, FILTER_RUNNER_NUM_TYPES, name);
+}
+
+const char *filter_runner_type_name(int type)
+{
+    return (type >= 0 && (unsigned int)type < FILTER_RUNNER_NUM_TYPES) ? filter_runner_names[type] : "unknown";
+}
+
+int filter_runner_parse_chain(const char *names, int *types, unsigned int max_types)
+{
+    unsigned int num_types = 0;
+    char         name[32];
+
+    while (*names) {
+        // Blanks around a name are skipped
+        while (isspace((unsigned char)*names)) {
+            names++;
+        }
+        size_t length = strcspn(names, ",");
+        size_t next = length;
+        while (length > 0 && isspace((unsigned char)names[length - 1])) {
+            length--;
+        }
+        if (length >= sizeof(name) || num_types == max_types) {
+            return -1;
+        }
+        memcpy(name, names, length);
+        name[length] = '\0';
+        types[num_types] = filter_runner_parse_type(name);
+        if (types[num_types++] < 0) {
+            return -1;
+        }
+        names += next;
+        names += (*names == ',');
+    }
+
+    return (num_types > 0) ? (int)num_types : -1;
+}
+
+/**
+  * @brief Read the next key=value line of a config file, blanks around the key and the value are trimmed
+  * @note Empty lines and lines starting with # are skipped
+  * @return 1 if a line was read, 0 at the end of the file, negative if a line has no =
+  */
+static int filter_runner_read_config(FILE *file, char *line, int size, char **key, char **value)
+{
+    while (fgets(line, size, file)) {
+        // Trim the line, then skip comments and empty lines
+        char *start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        size_t length = strlen(start);
+        while (length > 0 && isspace((unsigned char)start[length - 1])) {
+            start[--length] = '\0';
+        }
+        if (length == 0 || *start == '#') {
+            continue;
+        }
+
+        char *equals = strchr(start, '=');
+        if (!equals) {
+            return -1;
+        }
+        char *key_end = equals;
+        while (key_end > start && isspace((unsigned char)key_end[-1])) {
+            key_end--;
+        }
+        *key_end = '\0';
+        *value = equals + 1;
+        while (isspace((unsigned char)**value)) {
+            (*value)++;
+        }
+        *key = start;
+        return 1;
+    }
+
+    return 0;
+}
+
+int filter_runner_load_chain(const char *path, int *types, unsigned int max_types)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+
+    unsigned int num_types = 0;
+    char         line[256];
+    char        *key;
+    char        *value;
+    int          ret;
+    while ((ret = filter_runner_read_config(file, line, sizeof(line), &key, &value)) > 0) {
+        // Only the stage key is known
+        int count = strcmp(key, "stage") ? -1 : filter_runner_parse_chain(value, &types[num_types], max_types - num_types);
+        if (count < 0) {
+            ret = -1;
+            break;
+        }
+        num_types += (unsigned int)count;
+    }
+    fclose(file);
+
+    return (ret == 0 && num_types > 0) ? (int)num_types : -1;
+}
+
+/**
+  * @brief Parse a whole config value as a number
+  * @return 0 on success, negative if the value is not a number
+  */
+static int filter_runner_parse_number(const char *value, double *number)
+{
+    char *end;
+    *number = strtod(value, &end);
+    return (end == value || *end != '\0') ? -1 : 0;
+}
+
+void filter_runner_set_coeffs(const filter_runner_coeffs_t *coeffs)
+{
+    static const filter_runner_coeffs_t generated = FILTER_RUNNER_GENERATED_COEFFS;
+    filter_runner_coeffs = coeffs ? *coeffs : generated;
+}
+
+int filter_runner_load_design(const char *path, filter_design_spec_t *spec)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return -1;
+    }
+
+    // The defaults of filter_designer.py, the filter and the mode have to be given
+    memset(spec, 0, sizeof(filter_design_spec_t));
+    spec->window = FILTER_DESIGN_WINDOW_HAMMING;
+    spec->attenuation = 0.1;
+    int          fir = -1;
+    int          band = -1;
+    int          iir_type = FILTER_DESIGN_TYPE_BUTTER;
+    double       order = 0.0;
+    double       decimation = 1.0;
+    char         line[256];
+    char        *key;
+    char        *value;
+    int          ret;
+    while ((ret = filter_runner_read_config(file, line, sizeof(line), &key, &value)) > 0) {
+        int index = 0;
+        if (!strcmp(value, "None")) {
+            continue;
+        } else if (!strcmp(key, "filter")) {
+            index = filter_runner_lookup(filter_runner_design_filters, FILTER_RUNNER_ARRAY_SIZE(filter_runner_design_filters), value);
+            fir = (index >= FILTER_RUNNER_DESIGN_FIR);
+        } else if (!strcmp(key, "mode")) {
+            index = band = filter_runner_lookup(filter_runner_design_bands, FILTER_RUNNER_ARRAY_SIZE(filter_runner_design_bands), value);
+        } else if (!strcmp(key, "iir_filter_type")) {
+            index = iir_type = filter_runner_lookup(filter_runner_design_types, FILTER_RUNNER_ARRAY_SIZE(filter_runner_design_types), value);
+        } else if (!strcmp(key, "window")) {
+            index = filter_runner_lookup(filter_runner_design_windows, FILTER_RUNNER_ARRAY_SIZE(filter_runner_design_windows), value);
+            spec->window = (unsigned int)index;
+        } else if (!strcmp(key, "fir_algorithm")) {
+            index = strcmp(value, "firwin") ? -1 : 0;
+        } else if (!strcmp(key, "order")) {
+            index = filter_runner_parse_number(value, &order);
+        } else if (!strcmp(key, "sampling_rate")) {
+            index = filter_runner_parse_number(value, &spec->sampling_rate);
+        } else if (!strcmp(key, "start_cutoff")) {
+            index = filter_runner_parse_number(value, &spec->start_cutoff);
+        } else if (!strcmp(key, "stop_cutoff")) {
+            index = filter_runner_parse_number(value, &spec->stop_cutoff);
+        } else if (!strcmp(key, "ripple")) {
+            index = filter_runner_parse_number(value, &spec->ripple);
+        } else if (!strcmp(key, "attenuition")) {
+            index = filter_runner_parse_number(value, &spec->attenuation);
+        } else if (!strcmp(key, "roll_off")) {
+            index = filter_runner_parse_number(value, &spec->width);
+        } else if (!strcmp(key, "decimate")) {
+            index = filter_runner_parse_number(value, &decimation);
+        }
+        if (index < 0) {
+            ret = -1;
+            break;
+        }
+    }
+    fclose(file);
+    if (ret != 0 || fir < 0 || order < 0.0 || order != (unsigned int)order || decimation < 1.0 ||
+        decimation != (unsigned int)decimation) {
+        return -1;
+    }
+    spec->type = fir ? FILTER_DESIGN_TYPE_FIR : (unsigned int)iir_type;
+    spec->order = (unsigned int)order;
+
+    // A decimating FIR is the anti-alias filter, its pass band ends at 90% of the decimated Nyquist frequency unless
+    // a lower cut off is given, and without an order the transition band of the window ends at the decimated Nyquist
+    // frequency
+    if (decimation > 1.0) {
+        if (!fir || (band >= 0 && band != FILTER_DESIGN_BAND_LOWPASS)) {
+            return -1;
+        }
+        static const double transition_widths[] = { 3.3, 3.1, 5.5, 3.1, 0.9 };
+        double              nyquist = spec->sampling_rate / (2.0 * decimation);
+        band = FILTER_DESIGN_BAND_LOWPASS;
+        spec->stop_cutoff = 0.0;
+        if (spec->start_cutoff == 0.0 || spec->start_cutoff > 0.9 * nyquist) {
+            spec->start_cutoff = 0.9 * nyquist;
+        }
+        if (spec->order == 0) {
+            spec->order = (unsigned int)ceil((transition_widths[spec->window] * spec->sampling_rate) /
+                                             (2.0 * (nyquist - spec->start_cutoff))) | 1;
+        }
+    }
+    if (band < 0) {
+        return -1;
+    }
+    spec->band = (unsigned int)band;
+
+    return 0;
+}
+
+int filter_runner_design(const filter_design_spec_t *spec)
+{
+    filter_runner_design_t *design = &filter_runner_last_design;
+    filter_runner_coeffs_t  coeffs = filter_runner_coeffs;
+
+    if (!spec) {
+        return -1;
+    }
+    if (spec->type == FILTER_DESIGN_TYPE_FIR) {
+        if (filter_design_fir(spec, design->fir_b) != FILTER_DESIGN_ERROR_OK ||
+            filter_design_to_coeffs(design->fir_b, design->fir_b_coeffs, spec->order) != FILTER_DESIGN_ERROR_OK) {
+            return -1;
+        }
+        coeffs.fir_b_coeffs = design->fir_b_coeffs;
+        coeffs.fir_num_coeffs = spec->order;
+    } else {
+        unsigned int num_coeffs = FILTER_DESIGN_NUM_COEFFS(spec->order, spec->band);
+        if (filter_design_iir_sos(spec, design->sos, &design->num_sections) != FILTER_DESIGN_ERROR_OK ||
+            filter_design_iir_ba(spec, design->iir_b, design->iir_a) != FILTER_DESIGN_ERROR_OK ||
+            filter_design_to_coeffs(&design->sos[0][0], &design->sos_coeffs[0][0], 6 * design->num_sections) != FILTER_DESIGN_ERROR_OK) {
+            return -1;
+        }
+        coeffs.iir_sos_coeffs = design->sos_coeffs;
+        coeffs.iir_num_sections = design->num_sections;
+
+        // The direct form of a high order design soon outgrows the integer coefficient formats, only the iir filter
+        // type needs it
+        int fits = (filter_design_to_coeffs(design->iir_b, design->iir_b_coeffs, num_coeffs) == FILTER_DESIGN_ERROR_OK &&
+                    filter_design_to_coeffs(design->iir_a, design->iir_a_coeffs, num_coeffs) == FILTER_DESIGN_ERROR_OK);
+        coeffs.iir_b_coeffs = fits ? design->iir_b_coeffs : NULL;
+        coeffs.iir_a_coeffs = fits ? design->iir_a_coeffs : NULL;
+        coeffs.iir_order = num_coeffs - 1;
+    }
+    design->spec = *spec;
+    filter_runner_set_coeffs(&coeffs);
+
+    return 0;
+}
+
+/**
+  * @brief Write one key=value line of comma separated coefficients
+  */
+static void filter_runner_write_values(FILE *file, const char *key, const double *values, unsigned int count)
+{
+    fprintf(file, "%s=", key);
+    for (unsigned int i = 0; i < count; i++) {
+        fprintf(file, (i + 1 < count) ? "%.17g," : "%.17g\n", values[i]);
+    }
+}
+
+int filter_runner_write_design(const char *path)
+{
+    const filter_runner_design_t *design = &filter_runner_last_design;
+
+    // Every design has at least one tap or one pole
+    if (design->spec.order == 0) {
+        return -1;
+    }
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return -1;
+    }
+    if (design->spec.type == FILTER_DESIGN_TYPE_FIR) {
+        filter_runner_write_values(file, "b", design->fir_b, design->spec.order);
+    } else {
+        unsigned int num_coeffs = FILTER_DESIGN_NUM_COEFFS(design->spec.order, design->spec.band);
+        for (unsigned int i = 0; i < design->num_sections; i++) {
+            filter_runner_write_values(file, "sos", design->sos[i], 6);
+        }
+        filter_runner_write_values(file, "b", design->iir_b, num_coeffs);
+        filter_runner_write_values(file, "a", design->iir_a, num_coeffs);
+    }
+
+    return (fclose(file) == 0) ? 0 : -1;
+}
+
+/**
+  * @brief Create one chain stage for one channel, with the same parameters the single filter types use
+  * @note The filter and its state are carved from the arena, an arena without a buffer only counts their bytes
+  * @return 0 on success, negative on error
+  */
+static int filter_runner_add_stage(filter_chain_t *chain, int type, const filter_runner_coeffs_t *coeffs, filter_arena_t *arena)
+{
+    size_t filter_size;
+    size_t state_size = 0;
+    switch (type)
+    {
+    case FILTER_RUNNER_SMA:
+        filter_size = sizeof(sma_filter_t);
+        state_size = sma_filter_state_size(SMA_FILTER_SIZE);
+        break;
+    case FILTER_RUNNER_CIC:
+        filter_size = sizeof(cic_filter_t);
+        state_size = cic_filter_state_size(CIC_FILTER_NUM_STAGES, CIC_FILTER_WINDOW_SHIFT);
+        break;
+    case FILTER_RUNNER_EMA:
+        filter_size = sizeof(ema_filter_t);
+        break;
+    case FILTER_RUNNER_MEDIAN:
+        filter_size = sizeof(median_filter_t);
+        state_size = median_filter_state_size(MEDIAN_FILTER_WINDOW);
+        break;
+    case FILTER_RUNNER_HAMPEL:
+        filter_size = sizeof(hampel_filter_t);
+        state_size = median_filter_state_size(HAMPEL_FILTER_WINDOW);
+        break;
+    case FILTER_RUNNER_IIR:
+        // The previous inputs are followed by the previous outputs
+        filter_size = sizeof(iir_filter_t);
+        state_size = 2 * iir_filter_state_size(coeffs->iir_order);
+        break;
+    case FILTER_RUNNER_IIR_BIQUAD:
+        filter_size = sizeof(iir_biquad_filter_t);
+        state_size = iir_biquad_filter_state_size(coeffs->iir_num_sections, IIR_BIQUAD_FORM_DF1);
+        break;
+    case FILTER_RUNNER_IIR_BIQUAD_DF2T:
+        filter_size = sizeof(iir_biquad_filter_t);
+        state_size = iir_biquad_filter_state_size(coeffs->iir_num_sections, IIR_BIQUAD_FORM_DF2T);
+        break;
+    case FILTER_RUNNER_FIR:
+        filter_size = sizeof(fir_filter_t);
+        state_size = fir_filter_state_size(coeffs->fir_num_coeffs, FIR_FILTER_DELAY_MIRRORED);
+        break;
+    default:
+        return -1;
+    }
+
+    // The stages of one channel only ever run on one thread, they are packed closer than a cache line
+    void *filter = filter_arena_alloc_aligned(arena, filter_size, FILTER_RUNNER_STAGE_ALIGN);
+    void *state = filter_arena_alloc_aligned(arena, state_size, FILTER_RUNNER_STAGE_ALIGN);
+    if (!state) {
+        return arena->base ? -1 : 0;
+    }
+
+    int ret = -1;
+    switch (type)
+    {
+    case FILTER_RUNNER_SMA:
+        if (sma_filter_init((sma_filter_t *)filter, (filter_data_t *)state, SMA_FILTER_SIZE) == SMA_FILTER_ERROR_OK) {
+            ret = filter_chain_add_sma(chain, (sma_filter_t *)filter);
+        }
+        break;
+    case FILTER_RUNNER_CIC:
+        if (cic_filter_init((cic_filter_t *)filter, (filter_accum_t *)state, CIC_FILTER_NUM_STAGES, CIC_FILTER_WINDOW_SHIFT) == CIC_FILTER_ERROR_OK) {
+            ret = filter_chain_add_cic(chain, (cic_filter_t *)filter);
+        }
+        break;
+    case FILTER_RUNNER_EMA:
+        if (ema_filter_init((ema_filter_t *)filter, EMA_FILTER_WINDOW_SHIFT) == EMA_FILTER_ERROR_OK) {
+            ret = filter_chain_add_ema(chain, (ema_filter_t *)filter);
+        }
+        break;
+    case FILTER_RUNNER_MEDIAN:
+        if (median_filter_init((median_filter_t *)filter, (median_filter_node_t *)state, MEDIAN_FILTER_WINDOW) == MEDIAN_FILTER_ERROR_OK) {
+            ret = filter_chain_add_median(chain, (median_filter_t *)filter);
+        }
+        break;
+    case FILTER_RUNNER_HAMPEL:
+        if (hampel_filter_init((hampel_filter_t *)filter, (median_filter_node_t *)state, HAMPEL_FILTER_WINDOW,
+                               HAMPEL_FILTER_THRESHOLD(HAMPEL_FILTER_SIGMAS)) == MEDIAN_FILTER_ERROR_OK) {
+            ret = filter_chain_add_hampel(chain, (hampel_filter_t *)filter);
+        }
+        break;
+    case FILTER_RUNNER_IIR: {
+        filter_accum_t *prev_inputs = (filter_accum_t *)state;
+        if (iir_filter_init((iir_filter_t *)filter, coeffs->iir_b_coeffs, coeffs->iir_a_coeffs, prev_inputs,
+                            &prev_inputs[coeffs->iir_order], coeffs->iir_order) == IIR_FILTER_ERROR_OK) {
+            ret = filter_chain_add_iir(chain, (iir_filter_t *)filter);
+        }
+        break;
+    }
+    case FILTER_RUNNER_IIR_BIQUAD:
+    case FILTER_RUNNER_IIR_BIQUAD_DF2T:
+        if (type == FILTER_RUNNER_IIR_BIQUAD) {
+            ret = iir_biquad_filter_init((iir_biquad_filter_t *)filter, coeffs->iir_sos_coeffs, (filter_accum_t *)state,
+                                         coeffs->iir_num_sections);
+        } else {
+            ret = iir_biquad_filter_init_df2t((iir_biquad_filter_t *)filter, coeffs->iir_sos_coeffs, (filter_accum_t *)state,
+                                              coeffs->iir_num_sections);
+        }
+        if (ret == IIR_FILTER_ERROR_OK) {
+            ret = filter_chain_add_iir_biquad(chain, (iir_biquad_filter_t *)filter);
+        }
+        break;
+    default:
+        if (fir_filter_init_mirrored((fir_filter_t *)filter, coeffs->fir_b_coeffs, (filter_accum_t *)state,
+                                     coeffs->fir_num_coeffs) == FIR_FILTER_ERROR_OK) {
+            ret = filter_chain_add_fir(chain, (fir_filter_t *)filter);
+        }
+        break;
+    }
+
+    return (ret == 0) ? 0 : -1;
+}
+
+/**
+  * @brief Create one chain per channel
+  */
+static int filter_runner_setup_chain(filter_runner_t *runner, filter_arena_t *arena)
+{
+    const unsigned int num_channels = runner->num_channels;
+    const unsigned int num_types = runner->num_types;
+
+    runner->chains = (filter_chain_t *)filter_arena_alloc(arena, sizeof(filter_chain_t) * num_channels);
+    runner->chain_stages = (filter_chain_stage_t *)filter_arena_alloc(arena, sizeof(filter_chain_stage_t) * num_types * num_channels);
+    for (unsigned int i = 0; i < num_channels; i++) {
+        if (runner->chain_stages) {
+            filter_chain_init(&runner->chains[i], &runner->chain_stages[i * num_types], num_types);
+        }
+        for (unsigned int j = 0; j < num_types; j++) {
+            if (filter_runner_add_stage(runner->chains ? &runner->chains[i] : NULL, runner->types[j], &runner->coeffs, arena)) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief Carve the filters and their state out of the arena and initialize them
+  * @note An arena without a buffer only counts the bytes, the pointers of the runner are then NULL
+  * @return 0 on success, negative on error
+  */
+static int filter_runner_setup(filter_runner_t *runner, filter_arena_t *arena)
+{
+    const unsigned int            num_channels = runner->num_channels;
+    const unsigned int            decimation = runner->decimation;
+    const filter_runner_coeffs_t *coeffs = &runner->coeffs;
+    char                         *state;
+    size_t                        state_size;
+
+    if (runner->type == FILTER_RUNNER_CHAIN) {
+        return filter_runner_setup_chain(runner, arena);
+    }
+
+    // The SMA, CIC, EMA, median and Hampel filters run one filter per channel, every other filter type runs all channels through one
+    // bank whose state lives in a single contiguous block. A NULL state means the arena only counts
+    int ret = FILTER_BANK_ERROR_OK;
+    switch (runner->type)
+    {
+    case FILTER_RUNNER_SMA:
+        state_size = sma_filter_state_size(SMA_FILTER_SIZE);
+        runner->sma = (sma_filter_t *)filter_arena_alloc(arena, sizeof(sma_filter_t) * num_channels);
+        state = (char *)filter_arena_alloc(arena, state_size * num_channels);
+        for (unsigned int i = 0; state && i < num_channels; i++) {
+            sma_filter_init(&runner->sma[i], (filter_data_t *)&state[i * state_size], SMA_FILTER_SIZE);
+        }
+        break;
+    case FILTER_RUNNER_CIC:
+        state_size = cic_filter_state_size(CIC_FILTER_NUM_STAGES, CIC_FILTER_WINDOW_SHIFT);
+        runner->cic = (cic_filter_t *)filter_arena_alloc(arena, sizeof(cic_filter_t) * num_channels);
+        state = (char *)filter_arena_alloc(arena, state_size * num_channels);
+        for (unsigned int i = 0; state && i < num_channels; i++) {
+            if (cic_filter_init(&runner->cic[i], (filter_accum_t *)&state[i * state_size], CIC_FILTER_NUM_STAGES,
+                                CIC_FILTER_WINDOW_SHIFT) != CIC_FILTER_ERROR_OK) {
+                return -1;
+            }
+        }
+        break;
+    case FILTER_RUNNER_EMA:
+        runner->ema = (ema_filter_t *)filter_arena_alloc(arena, sizeof(ema_filter_t) * num_channels);
+        for (unsigned int i = 0; runner->ema && i < num_channels; i++) {
+            if (ema_filter_init(&runner->ema[i], EMA_FILTER_WINDOW_SHIFT) != EMA_FILTER_ERROR_OK) {
+                return -1;
+            }
+        }
+        break;
+    case FILTER_RUNNER_MEDIAN:
+        state_size = median_filter_state_size(MEDIAN_FILTER_WINDOW);
+        runner->median = (median_filter_t *)filter_arena_alloc(arena, sizeof(median_filter_t) * num_channels);
+        state = (char *)filter_arena_alloc(arena, state_size * num_channels);
+        for (unsigned int i = 0; state && i < num_channels; i++) {
+            if (median_filter_init(&runner->median[i], (median_filter_node_t *)&state[i * state_size],
+                                   MEDIAN_FILTER_WINDOW) != MEDIAN_FILTER_ERROR_OK) {
+                return -1;
+            }
+        }
+        break;
+    case FILTER_RUNNER_HAMPEL:
+        state_size = median_filter_state_size(HAMPEL_FILTER_WINDOW);
+        runner->hampel = (hampel_filter_t *)filter_arena_alloc(arena, sizeof(hampel_filter_t) * num_channels);
+        state = (char *)filter_arena_alloc(arena, state_size * num_channels);
+        for (unsigned int i = 0; state && i < num_channels; i++) {
+            if (hampel_filter_init(&runner->hampel[i], (median_filter_node_t *)&state[i * state_size],
+                                   HAMPEL_FILTER_WINDOW, HAMPEL_FILTER_THRESHOLD(HAMPEL_FILTER_SIGMAS)) != MEDIAN_FILTER_ERROR_OK) {
+                return -1;
+            }
+        }
+        break;
+    case FILTER_RUNNER_IIR:
+        runner->bank = (filter_bank_t *)filter_arena_alloc(arena, sizeof(filter_bank_t));
+        state = (char *)filter_arena_alloc(arena, filter_bank_state_size(FILTER_BANK_TYPE_IIR, coeffs->iir_order, num_channels));
+        if (state) {
+            ret = filter_bank_init_iir(runner->bank, coeffs->iir_b_coeffs, coeffs->iir_a_coeffs, (filter_accum_t *)state,
+                                       coeffs->iir_order, num_channels);
+        }
+        break;
+    case FILTER_RUNNER_IIR_BIQUAD:
+        runner->bank = (filter_bank_t *)filter_arena_alloc(arena, sizeof(filter_bank_t));
+        state = (char *)filter_arena_alloc(arena, filter_bank_state_size(FILTER_BANK_TYPE_IIR_BIQUAD, coeffs->iir_num_sections, num_channels));
+        if (state) {
+            ret = filter_bank_init_iir_biquad(runner->bank, coeffs->iir_sos_coeffs, (filter_accum_t *)state,
+                                              coeffs->iir_num_sections, num_channels);
+        }
+        break;
+    case FILTER_RUNNER_IIR_BIQUAD_DF2T:
+        runner->bank = (filter_bank_t *)filter_arena_alloc(arena, sizeof(filter_bank_t));
+        state = (char *)filter_arena_alloc(arena, filter_bank_state_size(FILTER_BANK_TYPE_IIR_BIQUAD_DF2T, coeffs->iir_num_sections, num_channels));
+        if (state) {
+            ret = filter_bank_init_iir_biquad_df2t(runner->bank, coeffs->iir_sos_coeffs, (filter_accum_t *)state,
+                                                   coeffs->iir_num_sections, num_channels);
+        }
+        break;
+    case FILTER_RUNNER_FIR:
+        // A polyphase decimator only computes the kept outputs, it reads the coefficients in place
+        if (decimation > 1) {
+            state_size = fir_polyphase_filter_state_size(coeffs->fir_num_coeffs, 1);
+            runner->fir_polyphase = (fir_polyphase_filter_t *)filter_arena_alloc(arena, sizeof(fir_polyphase_filter_t) * num_channels);
+            state = (char *)filter_arena_alloc(arena, state_size * num_channels);
+            for (unsigned int i = 0; state && i < num_channels; i++) {
+                if (fir_polyphase_filter_init(&runner->fir_polyphase[i], coeffs->fir_b_coeffs, coeffs->fir_num_coeffs, 1, decimation, NULL,
+                                              (filter_accum_t *)&state[i * state_size]) != FIR_POLYPHASE_FILTER_ERROR_OK) {
+                    return -1;
+                }
+            }
+            break;
+        }
+        if (fir_fft_filter_recommended(coeffs->fir_num_coeffs)) {
+            unsigned int block_size = fir_fft_filter_block_size(coeffs->fir_num_coeffs, FIR_FFT_FILTER_MODE_PARTITIONED);
+            state_size = fir_fft_filter_state_size(coeffs->fir_num_coeffs, block_size);
+            runner->fir_fft = (fir_fft_filter_t *)filter_arena_alloc(arena, sizeof(fir_fft_filter_t) * num_channels);
+            state = (char *)filter_arena_alloc(arena, state_size * num_channels);
+            for (unsigned int i = 0; state && i < num_channels; i++) {
+                if (fir_fft_filter_init(&runner->fir_fft[i], coeffs->fir_b_coeffs, coeffs->fir_num_coeffs, block_size,
+                                        FIR_FFT_FILTER_MODE_PARTITIONED, (double *)&state[i * state_size]) != FIR_FFT_FILTER_ERROR_OK) {
+                    return -1;
+                }
+            }
+            break;
+        }
+        runner->bank = (filter_bank_t *)filter_arena_alloc(arena, sizeof(filter_bank_t));
+        state = (char *)filter_arena_alloc(arena, filter_bank_state_size(FILTER_BANK_TYPE_FIR, coeffs->fir_num_coeffs, num_channels));
+        if (state) {
+            ret = filter_bank_init_fir(runner->bank, coeffs->fir_b_coeffs, (filter_accum_t *)state, coeffs->fir_num_coeffs, num_channels);
+        }
+        break;
+    default:
+        return -1;
+    }
+
+    return (ret == FILTER_BANK_ERROR_OK) ? 0 : -1;
+}
+
+int filter_runner_history_length(const int *types, unsigned int num_types, double tolerance)
+{
+    const filter_runner_coeffs_t *coeffs = &filter_runner_coeffs;
+    int                           history = 0;
+
+    if (!types || num_types == 0 || num_types > FILTER_RUNNER_MAX_STAGES || !(tolerance > 0.0)) {
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < num_types; i++) {
+        int length;
+        switch (types[i])
+        {
+        case FILTER_RUNNER_SMA:
+            length = SMA_FILTER_SIZE - 1;
+            break;
+        case FILTER_RUNNER_CIC:
+            length = CIC_FILTER_NUM_STAGES * ((1 << CIC_FILTER_WINDOW_SHIFT) - 1);
+            break;
+        case FILTER_RUNNER_EMA:
+            // The average is primed with the first row, the difference to the settled one is at most twice the
+            // largest input and shrinks by 1 - 2^-shift every row
+            length = (int)ceil(log(tolerance / 2.0) / log(1.0 - (1.0 / (double)(1 << EMA_FILTER_WINDOW_SHIFT))));
+            length = (length > 0) ? length : 0;
+            break;
+        case FILTER_RUNNER_MEDIAN:
+            length = MEDIAN_FILTER_WINDOW - 1;
+            break;
+        case FILTER_RUNNER_HAMPEL:
+            length = HAMPEL_FILTER_WINDOW - 1;
+            break;
+        case FILTER_RUNNER_FIR:
+            length = (int)coeffs->fir_num_coeffs - 1;
+            break;
+        case FILTER_RUNNER_IIR:
+            length = iir_filter_settle_length(coeffs->iir_b_coeffs, coeffs->iir_a_coeffs, coeffs->iir_order, tolerance);
+            if (length >= 0 && length < (int)coeffs->iir_order) {
+                length = (int)coeffs->iir_order;
+            }
+            break;
+        case FILTER_RUNNER_IIR_BIQUAD:
+            length = iir_biquad_filter_settle_length(coeffs->iir_sos_coeffs, coeffs->iir_num_sections, IIR_BIQUAD_FORM_DF1,
+                                                     tolerance);
+            if (length >= 0 && length < (int)coeffs->iir_num_sections * 4) {
+                length = (int)coeffs->iir_num_sections * 4;
+            }
+            break;
+        case FILTER_RUNNER_IIR_BIQUAD_DF2T:
+            length = iir_biquad_filter_settle_length(coeffs->iir_sos_coeffs, coeffs->iir_num_sections, IIR_BIQUAD_FORM_DF2T,
+                                                     tolerance);
+            if (length >= 0 && length < (int)coeffs->iir_num_sections * 2) {
+                length = (int)coeffs->iir_num_sections * 2;
+            }
+            break;
+        default:
+            length = -1;
+            break;
+        }
+        if (length < 0 || history > INT_MAX - length) {
+            return -1;
+        }
+        history += length;
+    }
+
+    return history;
+}
+
+int filter_runner_rounding_bound(const int *types, unsigned int num_types, double *bound)
+{
+    const filter_runner_coeffs_t *coeffs = &filter_runner_coeffs;
+
+    if (!types || num_types == 0 || num_types > FILTER_RUNNER_MAX_STAGES || !bound) {
+        return -1;
+    }
+
+    // d bounds the difference at the output of the stages so far, a stage passes it on times its gain and adds
+    // its own rounding. The integer builds count in units of the data format. The floating point build keeps the
+    // filter state in double and rounds the output of each stage to float, one unit there is the float spacing at
+    // the largest output, at most FLT_EPSILON times peak, the largest output relative to the largest input
+    double d = 0.0;
+    double peak = 1.0;
+    for (unsigned int i = 0; i < num_types; i++) {
+        double gain = 1.0;
+        double rounding = 0.0;
+        int    ret = IIR_FILTER_ERROR_OK;
+        switch (types[i])
+        {
+        case FILTER_RUNNER_SMA:
+        case FILTER_RUNNER_CIC:
+            // Averages, two inputs that differ round to outputs at most one unit further apart. The floating point
+            // running sums are rebuilt once per pass, so they also round differently from where they started
+#if defined(FILTER_USE_INTEGER_MATH)
+            rounding = (d > 0.0) ? 1.0 : 0.0;
+#else
+            rounding = 1.0;
+#endif /* FILTER_USE_INTEGER_MATH */
+            break;
+        case FILTER_RUNNER_EMA:
+#if defined(FILTER_USE_INTEGER_MATH)
+            // The rounded average feeds back with gain 1 - 2^-shift, half a unit of rounding on each output
+            // stays below half a unit in the state
+            rounding = 2.0;
+#else
+            rounding = 1.0;
+#endif /* FILTER_USE_INTEGER_MATH */
+            break;
+        case FILTER_RUNNER_MEDIAN:
+            break;
+        case FILTER_RUNNER_HAMPEL:
+            // An input that moves across the outlier threshold changes the output by the outlier itself
+            if (d > 0.0) {
+                return -1;
+            }
+            break;
+        case FILTER_RUNNER_FIR:
+            gain = 0.0;
+            for (unsigned int n = 0; n < coeffs->fir_num_coeffs; n++) {
+                gain += fabs((double)coeffs->fir_b_coeffs[n] / (double)FILTER_COEFF_ONE);
+            }
+            // The FFT convolution rounds differently depending on where its blocks start
+            rounding = (d > 0.0 || fir_fft_filter_recommended(coeffs->fir_num_coeffs)) ? 1.0 : 0.0;
+            break;
+        case FILTER_RUNNER_IIR:
+            ret = iir_filter_gain(coeffs->iir_b_coeffs, coeffs->iir_a_coeffs, coeffs->iir_order, IIR_FILTER_GAIN_INPUT,
+                                  &gain);
+#if defined(FILTER_USE_INTEGER_MATH)
+            if (ret == IIR_FILTER_ERROR_OK) {
+                ret = iir_filter_gain(coeffs->iir_b_coeffs, coeffs->iir_a_coeffs, coeffs->iir_order,
+                                      IIR_FILTER_GAIN_ROUNDING, &rounding);
+            }
+#else
+            rounding = 1.0;
+#endif /* FILTER_USE_INTEGER_MATH */
+            break;
+        case FILTER_RUNNER_IIR_BIQUAD:
+        case FILTER_RUNNER_IIR_BIQUAD_DF2T: {
+            unsigned int form = (types[i] == FILTER_RUNNER_IIR_BIQUAD) ? IIR_BIQUAD_FORM_DF1 : IIR_BIQUAD_FORM_DF2T;
+            ret = iir_biquad_filter_gain(coeffs->iir_sos_coeffs, coeffs->iir_num_sections, form, IIR_FILTER_GAIN_INPUT,
+                                         &gain);
+#if defined(FILTER_USE_INTEGER_MATH)
+            if (ret == IIR_FILTER_ERROR_OK) {
+                ret = iir_biquad_filter_gain(coeffs->iir_sos_coeffs, coeffs->iir_num_sections, form,
+                                             IIR_FILTER_GAIN_ROUNDING, &rounding);
+            }
+#else
+            rounding = 1.0;
+#endif /* FILTER_USE_INTEGER_MATH */
+            break;
+        }
+        default:
+            return -1;
+        }
+        if (ret != IIR_FILTER_ERROR_OK) {
+            return -1;
+        }
+        peak *= gain;
+#if defined(FILTER_USE_INTEGER_MATH)
+        d = (gain * d) + rounding;
+#else
+        d = (gain * d) + (rounding * FLT_EPSILON * peak);
+#endif /* FILTER_USE_INTEGER_MATH */
+    }
+    *bound = d;
+
+    return 0;
+}
+
+int filter_runner_init(filter_runner_t *runner, const int *types, unsigned int num_types, unsigned int num_channels,
+                       unsigned int decimation)
+{
+    filter_arena_t arena;
+
+    memset(runner, 0, sizeof(filter_runner_t));
+    runner->coeffs = filter_runner_coeffs;
+    runner->num_channels = num_channels;
+    runner->decimation = decimation;
+    if (decimation == 0 || !types || num_types == 0 || num_types > FILTER_RUNNER_MAX_STAGES) {
+        return -1;
+    }
+    memcpy(runner->types, types, sizeof(int) * num_types);
+    runner->num_types = num_types;
+    runner->type = (num_types > 1) ? FILTER_RUNNER_CHAIN : types[0];
+
+    // Size the block once, then carve every filter and its state out of it. The block starts and ends on a cache
+    // line boundary, so the runners of different threads never share a line
+    filter_arena_init(&arena, NULL, 0);
+    if (filter_runner_setup(runner, &arena)) {
+        return -1;
+    }
+    runner->memory_size = FILTER_ARENA_ALIGN_UP(filter_arena_used(&arena), FILTER_ARENA_ALIGN);
+    runner->memory = aligned_alloc(FILTER_ARENA_ALIGN, runner->memory_size);
+    if (!runner->memory || filter_arena_init(&arena, runner->memory, runner->memory_size) != FILTER_ARENA_ERROR_OK) {
+        return -1;
+    }
+
+    return (filter_runner_setup(runner, &arena) == 0 && filter_arena_valid(&arena)) ? 0 : -1;
+}
+
+int filter_runner_reset(filter_runner_t *runner)
+{
+    filter_arena_t arena;
+
+    if (!runner->memory || filter_arena_init(&arena, runner->memory, runner->memory_size) != FILTER_ARENA_ERROR_OK) {
+        return -1;
+    }
+    runner->phase = 0;
+
+    return (filter_runner_setup(runner, &arena) == 0 && filter_arena_valid(&arena)) ? 0 : -1;
+}
+
+size_t filter_runner_decimate(void *rows, size_t row_size, size_t num_rows, unsigned int decimation, unsigned int *phase)
+{
+    char  *data = (char *)rows;
+    size_t kept = 0;
+
+    if (decimation <= 1) {
+        return num_rows;
+    }
+
+    for (size_t n = *phase; n < num_rows; n += decimation) {
+        if (kept != n) {
+            memmove(&data[kept * row_size], &data[n * row_size], row_size);
+        }
+        kept++;
+    }
+
+    // Rows left to drop at the start of the next call
+    *phase = (unsigned int)((*phase + (kept * (size_t)decimation)) - num_rows);
+
+    return kept;
+}
+
+/**
+  * @brief Run the per channel chains, FFT convolutions or polyphase decimators, one channel at a time
+  * @return Number of frames kept
+  */
+static size_t filter_runner_run_columns(filter_runner_t *runner, filter_data_t *frames, size_t num_frames)
+{
+    filter_data_t      column[FILTER_RUNNER_COLUMN_SIZE];
+    const unsigned int num_channels = runner->num_channels;
+    size_t             kept = 0;
+
+    // Outputs never run ahead of the inputs, so writing the kept frames back in place never overwrites a frame
+    // that still has to be read
+    for (size_t start = 0; start < num_frames; start += FILTER_RUNNER_COLUMN_SIZE) {
+        size_t count = num_frames - start;
+        size_t num_outputs = 0;
+        if (count > FILTER_RUNNER_COLUMN_SIZE) {
+            count = FILTER_RUNNER_COLUMN_SIZE;
+        }
+        for (unsigned int i = 0; i < num_channels; i++) {
+            filter_data_t *data = &frames[(start * num_channels) + i];
+            for (size_t n = 0; n < count; n++) {
+                column[n] = data[n * num_channels];
+            }
+            if (runner->chains) {
+                int invalid = filter_chain_run_block(&runner->chains[i], column, column, count);
+                if (invalid > 0) {
+                    memset(column, 0, sizeof(filter_data_t) * (size_t)invalid);
+                }
+                num_outputs = count;
+            } else if (runner->fir_polyphase) {
+                fir_polyphase_filter_run_block(&runner->fir_polyphase[i], column, count, column, &num_outputs);
+            } else {
+                fir_fft_filter_run_block(&runner->fir_fft[i], column, column, count);
+                num_outputs = count;
+            }
+            data = &frames[(kept * num_channels) + i];
+            for (size_t n = 0; n < num_outputs; n++) {
+                data[n * num_channels] = column[n];
+            }
+        }
+        kept += num_outputs;
+    }
+
+    return kept;
+}
+
+/**
+  * @brief Filter a block of interleaved frames in place with the current control register
+  * @return Number of frames kept
+  */
+static size_t filter_runner_run_frames(filter_runner_t *runner, filter_data_t *frames, size_t num_frames)
+{
+    const size_t frame_size = sizeof(filter_data_t) * runner->num_channels;
+
+    // The FFT convolution filters one channel at a time, the partitioned mode adds no latency. The polyphase
+    // decimators keep the same frames as filter_runner_decimate()
+    if (runner->fir_fft || runner->fir_polyphase) {
+        return filter_runner_run_columns(runner, frames, num_frames);
+    }
+
+    if (runner->chains) {
+        filter_runner_run_columns(runner, frames, num_frames);
+    } else if (runner->type == FILTER_RUNNER_SMA) {
+        filter_data_t *frame = frames;
+        for (size_t n = 0; n < num_frames; n++) {
+            for (unsigned int i = 0; i < runner->num_channels; i++) {
+                sma_filter_run(&runner->sma[i], frame[i], &frame[i]);
+            }
+            frame += runner->num_channels;
+        }
+    } else if (runner->type == FILTER_RUNNER_CIC || runner->type == FILTER_RUNNER_EMA) {
+        filter_data_t *frame = frames;
+        for (size_t n = 0; n < num_frames; n++) {
+            for (unsigned int i = 0; i < runner->num_channels; i++) {
+                if (runner->cic) {
+                    cic_filter_run(&runner->cic[i], frame[i], &frame[i]);
+                } else {
+                    ema_filter_run(&runner->ema[i], frame[i], &frame[i]);
+                }
+            }
+            frame += runner->num_channels;
+        }
+    } else if (runner->type == FILTER_RUNNER_MEDIAN || runner->type == FILTER_RUNNER_HAMPEL) {
+        // The Hampel filter writes 0 until its window is full
+        filter_data_t *frame = frames;
+        for (size_t n = 0; n < num_frames; n++) {
+            for (unsigned int i = 0; i < runner->num_channels; i++) {
+                if (runner->median) {
+                    median_filter_run(&runner->median[i], frame[i], &frame[i]);
+                } else {
+                    hampel_filter_run(&runner->hampel[i], frame[i], &frame[i]);
+                }
+            }
+            frame += runner->num_channels;
+        }
+    } else {
+        // The FIR bank never reports a warm up window, the IIR warm up outputs are written as 0
+        int invalid = filter_bank_run(runner->bank, frames, frames, num_frames);
+        if (invalid > 0) {
+            memset(frames, 0, frame_size * (size_t)invalid);
+        }
+    }
+
+    return filter_runner_decimate(frames, frame_size, num_frames, runner->decimation, &runner->phase);
+}
+
+size_t filter_runner_run(filter_runner_t *runner, filter_data_t *frames, size_t num_frames)
+{
+    filter_simd_ftz_scope_t scope;
+
+    // A quiet input leaves the IIR tails subnormal, which runs several times slower on x86. Every pipeline, chunk
+    // and batch thread filters through here, so each block call flushes them on the thread that runs it
+    filter_simd_ftz_enter(&scope);
+    size_t num_kept = filter_runner_run_frames(runner, frames, num_frames);
+    filter_simd_ftz_exit(&scope);
+
+    return num_kept;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief Get the counters of one filter
+  * @return Pointer to the counters, NULL if the filter type has none
+  */
+static const filter_stats_t *filter_runner_filter_stats(int type, const void *filter)
+{
+    switch (type)
+    {
+    case FILTER_RUNNER_SMA:
+        return &((const sma_filter_t *)filter)->stats;
+    case FILTER_RUNNER_IIR:
+        return &((const iir_filter_t *)filter)->stats;
+    case FILTER_RUNNER_IIR_BIQUAD:
+    case FILTER_RUNNER_IIR_BIQUAD_DF2T:
+        return &((const iir_biquad_filter_t *)filter)->stats;
+    case FILTER_RUNNER_FIR:
+        return &((const fir_filter_t *)filter)->stats;
+    default:
+        return NULL;
+    }
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+void filter_runner_get_stats(const filter_runner_t *runner, filter_stats_t *stats)
+{
+#if FILTER_INSTRUMENTATION_ENABLED
+    if (!runner || !stats) {
+        return;
+    }
+    if (runner->bank) {
+        filter_stats_merge(&stats[0], &runner->bank->stats);
+        return;
+    }
+    for (unsigned int i = 0; i < runner->num_channels; i++) {
+        for (unsigned int j = 0; j < runner->num_types; j++) {
+            const filter_stats_t *filter_stats = NULL;
+            if (runner->chains) {
+                filter_stats = filter_runner_filter_stats(runner->types[j], runner->chain_stages[(i * runner->num_types) + j].filter);
+            } else if (runner->sma) {
+                filter_stats = &runner->sma[i].stats;
+            } else if (runner->fir_fft) {
+                filter_stats = &runner->fir_fft[i].stats;
+            } else if (runner->fir_polyphase) {
+                filter_stats = &runner->fir_polyphase[i].stats;
+            }
+            if (filter_stats) {
+                filter_stats_merge(&stats[j], filter_stats);
+            }
+        }
+    }
+#else
+    (void)runner;
+    (void)stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+}
+
+void filter_runner_free(filter_runner_t *runner)
+{
+    // Every filter lives in the one block, the pointers into it only have to be cleared
+    free(runner->memory);
+    memset(runner, 0, sizeof(filter_runner_t));
+}
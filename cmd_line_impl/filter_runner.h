@@ -0,0 +1,268 @@
+#ifndef FILTER_RUNNER_H_
+#define FILTER_RUNNER_H_
+
+#include "../impl/sma_filter/sma_filter.h"
+#include "../impl/cic_filter/cic_filter.h"
+#include "../impl/ema_filter/ema_filter.h"
+#include "../impl/median_filter/median_filter.h"
+#include "../impl/filter_bank/filter_bank.h"
+#include "../impl/filter_chain/filter_chain.h"
+#include "../impl/fir_filter/fir_fft_filter.h"
+#include "../impl/fir_filter/fir_polyphase.h"
+#include "../impl/filter_stats/filter_stats.h"
+#include "../impl/filter_arena/filter_arena.h"
+#include "../impl/filter_design/filter_design.h"
+#include "../impl/filter_types.h"
+
+// Filter configuration parameters
+#define SMA_FILTER_SIZE 10
+#define CIC_FILTER_NUM_STAGES   2
+#define CIC_FILTER_WINDOW_SHIFT 3
+#define EMA_FILTER_WINDOW_SHIFT 3
+#define MEDIAN_FILTER_WINDOW    5
+#define HAMPEL_FILTER_WINDOW    7
+#define HAMPEL_FILTER_SIGMAS    3
+
+// Samples of one channel gathered from the interleaved frames for each FFT FIR, polyphase or chain call
+#define FILTER_RUNNER_COLUMN_SIZE 256
+
+// Most filters one runner chains together
+#define FILTER_RUNNER_MAX_STAGES  8
+
+// Filter types selectable from the command line
+#define FILTER_RUNNER_SMA             0
+#define FILTER_RUNNER_IIR             1
+#define FILTER_RUNNER_IIR_BIQUAD      2
+#define FILTER_RUNNER_IIR_BIQUAD_DF2T 3
+#define FILTER_RUNNER_FIR             4
+#define FILTER_RUNNER_CIC             5
+#define FILTER_RUNNER_EMA             6
+#define FILTER_RUNNER_MEDIAN          7
+#define FILTER_RUNNER_HAMPEL          8
+
+// Type of a runner that chains several filters, not selectable on its own
+#define FILTER_RUNNER_CHAIN           -1
+
+/**
+  * @brief Coefficients the FIR, IIR and biquad filter types run with
+  * @note By default the tables filter_designer.py generates, see filter_runner_set_coeffs()
+  */
+typedef struct
+{
+    filter_coeff_t *fir_b_coeffs;
+    unsigned int    fir_num_coeffs;
+    filter_coeff_t *iir_b_coeffs;
+    filter_coeff_t *iir_a_coeffs;
+    unsigned int    iir_order;
+    filter_coeff_t (*iir_sos_coeffs)[6];
+    unsigned int    iir_num_sections;
+} filter_runner_coeffs_t;
+
+/**
+  * @brief Runs the selected filter type over a group of interleaved channels
+  * @note FIR filters with at least FIR_FFT_FILTER_CROSSOVER taps run one partitioned FFT convolution per channel
+  *       instead of the bank, the output lines up with the direct form.
+  *       With a decimation factor above one only every decimation'th frame is kept, starting with the first. FIR
+  *       filters then run one polyphase decimator per channel and only compute the kept outputs, every other
+  *       filter type runs at the full rate and drops the other frames.
+  *       The Hampel filter delays its output by HAMPEL_FILTER_WINDOW / 2 frames and writes 0 until its window is full.
+  *       Several filter types run as one filter_chain_t per channel. The stages pass FILTER_RUNNER_COLUMN_SIZE
+  *       samples of a channel through all of them while they are in cache, and outputs inside the warm up window
+  *       of any stage are written as 0. A chain keeps every frame and then drops the ones decimation discards.
+  *       Every filter, the bank and all of their state live in one memory_size byte block carved up by a
+  *       filter_arena_t, the block is cache line aligned so the runners of different threads never share a line.
+  */
+typedef struct
+{
+    int                     type;
+    int                     types[FILTER_RUNNER_MAX_STAGES];
+    unsigned int            num_types;
+    unsigned int            num_channels;
+    unsigned int            decimation;
+    unsigned int            phase;
+    filter_runner_coeffs_t  coeffs;
+    sma_filter_t           *sma;
+    cic_filter_t           *cic;
+    ema_filter_t           *ema;
+    filter_chain_t         *chains;
+    filter_chain_stage_t   *chain_stages;
+    median_filter_t        *median;
+    hampel_filter_t        *hampel;
+    filter_bank_t          *bank;
+    fir_fft_filter_t       *fir_fft;
+    fir_polyphase_filter_t *fir_polyphase;
+    void                   *memory;
+    size_t                  memory_size;
+} filter_runner_t;
+
+/**
+  * @brief Look up a filter type by its command line name
+  * @param name Filter type name, e.g. "fir"
+  * @return One of the FILTER_RUNNER_* types, negative if the name is unknown
+  */
+int filter_runner_parse_type(const char *name);
+
+/**
+  * @brief Get the command line name of a filter type
+  * @param type One of the FILTER_RUNNER_* types
+  * @return The name, "unknown" for an unknown type
+  */
+const char *filter_runner_type_name(int type);
+
+/**
+  * @brief Parse a comma separated list of filter types, e.g. "hampel,iir-biquad"
+  * @param names Filter type names
+  * @param types Pointer to max_types types
+  * @param max_types Largest number of types
+  * @return Number of types, negative if a name is unknown or there are too many
+  */
+int filter_runner_parse_chain(const char *names, int *types, unsigned int max_types);
+
+/**
+  * @brief Load a filter chain from a config file in the key=value style of design.cfg
+  * @note Every stage=<filter type> line appends a stage, the value may also be a comma separated list. Empty lines
+  *       and lines starting with # are skipped. See chain.cfg.example
+  * @param path Path of the config file
+  * @param types Pointer to max_types types
+  * @param max_types Largest number of types
+  * @return Number of types, negative if the file can not be read or holds an unknown key or filter type
+  */
+int filter_runner_load_chain(const char *path, int *types, unsigned int max_types);
+
+/**
+  * @brief Set the coefficients of the runners created from now on
+  * @note The arrays are not copied and have to outlive those runners. Call it before any runner is created, it
+  *       is not thread safe
+  * @param coeffs Pointer to the coefficients, NULL restores the tables filter_designer.py generated
+  */
+void filter_runner_set_coeffs(const filter_runner_coeffs_t *coeffs);
+
+/**
+  * @brief Load a filter specification from a filter_designer.py config file, e.g. design.cfg.example
+  * @note The filter, mode, order, sampling_rate, start_cutoff, stop_cutoff, ripple, attenuition, iir_filter_type,
+  *       window, roll_off, fir_algorithm and decimate keys are read, the keys only the Python tool uses are skipped.
+  *       As in filter_designer.py a decimating FIR is a low pass anti-alias filter whose cut off and, without an
+  *       order, number of taps follow from the decimated Nyquist frequency.
+  * @param path Path of the config file
+  * @param spec Pointer to the specification
+  * @return 0 on success, negative if the file can not be read or asks for a design filter_design does not support
+  *         (ellip and bessel filters, FIR algorithms other than firwin)
+  */
+int filter_runner_load_design(const char *path, filter_design_spec_t *spec);
+
+/**
+  * @brief Design coefficients and set them for the runners created from now on, see filter_runner_set_coeffs()
+  * @note An IIR specification replaces the IIR and biquad coefficients, a FIR specification the FIR coefficients.
+  *       The IIR filter type fails to initialize if its direct form coefficients do not fit the coefficient format,
+  *       high orders need the biquad filter types.
+  * @param spec Pointer to the specification
+  * @return 0 on success, negative if the design fails or its sections do not fit the coefficient format
+  */
+int filter_runner_design(const filter_design_spec_t *spec);
+
+/**
+  * @brief Write the coefficients of the last filter_runner_design() call at full precision
+  * @note One sos=b0,b1,b2,a0,a1,a2 line per section then the b= and a= lines of the direct form for an IIR design,
+  *       a single b= line for a FIR design
+  * @param path Path of the output file
+  * @return 0 on success, negative if nothing was designed or the file can not be written
+  */
+int filter_runner_write_design(const char *path);
+
+/**
+  * @brief Get the number of rows a new runner has to filter before its output matches a runner that filtered every
+  *        earlier row, so a log can be cut into chunks that are filtered in parallel
+  * @note The FIR, SMA, CIC, median and Hampel filters only look at a fixed window of rows, their history is exact up
+  *       to rounding. The IIR, biquad and EMA filters depend on every earlier row, their history is the settle length
+  *       after which the difference is at most tolerance times the largest input, see iir_filter_settle_length().
+  *       The histories of a chain add up. The history always covers the warm up window a new runner writes as 0.
+  *       The FIR, IIR and biquad filters use the coefficients set with filter_runner_set_coeffs().
+  * @param types FILTER_RUNNER_* types of the filters
+  * @param num_types Number of filters
+  * @param tolerance Largest difference of the IIR, biquad and EMA filters relative to the largest input, above 0
+  * @return Number of rows, negative if a filter is unknown or does not settle
+  */
+int filter_runner_history_length(const int *types, unsigned int num_types, double tolerance);
+
+/**
+  * @brief Get how far rounding lets the output of a runner that started filter_runner_history_length() rows early
+  *        drift from one that filtered every earlier row
+  * @note This comes on top of the tolerance of filter_runner_history_length(). The integer builds round every IIR
+  *       and biquad section output and every EMA average, and two runs that started from different states keep
+  *       rounding differently, so the difference never settles to 0. Each IIR or biquad adds its rounding gain, see
+  *       iir_filter_gain(), the EMA filter adds 2 units, and the stages after it scale the difference by their gain
+  *       and add 1 unit for their own rounding. The floating point build keeps the state in double but rounds the
+  *       output of every IIR, biquad, EMA, SMA and CIC stage to float, each adds one float step at its largest
+  *       output, at most FLT_EPSILON times the largest input times the gain so far. A FIR run as an FFT convolution
+  *       adds one unit in either case.
+  * @param types FILTER_RUNNER_* types of the filters
+  * @param num_types Number of filters
+  * @param bound Set to the largest difference, in units of 2^-FILTER_DATA_FRAC_BITS in the integer builds and
+  *              relative to the largest input in the floating point build
+  * @return 0 on success, negative if a filter is unknown, does not settle, or is a Hampel filter after a stage
+  *         whose output can differ, which has no bound
+  */
+int filter_runner_rounding_bound(const int *types, unsigned int num_types, double *bound);
+
+/**
+  * @brief Create the filter state for a group of channels
+  * @note The filters are sized with one pass over an arena without a buffer, then created in a single allocation.
+  *       The FIR, IIR and biquad filters use the coefficients set with filter_runner_set_coeffs().
+  * @param runner Pointer to the runner
+  * @param types FILTER_RUNNER_* types of the filters, run in order
+  * @param num_types Number of filters, 1 to FILTER_RUNNER_MAX_STAGES
+  * @param num_channels Number of interleaved channels the runner processes
+  * @param decimation Keep every decimation'th frame, 1 keeps every frame
+  * @return 0 on success, negative on error
+  */
+int filter_runner_init(filter_runner_t *runner, const int *types, unsigned int num_types, unsigned int num_channels,
+                       unsigned int decimation);
+
+/**
+  * @brief Clear the filter state so the runner can filter another log with the same filters and number of channels
+  * @note The filters are initialized again in the block filter_runner_init() allocated, nothing is allocated.
+  *       Collect the counters with filter_runner_get_stats() first, they are cleared as well.
+  * @param runner Pointer to the runner
+  * @return 0 on success, negative on error
+  */
+int filter_runner_reset(filter_runner_t *runner);
+
+/**
+  * @brief Filter a block of interleaved frames in place, outputs inside the IIR warm up window are written as 0
+  * @note The kept frames are packed at the start of frames, see filter_runner_decimate(). Subnormal values are
+  *       flushed to zero during the call where filter_simd_ftz_enter() is supported
+  * @param runner Pointer to the runner
+  * @param frames Pointer to num_frames frames of num_channels values
+  * @param num_frames Number of frames
+  * @return Number of frames kept
+  */
+size_t filter_runner_run(filter_runner_t *runner, filter_data_t *frames, size_t num_frames);
+
+/**
+  * @brief Keep every decimation'th of a stream of rows, packed at the start of the buffer
+  * @param rows Pointer to num_rows rows of row_size bytes
+  * @param row_size Size of one row in bytes
+  * @param num_rows Number of rows
+  * @param decimation Keep every decimation'th row
+  * @param phase Pointer to the number of rows to drop before the next kept one, 0 at the start of the stream
+  * @return Number of rows kept
+  */
+size_t filter_runner_decimate(void *rows, size_t row_size, size_t num_rows, unsigned int decimation, unsigned int *phase);
+
+/**
+  * @brief Add the counters of every filter to one total per stage, see filter_stats_t
+  * @note Only built with FILTER_ENABLE_INSTRUMENTATION, otherwise nothing is added. The filters of every channel
+  *       are summed. A single FIR, IIR or biquad stage runs as one bank whose counters already cover all channels.
+  *       Filter types without counters leave their total untouched.
+  * @param runner Pointer to the runner
+  * @param stats Pointer to one total for each filter type the runner was created with
+  */
+void filter_runner_get_stats(const filter_runner_t *runner, filter_stats_t *stats);
+
+/**
+  * @brief Release the filter state
+  * @param runner Pointer to the runner
+  */
+void filter_runner_free(filter_runner_t *runner);
+
+#endif /* FILTER_RUNNER_H_ */
@@ -0,0 +1,1133 @@
+#include "log_io.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int log_block_init(log_block_t *block, size_t capacity, unsigned int num_channels)
+{
+    if (!block || capacity == 0 || num_channels == 0) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    block->num_rows = 0;
+    block->capacity = capacity;
+    block->num_channels = num_channels;
+    block->time_stamps = (unsigned int *)malloc(sizeof(unsigned int) * capacity);
+    block->data = (filter_data_t *)malloc(sizeof(filter_data_t) * capacity * num_channels);
+    if (!block->time_stamps || !block->data) {
+        log_block_free(block);
+        return LOG_IO_ERROR_NO_MEMORY;
+    }
+
+    return LOG_IO_ERROR_OK;
+}
+
+void log_block_free(log_block_t *block)
+{
+    free(block->time_stamps);
+    free(block->data);
+    block->time_stamps = NULL;
+    block->data = NULL;
+    block->capacity = 0;
+    block->num_rows = 0;
+}
+
+// Powers of ten that are exact in a double
+static const double log_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Numbers handed to strtod are copied to a NUL terminated buffer of this size first
+#define LOG_NUMBER_SIZE 64
+
+static inline int log_is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static inline int log_is_blank(char c)
+{
+    return (c == ' ') || (c == '\t');
+}
+
+static double log_parse_double_slow(const char *begin, const char *end, const char **next)
+{
+    char        buffer[LOG_NUMBER_SIZE];
+    const char *field_end = begin;
+
+    // strtod stops at the first character that is not part of a number, so a field is never copied further
+    // than its delimiter
+    while (field_end < end && *field_end != ',' && *field_end != '\n') {
+        field_end++;
+    }
+    size_t length = (size_t)(field_end - begin);
+    char  *number = (length < LOG_NUMBER_SIZE) ? buffer : (char *)malloc(length + 1);
+    if (!number) {
+        *next = begin;
+        return 0;
+    }
+    memcpy(number, begin, length);
+    number[length] = '\0';
+
+    char  *number_end;
+    double value = strtod(number, &number_end);
+    *next = begin + (number_end - number);
+    if (number != buffer) {
+        free(number);
+    }
+
+    return value;
+}
+
+double log_parse_double(const char *begin, const char *end, const char **next)
+{
+    const char *p = begin;
+    uint64_t    mantissa = 0;
+    int         num_digits = 0;
+    int         exponent = 0;
+    int         exact = 1;
+    int         negative = 0;
+
+    while (p < end && log_is_blank(*p)) {
+        p++;
+    }
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    // Integer part, significant digits past 19 would overflow the mantissa
+    const char *digits = p;
+    while (p < end && log_is_digit(*p)) {
+        if (num_digits < 19) {
+            mantissa = (mantissa * 10) + (uint64_t)(*p - '0');
+            num_digits += (mantissa != 0);
+        } else {
+            exponent++;
+            exact = 0;
+        }
+        p++;
+    }
+
+    // Fractional part
+    int num_int_digits = (int)(p - digits);
+    int num_frac_digits = 0;
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && log_is_digit(*p)) {
+            if (num_digits < 19) {
+                mantissa = (mantissa * 10) + (uint64_t)(*p - '0');
+                num_digits += (mantissa != 0);
+                exponent--;
+            } else {
+                exact = 0;
+            }
+            num_frac_digits++;
+            p++;
+        }
+    }
+    if (num_int_digits == 0 && num_frac_digits == 0) {
+        // Not a decimal number, let strtod sort out nan, inf or report that there is no number at all
+        return log_parse_double_slow(begin, end, next);
+    }
+
+    // Exponent, only consumed when at least one digit follows
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        int         exponent_negative = 0;
+        int         value = 0;
+        if (e < end && (*e == '-' || *e == '+')) {
+            exponent_negative = (*e == '-');
+            e++;
+        }
+        if (e < end && log_is_digit(*e)) {
+            while (e < end && log_is_digit(*e)) {
+                if (value < 100000) {
+                    value = (value * 10) + (*e - '0');
+                }
+                e++;
+            }
+            exponent += exponent_negative ? -value : value;
+            p = e;
+        }
+    } else if (p < end && (*p == 'x' || *p == 'X')) {
+        return log_parse_double_slow(begin, end, next);
+    }
+
+    // Both the mantissa and the power of ten are exact, so one multiply or divide rounds correctly
+    if (!exact || mantissa > ((uint64_t)1 << 53) || exponent > 22 || exponent < -22) {
+        return log_parse_double_slow(begin, end, next);
+    }
+
+    double value = (double)mantissa;
+    if (exponent < 0) {
+        value /= log_pow10[-exponent];
+    } else {
+        value *= log_pow10[exponent];
+    }
+    *next = p;
+
+    return negative ? -value : value;
+}
+
+/**
+  * @brief Parse an integer the way atoi does
+  */
+static long log_parse_long(const char *p, const char *end, const char **next)
+{
+    long value = 0;
+    int  negative = 0;
+
+    while (p < end && log_is_blank(*p)) {
+        p++;
+    }
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    while (p < end && log_is_digit(*p)) {
+        value = (value * 10) + (*p - '0');
+        p++;
+    }
+    *next = p;
+
+    return negative ? -value : value;
+}
+
+static inline const char *log_skip_field(const char *p, const char *end)
+{
+    while (p < end && *p != ',' && *p != '\n') {
+        p++;
+    }
+
+    return p;
+}
+
+/**
+  * @brief Read a log that can not be memory mapped into one heap buffer
+  */
+static int log_reader_load(log_reader_t *reader, int fd)
+{
+    size_t  capacity = 1 << 20;
+    size_t  size = 0;
+    char   *data = (char *)malloc(capacity);
+    ssize_t count;
+
+    while (data && (count = read(fd, data + size, capacity - size)) > 0) {
+        size += (size_t)count;
+        if (size == capacity) {
+            char *grown = (char *)realloc(data, capacity * 2);
+            if (!grown) {
+                free(data);
+                data = NULL;
+                break;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+    if (!data) {
+        return LOG_IO_ERROR_NO_MEMORY;
+    }
+
+    reader->data = data;
+    reader->size = size;
+    reader->mapped = 0;
+
+    return LOG_IO_ERROR_OK;
+}
+
+// Two digit lookup used when writing integers
+static const char log_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Powers of ten up to LOG_PRECISION_MAX
+static const uint64_t log_pow10_u64[] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+typedef unsigned __int128 log_u128_t;
+
+static inline log_u128_t log_pow10_u128(int exponent)
+{
+    return (exponent < 20) ? log_pow10_u64[exponent] : ((log_u128_t)log_pow10_u64[19] * log_pow10_u64[exponent - 19]);
+}
+
+/**
+  * @brief Write an unsigned integer, returns the number of digits
+  */
+static int log_format_u64(char *dst, uint64_t value)
+{
+    char  digits[20];
+    char *p = digits + sizeof(digits);
+
+    while (value >= 100) {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--p = log_digit_pairs[pair + 1];
+        *--p = log_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = log_digit_pairs[(value * 2) + 1];
+        *--p = log_digit_pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+
+    int length = (int)(digits + sizeof(digits) - p);
+    memcpy(dst, p, (size_t)length);
+
+    return length;
+}
+
+/**
+  * @brief Write value / 10^precision in fixed point notation, value is the already rounded scaled magnitude
+  */
+static int log_format_scaled(char *dst, log_u128_t value, int precision, int negative)
+{
+    char  digits[48];
+    int   num_digits;
+    char *p = dst;
+
+    // Split into chunks of at most 19 digits so every division after the first one is 64 bit
+    if (value >> 64) {
+        uint64_t low = (uint64_t)(value % log_pow10_u64[19]);
+        num_digits = log_format_u64(digits, (uint64_t)(value / log_pow10_u64[19]));
+        char chunk[20];
+        int  chunk_digits = log_format_u64(chunk, low);
+        memset(digits + num_digits, '0', (size_t)(19 - chunk_digits));
+        memcpy(digits + num_digits + 19 - chunk_digits, chunk, (size_t)chunk_digits);
+        num_digits += 19;
+    } else {
+        num_digits = log_format_u64(digits, (uint64_t)value);
+    }
+
+    // Pad with leading zeros so there is at least one digit in front of the decimal point
+    if (negative) {
+        *p++ = '-';
+    }
+    if (num_digits <= precision) {
+        *p++ = '0';
+        if (precision > 0) {
+            *p++ = '.';
+            memset(p, '0', (size_t)(precision - num_digits));
+            p += precision - num_digits;
+            memcpy(p, digits, (size_t)num_digits);
+            p += num_digits;
+        }
+    } else {
+        int num_int_digits = num_digits - precision;
+        memcpy(p, digits, (size_t)num_int_digits);
+        p += num_int_digits;
+        if (precision > 0) {
+            *p++ = '.';
+            memcpy(p, digits + num_int_digits, (size_t)precision);
+            p += precision;
+        }
+    }
+    *p = '\0';
+
+    return (int)(p - dst);
+}
+
+/**
+  * @brief Round mantissa * 2^exponent * 10^precision to an integer, half to even
+  * @note The caller guarantees the product fits, exponent is in [-149, 36] and precision <= LOG_PRECISION_MAX.
+  */
+static log_u128_t log_scale_round(uint32_t mantissa, int exponent, int precision)
+{
+    log_u128_t scaled = (log_u128_t)mantissa * log_pow10_u128(precision);
+
+    if (exponent >= 0) {
+        return scaled << exponent;
+    }
+
+    int shift = -exponent;
+    if (shift >= 128) {
+        return 0;
+    }
+    log_u128_t quotient = scaled >> shift;
+    log_u128_t remainder = scaled - (quotient << shift);
+    log_u128_t half = (log_u128_t)1 << (shift - 1);
+    if (remainder > half || (remainder == half && (quotient & 1))) {
+        quotient++;
+    }
+
+    return quotient;
+}
+
+/**
+  * @brief Check if quotient / 10^precision reads back as mantissa * 2^exponent, exponent < 0
+  */
+static int log_round_trips(log_u128_t quotient, uint32_t mantissa, int exponent, int precision, int lower_gap_halved)
+{
+    // Scale everything by 10^precision * 2^(2 - exponent): the value becomes 4 * mantissa * 10^precision and half
+    // the gap to each neighbouring float becomes 2 * 10^precision (10^precision below a power of two)
+    int        shift = 2 - exponent;
+    log_u128_t power = log_pow10_u128(precision);
+    log_u128_t value = ((log_u128_t)mantissa * power) << 2;
+    log_u128_t candidate = (shift >= 128) ? 0 : (quotient << shift);
+    int        inclusive = !(mantissa & 1);
+
+    if (quotient != 0 && (shift >= 128 || (candidate >> shift) != quotient)) {
+        return 0;
+    }
+    if (candidate >= value) {
+        log_u128_t gap = power << 1;
+        return inclusive ? (candidate - value <= gap) : (candidate - value < gap);
+    }
+
+    log_u128_t gap = lower_gap_halved ? power : (power << 1);
+    return inclusive ? (value - candidate <= gap) : (value - candidate < gap);
+}
+
+int log_format_float(char *dst, float value, int precision)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(uint32_t));
+    int      negative = (int)(bits >> 31);
+    int      biased_exponent = (int)((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+    int      exponent;
+
+    // Split the float into mantissa * 2^exponent
+    if (biased_exponent == 0xFF) {
+        return snprintf(dst, LOG_VALUE_SIZE, "%f", (double)value);
+    } else if (biased_exponent == 0) {
+        exponent = -149;
+    } else {
+        mantissa |= 0x800000;
+        exponent = biased_exponent - 150;
+    }
+
+    // Values of 2^60 and above would overflow the scaled integer
+    if (exponent > 36) {
+        return snprintf(dst, LOG_VALUE_SIZE, "%.*f", (precision < 0) ? 0 : precision, (double)value);
+    }
+
+    if (precision >= 0) {
+        // Most values fit in 64 bits, keep the common case off the 128 bit path
+        if (exponent <= 0 && exponent > -64 && precision <= 9) {
+            uint64_t scaled = (uint64_t)mantissa * log_pow10_u64[precision];
+            int      shift = -exponent;
+            uint64_t quotient = (shift == 0) ? scaled : (scaled >> shift);
+            if (shift > 0) {
+                uint64_t remainder = scaled - (quotient << shift);
+                uint64_t half = (uint64_t)1 << (shift - 1);
+                if (remainder > half || (remainder == half && (quotient & 1))) {
+                    quotient++;
+                }
+            }
+            return log_format_scaled(dst, quotient, precision, negative);
+        }
+        return log_format_scaled(dst, log_scale_round(mantissa, exponent, precision), precision, negative);
+    }
+
+    // Shortest, integers need no digits after the decimal point
+    if (exponent >= 0 || mantissa == 0) {
+        return log_format_scaled(dst, log_scale_round(mantissa, exponent, 0), 0, negative);
+    }
+    int lower_gap_halved = (mantissa == 0x800000) && (biased_exponent > 1);
+    int digits = 0;
+    if (exponent > -62) {
+        // Same search in 64 bit arithmetic while 4 * mantissa * 10^digits fits
+        int      shift = -exponent;
+        int      inclusive = !(mantissa & 1);
+        uint64_t half = (uint64_t)1 << (shift - 1);
+        for (; digits <= 11; digits++) {
+            uint64_t power = log_pow10_u64[digits];
+            uint64_t scaled = (uint64_t)mantissa * power;
+            uint64_t quotient = scaled >> shift;
+            uint64_t remainder = scaled - (quotient << shift);
+            if (remainder > half || (remainder == half && (quotient & 1))) {
+                quotient++;
+            }
+
+            uint64_t value = scaled << 2;
+            uint64_t candidate = quotient << (shift + 2);
+            uint64_t gap = (candidate >= value || !lower_gap_halved) ? (power << 1) : power;
+            uint64_t distance = (candidate >= value) ? (candidate - value) : (value - candidate);
+            if (inclusive ? (distance <= gap) : (distance < gap)) {
+                return log_format_scaled(dst, quotient, digits, negative);
+            }
+        }
+    }
+    for (; digits <= LOG_PRECISION_MAX; digits++) {
+        log_u128_t quotient = log_scale_round(mantissa, exponent, digits);
+        if (log_round_trips(quotient, mantissa, exponent, digits, lower_gap_halved)) {
+            return log_format_scaled(dst, quotient, digits, negative);
+        }
+    }
+
+    return snprintf(dst, LOG_VALUE_SIZE, "%.9g", (double)value);
+}
+
+static inline uint64_t log_fcol_align(uint64_t offset)
+{
+    return (offset + LOG_FCOL_ALIGN - 1) & ~(uint64_t)(LOG_FCOL_ALIGN - 1);
+}
+
+static unsigned int log_fcol_dtype_size(unsigned int dtype)
+{
+    switch (dtype)
+    {
+    case LOG_FCOL_DTYPE_INT32:
+    case LOG_FCOL_DTYPE_FLOAT32:
+        return 4;
+    case LOG_FCOL_DTYPE_FLOAT64:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+/**
+  * @brief Offset of every column from the start of the file, the time column is column 0
+  */
+static void log_fcol_layout(uint64_t *offsets, uint64_t data_offset, unsigned int num_columns, uint64_t num_samples,
+                            unsigned int dtype)
+{
+    offsets[0] = data_offset;
+    for (unsigned int i = 1; i < num_columns; i++) {
+        uint64_t column_size = num_samples * ((i == 1) ? 4 : log_fcol_dtype_size(dtype));
+        offsets[i] = log_fcol_align(offsets[i - 1] + column_size);
+    }
+}
+
+static inline uint16_t log_get_u16(const char *p)
+{
+    const unsigned char *b = (const unsigned char *)p;
+
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static inline uint32_t log_get_u32(const char *p)
+{
+    const unsigned char *b = (const unsigned char *)p;
+
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static inline uint64_t log_get_u64(const char *p)
+{
+    return (uint64_t)log_get_u32(p) | ((uint64_t)log_get_u32(p + 4) << 32);
+}
+
+static inline void log_put_u16(char *p, uint16_t value)
+{
+    p[0] = (char)(value & 0xFF);
+    p[1] = (char)(value >> 8);
+}
+
+static inline void log_put_u32(char *p, uint32_t value)
+{
+    log_put_u16(p, (uint16_t)(value & 0xFFFF));
+    log_put_u16(p + 2, (uint16_t)(value >> 16));
+}
+
+static inline void log_put_u64(char *p, uint64_t value)
+{
+    log_put_u32(p, (uint32_t)(value & 0xFFFFFFFF));
+    log_put_u32(p + 4, (uint32_t)(value >> 32));
+}
+
+/**
+  * @brief Parse the header of a binary columnar log, see LOG_FCOL_MAGIC
+  */
+static int log_reader_open_fcol(log_reader_t *reader)
+{
+    if (reader->size < LOG_FCOL_HEADER_SIZE || memcmp(reader->data, LOG_FCOL_MAGIC, 4) ||
+        log_get_u16(reader->data + 4) != LOG_FCOL_VERSION) {
+        return LOG_IO_ERROR_FORMAT;
+    }
+
+    reader->format = LOG_FORMAT_FCOL;
+    reader->dtype = log_get_u16(reader->data + 6);
+    reader->num_columns = log_get_u32(reader->data + 8);
+    uint64_t data_offset = log_get_u32(reader->data + 12);
+    reader->num_samples = log_get_u64(reader->data + 16);
+    uint64_t time_base = log_get_u64(reader->data + 24);
+    memcpy(&reader->time_base, &time_base, sizeof(double));
+    if (!log_fcol_dtype_size(reader->dtype) || reader->num_columns == 0 || data_offset < LOG_FCOL_HEADER_SIZE ||
+        data_offset > reader->size || reader->num_samples > reader->size) {
+        return LOG_IO_ERROR_FORMAT;
+    }
+
+    // Column names, one NUL terminated string per column
+    const char  *names = reader->data + LOG_FCOL_HEADER_SIZE;
+    const char  *names_end = names;
+    unsigned int num_names = 0;
+    while (num_names < reader->num_columns && names_end < reader->data + data_offset) {
+        num_names += (*names_end++ == '\0');
+    }
+    if (num_names != reader->num_columns) {
+        return LOG_IO_ERROR_FORMAT;
+    }
+    reader->names_length = (size_t)(names_end - names);
+    reader->names = (char *)malloc(reader->names_length);
+    if (!reader->names) {
+        return LOG_IO_ERROR_NO_MEMORY;
+    }
+    memcpy(reader->names, names, reader->names_length);
+
+    // Every column has to fit in the file
+    uint64_t *offsets = (uint64_t *)malloc(sizeof(uint64_t) * reader->num_columns);
+    reader->columns = (const char **)malloc(sizeof(const char *) * reader->num_columns);
+    if (!offsets || !reader->columns) {
+        free(offsets);
+        return LOG_IO_ERROR_NO_MEMORY;
+    }
+    log_fcol_layout(offsets, data_offset, reader->num_columns, reader->num_samples, reader->dtype);
+    unsigned int last_size = (reader->num_columns == 1) ? 4 : log_fcol_dtype_size(reader->dtype);
+    int          ret = LOG_IO_ERROR_OK;
+    if (offsets[reader->num_columns - 1] + (reader->num_samples * last_size) > reader->size) {
+        ret = LOG_IO_ERROR_FORMAT;
+    }
+    for (unsigned int i = 0; i < reader->num_columns; i++) {
+        reader->columns[i] = reader->data + offsets[i];
+    }
+    free(offsets);
+
+    return ret;
+}
+
+/**
+  * @brief Parse the header line of a CSV log
+  */
+static int log_reader_open_csv(log_reader_t *reader)
+{
+    reader->format = LOG_FORMAT_CSV;
+    reader->time_base = 0.001;
+
+    // The header is the first line, base the number of columns on the number of entries in it
+    const char *line_end = memchr(reader->data, '\n', reader->size);
+    line_end = line_end ? (line_end + 1) : reader->end;
+    reader->header = reader->data;
+    reader->header_length = (size_t)(line_end - reader->data);
+
+    // Keep the names without the line ending, separated by NULs like in a binary log
+    reader->names = (char *)malloc(reader->header_length + 1);
+    if (!reader->names) {
+        return LOG_IO_ERROR_NO_MEMORY;
+    }
+    reader->num_columns = 1;
+    for (const char *p = reader->header; p < line_end; p++) {
+        if (*p == ',') {
+            reader->names[reader->names_length++] = '\0';
+            reader->num_columns++;
+        } else if (*p != '\n' && *p != '\r') {
+            reader->names[reader->names_length++] = *p;
+        }
+    }
+    reader->names[reader->names_length++] = '\0';
+
+    // Count the rows up front so a binary output log can be laid out before the first block is written, empty
+    // lines are skipped exactly like log_reader_read_block does
+    const char *p = line_end;
+    while (p < reader->end) {
+        if (*p == '\n' || *p == '\r') {
+            p++;
+            continue;
+        }
+        reader->num_samples++;
+        p = memchr(p, '\n', (size_t)(reader->end - p));
+        p = p ? (p + 1) : reader->end;
+    }
+    reader->cursor = line_end;
+
+    return LOG_IO_ERROR_OK;
+}
+
+int log_reader_open(log_reader_t *reader, const char *path)
+{
+    if (!reader || !path) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    memset(reader, 0, sizeof(log_reader_t));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return LOG_IO_ERROR_OPEN;
+    }
+
+    // Map regular files, the mapping stays valid after the descriptor is closed
+    struct stat info;
+    int         ret = LOG_IO_ERROR_OK;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        if (info.st_size > 0) {
+            void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                ret = log_reader_load(reader, fd);
+            } else {
+                madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+                reader->data = (const char *)map;
+                reader->size = (size_t)info.st_size;
+                reader->mapped = 1;
+            }
+        }
+    } else {
+        ret = log_reader_load(reader, fd);
+    }
+    close(fd);
+    if (ret != LOG_IO_ERROR_OK) {
+        return ret;
+    }
+    reader->cursor = reader->data;
+    reader->end = reader->data + reader->size;
+    if (reader->size == 0) {
+        return LOG_IO_ERROR_NO_DATA;
+    }
+
+    if (reader->size >= 4 && !memcmp(reader->data, LOG_FCOL_MAGIC, 4)) {
+        return log_reader_open_fcol(reader);
+    }
+
+    return log_reader_open_csv(reader);
+}
+
+static inline void log_reader_track_time(log_reader_t *reader, unsigned int time_stamp)
+{
+    if (reader->prev_time == 0) {
+        reader->prev_time = time_stamp;
+    } else {
+        reader->delta_time += time_stamp - reader->prev_time;
+        reader->prev_time = time_stamp;
+    }
+    reader->line_count++;
+}
+
+static size_t log_reader_read_block_csv(log_reader_t *reader, log_block_t *block)
+{
+    const char *p = reader->cursor;
+    const char *end = reader->end;
+
+    block->num_rows = 0;
+    while (block->num_rows < block->capacity && p < end) {
+        // Skip empty lines
+        if (*p == '\n' || *p == '\r') {
+            p++;
+            continue;
+        }
+
+        // Get the time stamp
+        unsigned int time_stamp = (unsigned int)log_parse_long(p, end, &p);
+        log_reader_track_time(reader, time_stamp);
+        p = log_skip_field(p, end);
+
+        // Get the data, missing columns read as 0
+        filter_data_t *frame = &block->data[block->num_rows * block->num_channels];
+        for (unsigned int i = 0; i < block->num_channels; i++) {
+            if (p < end && *p == ',') {
+                frame[i] = filter_data_from_double(log_parse_double(p + 1, end, &p));
+                p = log_skip_field(p, end);
+            } else {
+                frame[i] = (filter_data_t)0;
+            }
+        }
+
+        // Ignore anything past the last data column
+        p = memchr(p, '\n', (size_t)(end - p));
+        p = p ? (p + 1) : end;
+
+        block->time_stamps[block->num_rows++] = time_stamp;
+    }
+    reader->cursor = p;
+
+    return block->num_rows;
+}
+
+static size_t log_reader_read_block_fcol(log_reader_t *reader, log_block_t *block)
+{
+    uint64_t remaining = reader->num_samples - reader->sample;
+    size_t   num_rows = (remaining < block->capacity) ? (size_t)remaining : block->capacity;
+
+    const char *time_column = reader->columns[0] + (reader->sample * 4);
+    for (size_t n = 0; n < num_rows; n++) {
+        uint32_t time_stamp;
+        memcpy(&time_stamp, time_column + (n * 4), sizeof(uint32_t));
+        block->time_stamps[n] = time_stamp;
+        log_reader_track_time(reader, time_stamp);
+    }
+
+    // Walk each column in order and scatter it into the interleaved frames, columns missing from the log read as 0
+    for (unsigned int i = 0; i < block->num_channels; i++) {
+        filter_data_t *dst = block->data + i;
+        if (i + 1 >= reader->num_columns) {
+            for (size_t n = 0; n < num_rows; n++) {
+                dst[n * block->num_channels] = (filter_data_t)0;
+            }
+            continue;
+        }
+
+        const char *src = reader->columns[i + 1] + (reader->sample * log_fcol_dtype_size(reader->dtype));
+        for (size_t n = 0; n < num_rows; n++) {
+            if (reader->dtype == LOG_FCOL_DTYPE_INT32) {
+                int32_t value;
+                memcpy(&value, src + (n * 4), sizeof(int32_t));
+                dst[n * block->num_channels] = filter_data_from_double((double)value);
+            } else if (reader->dtype == LOG_FCOL_DTYPE_FLOAT32) {
+                float value;
+                memcpy(&value, src + (n * 4), sizeof(float));
+                dst[n * block->num_channels] = filter_data_from_double((double)value);
+            } else {
+                double value;
+                memcpy(&value, src + (n * 8), sizeof(double));
+                dst[n * block->num_channels] = filter_data_from_double((double)value);
+            }
+        }
+    }
+
+    reader->sample += num_rows;
+    block->num_rows = num_rows;
+
+    return num_rows;
+}
+
+size_t log_reader_read_block(log_reader_t *reader, log_block_t *block)
+{
+    if (reader->format == LOG_FORMAT_FCOL) {
+        return log_reader_read_block_fcol(reader, block);
+    }
+
+    return log_reader_read_block_csv(reader, block);
+}
+
+size_t log_reader_skip(log_reader_t *reader, size_t num_rows)
+{
+    if (reader->format == LOG_FORMAT_FCOL) {
+        uint64_t remaining = reader->num_samples - reader->sample;
+        size_t   count = (remaining < num_rows) ? (size_t)remaining : num_rows;
+        reader->sample += count;
+        return count;
+    }
+
+    // Only the line endings are looked at, the same lines log_reader_read_block would read
+    const char *p = reader->cursor;
+    const char *end = reader->end;
+    size_t      count = 0;
+    while (count < num_rows && p < end) {
+        if (*p == '\n' || *p == '\r') {
+            p++;
+            continue;
+        }
+        p = memchr(p, '\n', (size_t)(end - p));
+        p = p ? (p + 1) : end;
+        count++;
+    }
+    reader->cursor = p;
+
+    return count;
+}
+
+int log_reader_time_span(const log_reader_t *reader, unsigned int *first, unsigned int *last)
+{
+    if (!reader || !first || !last) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+    if (reader->num_samples == 0) {
+        return LOG_IO_ERROR_NO_DATA;
+    }
+
+    if (reader->format == LOG_FORMAT_FCOL) {
+        uint32_t time_stamp;
+        memcpy(&time_stamp, reader->columns[0], sizeof(uint32_t));
+        *first = time_stamp;
+        memcpy(&time_stamp, reader->columns[0] + ((reader->num_samples - 1) * 4), sizeof(uint32_t));
+        *last = time_stamp;
+        return LOG_IO_ERROR_OK;
+    }
+
+    // The first row follows the header, the last row is found by walking back over the trailing line endings.
+    // Empty lines are skipped exactly like log_reader_read_block does
+    const char *rows = reader->header + reader->header_length;
+    const char *p = rows;
+    while (p < reader->end && (*p == '\n' || *p == '\r')) {
+        p++;
+    }
+    *first = (unsigned int)log_parse_long(p, reader->end, &p);
+
+    p = reader->end;
+    while (p > rows && (p[-1] == '\n' || p[-1] == '\r')) {
+        p--;
+    }
+    while (p > rows && p[-1] != '\n') {
+        p--;
+    }
+    *last = (unsigned int)log_parse_long(p, reader->end, &p);
+
+    return LOG_IO_ERROR_OK;
+}
+
+void log_reader_close(log_reader_t *reader)
+{
+    if (reader->mapped) {
+        munmap((void *)reader->data, reader->size);
+    } else {
+        free((void *)reader->data);
+    }
+    free(reader->names);
+    free((void *)reader->columns);
+    reader->data = NULL;
+    reader->cursor = NULL;
+    reader->end = NULL;
+    reader->header = NULL;
+    reader->names = NULL;
+    reader->columns = NULL;
+    reader->size = 0;
+}
+
+int log_format_from_path(const char *path)
+{
+    size_t length = strlen(path);
+
+    if (length >= 5 && !strcmp(path + length - 5, ".fcol")) {
+        return LOG_FORMAT_FCOL;
+    }
+
+    return LOG_FORMAT_CSV;
+}
+
+int log_writer_open(log_writer_t *writer, const char *path, int format)
+{
+    if (!writer || !path || (format != LOG_FORMAT_CSV && format != LOG_FORMAT_FCOL)) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    memset(writer, 0, sizeof(log_writer_t));
+    writer->format = format;
+    writer->precision = LOG_PRECISION_DEFAULT;
+    writer->decimation = 1;
+    if (format == LOG_FORMAT_CSV) {
+        writer->buffer = (char *)malloc(LOG_WRITE_BUFFER_SIZE);
+        if (!writer->buffer) {
+            return LOG_IO_ERROR_NO_MEMORY;
+        }
+    }
+    writer->file = fopen(path, (format == LOG_FORMAT_FCOL) ? "wb" : "w");
+
+    return writer->file ? LOG_IO_ERROR_OK : LOG_IO_ERROR_OPEN;
+}
+
+int log_writer_set_precision(log_writer_t *writer, int precision)
+{
+    if (!writer || precision > LOG_PRECISION_MAX || (precision < 0 && precision != LOG_PRECISION_SHORTEST)) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    writer->precision = precision;
+
+    return LOG_IO_ERROR_OK;
+}
+
+int log_writer_set_decimation(log_writer_t *writer, unsigned int decimation)
+{
+    if (!writer || decimation == 0) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    writer->decimation = decimation;
+
+    return LOG_IO_ERROR_OK;
+}
+
+int log_writer_set_num_rows(log_writer_t *writer, uint64_t num_rows)
+{
+    if (!writer) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    writer->num_rows = num_rows;
+
+    return LOG_IO_ERROR_OK;
+}
+
+static int log_writer_write_header_fcol(log_writer_t *writer, const log_reader_t *reader)
+{
+    uint64_t data_offset = log_fcol_align(LOG_FCOL_HEADER_SIZE + reader->names_length);
+    char    *header = (char *)calloc(1, (size_t)data_offset);
+
+    writer->num_columns = reader->num_columns;
+    uint64_t num_rows = writer->num_rows ? writer->num_rows : reader->num_samples;
+    writer->num_samples = (num_rows + writer->decimation - 1) / writer->decimation;
+    writer->offsets = (uint64_t *)malloc(sizeof(uint64_t) * writer->num_columns);
+    writer->scratch = malloc(sizeof(double) * 1024);
+    if (!header || !writer->offsets || !writer->scratch) {
+        free(header);
+        return LOG_IO_ERROR_NO_MEMORY;
+    }
+
+    double time_base = reader->time_base;
+    uint64_t time_base_bits;
+    memcpy(&time_base_bits, &time_base, sizeof(double));
+    memcpy(header, LOG_FCOL_MAGIC, 4);
+    log_put_u16(header + 4, LOG_FCOL_VERSION);
+    log_put_u16(header + 6, LOG_FCOL_DTYPE);
+    log_put_u32(header + 8, writer->num_columns);
+    log_put_u32(header + 12, (uint32_t)data_offset);
+    log_put_u64(header + 16, writer->num_samples);
+    log_put_u64(header + 24, time_base_bits);
+    memcpy(header + LOG_FCOL_HEADER_SIZE, reader->names, reader->names_length);
+    log_fcol_layout(writer->offsets, data_offset, writer->num_columns, writer->num_samples, LOG_FCOL_DTYPE);
+
+    // Size the file up front, the columns are then filled in block by block
+    int ret = LOG_IO_ERROR_OK;
+    if (fwrite(header, 1, (size_t)data_offset, writer->file) != data_offset) {
+        ret = LOG_IO_ERROR_WRITE;
+    }
+    unsigned int last_size = (writer->num_columns == 1) ? 4 : log_fcol_dtype_size(LOG_FCOL_DTYPE);
+    fflush(writer->file);
+    if (ftruncate(fileno(writer->file), (off_t)(writer->offsets[writer->num_columns - 1] + (writer->num_samples * last_size)))) {
+        ret = LOG_IO_ERROR_WRITE;
+    }
+    free(header);
+
+    return ret;
+}
+
+int log_writer_write_header(log_writer_t *writer, const log_reader_t *reader)
+{
+    if (!writer || !reader) {
+        return LOG_IO_ERROR_INVALID_PARAM;
+    }
+
+    if (writer->format == LOG_FORMAT_FCOL) {
+        return log_writer_write_header_fcol(writer, reader);
+    }
+
+    // Copy a CSV header as is, otherwise join the column names
+    if (reader->format == LOG_FORMAT_CSV) {
+        fwrite(reader->header, 1, reader->header_length, writer->file);
+    } else {
+        const char *name = reader->names;
+        for (unsigned int i = 0; i < reader->num_columns; i++) {
+            fprintf(writer->file, (i < reader->num_columns - 1) ? "%s," : "%s\n", name);
+            name += strlen(name) + 1;
+        }
+    }
+
+    return LOG_IO_ERROR_OK;
+}
+
+static void log_writer_write_block_fcol(log_writer_t *writer, const log_block_t *block)
+{
+    const unsigned int num_channels = block->num_channels;
+    const unsigned int dtype_size = log_fcol_dtype_size(LOG_FCOL_DTYPE);
+
+    // Never write past the number of samples announced in the header
+    size_t num_rows = block->num_rows;
+    if (writer->sample + num_rows > writer->num_samples) {
+        num_rows = (size_t)(writer->num_samples - writer->sample);
+    }
+
+    fseeko(writer->file, (off_t)(writer->offsets[0] + (writer->sample * 4)), SEEK_SET);
+    for (size_t n = 0; n < num_rows; n++) {
+        uint32_t time_stamp = block->time_stamps[n];
+        fwrite(&time_stamp, sizeof(uint32_t), 1, writer->file);
+    }
+
+    // Convert each column in chunks of 1024 values and append it to its region of the file
+    for (unsigned int i = 0; i < num_channels && i + 1 < writer->num_columns; i++) {
+        fseeko(writer->file, (off_t)(writer->offsets[i + 1] + (writer->sample * dtype_size)), SEEK_SET);
+        for (size_t first = 0; first < num_rows; first += 1024) {
+            size_t count = (num_rows - first < 1024) ? (num_rows - first) : 1024;
+            for (size_t n = 0; n < count; n++) {
+                filter_data_t value = block->data[((first + n) * num_channels) + i];
+#if LOG_FCOL_DTYPE == LOG_FCOL_DTYPE_FLOAT32
+                ((float *)writer->scratch)[n] = (float)filter_data_to_double(value);
+#else
+                ((double *)writer->scratch)[n] = filter_data_to_double(value);
+#endif
+            }
+            fwrite(writer->scratch, dtype_size, count, writer->file);
+        }
+    }
+
+    writer->sample += num_rows;
+}
+
+/**
+  * @brief Hand the buffered CSV text to the file
+  */
+static void log_writer_flush(log_writer_t *writer)
+{
+    if (writer->buffer_used) {
+        fwrite(writer->buffer, 1, writer->buffer_used, writer->file);
+        writer->buffer_used = 0;
+    }
+}
+
+void log_writer_write_block(log_writer_t *writer, const log_block_t *block)
+{
+    const unsigned int num_channels = block->num_channels;
+
+    if (writer->format == LOG_FORMAT_FCOL) {
+        log_writer_write_block_fcol(writer, block);
+        return;
+    }
+
+    for (size_t n = 0; n < block->num_rows; n++) {
+        const filter_data_t *frame = &block->data[n * num_channels];
+
+        // Write the time stamp, then the data, if this is the last column, don't write a comma. Every value fits
+        // in LOG_VALUE_SIZE characters plus its separator.
+        if (LOG_WRITE_BUFFER_SIZE - writer->buffer_used < LOG_VALUE_SIZE + 1) {
+            log_writer_flush(writer);
+        }
+        char *p = writer->buffer + writer->buffer_used;
+        p += log_format_u64(p, block->time_stamps[n]);
+        *p++ = ',';
+        for (unsigned int i = 0; i < num_channels; i++) {
+            if ((size_t)(writer->buffer + LOG_WRITE_BUFFER_SIZE - p) < LOG_VALUE_SIZE + 1) {
+                writer->buffer_used = (size_t)(p - writer->buffer);
+                log_writer_flush(writer);
+                p = writer->buffer;
+            }
+            p += log_format_float(p, (float)filter_data_to_double(frame[i]), writer->precision);
+            *p++ = (i < num_channels - 1) ? ',' : '\n';
+        }
+        writer->buffer_used = (size_t)(p - writer->buffer);
+    }
+}
+
+void log_writer_close(log_writer_t *writer)
+{
+    if (writer->file) {
+        log_writer_flush(writer);
+        fclose(writer->file);
+        writer->file = NULL;
+    }
+    free(writer->buffer);
+    free(writer->offsets);
+    free(writer->scratch);
+    writer->buffer = NULL;
+    writer->offsets = NULL;
+    writer->scratch = NULL;
+}
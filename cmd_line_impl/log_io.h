@@ -0,0 +1,273 @@
+#ifndef LOG_IO_H_
+#define LOG_IO_H_
+
+#include "../impl/filter_types.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LOG_IO_ERROR_OK            0
+#define LOG_IO_ERROR_INVALID_PARAM -1
+#define LOG_IO_ERROR_OPEN          -2
+#define LOG_IO_ERROR_NO_MEMORY     -3
+#define LOG_IO_ERROR_NO_DATA       -4
+#define LOG_IO_ERROR_FORMAT        -5
+#define LOG_IO_ERROR_WRITE         -6
+
+// Output precision, number of digits after the decimal point, LOG_PRECISION_DEFAULT matches printf("%f")
+#define LOG_PRECISION_DEFAULT  6
+#define LOG_PRECISION_MAX      20
+#define LOG_PRECISION_SHORTEST -1
+
+// Longest value log_format_float writes, including the terminating NUL
+#define LOG_VALUE_SIZE         64
+
+// Size of the CSV output buffer
+#define LOG_WRITE_BUFFER_SIZE  (1 << 20)
+
+// Log formats
+#define LOG_FORMAT_CSV  0
+#define LOG_FORMAT_FCOL 1
+
+/*
+ * Binary columnar log (.fcol), all fields little endian:
+ *
+ *   offset  size  field
+ *   0       4     magic "FCOL"
+ *   4       2     version, LOG_FCOL_VERSION
+ *   6       2     dtype of the data columns, one of LOG_FCOL_DTYPE_*
+ *   8       4     number of columns, including the time column
+ *   12      4     offset of the first column from the start of the file
+ *   16      8     number of samples in every column
+ *   24      8     time base, seconds per time stamp tick as an IEEE double (0.001 for milliseconds)
+ *   32      ...   column names, each terminated by a NUL
+ *
+ * The time column is uint32, every other column holds num_samples values of dtype. Each column starts on a
+ * LOG_FCOL_ALIGN byte boundary so it can be memory mapped as a plain array, see filter_analysis/fcol.py.
+ */
+#define LOG_FCOL_MAGIC         "FCOL"
+#define LOG_FCOL_VERSION       1
+#define LOG_FCOL_HEADER_SIZE   32
+#define LOG_FCOL_ALIGN         64
+#define LOG_FCOL_DTYPE_INT32   1
+#define LOG_FCOL_DTYPE_FLOAT32 2
+#define LOG_FCOL_DTYPE_FLOAT64 3
+
+// The data type written for filter_data_t, the values are written through filter_data_to_double and the
+// conversion is exact in every math mode
+#if defined(FILTER_USE_FLOAT_MATH) || defined(FILTER_USE_Q15_MATH)
+#define LOG_FCOL_DTYPE LOG_FCOL_DTYPE_FLOAT32
+#else
+#define LOG_FCOL_DTYPE LOG_FCOL_DTYPE_FLOAT64
+#endif
+
+/**
+  * @brief A block of rows, the data columns of each row are stored as one interleaved frame
+  */
+typedef struct
+{
+    size_t         num_rows;
+    size_t         capacity;
+    unsigned int   num_channels;
+    unsigned int  *time_stamps;
+    filter_data_t *data;
+} log_block_t;
+
+/**
+  * @brief Log reader, the first column is an integer time stamp and every other column is a data channel
+  * @note The log is memory mapped and parsed in place, CSV logs have no limit on the length of a line. Logs that
+  *       can not be mapped (pipes, character devices) are read into memory once instead. The format is detected
+  *       from the first bytes of the log.
+  */
+typedef struct
+{
+    int          format;
+    const char  *data;
+    const char  *cursor;
+    const char  *end;
+    size_t       size;
+    int          mapped;
+    const char  *header;
+    size_t       header_length;
+    char        *names;
+    size_t       names_length;
+    unsigned int num_columns;
+    uint64_t     num_samples;
+    uint64_t     sample;
+    double       time_base;
+    unsigned int dtype;
+    const char **columns;
+    unsigned int delta_time;
+    unsigned int prev_time;
+    unsigned int line_count;
+} log_reader_t;
+
+/**
+  * @brief Log writer
+  */
+typedef struct
+{
+    int          format;
+    int          precision;
+    unsigned int decimation;
+    uint64_t     num_rows;
+    FILE        *file;
+    char        *buffer;
+    size_t       buffer_used;
+    unsigned int num_columns;
+    uint64_t     num_samples;
+    uint64_t     sample;
+    uint64_t    *offsets;
+    void        *scratch;
+} log_writer_t;
+
+/**
+  * @brief Parse a decimal number, locale independent and with the same result as strtod
+  * @note Numbers with at most 19 significant digits and a decimal exponent within +-22 are converted exactly
+  *       with a single correctly rounded multiply or divide, anything else (long mantissas, nan, inf, hex) is
+  *       handed to strtod.
+  * @param begin Pointer to the first character, leading blanks are skipped
+  * @param end Pointer one past the last character that may be read, the text does not need to be NUL terminated
+  * @param next Set to the first character after the number, or to begin if no number was found
+  * @return The parsed value, 0 if no number was found
+  */
+double log_parse_double(const char *begin, const char *end, const char **next);
+
+/**
+  * @brief Format a value in fixed point notation without going through printf
+  * @note With a precision of 0 to LOG_PRECISION_MAX the text is identical to printf("%.*f", precision, value),
+  *       including round half to even on exact ties and "-0.000000" for small negative values. The value is split
+  *       into its binary mantissa and exponent and scaled by a power of ten in exact integer arithmetic, values too
+  *       large for that and nan or inf are passed to snprintf.
+  *       LOG_PRECISION_SHORTEST writes the fewest digits after the decimal point that still read back as the same
+  *       float, or "%.9g" if more than LOG_PRECISION_MAX digits would be needed.
+  * @param dst Pointer to at least LOG_VALUE_SIZE characters
+  * @param value Value to format
+  * @param precision Number of digits after the decimal point, or LOG_PRECISION_SHORTEST
+  * @return Number of characters written, not counting the terminating NUL
+  */
+int log_format_float(char *dst, float value, int precision);
+
+/**
+  * @brief Pick the output format from the file name, names ending in .fcol are written as binary columnar logs
+  * @param path Path of the log
+  * @return One of the LOG_FORMAT_* formats
+  */
+int log_format_from_path(const char *path);
+
+/**
+  * @brief Allocate a block
+  * @param block Pointer to the block
+  * @param capacity Number of rows the block holds
+  * @param num_channels Number of data columns in each row
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_block_init(log_block_t *block, size_t capacity, unsigned int num_channels);
+
+/**
+  * @brief Release a block
+  * @param block Pointer to the block
+  */
+void log_block_free(log_block_t *block);
+
+/**
+  * @brief Open a log and read its header, the number of columns and samples are taken from the header
+  * @param reader Pointer to the reader
+  * @param path Path of the log
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_reader_open(log_reader_t *reader, const char *path);
+
+/**
+  * @brief Read the next rows of the log into a block, empty CSV lines are skipped
+  * @param reader Pointer to the reader
+  * @param block Pointer to the block, its number of channels must match the log
+  * @return Number of rows read, 0 at the end of the log
+  */
+size_t log_reader_read_block(log_reader_t *reader, log_block_t *block);
+
+/**
+  * @brief Move past the next rows of the log without parsing them, empty CSV lines are skipped
+  * @note A copy of an open reader reads on from the same place in the same mapping without touching the original,
+  *       so several threads can each read a range of rows of one log through their own copy. Only the original is
+  *       closed, after every copy is done.
+  * @param reader Pointer to the reader
+  * @param num_rows Number of rows to skip
+  * @return Number of rows skipped, less than num_rows at the end of the log
+  */
+size_t log_reader_skip(log_reader_t *reader, size_t num_rows);
+
+/**
+  * @brief Get the time stamps of the first and last row without reading the log
+  * @param reader Pointer to the open reader
+  * @param first Pointer to the first time stamp
+  * @param last Pointer to the last time stamp
+  * @return LOG_IO_ERROR_OK on success, LOG_IO_ERROR_NO_DATA if the log has no rows, negative on error
+  */
+int log_reader_time_span(const log_reader_t *reader, unsigned int *first, unsigned int *last);
+
+/**
+  * @brief Close the log
+  * @param reader Pointer to the reader
+  */
+void log_reader_close(log_reader_t *reader);
+
+/**
+  * @brief Create the output log
+  * @param writer Pointer to the writer
+  * @param path Path of the log
+  * @param format One of the LOG_FORMAT_* formats
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_writer_open(log_writer_t *writer, const char *path, int format);
+
+/**
+  * @brief Set the number of digits after the decimal point written to a CSV log, see log_format_float
+  * @param writer Pointer to the writer
+  * @param precision 0 to LOG_PRECISION_MAX, or LOG_PRECISION_SHORTEST
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_writer_set_precision(log_writer_t *writer, int precision);
+
+/**
+  * @brief Set the decimation factor the rows are written with, the binary columnar header announces one sample for
+  *        every decimation'th input row
+  * @param writer Pointer to the writer
+  * @param decimation Keep every decimation'th row, 1 (the default) keeps every row
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_writer_set_decimation(log_writer_t *writer, unsigned int decimation);
+
+/**
+  * @brief Set the number of rows handed to the writer before decimation, for stages that change the number of
+  *        rows such as the resampler. The binary columnar header announces them instead of the input rows
+  * @param writer Pointer to the writer
+  * @param num_rows Number of rows, 0 (the default) takes the number of rows of the input log
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_writer_set_num_rows(log_writer_t *writer, uint64_t num_rows);
+
+/**
+  * @brief Write the header of the output log, the columns and number of samples match the input log, see
+  *        log_writer_set_decimation() and log_writer_set_num_rows()
+  * @note A CSV header is copied as is from a CSV input log.
+  * @param writer Pointer to the writer
+  * @param reader Pointer to the open input log
+  * @return LOG_IO_ERROR_OK on success, negative on error
+  */
+int log_writer_write_header(log_writer_t *writer, const log_reader_t *reader);
+
+/**
+  * @brief Write every row of a block
+  * @param writer Pointer to the writer
+  * @param block Pointer to the block
+  */
+void log_writer_write_block(log_writer_t *writer, const log_block_t *block);
+
+/**
+  * @brief Flush and close the output log
+  * @param writer Pointer to the writer
+  */
+void log_writer_close(log_writer_t *writer);
+
+#endif /* LOG_IO_H_ */
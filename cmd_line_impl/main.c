@@ -1,17 +1,17 @@
-#include "../impl/sma_filter/sma_filter.h"
-#include "../impl/iir_filter/iir_filter.h"
-#include "../impl/iir_filter/iir_config.h"
-#include "../impl/fir_filter/fir_filter.h"
-#include "../impl/fir_filter/fir_config.h"
 #include "../impl/filter_types.h"
+#include "filter_runner.h"
+#include "log_io.h"
+#include "pipeline.h"
+#include "spectrum_monitor.h"
+#include "batch.h"
+#include "../impl/resampler/resampler.h"
 
+#include <float.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
-
-// Filter configuration parameters
-#define SMA_FILTER_SIZE 10
+#include <time.h>
 
 // Argument strings
 #define ARG_INPUT_FILE_LONG   "--input-file"
@@ -22,218 +22,476 @@
 #define ARG_FILTER_TYPE_SHORT "-f"
 #define ARG_SUB_FILTER_LONG   "--sub-filter"
 #define ARG_SUB_FILTER_SHORT  "-s"
+#define ARG_THREADS_LONG      "--threads"
+#define ARG_THREADS_SHORT     "-t"
+#define ARG_TIME_THREADS_LONG  "--time-threads"
+#define ARG_TIME_THREADS_SHORT "-T"
+#define ARG_PRECISION_LONG    "--precision"
+#define ARG_PRECISION_SHORT   "-p"
+#define ARG_DECIMATE_LONG     "--decimate"
+#define ARG_DECIMATE_SHORT    "-d"
+#define ARG_RESAMPLE_LONG     "--resample"
+#define ARG_RESAMPLE_SHORT    "-r"
+#define ARG_CHAIN_LONG        "--chain"
+#define ARG_CHAIN_SHORT       "-c"
+#define ARG_DESIGN_LONG       "--design"
+#define ARG_DESIGN_SHORT      "-D"
+#define ARG_WRITE_DESIGN_LONG "--write-design"
+#define ARG_WRITE_DESIGN_SHORT "-w"
+#define ARG_ANALYZE_LONG      "--analyze"
+#define ARG_ANALYZE_SHORT     "-a"
+#define ARG_ANALYZE_OUTPUT_LONG  "--analyze-output"
+#define ARG_ANALYZE_OUTPUT_SHORT "-A"
+#define ARG_BATCH_LONG        "--batch"
+#define ARG_BATCH_SHORT       "-b"
 #define ARG_HELP_LONG         "--help"
 #define ARG_HELP_SHORT        "-h"
 
 void print_help()
 {
-    printf("Usage: filter_example -i <input file> -o <output file> -f <filter type> -s <sub filter type>\n");
+    printf("Usage: filter_example -i <input file> -o <output file> -f <filter type>[,<filter type>...] -s <sub filter type> [-c <chain config>] [-t <threads> | -T <threads>] [-p <precision>] [-d <decimation>] [-r <mode>[:<period>]] [-D <design config> [-w <design output>]] [-a <analysis> -A <analysis output>]\n");
+    printf("       filter_example -b <directory, glob or manifest> -o <output directory> -f <filter type>[,<filter type>...] [-c <chain config>] [-t <threads>] [-p <precision>] [-d <decimation>] [-D <design config>]\n");
+    printf("       filter_example -D <design config> -w <design output>\n");
     printf("Filter types:\n");
     printf("  sma - Simple Moving Average\n");
     printf("  iir - Infinite Impulse Response\n");
     printf("  iir-biquad - Infinite Impulse Response Biquad\n");
+    printf("  iir-biquad-df2t - Infinite Impulse Response Biquad, Direct Form II Transposed\n");
     printf("  fir - Finite Impulse Response\n");
+    printf("  cic - Cascaded moving average, 2 stages of 8 samples\n");
+    printf("  ema - Exponential moving average, smoothing factor 1/8\n");
+    printf("  median - Running median of 5 samples\n");
+    printf("  hampel - Hampel outlier filter, 7 sample window, 3 sigmas, output delayed by 3 samples\n");
+    printf("  A comma separated list, e.g. hampel,iir-biquad, runs the filters as a chain in one pass\n");
+    printf("Chain config:\n");
+    printf("  A file of stage=<filter type> lines, used in place of -f, see chain.cfg.example\n");
     printf("Sub filter types:\n");
     printf("  highpass - High pass filter\n");
     printf("  lowpass - Low pass filter\n");
     printf("  bandpass - Band pass filter\n");
     printf("  bandstop - Band stop filter\n");
+    printf("Threads:\n");
+    printf("  0 - Parse, filter and write on one thread (default), in batch mode one worker per CPU\n");
+    printf("  N - Parser thread, N filter worker threads sharded by column and a writer thread, in batch mode N workers\n");
+    printf("Time threads:\n");
+    printf("  N - Cut every column into chunks of rows filtered on N threads, for logs with few long columns. Each chunk\n");
+    printf("      starts early on rows of the previous one, IIR, biquad and EMA outputs differ from -t by at most %g\n", PIPELINE_SETTLE_TOLERANCE);
+    printf("      times the largest input, plus rounding printed at the start of the run. The integer builds add up to\n");
+    printf("      2 LSB for EMA and the rounding gain of the feedback for IIR and biquad, saturated outputs aside. The\n");
+    printf("      float build adds about %g times the largest output for each stage that rounds to float\n", FLT_EPSILON);
+    printf("Batch:\n");
+    printf("  Filter every log of a directory, a quoted glob pattern or a manifest of one path per line, or a single log,\n");
+    printf("  into the output directory under the same file names, on a work stealing pool. A file whose first line is\n");
+    printf("  not a readable path is taken as a log. Logs of at least %d rows are split by column,\n", BATCH_SPLIT_ROWS);
+    printf("  or into chunks of rows like time threads when they have fewer columns than workers and the filters give\n");
+    printf("  the same output in chunks: FIR, median, Hampel, and SMA and CIC in the integer builds. The output is\n");
+    printf("  identical to filtering each log on its own\n");
+    printf("Precision:\n");
+    printf("  0 to 20 - Digits after the decimal point in CSV output (default 6)\n");
+    printf("  shortest - Fewest digits that read back as the same value\n");
+    printf("Decimation:\n");
+    printf("  M - Keep every M'th output row (default 1), FIR filters only compute the kept rows\n");
+    printf("Resample modes, put the rows on a uniform grid of period ms before filtering (default: the average spacing):\n");
+    printf("  linear - Linear interpolation\n");
+    printf("  cubic - Cubic Hermite interpolation\n");
+    printf("  sinc - Windowed sinc, band limited to half the output rate\n");
+    printf("Design config:\n");
+    printf("  A filter_designer.py config, e.g. design.cfg.example, designed at start up in place of the generated\n");
+    printf("  coefficients. butter, cheby1 and cheby2 IIR filters and firwin FIR filters are supported\n");
+    printf("Design output:\n");
+    printf("  Write the designed coefficients at full precision, without an input file nothing is filtered\n");
+    printf("Analysis, streaming spectrum of every filtered column written to the analysis output as CSV:\n");
+    printf("  goertzel:<block>:<f>[,<f>...] - Amplitude of each tone in Hz over blocks of block rows\n");
+    printf("  sdft:<size>:<f>[,<f>...][:<hop>] - Sliding DFT of the last size rows at each tone, every hop rows (default 1)\n");
+    printf("  stft:<size>[:<hop>] - Hann windowed spectrum of size rows, a power of two, every hop rows (default size/2)\n");
 }
 
+/**
+  * @brief Parse a resample argument, a mode name optionally followed by ':' and the period in ms
+  * @return One of the RESAMPLER_MODE_* modes, negative if the argument is invalid
+  */
+static int parse_resample(const char *arg, double *period)
+{
+    static const char *const names[] = { "linear", "cubic", "sinc" };
+    static const int         modes[] = { RESAMPLER_MODE_LINEAR, RESAMPLER_MODE_CUBIC, RESAMPLER_MODE_SINC };
+
+    const char *colon = strchr(arg, ':');
+    size_t      length = colon ? (size_t)(colon - arg) : strlen(arg);
+    *period = 0.0;
+    if (colon) {
+        char *end;
+        *period = strtod(colon + 1, &end);
+        if (end == colon + 1 || *end != '\0' || !(*period > 0.0)) {
+            return -1;
+        }
+    }
+    for (unsigned int i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strlen(names[i]) == length && !strncmp(arg, names[i], length)) {
+            return modes[i];
+        }
+    }
+
+    return -1;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief Print the counters of every filter stage, summed over the columns
+  */
+static void print_stats(const int *filter_types, unsigned int num_filters, const filter_stats_t *stats)
+{
+    printf("Filter statistics:\n");
+    for (unsigned int i = 0; i < num_filters; i++) {
+        const filter_stats_t *stage = &stats[i];
+        printf("  %s: ", filter_runner_type_name(filter_types[i]));
+        if (stage->num_calls == 0) {
+            printf("not instrumented\n");
+            continue;
+        }
+        printf("%llu samples in %llu calls, %llu warm up, %llu saturated, %llu non finite", (unsigned long long)stage->num_samples,
+               (unsigned long long)stage->num_calls, (unsigned long long)stage->num_warmup,
+               (unsigned long long)stage->num_saturated, (unsigned long long)stage->num_non_finite);
+        if (stage->num_samples > stage->num_non_finite) {
+            printf(", min %f, max %f", filter_data_to_double(stage->min), filter_data_to_double(stage->max));
+        }
+        if (stage->cycles > 0 && stage->num_samples > 0) {
+            printf(", %.2f cycles per sample", (double)stage->cycles / (double)stage->num_samples);
+        }
+        printf("\n");
+    }
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
 int main(int argc, char *argv[])
 {
-    // Check for help
-    if (argc == 2 && (!strcmp(argv[1], ARG_HELP_LONG) || !strcmp(argv[1], ARG_HELP_SHORT))) {
+    const char  *input_path = NULL;
+    const char  *output_path = NULL;
+    const char  *filter_name = NULL;
+    const char  *sub_filter_name = NULL;
+    unsigned int num_threads = 0;
+    unsigned int time_threads = 0;
+    int          precision = LOG_PRECISION_DEFAULT;
+    unsigned int decimation = 1;
+    const char  *resample_name = NULL;
+    const char  *chain_path = NULL;
+    const char  *design_path = NULL;
+    const char  *write_design_path = NULL;
+    const char  *analyze_name = NULL;
+    const char  *analyze_path = NULL;
+    const char  *batch_inputs = NULL;
+
+    // Parse the arguments, every option takes a value except help
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], ARG_HELP_LONG) || !strcmp(argv[i], ARG_HELP_SHORT)) {
+            print_help();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printf("Missing value for %s\n", argv[i]);
+            print_help();
+            return -1;
+        }
+        if (!strcmp(argv[i], ARG_INPUT_FILE_LONG) || !strcmp(argv[i], ARG_INPUT_FILE_SHORT)) {
+            input_path = argv[++i];
+        } else if (!strcmp(argv[i], ARG_OUTPUT_FILE_LONG) || !strcmp(argv[i], ARG_OUTPUT_FILE_SHORT)) {
+            output_path = argv[++i];
+        } else if (!strcmp(argv[i], ARG_FILTER_TYPE_LONG) || !strcmp(argv[i], ARG_FILTER_TYPE_SHORT)) {
+            filter_name = argv[++i];
+        } else if (!strcmp(argv[i], ARG_SUB_FILTER_LONG) || !strcmp(argv[i], ARG_SUB_FILTER_SHORT)) {
+            sub_filter_name = argv[++i];
+        } else if (!strcmp(argv[i], ARG_THREADS_LONG) || !strcmp(argv[i], ARG_THREADS_SHORT)) {
+            num_threads = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], ARG_TIME_THREADS_LONG) || !strcmp(argv[i], ARG_TIME_THREADS_SHORT)) {
+            time_threads = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], ARG_PRECISION_LONG) || !strcmp(argv[i], ARG_PRECISION_SHORT)) {
+            i++;
+            precision = !strcmp(argv[i], "shortest") ? LOG_PRECISION_SHORTEST : (int)strtol(argv[i], NULL, 10);
+        } else if (!strcmp(argv[i], ARG_DECIMATE_LONG) || !strcmp(argv[i], ARG_DECIMATE_SHORT)) {
+            decimation = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], ARG_RESAMPLE_LONG) || !strcmp(argv[i], ARG_RESAMPLE_SHORT)) {
+            resample_name = argv[++i];
+        } else if (!strcmp(argv[i], ARG_CHAIN_LONG) || !strcmp(argv[i], ARG_CHAIN_SHORT)) {
+            chain_path = argv[++i];
+        } else if (!strcmp(argv[i], ARG_DESIGN_LONG) || !strcmp(argv[i], ARG_DESIGN_SHORT)) {
+            design_path = argv[++i];
+        } else if (!strcmp(argv[i], ARG_WRITE_DESIGN_LONG) || !strcmp(argv[i], ARG_WRITE_DESIGN_SHORT)) {
+            write_design_path = argv[++i];
+        } else if (!strcmp(argv[i], ARG_ANALYZE_LONG) || !strcmp(argv[i], ARG_ANALYZE_SHORT)) {
+            analyze_name = argv[++i];
+        } else if (!strcmp(argv[i], ARG_ANALYZE_OUTPUT_LONG) || !strcmp(argv[i], ARG_ANALYZE_OUTPUT_SHORT)) {
+            analyze_path = argv[++i];
+        } else if (!strcmp(argv[i], ARG_BATCH_LONG) || !strcmp(argv[i], ARG_BATCH_SHORT)) {
+            batch_inputs = argv[++i];
+        } else {
+            printf("Unknown argument %s\n", argv[i]);
+            print_help();
+            return -1;
+        }
+    }
+
+    // A design config replaces the generated FIR or IIR coefficients, designing only takes microseconds
+    if (write_design_path && !design_path) {
+        printf("Writing a design needs a design config\n");
         print_help();
-        return 0;
+        return -1;
+    }
+    if (design_path) {
+        filter_design_spec_t spec;
+        struct timespec      start;
+        struct timespec      end;
+        if (filter_runner_load_design(design_path, &spec) != 0) {
+            printf("Invalid design config\n");
+            print_help();
+            return -1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int designed = filter_runner_design(&spec);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (designed != 0) {
+            printf("Failed to design the filter\n");
+            return -1;
+        }
+        printf("Design: %s, %.1f us\n", design_path,
+               ((double)(end.tv_sec - start.tv_sec) * 1e6) + ((double)(end.tv_nsec - start.tv_nsec) / 1e3));
+        if (write_design_path && filter_runner_write_design(write_design_path) != 0) {
+            printf("Failed to write the design\n");
+            return -1;
+        }
+        if (write_design_path && !input_path && !batch_inputs && !output_path && !filter_name && !chain_path) {
+            return 0;
+        }
     }
 
-    // Check for correct number of arguments
-    if (argc < 7) {
+    // Check for the required arguments
+    if (!input_path == !batch_inputs || !output_path || (!filter_name && !chain_path)) {
         printf("Incorrect number of arguments\n");
         print_help();
         return -1;
     }
 
-    // Check that the filter type is valid
-    if (strcmp(argv[6], "sma") && strcmp(argv[6], "iir") && strcmp(argv[6], "iir-biquad") && strcmp(argv[6], "fir")) {
+    // Check that the decimation factor is valid
+    if (decimation == 0) {
+        printf("Invalid decimation\n");
+        print_help();
+        return -1;
+    }
+
+    // Check that the resample mode is valid
+    int    resample_mode = PIPELINE_RESAMPLE_NONE;
+    double resample_period = 0.0;
+    if (resample_name) {
+        resample_mode = parse_resample(resample_name, &resample_period);
+        if (resample_mode < 0) {
+            printf("Invalid resample mode\n");
+            print_help();
+            return -1;
+        }
+    }
+
+    // Check that the analysis is valid, it needs somewhere to write its results
+    spectrum_monitor_config_t analysis;
+    if (!analyze_name != !analyze_path ||
+        (analyze_name && spectrum_monitor_parse(analyze_name, &analysis) != SPECTRUM_MONITOR_ERROR_OK)) {
+        printf("Invalid analysis\n");
+        print_help();
+        return -1;
+    }
+
+    // Check that the filter types are valid, a chain config replaces the filter types given with -f
+    int filter_types[FILTER_RUNNER_MAX_STAGES];
+    int num_filters;
+    if (chain_path) {
+        num_filters = filter_runner_load_chain(chain_path, filter_types, FILTER_RUNNER_MAX_STAGES);
+    } else {
+        num_filters = filter_runner_parse_chain(filter_name, filter_types, FILTER_RUNNER_MAX_STAGES);
+    }
+    if (num_filters < 0) {
         printf("Invalid filter type\n");
         print_help();
         return -1;
     }
 
+    // Batch mode filters every log with the same filters, each log is written to the output directory
+    if (batch_inputs) {
+        if (resample_name || analyze_name || time_threads) {
+            printf("Resampling, analysis and time threads are not supported in batch mode\n");
+            print_help();
+            return -1;
+        }
+        if (precision != LOG_PRECISION_SHORTEST && (precision < 0 || precision > LOG_PRECISION_MAX)) {
+            printf("Invalid precision\n");
+            print_help();
+            return -1;
+        }
+        batch_config_t config = { filter_types, (unsigned int)num_filters, decimation, precision, num_threads };
+        batch_stats_t  batch_stats;
+        filter_stats_t stats[FILTER_RUNNER_MAX_STAGES];
+        memset(stats, 0, sizeof(stats));
+        int ret = batch_run(batch_inputs, output_path, &config, &batch_stats, stats);
+        if (ret != BATCH_ERROR_OK && ret != BATCH_ERROR_FAILED) {
+            printf("Failed to run the batch: %s\n", (ret == BATCH_ERROR_NO_FILES) ? "no input logs" :
+                   (ret == BATCH_ERROR_OUTPUT) ? "invalid output directory" : "out of resources");
+            return -1;
+        }
+        double seconds = (batch_stats.seconds > 0.0) ? batch_stats.seconds : 1e-9;
+        printf("Batch: %u files, %u split, %u failed, %llu tasks, %llu stolen\n", batch_stats.num_files,
+               batch_stats.num_split, batch_stats.num_failed, (unsigned long long)batch_stats.num_tasks,
+               (unsigned long long)batch_stats.num_steals);
+        printf("Batch throughput: %llu rows, %llu values, %.1f MB in %.3f s, %.0f rows/s, %.0f values/s, %.1f MB/s\n",
+               (unsigned long long)batch_stats.num_rows, (unsigned long long)batch_stats.num_values,
+               (double)batch_stats.num_bytes / 1e6, batch_stats.seconds, (double)batch_stats.num_rows / seconds,
+               (double)batch_stats.num_values / seconds, (double)batch_stats.num_bytes / 1e6 / seconds);
+#if FILTER_INSTRUMENTATION_ENABLED
+        print_stats(filter_types, (unsigned int)num_filters, stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+        return (ret == BATCH_ERROR_OK) ? 0 : -1;
+    }
+
     // Echo the arguments for now
-    printf("Input file: %s\n", argv[2]);
-    printf("Output file: %s\n", argv[4]);
-    printf("Filter type: %s\n", argv[6]);
-    if (argc == 9) {
-        printf("Sub filter type: %s\n", argv[8]);
+    printf("Input file: %s\n", input_path);
+    printf("Output file: %s\n", output_path);
+    if (chain_path) {
+        printf("Filter chain: %s\n", chain_path);
+    } else {
+        printf("Filter type: %s\n", filter_name);
+    }
+    if (sub_filter_name) {
+        printf("Sub filter type: %s\n", sub_filter_name);
+    }
+    if (decimation > 1) {
+        printf("Decimation: %u\n", decimation);
+    }
+
+    // Chunking by time starts every chunk early by the rows the filters need to forget their initial state
+    int history = 0;
+    if (time_threads) {
+        history = filter_runner_history_length(filter_types, (unsigned int)num_filters, PIPELINE_SETTLE_TOLERANCE);
+        if (num_threads || history < 0 || history > PIPELINE_CHUNK_MAX_HISTORY) {
+            printf("Time threads need -t 0 and filters that settle within %d rows\n", PIPELINE_CHUNK_MAX_HISTORY);
+            print_help();
+            return -1;
+        }
+        printf("Time threads: %u, history %d rows\n", time_threads, history);
+        double rounding;
+        if (filter_runner_rounding_bound(filter_types, (unsigned int)num_filters, &rounding) == 0) {
+#if defined(FILTER_USE_INTEGER_MATH)
+            printf("Time threads rounding: up to %.1f LSB (%g)\n", rounding,
+                   rounding / (double)((int64_t)1 << FILTER_DATA_FRAC_BITS));
+#else
+            printf("Time threads rounding: up to %g times the largest input\n", rounding);
+#endif /* FILTER_USE_INTEGER_MATH */
+        } else {
+            printf("Time threads rounding: no bound, a Hampel filter follows a filter that rounds\n");
+        }
     }
 
     /*
       * We assume the following:
-      * 1. Data is in .csv format
+      * 1. Data is in .csv format, or in the binary columnar .fcol format (see log_io.h)
       * 2. The first column is the time stamp, and is represented as milliseconds and is an integer
       * 3. All columns after that are the data column
       * 4. We set up a filter object for each data column
       */
-    // Open the input and output files
-    FILE *input_file = fopen(argv[2], "r");
-    FILE *output_file = fopen(argv[4], "w");
-
-    // Check that the files opened correctly
-    if (!input_file) {
+    // Open the input and output files, the header line gives the number of columns
+    log_reader_t reader;
+    log_writer_t writer;
+    int          ret = log_reader_open(&reader, input_path);
+    if (ret == LOG_IO_ERROR_OPEN) {
         printf("Failed to open input file\n");
         return -1;
     }
-    if (!output_file) {
+    if (log_writer_open(&writer, output_path, log_format_from_path(output_path)) != LOG_IO_ERROR_OK) {
         printf("Failed to open output file\n");
         return -1;
     }
-
-    // Read the first line of the file, base the number of columns on the number of entries in the first line
-    char line[1024];
-    fgets(line, 1024, input_file);
-    fprintf(output_file, "%s", line);
-    int   num_columns = 0;
-    char *token = strtok(line, ",");
-    while (token) {
-        num_columns++;
-        token = strtok(NULL, ",");
+    if (log_writer_set_precision(&writer, precision) != LOG_IO_ERROR_OK) {
+        printf("Invalid precision\n");
+        print_help();
+        return -1;
     }
 
-    // Void pointer to the filter object
-    void *filter = (void *)0;
-
-    // Print the fixed point configuration, print the size of all the filter types in bits
-    printf("filter_coeff_t: %lu bits\n", sizeof(filter_coeff_t) * 8);
-    printf("filter_data_t: %lu bits\n", sizeof(filter_data_t) * 8);
-    printf("filter_accum_t: %lu bits\n", sizeof(filter_accum_t) * 8);
-
-    // Create the filter object using dynamic memory and based on the filter type
-    if (!strcmp(argv[6], "sma")) {
-        filter = (void *)malloc(sizeof(sma_filter_t) * num_columns);
-
-        // Now intialize the filter
-        for (int i = 0; i < num_columns; i++) {
-            sma_filter_init((sma_filter_t *)filter + i, (filter_data_t *)malloc(sizeof(filter_data_t) * SMA_FILTER_SIZE),
-                            SMA_FILTER_SIZE);
-        }
-    } else if (!strcmp(argv[6], "iir")) {
-        filter = (void *)malloc(sizeof(iir_filter_t) * num_columns);
-
-        // Now intialize the filter
-        for (int i = 0; i < num_columns; i++) {
-            iir_filter_init((iir_filter_t *)filter + i, _iir_b_coeffs, _iir_a_coeffs,
-                            (filter_accum_t *)malloc(sizeof(filter_accum_t) * IIR_NUM_COEFFS),
-                            (filter_accum_t *)malloc(sizeof(filter_accum_t) * IIR_NUM_COEFFS),
-                            IIR_NUM_COEFFS);
-        }
-    } else if (!strcmp(argv[6], "iir-biquad")) {
-        filter = (void *)malloc(sizeof(iir_biquad_filter_t) * num_columns);
+    // The first column is the time stamp, every other column is a data channel
+    if (ret != LOG_IO_ERROR_OK || reader.num_columns < 2) {
+        printf("Input file has no data columns\n");
+        return -1;
+    }
 
-        // Now intialize the filter
-        for (int i = 0; i < num_columns; i++) {
-            iir_biquad_filter_init((iir_biquad_filter_t *)filter + i, _iir_sos_coeffs,
-                                   (filter_accum_t *)malloc(sizeof(filter_accum_t) * (IIR_BIQUAD_NUM_TERMS * 4)),
-                                   IIR_BIQUAD_NUM_TERMS);
+    // Resampling puts the rows on a grid from the first to the last time stamp, by default with the average spacing
+    if (resample_mode != PIPELINE_RESAMPLE_NONE) {
+        unsigned int first_time;
+        unsigned int last_time;
+        if (log_reader_time_span(&reader, &first_time, &last_time) != LOG_IO_ERROR_OK || reader.num_samples < 2 ||
+            last_time <= first_time) {
+            printf("Not enough rows to resample\n");
+            return -1;
         }
-    } else if (!strcmp(argv[6], "fir")) {
-        filter = (void *)malloc(sizeof(fir_filter_t) * num_columns);
-
-        // Now intialize the filter
-        for (int i = 0; i < num_columns; i++) {
-            fir_filter_init((fir_filter_t *)filter + i, _fir_b_coeffs,
-                            (filter_accum_t *)malloc(sizeof(filter_accum_t) * FIR_NUM_COEFFS), FIR_NUM_COEFFS);
+        if (resample_period == 0.0) {
+            resample_period = (double)(last_time - first_time) / (double)(reader.num_samples - 1);
         }
-    } else {
-        printf("Invalid filter type\n");
-        print_help();
+        printf("Resample: %.*s, period %f ms\n", (int)strcspn(resample_name, ":"), resample_name, resample_period);
+        log_writer_set_num_rows(&writer, resampler_num_outputs((double)first_time, (double)last_time, resample_period));
+    }
+    if (log_writer_set_decimation(&writer, decimation) != LOG_IO_ERROR_OK ||
+        log_writer_write_header(&writer, &reader) != LOG_IO_ERROR_OK) {
+        printf("Failed to write the output file header\n");
         return -1;
     }
 
-    // Now read the rest of the file and run the filter on each column
-    unsigned int delta_time = 0;
-    unsigned int prev_time = 0;
-    unsigned int line_count = 0;
-    while (fgets(line, 1024, input_file)) {
-        // Get the time stamp
-        token = strtok(line, ",");
-        unsigned int time_stamp = atoi(token);
-        if (prev_time == 0) {
-            prev_time = time_stamp;
-        } else {
-            delta_time += time_stamp - prev_time;
-            prev_time = time_stamp;
+    // The analysis sees the written rows, their rate follows from the resample period or the average spacing of the
+    // input rows and drops with the decimation
+    spectrum_monitor_t monitor;
+    if (analyze_name) {
+        unsigned int first_time;
+        unsigned int last_time;
+        double       sampling_rate = 0.0;
+        if (resample_mode != PIPELINE_RESAMPLE_NONE) {
+            sampling_rate = 1.0 / (resample_period * reader.time_base);
+        } else if (log_reader_time_span(&reader, &first_time, &last_time) == LOG_IO_ERROR_OK && last_time > first_time) {
+            sampling_rate = (double)(reader.num_samples - 1) / ((double)(last_time - first_time) * reader.time_base);
         }
-
-        // Write the time stamp to the output file
-        fprintf(output_file, "%u,", time_stamp);
-
-        // Get the data
-        for (int i = 0; i < num_columns - 1; i++) {
-            token = strtok(NULL, ",");
-            filter_data_t input = (filter_data_t)atof(token);
-            filter_data_t output = 0;
-
-            // Run the filter
-            if (!strcmp(argv[6], "sma")) {
-                sma_filter_run((sma_filter_t *)filter + i, input, &output);
-            } else if (!strcmp(argv[6], "iir")) {
-                if (iir_filter_run((iir_filter_t *)filter + i, input, &output) == IIR_FILTER_ERROR_INVALID_OUTPUT) {
-                    output = 0;
-                }
-            } else if (!strcmp(argv[6], "iir-biquad")) {
-                if (iir_biquad_filter_run((iir_biquad_filter_t *)filter + i, input, &output) == IIR_FILTER_ERROR_INVALID_OUTPUT) {
-                    output = 0;
-                }
-            } else if (!strcmp(argv[6], "fir")) {
-                fir_filter_run((fir_filter_t *)filter + i, input, &output);
-            }
-
-            // Write the output to the file, if this is the last column, don't write a comma
-            if (i < num_columns - 2) {
-                fprintf(output_file, "%f,", (float)output);
-            } else {
-                fprintf(output_file, "%f", (float)output);
-            }
+        sampling_rate /= (double)decimation;
+        if (spectrum_monitor_init(&monitor, &analysis, &reader, sampling_rate, analyze_path) != SPECTRUM_MONITOR_ERROR_OK) {
+            printf("Failed to set up the analysis\n");
+            return -1;
         }
+        printf("Analysis: %s, sampling rate %f Hz, output %s\n", analyze_name, sampling_rate, analyze_path);
+    }
 
-        // Write a new line
-        fprintf(output_file, "\n");
+    // Print the fixed point configuration, print the size of all the filter types in bits
+    printf("filter_coeff_t: %lu bits\n", sizeof(filter_coeff_t) * 8);
+    printf("filter_data_t: %lu bits\n", sizeof(filter_data_t) * 8);
+    printf("filter_accum_t: %lu bits\n", sizeof(filter_accum_t) * 8);
 
-        // Increment the line count
-        line_count++;
+    // Now read the rest of the file and run the filter on each column, the counters stay zero unless the filters
+    // are built with FILTER_ENABLE_INSTRUMENTATION
+    filter_stats_t stats[FILTER_RUNNER_MAX_STAGES];
+    memset(stats, 0, sizeof(stats));
+    if (time_threads) {
+        ret = pipeline_run_chunked(&reader, &writer, filter_types, (unsigned int)num_filters, time_threads, decimation,
+                                   resample_mode, resample_period, (unsigned int)history, stats, analyze_name ? &monitor : NULL);
+    } else {
+        ret = pipeline_run(&reader, &writer, filter_types, (unsigned int)num_filters, num_threads, decimation, resample_mode,
+                           resample_period, stats, analyze_name ? &monitor : NULL);
+    }
+    if (ret == PIPELINE_ERROR_FILTER_INIT) {
+        printf("Failed to initialize the filter\n");
+        return -1;
+    } else if (ret != PIPELINE_ERROR_OK) {
+        printf("Failed to run the filter pipeline\n");
+        return -1;
     }
 
     // Close the files
-    fclose(input_file);
-    fclose(output_file);
-
-    // Print the average time delta
-    printf("Average time delta: %f ms\n", (float)delta_time / (float)line_count);
-    printf("Average sample rate: %f Hz\n", 1000.0 / ((float)delta_time / (float)line_count));
-
-    // Based on the filter size and type, free all of the sub objects
-    if (!strcmp(argv[6], "sma")) {
-        for (int i = 0; i < num_columns; i++) {
-            free(((sma_filter_t *)filter + i)->data);
-        }
-    } else if (!strcmp(argv[6], "iir")) {
-        for (int i = 0; i < num_columns; i++) {
-            free(((iir_filter_t *)filter + i)->prev_inputs);
-            free(((iir_filter_t *)filter + i)->prev_outputs);
-        }
-    } else if (!strcmp(argv[6], "iir-biquad")) {
-        for (int i = 0; i < num_columns; i++) {
-            free(((iir_biquad_filter_t *)filter + i)->delay_elements);
-        }
-    } else if (!strcmp(argv[6], "fir")) {
-        for (int i = 0; i < num_columns; i++) {
-            free(((fir_filter_t *)filter + i)->prev_inputs);
-        }
+    log_reader_close(&reader);
+    log_writer_close(&writer);
+    if (analyze_name) {
+        spectrum_monitor_free(&monitor);
     }
 
-    // Now free the filter object
-    free(filter);
+    // Print the average time delta
+    printf("Average time delta: %f ms\n", (float)reader.delta_time / (float)reader.line_count);
+    printf("Average sample rate: %f Hz\n", 1000.0 / ((float)reader.delta_time / (float)reader.line_count));
+#if FILTER_INSTRUMENTATION_ENABLED
+    print_stats(filter_types, (unsigned int)num_filters, stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 }
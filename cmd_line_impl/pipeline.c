@@ -0,0 +1,590 @@
+#include "pipeline.h"
+#include "filter_runner.h"
+#include "spsc_ring.h"
+#include "../impl/resampler/resampler.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct pipeline_s pipeline_t;
+
+/**
+  * @brief Rows handed to the filters, either straight from the reader or put on a uniform time grid first
+  */
+typedef struct
+{
+    log_reader_t  *reader;
+    int            resample;
+    resampler_t    resampler;
+    double        *times;
+    filter_data_t *values;
+    log_block_t    input;
+    size_t         cursor;
+    int            finished;
+} pipeline_source_t;
+
+/**
+  * @brief Filter worker, owns the filter state of the columns [first_channel, first_channel + num_channels)
+  */
+typedef struct
+{
+    pthread_t       thread;
+    filter_runner_t runner;
+    unsigned int    first_channel;
+    unsigned int    num_channels;
+    filter_data_t  *scratch;
+    spsc_ring_t     in;
+    spsc_ring_t     out;
+    void           *in_items[PIPELINE_RING_SIZE];
+    void           *out_items[PIPELINE_RING_SIZE];
+} pipeline_worker_t;
+
+struct pipeline_s
+{
+    pipeline_source_t   source;
+    log_writer_t       *writer;
+    spectrum_monitor_t *monitor;
+    unsigned int        num_workers;
+    unsigned int        decimation;
+    unsigned int        phase;
+    pipeline_worker_t  *workers;
+    pthread_t           writer_thread;
+    spsc_ring_t         free_blocks;
+    void               *free_items[PIPELINE_RING_SIZE];
+    log_block_t         blocks[PIPELINE_NUM_BLOCKS];
+};
+
+static void pipeline_source_free(pipeline_source_t *source)
+{
+    free(source->times);
+    free(source->values);
+    log_block_free(&source->input);
+    source->times = NULL;
+    source->values = NULL;
+}
+
+static int pipeline_source_init(pipeline_source_t *source, log_reader_t *reader, int resample_mode, double resample_period)
+{
+    unsigned int num_channels = reader->num_columns - 1;
+
+    memset(source, 0, sizeof(pipeline_source_t));
+    source->reader = reader;
+    source->resample = (resample_mode != PIPELINE_RESAMPLE_NONE);
+    if (!source->resample) {
+        return PIPELINE_ERROR_OK;
+    }
+
+    source->times = (double *)malloc(sizeof(double) * RESAMPLER_HISTORY_SIZE(resample_mode));
+    source->values = (filter_data_t *)malloc(sizeof(filter_data_t) * RESAMPLER_VALUES_SIZE(resample_mode, num_channels));
+    if (!source->times || !source->values || log_block_init(&source->input, PIPELINE_BLOCK_ROWS, num_channels) != LOG_IO_ERROR_OK) {
+        pipeline_source_free(source);
+        return PIPELINE_ERROR_NO_MEMORY;
+    }
+    if (resampler_init(&source->resampler, resample_mode, num_channels, resample_period, source->times, source->values) != RESAMPLER_ERROR_OK) {
+        pipeline_source_free(source);
+        return PIPELINE_ERROR_INVALID_PARAM;
+    }
+
+    return PIPELINE_ERROR_OK;
+}
+
+/**
+  * @brief Fill a block with the next rows, resampled rows are pulled until the block is full or the log ends
+  * @return Number of rows in the block, 0 at the end of the log
+  */
+static size_t pipeline_source_read(pipeline_source_t *source, log_block_t *block)
+{
+    if (!source->resample) {
+        return log_reader_read_block(source->reader, block);
+    }
+
+    const unsigned int num_channels = block->num_channels;
+    block->num_rows = 0;
+    while (block->num_rows < block->capacity) {
+        double time;
+        if (resampler_pull(&source->resampler, &time, &block->data[block->num_rows * num_channels]) == RESAMPLER_ERROR_OK) {
+            block->time_stamps[block->num_rows++] = (unsigned int)(time + 0.5);
+            continue;
+        }
+
+        if (source->cursor < source->input.num_rows) {
+            // Rows whose time stamp does not advance are dropped
+            resampler_push(&source->resampler, (double)source->input.time_stamps[source->cursor],
+                           &source->input.data[source->cursor * num_channels]);
+            source->cursor++;
+        } else if (source->finished) {
+            break;
+        } else {
+            source->cursor = 0;
+            if (!log_reader_read_block(source->reader, &source->input)) {
+                resampler_finish(&source->resampler);
+                source->finished = 1;
+            }
+        }
+    }
+
+    return block->num_rows;
+}
+
+static int pipeline_run_single(log_reader_t *reader, log_writer_t *writer, const int *filter_types, unsigned int num_filters,
+                               unsigned int decimation, int resample_mode, double resample_period, filter_stats_t *stats,
+                               spectrum_monitor_t *monitor)
+{
+    unsigned int      num_channels = reader->num_columns - 1;
+    unsigned int      phase = 0;
+    filter_runner_t   runner;
+    log_block_t       block;
+    pipeline_source_t source;
+
+    int ret = pipeline_source_init(&source, reader, resample_mode, resample_period);
+    if (ret != PIPELINE_ERROR_OK) {
+        return ret;
+    }
+    if (log_block_init(&block, PIPELINE_BLOCK_ROWS, num_channels) != LOG_IO_ERROR_OK) {
+        pipeline_source_free(&source);
+        return PIPELINE_ERROR_NO_MEMORY;
+    }
+    if (filter_runner_init(&runner, filter_types, num_filters, num_channels, decimation)) {
+        filter_runner_free(&runner);
+        log_block_free(&block);
+        pipeline_source_free(&source);
+        return PIPELINE_ERROR_FILTER_INIT;
+    }
+
+    while (pipeline_source_read(&source, &block)) {
+        size_t num_rows = filter_runner_run(&runner, block.data, block.num_rows);
+        filter_runner_decimate(block.time_stamps, sizeof(unsigned int), block.num_rows, decimation, &phase);
+        block.num_rows = num_rows;
+        log_writer_write_block(writer, &block);
+        if (monitor) {
+            spectrum_monitor_run(monitor, &block);
+        }
+    }
+
+    filter_runner_get_stats(&runner, stats);
+    filter_runner_free(&runner);
+    log_block_free(&block);
+    pipeline_source_free(&source);
+
+    return PIPELINE_ERROR_OK;
+}
+
+static void *pipeline_worker_main(void *arg)
+{
+    pipeline_worker_t *worker = (pipeline_worker_t *)arg;
+    log_block_t       *block;
+
+    // A NULL block marks the end of the log
+    while ((block = (log_block_t *)spsc_ring_pop_wait(&worker->in)) != NULL) {
+        const unsigned int stride = block->num_channels;
+        const unsigned int width = worker->num_channels;
+
+        if (width == stride) {
+            filter_runner_run(&worker->runner, block->data, block->num_rows);
+        } else {
+            // Gather the slice into contiguous frames, filter them, then scatter the kept frames back, the other
+            // workers only touch their own columns of the block
+            filter_data_t *src = block->data + worker->first_channel;
+            for (size_t n = 0; n < block->num_rows; n++) {
+                memcpy(&worker->scratch[n * width], &src[n * stride], sizeof(filter_data_t) * width);
+            }
+            size_t num_rows = filter_runner_run(&worker->runner, worker->scratch, block->num_rows);
+            for (size_t n = 0; n < num_rows; n++) {
+                memcpy(&src[n * stride], &worker->scratch[n * width], sizeof(filter_data_t) * width);
+            }
+        }
+
+        spsc_ring_push_wait(&worker->out, block);
+    }
+    spsc_ring_push_wait(&worker->out, NULL);
+
+    return NULL;
+}
+
+static void *pipeline_writer_main(void *arg)
+{
+    pipeline_t *pipeline = (pipeline_t *)arg;
+
+    for (;;) {
+        // Every worker sees the blocks in parse order, so the heads of the worker rings are always the same
+        // block and the output keeps the input order
+        log_block_t *block = (log_block_t *)spsc_ring_pop_wait(&pipeline->workers[0].out);
+        for (unsigned int i = 1; i < pipeline->num_workers; i++) {
+            spsc_ring_pop_wait(&pipeline->workers[i].out);
+        }
+        if (!block) {
+            break;
+        }
+
+        // Every worker kept the same rows, drop the other time stamps to match
+        block->num_rows = filter_runner_decimate(block->time_stamps, sizeof(unsigned int), block->num_rows,
+                                                 pipeline->decimation, &pipeline->phase);
+        log_writer_write_block(pipeline->writer, block);
+        if (pipeline->monitor) {
+            spectrum_monitor_run(pipeline->monitor, block);
+        }
+        spsc_ring_push_wait(&pipeline->free_blocks, block);
+    }
+
+    return NULL;
+}
+
+static void pipeline_free(pipeline_t *pipeline)
+{
+    if (pipeline->workers) {
+        for (unsigned int i = 0; i < pipeline->num_workers; i++) {
+            filter_runner_free(&pipeline->workers[i].runner);
+            free(pipeline->workers[i].scratch);
+        }
+        free(pipeline->workers);
+    }
+    for (unsigned int i = 0; i < PIPELINE_NUM_BLOCKS; i++) {
+        log_block_free(&pipeline->blocks[i]);
+    }
+    pipeline_source_free(&pipeline->source);
+    free(pipeline);
+}
+
+static int pipeline_run_threaded(log_reader_t *reader, log_writer_t *writer, const int *filter_types, unsigned int num_filters,
+                                 unsigned int num_threads, unsigned int decimation, int resample_mode, double resample_period,
+                                 filter_stats_t *stats, spectrum_monitor_t *monitor)
+{
+    unsigned int num_channels = reader->num_columns - 1;
+    pipeline_t  *pipeline = (pipeline_t *)calloc(1, sizeof(pipeline_t));
+
+    if (!pipeline) {
+        return PIPELINE_ERROR_NO_MEMORY;
+    }
+    int ret = pipeline_source_init(&pipeline->source, reader, resample_mode, resample_period);
+    if (ret != PIPELINE_ERROR_OK) {
+        pipeline_free(pipeline);
+        return ret;
+    }
+    pipeline->writer = writer;
+    pipeline->monitor = monitor;
+    pipeline->decimation = decimation;
+    pipeline->num_workers = (num_threads > num_channels) ? num_channels : num_threads;
+    pipeline->workers = (pipeline_worker_t *)calloc(pipeline->num_workers, sizeof(pipeline_worker_t));
+    if (!pipeline->workers) {
+        pipeline_free(pipeline);
+        return PIPELINE_ERROR_NO_MEMORY;
+    }
+
+    // Every block starts out free
+    spsc_ring_init(&pipeline->free_blocks, pipeline->free_items, PIPELINE_RING_SIZE);
+    for (unsigned int i = 0; i < PIPELINE_NUM_BLOCKS; i++) {
+        if (log_block_init(&pipeline->blocks[i], PIPELINE_BLOCK_ROWS, num_channels) != LOG_IO_ERROR_OK) {
+            pipeline_free(pipeline);
+            return PIPELINE_ERROR_NO_MEMORY;
+        }
+        spsc_ring_push(&pipeline->free_blocks, &pipeline->blocks[i]);
+    }
+
+    // Split the columns as evenly as possible
+    unsigned int first_channel = 0;
+    for (unsigned int i = 0; i < pipeline->num_workers; i++) {
+        pipeline_worker_t *worker = &pipeline->workers[i];
+        worker->first_channel = first_channel;
+        worker->num_channels = (num_channels / pipeline->num_workers) + ((i < num_channels % pipeline->num_workers) ? 1 : 0);
+        first_channel += worker->num_channels;
+
+        spsc_ring_init(&worker->in, worker->in_items, PIPELINE_RING_SIZE);
+        spsc_ring_init(&worker->out, worker->out_items, PIPELINE_RING_SIZE);
+        worker->scratch = (filter_data_t *)malloc(sizeof(filter_data_t) * PIPELINE_BLOCK_ROWS * worker->num_channels);
+        if (!worker->scratch || filter_runner_init(&worker->runner, filter_types, num_filters, worker->num_channels, decimation)) {
+            pipeline_free(pipeline);
+            return PIPELINE_ERROR_FILTER_INIT;
+        }
+    }
+
+    // Start the stages, the calling thread is the parser and resamples the rows before they are handed on
+    unsigned int num_started = 0;
+    for (; num_started < pipeline->num_workers; num_started++) {
+        if (pthread_create(&pipeline->workers[num_started].thread, NULL, pipeline_worker_main, &pipeline->workers[num_started])) {
+            ret = PIPELINE_ERROR_THREAD;
+            break;
+        }
+    }
+    if (ret == PIPELINE_ERROR_OK && pthread_create(&pipeline->writer_thread, NULL, pipeline_writer_main, pipeline)) {
+        ret = PIPELINE_ERROR_THREAD;
+    }
+
+    if (ret == PIPELINE_ERROR_OK) {
+        for (;;) {
+            log_block_t *block = (log_block_t *)spsc_ring_pop_wait(&pipeline->free_blocks);
+            if (!pipeline_source_read(&pipeline->source, block)) {
+                break;
+            }
+            for (unsigned int i = 0; i < pipeline->num_workers; i++) {
+                spsc_ring_push_wait(&pipeline->workers[i].in, block);
+            }
+        }
+    }
+
+    // Shut down whatever was started
+    for (unsigned int i = 0; i < num_started; i++) {
+        spsc_ring_push_wait(&pipeline->workers[i].in, NULL);
+    }
+    if (ret == PIPELINE_ERROR_OK) {
+        pthread_join(pipeline->writer_thread, NULL);
+    }
+    for (unsigned int i = 0; i < num_started; i++) {
+        pthread_join(pipeline->workers[i].thread, NULL);
+    }
+    if (ret == PIPELINE_ERROR_OK) {
+        for (unsigned int i = 0; i < pipeline->num_workers; i++) {
+            filter_runner_get_stats(&pipeline->workers[i].runner, stats);
+        }
+    }
+
+    pipeline_free(pipeline);
+
+    return ret;
+}
+
+typedef struct pipeline_chunked_s pipeline_chunked_t;
+
+/**
+  * @brief Chunk worker, filters one chunk of every block with its own runner
+  */
+typedef struct
+{
+    pthread_t           thread;
+    pipeline_chunked_t *pipeline;
+    unsigned int        index;
+    filter_runner_t     runner;
+    filter_data_t      *scratch;
+    filter_stats_t      stats[FILTER_RUNNER_MAX_STAGES];
+    spsc_ring_t         in;
+    spsc_ring_t         out;
+    void               *in_items[PIPELINE_RING_SIZE];
+    void               *out_items[PIPELINE_RING_SIZE];
+} pipeline_chunk_worker_t;
+
+/**
+  * @brief The input holds history rows before the rows of the block, only the last num_history of them are filled
+  */
+struct pipeline_chunked_s
+{
+    pipeline_source_t        source;
+    unsigned int             num_channels;
+    unsigned int             decimation;
+    size_t                   history;
+    size_t                   chunk_rows;
+    size_t                   num_history;
+    size_t                   num_rows;
+    log_block_t              input;
+    filter_data_t           *output;
+    unsigned int             num_workers;
+    pipeline_chunk_worker_t *workers;
+    unsigned int             num_filters;
+    filter_stats_t          *stats;
+};
+
+/**
+  * @brief Filter one chunk of the block from a reset runner, starting up to history rows early
+  */
+static void pipeline_chunk_run(pipeline_chunked_t *pipeline, pipeline_chunk_worker_t *worker)
+{
+    const unsigned int num_channels = pipeline->num_channels;
+    const size_t       first = worker->index * pipeline->chunk_rows;
+
+    if (first >= pipeline->num_rows) {
+        return;
+    }
+    size_t count = pipeline->num_rows - first;
+    if (count > pipeline->chunk_rows) {
+        count = pipeline->chunk_rows;
+    }
+
+    // Every chunk and the history are a multiple of the decimation, so the runner keeps the same rows a runner
+    // that filtered the whole log keeps
+    size_t warm = pipeline->num_history + first;
+    if (warm > pipeline->history) {
+        warm = pipeline->history;
+    }
+    const size_t begin = pipeline->history + first - warm;
+    memcpy(worker->scratch, &pipeline->input.data[begin * num_channels], sizeof(filter_data_t) * (warm + count) * num_channels);
+
+    filter_runner_get_stats(&worker->runner, worker->stats);
+    filter_runner_reset(&worker->runner);
+    size_t       kept = filter_runner_run(&worker->runner, worker->scratch, warm + count);
+    const size_t skip = warm / pipeline->decimation;
+    memcpy(&pipeline->output[(first / pipeline->decimation) * num_channels], &worker->scratch[skip * num_channels],
+           sizeof(filter_data_t) * (kept - skip) * num_channels);
+}
+
+static void *pipeline_chunk_worker_main(void *arg)
+{
+    pipeline_chunk_worker_t *worker = (pipeline_chunk_worker_t *)arg;
+
+    // A NULL marks the end of the log
+    while (spsc_ring_pop_wait(&worker->in) != NULL) {
+        pipeline_chunk_run(worker->pipeline, worker);
+        spsc_ring_push_wait(&worker->out, worker->pipeline);
+    }
+
+    return NULL;
+}
+
+static void pipeline_chunked_free(pipeline_chunked_t *pipeline)
+{
+    if (pipeline->workers) {
+        for (unsigned int i = 0; i < pipeline->num_workers; i++) {
+            pipeline_chunk_worker_t *worker = &pipeline->workers[i];
+            filter_runner_get_stats(&worker->runner, worker->stats);
+            for (unsigned int j = 0; pipeline->stats && j < pipeline->num_filters; j++) {
+                filter_stats_merge(&pipeline->stats[j], &worker->stats[j]);
+            }
+            filter_runner_free(&worker->runner);
+            free(worker->scratch);
+        }
+        free(pipeline->workers);
+    }
+    free(pipeline->output);
+    log_block_free(&pipeline->input);
+    pipeline_source_free(&pipeline->source);
+    free(pipeline);
+}
+
+int pipeline_run_chunked(log_reader_t *reader, log_writer_t *writer, const int *filter_types, unsigned int num_filters,
+                         unsigned int num_threads, unsigned int decimation, int resample_mode, double resample_period,
+                         unsigned int history, filter_stats_t *stats, spectrum_monitor_t *monitor)
+{
+    if (!reader || !writer || !filter_types || num_filters == 0 || reader->num_columns < 2 || decimation == 0 ||
+        history > PIPELINE_CHUNK_MAX_HISTORY) {
+        return PIPELINE_ERROR_INVALID_PARAM;
+    }
+
+    pipeline_chunked_t *pipeline = (pipeline_chunked_t *)calloc(1, sizeof(pipeline_chunked_t));
+    if (!pipeline) {
+        return PIPELINE_ERROR_NO_MEMORY;
+    }
+    int ret = pipeline_source_init(&pipeline->source, reader, resample_mode, resample_period);
+    if (ret != PIPELINE_ERROR_OK) {
+        free(pipeline);
+        return ret;
+    }
+    const unsigned int num_channels = reader->num_columns - 1;
+    pipeline->num_channels = num_channels;
+    pipeline->decimation = decimation;
+    pipeline->num_filters = num_filters;
+    pipeline->stats = stats;
+    pipeline->num_workers = num_threads ? num_threads : 1;
+
+    // Round the history and the chunks up to the decimation
+    pipeline->history = (((size_t)history + decimation - 1) / decimation) * decimation;
+    pipeline->chunk_rows = (pipeline->history * 8 > PIPELINE_CHUNK_ROWS) ? (pipeline->history * 8) : PIPELINE_CHUNK_ROWS;
+    pipeline->chunk_rows = ((pipeline->chunk_rows + decimation - 1) / decimation) * decimation;
+    const size_t block_rows = pipeline->chunk_rows * pipeline->num_workers;
+
+    pipeline->output = (filter_data_t *)malloc(sizeof(filter_data_t) * block_rows * num_channels);
+    pipeline->workers = (pipeline_chunk_worker_t *)calloc(pipeline->num_workers, sizeof(pipeline_chunk_worker_t));
+    if (!pipeline->output || !pipeline->workers ||
+        log_block_init(&pipeline->input, pipeline->history + block_rows, num_channels) != LOG_IO_ERROR_OK) {
+        pipeline_chunked_free(pipeline);
+        return PIPELINE_ERROR_NO_MEMORY;
+    }
+    for (unsigned int i = 0; i < pipeline->num_workers; i++) {
+        pipeline_chunk_worker_t *worker = &pipeline->workers[i];
+        worker->pipeline = pipeline;
+        worker->index = i;
+        spsc_ring_init(&worker->in, worker->in_items, PIPELINE_RING_SIZE);
+        spsc_ring_init(&worker->out, worker->out_items, PIPELINE_RING_SIZE);
+        worker->scratch = (filter_data_t *)malloc(sizeof(filter_data_t) * (pipeline->history + pipeline->chunk_rows) * num_channels);
+        if (!worker->scratch || filter_runner_init(&worker->runner, filter_types, num_filters, num_channels, decimation)) {
+            pipeline_chunked_free(pipeline);
+            return PIPELINE_ERROR_FILTER_INIT;
+        }
+    }
+
+    // The calling thread filters the first chunk of every block itself
+    unsigned int num_started = 1;
+    for (; num_started < pipeline->num_workers; num_started++) {
+        if (pthread_create(&pipeline->workers[num_started].thread, NULL, pipeline_chunk_worker_main, &pipeline->workers[num_started])) {
+            ret = PIPELINE_ERROR_THREAD;
+            break;
+        }
+    }
+
+    while (ret == PIPELINE_ERROR_OK) {
+        // Fill the block after the history
+        log_block_t block = pipeline->input;
+        block.time_stamps += pipeline->history;
+        block.data += pipeline->history * num_channels;
+        block.capacity = block_rows;
+        size_t num_rows = 0;
+        for (;;) {
+            log_block_t rest = block;
+            rest.time_stamps += num_rows;
+            rest.data += num_rows * num_channels;
+            rest.capacity = block_rows - num_rows;
+            size_t count = (rest.capacity > 0) ? pipeline_source_read(&pipeline->source, &rest) : 0;
+            if (count == 0) {
+                break;
+            }
+            num_rows += count;
+        }
+        if (num_rows == 0) {
+            break;
+        }
+        pipeline->num_rows = num_rows;
+
+        for (unsigned int i = 1; i < num_started; i++) {
+            spsc_ring_push_wait(&pipeline->workers[i].in, pipeline);
+        }
+        pipeline_chunk_run(pipeline, &pipeline->workers[0]);
+        for (unsigned int i = 1; i < num_started; i++) {
+            spsc_ring_pop_wait(&pipeline->workers[i].out);
+        }
+
+        // The block starts on a kept row
+        unsigned int phase = 0;
+        block.num_rows = filter_runner_decimate(block.time_stamps, sizeof(unsigned int), num_rows, decimation, &phase);
+        block.data = pipeline->output;
+        log_writer_write_block(writer, &block);
+        if (monitor) {
+            spectrum_monitor_run(monitor, &block);
+        }
+
+        // Keep the last rows of the input as the history of the next block
+        size_t keep = pipeline->num_history + num_rows;
+        if (keep > pipeline->history) {
+            keep = pipeline->history;
+        }
+        memmove(&pipeline->input.data[(pipeline->history - keep) * num_channels],
+                &pipeline->input.data[(pipeline->history + num_rows - keep) * num_channels],
+                sizeof(filter_data_t) * keep * num_channels);
+        pipeline->num_history = keep;
+    }
+
+    // Shut down whatever was started
+    for (unsigned int i = 1; i < num_started; i++) {
+        spsc_ring_push_wait(&pipeline->workers[i].in, NULL);
+    }
+    for (unsigned int i = 1; i < num_started; i++) {
+        pthread_join(pipeline->workers[i].thread, NULL);
+    }
+
+    pipeline_chunked_free(pipeline);
+
+    return ret;
+}
+
+int pipeline_run(log_reader_t *reader, log_writer_t *writer, const int *filter_types, unsigned int num_filters,
+                 unsigned int num_threads, unsigned int decimation, int resample_mode, double resample_period,
+                 filter_stats_t *stats, spectrum_monitor_t *monitor)
+{
+    if (!reader || !writer || !filter_types || num_filters == 0 || reader->num_columns < 2 || decimation == 0) {
+        return PIPELINE_ERROR_INVALID_PARAM;
+    }
+
+    if (num_threads == 0) {
+        return pipeline_run_single(reader, writer, filter_types, num_filters, decimation, resample_mode, resample_period,
+                                   stats, monitor);
+    }
+
+    return pipeline_run_threaded(reader, writer, filter_types, num_filters, num_threads, decimation, resample_mode,
+                                 resample_period, stats, monitor);
+}
@@ -0,0 +1,94 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include "log_io.h"
+#include "spectrum_monitor.h"
+#include "../impl/filter_stats/filter_stats.h"
+
+#define PIPELINE_ERROR_OK            0
+#define PIPELINE_ERROR_INVALID_PARAM -1
+#define PIPELINE_ERROR_NO_MEMORY     -2
+#define PIPELINE_ERROR_FILTER_INIT   -3
+#define PIPELINE_ERROR_THREAD        -4
+
+// Rows parsed, filtered and written as one unit
+#define PIPELINE_BLOCK_ROWS   1024
+
+// Blocks in flight between the stages of the threaded pipeline
+#define PIPELINE_NUM_BLOCKS   8
+
+// Entries in each ring between two stages, a power of two no smaller than PIPELINE_NUM_BLOCKS + 1
+#define PIPELINE_RING_SIZE    16
+
+// Resample mode that hands the rows to the filters as they are read, see pipeline_run()
+#define PIPELINE_RESAMPLE_NONE -1
+
+// Rows in each chunk of the chunked pipeline, at least 8 times the history so the overlap stays a small overhead
+#define PIPELINE_CHUNK_ROWS        16384
+
+// Longest history the chunked pipeline accepts, filters that settle slower gain little from chunking
+#define PIPELINE_CHUNK_MAX_HISTORY (1 << 20)
+
+// Largest difference of a chunked IIR, biquad or EMA output from the sequential one, relative to the largest input,
+// see filter_runner_history_length(). The rounding of filter_runner_rounding_bound() comes on top
+#define PIPELINE_SETTLE_TOLERANCE  1e-7
+
+/**
+  * @brief Filter every data column of a log and write the result
+  * @note With num_threads == 0 everything runs on the calling thread. Otherwise the calling thread parses,
+  *       num_threads workers each filter a contiguous slice of the columns and a writer thread formats the
+  *       blocks in input order. The stages hand blocks to each other through lock free single producer single
+  *       consumer rings. The output is identical in both modes.
+  *       With a resample mode the rows are first put on a uniform grid of resample_period ticks by the parser,
+  *       see resampler_t, the filters then see evenly spaced samples.
+  *       With a decimation factor above one only every decimation'th row is written, starting with the first.
+  *       A spectrum monitor sees the rows as they are written, on the calling thread or the writer thread.
+  * @param reader Pointer to an open reader, its header has already been read
+  * @param writer Pointer to an open writer, the header has already been written
+  * @param filter_types FILTER_RUNNER_* types of the filters, run in order on every column
+  * @param num_filters Number of filters, 1 to FILTER_RUNNER_MAX_STAGES
+  * @param num_threads Number of filter worker threads, capped to the number of data columns
+  * @param decimation Keep every decimation'th row, 1 keeps every row
+  * @param resample_mode One of the RESAMPLER_MODE_* modes, or PIPELINE_RESAMPLE_NONE
+  * @param resample_period Time stamp ticks between two resampled rows, ignored without a resample mode
+  * @param stats Pointer to one total per filter the counters of every column are added to, see
+  *              filter_runner_get_stats(). May be NULL
+  * @param monitor Pointer to an initialized spectrum monitor the written rows are added to, may be NULL
+  * @return PIPELINE_ERROR_OK on success, negative on error
+  */
+int pipeline_run(log_reader_t *reader, log_writer_t *writer, const int *filter_types, unsigned int num_filters,
+                 unsigned int num_threads, unsigned int decimation, int resample_mode, double resample_period,
+                 filter_stats_t *stats, spectrum_monitor_t *monitor);
+
+/**
+  * @brief Filter every data column of a log with each column cut into chunks of rows filtered in parallel
+  * @note For logs with fewer columns than threads, e.g. a single long channel. The calling thread reads num_threads
+  *       chunks of rows at a time, then it and num_threads - 1 workers each filter one chunk on all columns with a
+  *       runner reset to its initial state. Each runner starts history rows before its chunk, on rows the previous
+  *       chunk or block also filtered, and those outputs are dropped. With the history of
+  *       filter_runner_history_length() the output of the FIR, SMA, CIC, median and Hampel filters matches
+  *       pipeline_run() up to rounding, and the IIR, biquad and EMA outputs differ by at most the tolerance times
+  *       the largest input. The first chunk of the log starts from the initial state as usual. The bound is for the
+  *       exact recursion, rounding adds up to filter_runner_rounding_bound(): units of the data format in the integer
+  *       builds, which also covers the limit cycles of e.g. a narrow Q15 low pass, and about FLT_EPSILON times the
+  *       largest output in the floating point build. Saturated outputs can differ by more.
+  *       Resampling, decimation and the spectrum monitor work as in pipeline_run(), the chunks start on a kept row.
+  * @param reader Pointer to an open reader, its header has already been read
+  * @param writer Pointer to an open writer, the header has already been written
+  * @param filter_types FILTER_RUNNER_* types of the filters, run in order on every column
+  * @param num_filters Number of filters, 1 to FILTER_RUNNER_MAX_STAGES
+  * @param num_threads Number of chunks filtered at once, including the calling thread
+  * @param decimation Keep every decimation'th row, 1 keeps every row
+  * @param resample_mode One of the RESAMPLER_MODE_* modes, or PIPELINE_RESAMPLE_NONE
+  * @param resample_period Time stamp ticks between two resampled rows, ignored without a resample mode
+  * @param history Rows each chunk is started early, at most PIPELINE_CHUNK_MAX_HISTORY
+  * @param stats Pointer to one total per filter the counters of every chunk are added to, the overlapping rows are
+  *              counted in every chunk that filters them. May be NULL
+  * @param monitor Pointer to an initialized spectrum monitor the written rows are added to, may be NULL
+  * @return PIPELINE_ERROR_OK on success, negative on error
+  */
+int pipeline_run_chunked(log_reader_t *reader, log_writer_t *writer, const int *filter_types, unsigned int num_filters,
+                         unsigned int num_threads, unsigned int decimation, int resample_mode, double resample_period,
+                         unsigned int history, filter_stats_t *stats, spectrum_monitor_t *monitor);
+
+#endif /* PIPELINE_H_ */
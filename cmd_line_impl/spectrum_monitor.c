@@ -0,0 +1,246 @@
+#include "spectrum_monitor.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  * @brief Parse a positive integer
+  * @return Pointer to the first character after the number, NULL if there is no positive number
+  */
+static const char *spectrum_monitor_parse_count(const char *text, unsigned int *value)
+{
+    char *end;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (end == text || *text == '-' || *text == '+' || parsed == 0 || parsed > 0x7FFFFFFFUL) {
+        return NULL;
+    }
+    *value = (unsigned int)parsed;
+
+    return end;
+}
+
+int spectrum_monitor_parse(const char *arg, spectrum_monitor_config_t *config)
+{
+    static const char *const names[] = { "goertzel", "sdft", "stft" };
+    static const int         modes[] = { SPECTRUM_MONITOR_GOERTZEL, SPECTRUM_MONITOR_SDFT, SPECTRUM_MONITOR_STFT };
+
+    if (!arg || !config) {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+    memset(config, 0, sizeof(spectrum_monitor_config_t));
+
+    // The mode name and the size are always there
+    const char *colon = strchr(arg, ':');
+    if (!colon) {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+    config->mode = -1;
+    for (unsigned int i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strlen(names[i]) == (size_t)(colon - arg) && !strncmp(arg, names[i], (size_t)(colon - arg))) {
+            config->mode = modes[i];
+        }
+    }
+    const char *text = spectrum_monitor_parse_count(colon + 1, &config->size);
+    if (config->mode < 0 || !text) {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+
+    // The Goertzel and sliding DFT modes need a comma separated list of tones
+    if (config->mode != SPECTRUM_MONITOR_STFT) {
+        if (*text != ':') {
+            return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+        }
+        do {
+            char *end;
+            text++;
+            double tone = strtod(text, &end);
+            if (end == text || !(tone >= 0.0) || config->num_tones == SPECTRUM_MONITOR_MAX_TONES) {
+                return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+            }
+            config->tones[config->num_tones++] = tone;
+            text = end;
+        } while (*text == ',');
+    }
+
+    // The sliding DFT reports every row and the STFT every half frame unless a hop is given
+    config->hop = (config->mode == SPECTRUM_MONITOR_STFT) ? (config->size / 2) : 1;
+    if (*text == ':' && config->mode != SPECTRUM_MONITOR_GOERTZEL) {
+        text = spectrum_monitor_parse_count(text + 1, &config->hop);
+        if (!text) {
+            return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+        }
+    }
+    if (*text != '\0') {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+
+    // The STFT frames are transformed with a real FFT
+    if (config->mode == SPECTRUM_MONITOR_STFT && (config->size < 4 || (config->size & (config->size - 1)))) {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+
+    return SPECTRUM_MONITOR_ERROR_OK;
+}
+
+int spectrum_monitor_init(spectrum_monitor_t *monitor, const spectrum_monitor_config_t *config, const log_reader_t *reader,
+                          double sampling_rate, const char *path)
+{
+    if (!monitor || !config || !reader || !path || reader->num_columns < 2 || !(sampling_rate > 0.0)) {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+    memset(monitor, 0, sizeof(spectrum_monitor_t));
+    monitor->config = *config;
+    monitor->sampling_rate = sampling_rate;
+    monitor->num_channels = reader->num_columns - 1;
+
+    const unsigned int num_channels = monitor->num_channels;
+    const unsigned int size = config->size;
+    size_t             state_size = 0;
+    if (config->mode == SPECTRUM_MONITOR_GOERTZEL) {
+        monitor->num_bins = config->num_tones;
+        monitor->goertzel = (spectral_goertzel_t *)malloc(sizeof(spectral_goertzel_t) * num_channels * config->num_tones);
+    } else if (config->mode == SPECTRUM_MONITOR_SDFT) {
+        // Each tone is tracked at the nearest bin of the window
+        monitor->num_bins = config->num_tones;
+        for (unsigned int i = 0; i < config->num_tones; i++) {
+            double bin = floor((config->tones[i] * (double)size / sampling_rate) + 0.5);
+            if (bin > (double)(size / 2)) {
+                return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+            }
+            monitor->bins[i] = (unsigned int)bin;
+        }
+        state_size = SPECTRAL_SDFT_STATE_SIZE(size, config->num_tones);
+        monitor->sdft = (spectral_sdft_t *)malloc(sizeof(spectral_sdft_t) * num_channels);
+    } else if (config->mode == SPECTRUM_MONITOR_STFT) {
+        monitor->num_bins = FILTER_FFT_NUM_BINS(size);
+        state_size = SPECTRAL_STFT_STATE_SIZE(size);
+        monitor->stft = (spectral_stft_t *)malloc(sizeof(spectral_stft_t) * num_channels);
+    } else {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+    if (state_size) {
+        monitor->state = (double *)malloc(sizeof(double) * state_size * num_channels);
+    }
+
+    // Keep a copy of the column names, the time column comes first
+    monitor->names = (char *)malloc(reader->names_length + 1);
+    monitor->column_names = (const char **)malloc(sizeof(const char *) * num_channels);
+    monitor->output = (filter_fft_complex_t *)malloc(sizeof(filter_fft_complex_t) * monitor->num_bins);
+    if (!monitor->names || !monitor->column_names || !monitor->output || (state_size && !monitor->state) ||
+        (!monitor->goertzel && !monitor->sdft && !monitor->stft)) {
+        spectrum_monitor_free(monitor);
+        return SPECTRUM_MONITOR_ERROR_NO_MEMORY;
+    }
+    memcpy(monitor->names, reader->names, reader->names_length);
+    monitor->names[reader->names_length] = '\0';
+    const char *name = monitor->names;
+    for (unsigned int i = 0; i < num_channels; i++) {
+        name += strlen(name) + 1;
+        monitor->column_names[i] = (name < monitor->names + reader->names_length) ? name : "";
+    }
+
+    int ret = SPECTRAL_ERROR_OK;
+    for (unsigned int i = 0; i < num_channels && ret == SPECTRAL_ERROR_OK; i++) {
+        if (monitor->goertzel) {
+            for (unsigned int j = 0; j < config->num_tones && ret == SPECTRAL_ERROR_OK; j++) {
+                ret = spectral_goertzel_init(&monitor->goertzel[(i * config->num_tones) + j], config->tones[j],
+                                             sampling_rate, size);
+            }
+        } else if (monitor->sdft) {
+            ret = spectral_sdft_init(&monitor->sdft[i], size, monitor->bins, config->num_tones, &monitor->state[i * state_size]);
+        } else {
+            ret = spectral_stft_init(&monitor->stft[i], size, config->hop, SPECTRAL_WINDOW_HANN, &monitor->state[i * state_size]);
+        }
+    }
+    if (ret != SPECTRAL_ERROR_OK) {
+        spectrum_monitor_free(monitor);
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+
+    monitor->file = fopen(path, "w");
+    if (!monitor->file) {
+        spectrum_monitor_free(monitor);
+        return SPECTRUM_MONITOR_ERROR_OPEN;
+    }
+    fprintf(monitor->file, "time,column,frequency,amplitude\n");
+
+    return SPECTRUM_MONITOR_ERROR_OK;
+}
+
+/**
+  * @brief Write one result line, the bin is scaled to the amplitude of a sinusoid at its frequency
+  * @note DC and Nyquist have no negative frequency image and are not doubled
+  */
+static void spectrum_monitor_write(spectrum_monitor_t *monitor, unsigned int time, unsigned int channel, double frequency,
+                                   const filter_fft_complex_t *bin, double gain, int edge)
+{
+    double amplitude = hypot(bin->re, bin->im) * (edge ? 1.0 : 2.0) / gain;
+    fprintf(monitor->file, "%u,%s,%f,%.9g\n", time, monitor->column_names[channel], frequency, amplitude);
+}
+
+int spectrum_monitor_run(spectrum_monitor_t *monitor, const log_block_t *block)
+{
+    if (!monitor || !block || block->num_channels != monitor->num_channels) {
+        return SPECTRUM_MONITOR_ERROR_INVALID_PARAM;
+    }
+
+    const spectrum_monitor_config_t *config = &monitor->config;
+    const unsigned int               num_channels = monitor->num_channels;
+    const double                     resolution = monitor->sampling_rate / (double)config->size;
+    for (size_t n = 0; n < block->num_rows; n++) {
+        const filter_data_t *row = &block->data[n * num_channels];
+        const unsigned int   time = block->time_stamps[n];
+
+        // The sliding DFT is updated on every row but only reported every hop rows once its window is full
+        const int report = (monitor->count + 1 >= config->size) &&
+                           (((monitor->count + 1 - config->size) % config->hop) == 0);
+        monitor->count++;
+
+        for (unsigned int c = 0; c < num_channels; c++) {
+            if (monitor->goertzel) {
+                for (unsigned int j = 0; j < config->num_tones; j++) {
+                    double tone = config->tones[j];
+                    if (spectral_goertzel_run(&monitor->goertzel[(c * config->num_tones) + j], row[c], monitor->output) ==
+                        SPECTRAL_ERROR_OK) {
+                        spectrum_monitor_write(monitor, time, c, tone, monitor->output, (double)config->size,
+                                               (tone == 0.0) || (2.0 * tone == monitor->sampling_rate));
+                    }
+                }
+            } else if (monitor->sdft) {
+                if (spectral_sdft_run(&monitor->sdft[c], row[c], monitor->output) == SPECTRAL_ERROR_OK && report) {
+                    for (unsigned int j = 0; j < monitor->num_bins; j++) {
+                        unsigned int bin = monitor->bins[j];
+                        spectrum_monitor_write(monitor, time, c, (double)bin * resolution, &monitor->output[j],
+                                               (double)config->size, (bin == 0) || (2 * bin == config->size));
+                    }
+                }
+            } else if (spectral_stft_run(&monitor->stft[c], row[c], monitor->output) == SPECTRAL_ERROR_OK) {
+                for (unsigned int k = 0; k < monitor->num_bins; k++) {
+                    spectrum_monitor_write(monitor, time, c, (double)k * resolution, &monitor->output[k],
+                                           monitor->stft[c].window_sum, (k == 0) || (2 * k == config->size));
+                }
+            }
+        }
+    }
+
+    return SPECTRUM_MONITOR_ERROR_OK;
+}
+
+void spectrum_monitor_free(spectrum_monitor_t *monitor)
+{
+    if (!monitor) {
+        return;
+    }
+    if (monitor->file) {
+        fclose(monitor->file);
+    }
+    free(monitor->goertzel);
+    free(monitor->sdft);
+    free(monitor->stft);
+    free(monitor->state);
+    free(monitor->output);
+    free(monitor->column_names);
+    free(monitor->names);
+    memset(monitor, 0, sizeof(spectrum_monitor_t));
+}
@@ -0,0 +1,99 @@
+#ifndef SPECTRUM_MONITOR_H_
+#define SPECTRUM_MONITOR_H_
+
+#include "log_io.h"
+#include "../impl/spectral/spectral.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SPECTRUM_MONITOR_ERROR_OK            0
+#define SPECTRUM_MONITOR_ERROR_INVALID_PARAM -1
+#define SPECTRUM_MONITOR_ERROR_NO_MEMORY     -2
+#define SPECTRUM_MONITOR_ERROR_OPEN          -3
+
+// Analysis modes selectable from the command line
+#define SPECTRUM_MONITOR_GOERTZEL 0
+#define SPECTRUM_MONITOR_SDFT     1
+#define SPECTRUM_MONITOR_STFT     2
+
+// Most tones a Goertzel or sliding DFT monitor tracks
+#define SPECTRUM_MONITOR_MAX_TONES 16
+
+/**
+  * @brief Analysis parsed from the command line, see spectrum_monitor_parse()
+  */
+typedef struct
+{
+    int          mode;
+    unsigned int size;
+    unsigned int hop;
+    unsigned int num_tones;
+    double       tones[SPECTRUM_MONITOR_MAX_TONES];
+} spectrum_monitor_config_t;
+
+/**
+  * @brief Streaming spectral analysis of every data column of the filtered rows
+  * @note Every row costs O(1) per tracked tone with the Goertzel and sliding DFT modes, and O(log size) per column
+  *       with the STFT, nothing is recomputed over the whole log. The results are written as CSV lines of time,
+  *       column, frequency in Hz and amplitude of a sinusoid at that frequency, the time is the time stamp of the
+  *       row that completed the block, window or frame.
+  *       The sliding DFTs point at the bins of the monitor, it must not be moved once initialized.
+  */
+typedef struct
+{
+    spectrum_monitor_config_t config;
+    double                    sampling_rate;
+    unsigned int              num_channels;
+    unsigned int              num_bins;
+    unsigned int              bins[SPECTRUM_MONITOR_MAX_TONES];
+    uint64_t                  count;
+    FILE                     *file;
+    char                     *names;
+    const char              **column_names;
+    spectral_goertzel_t      *goertzel;
+    spectral_sdft_t          *sdft;
+    spectral_stft_t          *stft;
+    double                   *state;
+    filter_fft_complex_t     *output;
+} spectrum_monitor_t;
+
+/**
+  * @brief Parse an analysis argument
+  * @note goertzel:<block>:<f>[,<f>...] runs one Goertzel detector per tone over blocks of block rows.
+  *       sdft:<size>:<f>[,<f>...][:<hop>] slides a size row DFT over the bins nearest the tones and reports them
+  *       every hop rows, by default on every row. stft:<size>[:<hop>] transforms Hann windowed frames of size rows,
+  *       a power of two, every hop rows, by default size / 2. Tones are in Hz.
+  * @param arg Argument text
+  * @param config Pointer to the parsed analysis
+  * @return SPECTRUM_MONITOR_ERROR_OK on success, negative if the argument is invalid
+  */
+int spectrum_monitor_parse(const char *arg, spectrum_monitor_config_t *config);
+
+/**
+  * @brief Create the analysis state of every data column and write the header of the results
+  * @param monitor Pointer to the monitor
+  * @param config Pointer to the analysis
+  * @param reader Pointer to the open reader, gives the number and names of the columns
+  * @param sampling_rate Rate of the rows handed to spectrum_monitor_run() in Hz
+  * @param path Path of the CSV results
+  * @return SPECTRUM_MONITOR_ERROR_OK on success, negative on error
+  */
+int spectrum_monitor_init(spectrum_monitor_t *monitor, const spectrum_monitor_config_t *config, const log_reader_t *reader,
+                          double sampling_rate, const char *path);
+
+/**
+  * @brief Add the rows of a block and write the results they complete
+  * @param monitor Pointer to the monitor
+  * @param block Pointer to the block, its number of channels must match the log
+  * @return SPECTRUM_MONITOR_ERROR_OK on success, negative on error
+  */
+int spectrum_monitor_run(spectrum_monitor_t *monitor, const log_block_t *block);
+
+/**
+  * @brief Close the results and release the analysis state
+  * @param monitor Pointer to the monitor
+  */
+void spectrum_monitor_free(spectrum_monitor_t *monitor);
+
+#endif /* SPECTRUM_MONITOR_H_ */
@@ -0,0 +1,111 @@
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <sched.h>
+
+#define SPSC_RING_ERROR_OK            0
+#define SPSC_RING_ERROR_INVALID_PARAM -1
+
+// Keep the producer and consumer indices on separate cache lines
+#define SPSC_RING_CACHE_LINE 64
+
+/**
+  * @brief Bounded lock free ring of pointers with exactly one producer thread and one consumer thread
+  * @note The capacity must be a power of two, the item storage is provided by the caller.
+  */
+typedef struct
+{
+    atomic_size_t head;
+    char          head_pad[SPSC_RING_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t tail;
+    char          tail_pad[SPSC_RING_CACHE_LINE - sizeof(atomic_size_t)];
+    size_t        mask;
+    void        **items;
+} spsc_ring_t;
+
+/**
+  * @brief Initialize the ring
+  * @param ring Pointer to the ring
+  * @param items Pointer to the item storage
+  * @param capacity Number of entries in items, must be a power of two
+  * @return SPSC_RING_ERROR_OK on success, negative on error
+  */
+static inline int spsc_ring_init(spsc_ring_t *ring, void **items, size_t capacity)
+{
+    if (!ring || !items || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return SPSC_RING_ERROR_INVALID_PARAM;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->mask = capacity - 1;
+    ring->items = items;
+
+    return SPSC_RING_ERROR_OK;
+}
+
+/**
+  * @brief Push an item, producer side only
+  * @return 1 if the item was pushed, 0 if the ring is full
+  */
+static inline int spsc_ring_push(spsc_ring_t *ring, void *item)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail - head > ring->mask) {
+        return 0;
+    }
+
+    ring->items[tail & ring->mask] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return 1;
+}
+
+/**
+  * @brief Pop an item, consumer side only
+  * @return 1 if an item was popped, 0 if the ring is empty
+  */
+static inline int spsc_ring_pop(spsc_ring_t *ring, void **item)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return 0;
+    }
+
+    *item = ring->items[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return 1;
+}
+
+/**
+  * @brief Push an item, yielding the CPU while the ring is full
+  */
+static inline void spsc_ring_push_wait(spsc_ring_t *ring, void *item)
+{
+    while (!spsc_ring_push(ring, item)) {
+        sched_yield();
+    }
+}
+
+/**
+  * @brief Pop an item, yielding the CPU while the ring is empty
+  */
+static inline void *spsc_ring_pop_wait(spsc_ring_t *ring)
+{
+    void *item;
+
+    while (!spsc_ring_pop(ring, &item)) {
+        sched_yield();
+    }
+
+    return item;
+}
+
+#endif /* SPSC_RING_H_ */
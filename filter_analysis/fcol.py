@@ -0,0 +1,92 @@
+import struct
+import numpy as np
+
+"""Binary columnar log (.fcol) support, the layout is documented in cmd_line_impl/log_io.h.
+
+Every column is stored as one contiguous little endian array, so the columns are loaded with numpy.memmap and no
+text is parsed."""
+
+MAGIC = b'FCOL'
+VERSION = 1
+HEADER = struct.Struct('<4sHHIIQd')
+ALIGN = 64
+DTYPES = {1: np.dtype('<i4'), 2: np.dtype('<f4'), 3: np.dtype('<f8')}
+TIME_DTYPE = np.dtype('<u4')
+
+"""FcolLog - A loaded binary columnar log
+@param names - The column names, the first one is the time column
+@param time - The time stamps
+@param columns - One array per data column
+@param time_base - Seconds per time stamp tick"""
+class FcolLog:
+    def __init__(self, names, time, columns, time_base):
+        self.names = names
+        self.time = time
+        self.columns = columns
+        self.time_base = time_base
+
+"""_align - Round an offset up to the column alignment
+@param offset - The offset in bytes
+@return offset - The aligned offset"""
+def _align(offset):
+    return (offset + ALIGN - 1) & ~(ALIGN - 1)
+
+"""_map - Memory map one column
+@param file_name - The file name
+@param dtype - The column data type
+@param offset - The column offset in bytes
+@param num_samples - The number of samples
+@return column - The column"""
+def _map(file_name, dtype, offset, num_samples):
+    if num_samples == 0:
+        return np.zeros(0, dtype=dtype)
+    return np.memmap(file_name, dtype=dtype, mode='r', offset=offset, shape=(num_samples,))
+
+"""is_fcol - Check if a file is a binary columnar log
+@param file_name - The file name
+@return True if the file starts with the binary columnar log magic"""
+def is_fcol(file_name):
+    with open(file_name, 'rb') as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+"""load - Load a binary columnar log, the columns are memory mapped
+@param file_name - The file name
+@return log - The FcolLog"""
+def load(file_name):
+    with open(file_name, 'rb') as f:
+        magic, version, dtype, num_columns, data_offset, num_samples, time_base = HEADER.unpack(f.read(HEADER.size))
+        if magic != MAGIC or version != VERSION or dtype not in DTYPES:
+            raise ValueError(f"{file_name} is not a supported binary columnar log")
+        names = [n.decode() for n in f.read(data_offset - HEADER.size).split(b'\0')[:num_columns]]
+
+    offset = data_offset
+    time = _map(file_name, TIME_DTYPE, offset, num_samples)
+    offset = _align(offset + TIME_DTYPE.itemsize * num_samples)
+    columns = []
+    for _ in range(num_columns - 1):
+        columns.append(_map(file_name, DTYPES[dtype], offset, num_samples))
+        offset = _align(offset + DTYPES[dtype].itemsize * num_samples)
+    return FcolLog(names, time, columns, time_base)
+
+"""save - Write a binary columnar log
+@param file_name - The file name
+@param names - The column names, the first one is the time column
+@param time - The time stamps
+@param columns - One array per data column
+@param dtype - The data column type, int32, float32 or float64
+@param time_base - Seconds per time stamp tick"""
+def save(file_name, names, time, columns, dtype=np.float32, time_base=0.001):
+    dtype = np.dtype(dtype).newbyteorder('<')
+    dtype_id = [k for k, v in DTYPES.items() if v == dtype][0]
+    num_samples = len(time)
+    name_bytes = b''.join(n.encode() + b'\0' for n in names)
+    data_offset = _align(HEADER.size + len(name_bytes))
+    with open(file_name, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, dtype_id, len(names), data_offset, num_samples, time_base))
+        f.write(name_bytes)
+        arrays = [np.asarray(time, dtype=TIME_DTYPE)] + [np.asarray(c, dtype=dtype) for c in columns]
+        offset = data_offset
+        for array in arrays:
+            f.write(b'\0' * (offset - f.tell()))
+            f.write(array.tobytes())
+            offset = _align(offset + array.nbytes)
@@ -1,6 +1,7 @@
 import sys
 import matplotlib.pyplot as plt
 import numpy as np
+import fcol
 
 """fft_wrapper - Wrapper for the FFT
 @param signal - The signal
@@ -44,6 +45,18 @@ def read_file(file_name):
                     data.append(line.strip().split(','))
     return header, data
 
+"""read_columns - Read the time stamps and the first data column of a CSV or binary columnar log
+@param file_name - The file name
+@return header - The header
+@return time - The time stamps
+@return signal - The first data column"""
+def read_columns(file_name):
+    if fcol.is_fcol(file_name):
+        log = fcol.load(file_name)
+        return log.names, np.asarray(log.time, dtype=float), log.columns[0]
+    header, data = read_file(file_name)
+    return header, [float(x[0]) for x in data], [float(x[1]) for x in data]
+
 """plot_subplots - Plot the FFT results in a comparison plot
 @param plot_names - The plot names
 @param plot_headers - The plot headers
@@ -68,13 +81,13 @@ def plot_subplots(plot_names, plot_headers, set1, set2):
 @param file_name1 - The first file name
 @param file_name2 - The second file name"""
 def fft_compare(file_name1, file_name2):
-    header1, data1 = read_file(file_name1)
-    fs1 = find_sample_rate([float(x[0]) for x in data1])
-    time1, mag1 = fft_wrapper([float(x[1]) for x in data1], fs1)
+    header1, stamps1, signal1 = read_columns(file_name1)
+    fs1 = find_sample_rate(stamps1)
+    time1, mag1 = fft_wrapper(signal1, fs1)
 
-    header2, data2 = read_file(file_name2)
-    fs2 = find_sample_rate([float(x[0]) for x in data2])
-    time2, mag2 = fft_wrapper([float(x[1]) for x in data2], fs2)
+    header2, stamps2, signal2 = read_columns(file_name2)
+    fs2 = find_sample_rate(stamps2)
+    time2, mag2 = fft_wrapper(signal2, fs2)
 
     plot_names = [file_name1, file_name2]
     plot_headers = [header1, header2]
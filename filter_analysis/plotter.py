@@ -1,17 +1,20 @@
 import sys
 import pandas as pd
 import matplotlib.pyplot as plt
+import fcol
 
-def plot_csv_files(file1, file2):
-    # Read the CSV files into pandas DataFrames
-    df1 = pd.read_csv(file1)
-    if file2 != "":
-        df2 = pd.read_csv(file2)
+def read_log(file_name):
+    # Binary columnar logs are memory mapped, CSV logs are parsed and the first row is stripped, these are the labels
+    if fcol.is_fcol(file_name):
+        log = fcol.load(file_name)
+        return pd.DataFrame(dict(zip(log.names, [log.time] + log.columns)), copy=False)
+    return pd.read_csv(file_name).iloc[1:]
 
-    # Strip the first row from each DataFrame, these are the labels
-    df1 = df1.iloc[1:]
+def plot_csv_files(file1, file2):
+    # Read the logs into pandas DataFrames
+    df1 = read_log(file1)
     if file2 != "":
-        df2 = df2.iloc[1:]
+        df2 = read_log(file2)
     
     # Extract the time column from each DataFrame
     time1 = df1.iloc[:, 0]
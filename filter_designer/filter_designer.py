@@ -4,6 +4,68 @@ from scipy.signal import butter, cheby1, cheby2, freqz, sosfreqz, sosfilt, lfilt
 import argparse
 import os
 
+# Integer builds of the C implementation, the macro that selects each one, its word size and the default
+# FILTER_COEFF_FRAC_BITS and FILTER_DATA_FRAC_BITS from impl/filter_types.h
+Q_FORMATS = {
+    'q15': ('FILTER_USE_Q15_MATH', 16, 13, 4),
+    'q31': ('FILTER_USE_Q31_MATH', 32, 27, 12),
+}
+
+# Largest difference between the C design module and scipy, relative to the largest coefficient
+C_DESIGN_TOLERANCE = 1e-9
+
+"""quantize_coeffs - Round coefficients to a signed fixed point format
+@param values - The coefficients
+@param word_bits - The word size in bits
+@param frac_bits - The number of fractional bits
+@return quantized - The quantized coefficients as integers, None if a coefficient does not fit the word"""
+def quantize_coeffs(values, word_bits, frac_bits):
+    quantized = [int(np.round(v * (1 << frac_bits))) for v in np.ravel(values)]
+    if any(q >= (1 << (word_bits - 1)) or q < -(1 << (word_bits - 1)) for q in quantized):
+        return None
+    return quantized
+
+"""write_coeff_array - Write one coefficient array
+@param f - The open file
+@param declaration - The C declaration of the array
+@param values - The formatted coefficients
+@param row_length - Number of coefficients on each row of a two dimensional array, None for one dimension"""
+def write_coeff_array(f, declaration, values, row_length):
+    f.write(f"{declaration} = {{\n")
+    if row_length:
+        for i in range(0, len(values), row_length):
+            f.write("{")
+            for value in values[i:i + row_length]:
+                f.write(f"{value},")
+            f.write("},\n")
+    else:
+        for value in values:
+            f.write(f"\t{value},\n")
+    f.write("};\n")
+
+"""write_coeff_arrays - Write coefficient arrays for every math mode of the C implementation
+The integer builds get tables quantized to their coefficient format, the floating point and fixed point library
+builds keep the full precision values.
+@param f - The open file
+@param arrays - List of (declaration, values, row_length)"""
+def write_coeff_arrays(f, arrays):
+    for i, (name, (macro, word_bits, frac_bits, _)) in enumerate(Q_FORMATS.items()):
+        f.write(f"#{'if' if i == 0 else 'elif'} defined({macro})\n")
+        f.write(f"#if FILTER_COEFF_FRAC_BITS != {frac_bits}\n")
+        f.write(f"#error \"The {name} tables were generated for {frac_bits} fractional coefficient bits\"\n")
+        f.write("#endif\n")
+        quantized = [quantize_coeffs(values, word_bits, frac_bits) for _, values, _ in arrays]
+        if any(q is None for q in quantized):
+            print(f"Warning: the coefficients do not fit the {name} coefficient format")
+            f.write(f"#error \"The coefficients do not fit the {name} coefficient format\"\n")
+            continue
+        for (declaration, _, row_length), q in zip(arrays, quantized):
+            write_coeff_array(f, declaration, [str(v) for v in q], row_length)
+    f.write("#else\n")
+    for declaration, values, row_length in arrays:
+        write_coeff_array(f, declaration, [f"(filter_coeff_t)({v})" for v in np.ravel(values)], row_length)
+    f.write("#endif\n")
+
 """write_fir_coeffs - Write the FIR filter coefficients to a file
 @param h - The filter coefficients
 @param fname - The file name to write to
@@ -15,10 +77,7 @@ def write_fir_coeffs(h, fname):
             f.write("// You can modify this manually or regenerate it by running filter_designer.py\n")
             f.write("// See the README for more information\n")
             f.write("#include \"fir_config.h\"\n")
-            f.write("filter_coeff_t _fir_b_coeffs[FIR_NUM_COEFFS] = {\n")
-            for i in range(len(h)):
-                f.write(f"\t(filter_coeff_t)({h[i]}),\n")
-            f.write("};\n")
+            write_coeff_arrays(f, [("filter_coeff_t _fir_b_coeffs[FIR_NUM_COEFFS]", h, None)])
     except Exception as e:
         print(f"Error writing to file: {e}")
 
@@ -27,8 +86,9 @@ def write_fir_coeffs(h, fname):
 @param start_freq - The start frequency
 @param stop_freq - The stop frequency
 @param fname - The file name to write to
+@param decimate - The decimation factor the filter is designed for
 @return None"""
-def write_fir_config(filter_order, start_freq, stop_freq, fname):
+def write_fir_config(filter_order, start_freq, stop_freq, fname, decimate=1):
     try:
         if stop_freq is None:
             stop_freq = 0
@@ -43,6 +103,7 @@ def write_fir_config(filter_order, start_freq, stop_freq, fname):
             f.write(f"#define FIR_FILTER_ORDER {filter_order}\n")
             f.write(f"#define FIR_START_FREQ {start_freq}\n")
             f.write(f"#define FIR_STOP_FREQ {stop_freq}\n")
+            f.write(f"#define FIR_DECIMATION {decimate}\n")
             f.write(f"extern filter_coeff_t _fir_b_coeffs[FIR_NUM_COEFFS];\n")
             f.write("#endif")
     except Exception as e:
@@ -61,21 +122,9 @@ def write_iir_coeffs(sos, b, a, fname):
             f.write("// You can modify this manually or regenerate it by running filter_designer.py\n")
             f.write("// See the README for more information\n")
             f.write("#include \"iir_config.h\"\n")
-            f.write("filter_coeff_t _iir_b_coeffs[IIR_NUM_COEFFS] = {\n")
-            for i in range(len(b)):
-                f.write(f"\t(filter_coeff_t)({b[i]}),\n")
-            f.write("};\n")
-            f.write("filter_coeff_t _iir_a_coeffs[IIR_NUM_COEFFS] = {\n")
-            for i in range(len(a)):
-                f.write(f"\t(filter_coeff_t)({a[i]}),\n")
-            f.write("};\n")
-            f.write("filter_coeff_t _iir_sos_coeffs[IIR_BIQUAD_NUM_TERMS][6] = {\n")
-            for i in range(len(sos)):
-                f.write("{")
-                for j in range(len(sos[i])):
-                    f.write(f"(filter_coeff_t)({sos[i][j]}),")
-                f.write("},\n")
-            f.write("};\n")
+            write_coeff_arrays(f, [("filter_coeff_t _iir_b_coeffs[IIR_NUM_COEFFS]", b, None),
+                                   ("filter_coeff_t _iir_a_coeffs[IIR_NUM_COEFFS]", a, None),
+                                   ("filter_coeff_t _iir_sos_coeffs[IIR_BIQUAD_NUM_TERMS][6]", sos, 6)])
     except Exception as e:
         print(f"Error writing to file: {e}")
 
@@ -111,6 +160,49 @@ def write_iir_config(num_terms, filter_order, start_freq, stop_freq, fname):
     except Exception as e:
         print(f"Error writing to file: {e}")
 
+"""write_fir_static - Write a header only FIR filter with static const coefficients and a compile time tap count
+@param h - The filter coefficients
+@param fname - The file name to write to
+@return None"""
+def write_fir_static(h, fname):
+    try:
+        with open(fname, 'w') as f:
+            f.write("// This is an auto generated file by filter_designer.py\n")
+            f.write("// You can modify this manually or regenerate it by running filter_designer.py\n")
+            f.write("// See the README for more information\n")
+            f.write("#ifndef FIR_STATIC_COEFFICIENTS_H_\n")
+            f.write("#define FIR_STATIC_COEFFICIENTS_H_\n")
+            f.write("#include \"fir_filter_static.h\"\n")
+            f.write(f"#define FIR_STATIC_NUM_COEFFS {len(h)}\n")
+            write_coeff_arrays(f, [("static const filter_coeff_t fir_static_b_coeffs[FIR_STATIC_NUM_COEFFS]", h, None)])
+            f.write("FIR_FILTER_STATIC_DEFINE(fir_static_filter, fir_static_b_coeffs, FIR_STATIC_NUM_COEFFS)\n")
+            f.write("#endif\n")
+    except Exception as e:
+        print(f"Error writing to file: {e}")
+
+"""write_iir_static - Write a header only biquad filter with static const coefficients and a compile time section count
+@param sos - The second order sections
+@param form - The biquad structure, df1 or df2t
+@param fname - The file name to write to
+@return None"""
+def write_iir_static(sos, form, fname):
+    try:
+        define = "IIR_BIQUAD_DF2T_STATIC_DEFINE" if form == 'df2t' else "IIR_BIQUAD_STATIC_DEFINE"
+        with open(fname, 'w') as f:
+            f.write("// This is an auto generated file by filter_designer.py\n")
+            f.write("// You can modify this manually or regenerate it by running filter_designer.py\n")
+            f.write("// See the README for more information\n")
+            f.write("#ifndef IIR_STATIC_COEFFICIENTS_H_\n")
+            f.write("#define IIR_STATIC_COEFFICIENTS_H_\n")
+            f.write("#include \"iir_filter_static.h\"\n")
+            f.write(f"#define IIR_STATIC_BIQUAD_NUM_TERMS {len(sos)}\n")
+            f.write(f"#define IIR_STATIC_BIQUAD_DF2T {1 if form == 'df2t' else 0}\n")
+            write_coeff_arrays(f, [("static const filter_coeff_t iir_static_sos_coeffs[IIR_STATIC_BIQUAD_NUM_TERMS][6]", sos, 6)])
+            f.write(f"{define}(iir_static_biquad_filter, iir_static_sos_coeffs, IIR_STATIC_BIQUAD_NUM_TERMS)\n")
+            f.write("#endif\n")
+    except Exception as e:
+        print(f"Error writing to file: {e}")
+
 """plot_iir_filter_response - Plot the frequency response of the filter
 @param sos - The second order sections
 @param b - The numerator coefficients
@@ -208,13 +300,15 @@ def synthesize_filter_input(filter_mode, frequencies, sampling_rate, fname):
 """test_c_filter_impl - Test the C filter implementation
 @param c_args - The command line arguments for the C filter implementation
 @param fout - The output file
+@param math - The math mode to build the C implementation with, float or one of Q_FORMATS
 @return filtered_signal - The filtered signal in C"""
-def test_c_filter_impl(c_args, fout):    
+def test_c_filter_impl(c_args, fout, math):
     try:
         # Clean and compile the application, change the working directory to example_impl
+        macro = Q_FORMATS[math][0] if math in Q_FORMATS else 'FILTER_USE_FLOAT_MATH'
         os.chdir('cmd_line_impl')
         os.system("make clean")
-        os.system("make")
+        os.system(f"make CFLAGS='-Wall -g -D{macro}'")
         os.chdir('..')
 
         # Run the filter program with the test signal as input
@@ -251,6 +345,135 @@ def test_iir_python_filter_impl(sos, b, a , sinusoid, use_sos):
 def test_fir_python_filter_impl(h, sinusoid):
     return lfilter(h, 1, sinusoid)
 
+"""q_rescale - Model of filter_accum_rescale, round half up, floor shift and saturate
+@param acc - The accumulator
+@param word_bits - The data word size in bits
+@param frac_bits - The number of fractional coefficient bits
+@return value - The value at data scale"""
+def q_rescale(acc, word_bits, frac_bits):
+    acc = (acc + (1 << (frac_bits - 1))) >> frac_bits
+    return max(-(1 << (word_bits - 1)), min((1 << (word_bits - 1)) - 1, acc))
+
+"""q_from_float - Model of filter_data_from_double, scale, round half away from zero and saturate
+@param value - The value
+@param word_bits - The data word size in bits
+@param data_frac_bits - The number of fractional data bits
+@return value - The integer data word"""
+def q_from_float(value, word_bits, data_frac_bits):
+    scaled = float(value) * (1 << data_frac_bits)
+    if scaled != scaled:
+        return 0
+    if scaled >= (1 << (word_bits - 1)) - 1:
+        return (1 << (word_bits - 1)) - 1
+    if scaled <= -(1 << (word_bits - 1)):
+        return -(1 << (word_bits - 1))
+    return int(scaled - 0.5) if scaled < 0 else int(scaled + 0.5)
+
+"""q_filter - Bit exact model of the integer C kernels
+@param c_filter - The C filter, fir, iir, iir-biquad or iir-biquad-df2t
+@param coeffs - The coefficients, [h] for fir, [b, a] for iir and [sos] for the biquads
+@param signal - The input signal
+@param math - One of Q_FORMATS
+@return filtered_signal - The filtered signal at data scale"""
+def q_filter(c_filter, coeffs, signal, math):
+    _, word_bits, frac_bits, data_frac_bits = Q_FORMATS[math]
+    q = [quantize_coeffs(c, 64, frac_bits) for c in coeffs]
+    x = [q_from_float(v, word_bits, data_frac_bits) for v in signal]
+    y = []
+    if c_filter == 'fir':
+        window = [0] * len(q[0])
+        for v in x:
+            window = [v] + window[:-1]
+            y.append(q_rescale(sum(c * w for c, w in zip(q[0], window)), word_bits, frac_bits))
+    elif c_filter == 'iir':
+        b, a = q
+        prev_in = [0] * (len(a) - 1)
+        prev_out = [0] * (len(a) - 1)
+        for v in x:
+            acc = b[0] * v + sum(b[i] * prev_in[i - 1] - a[i] * prev_out[i - 1] for i in range(1, len(a)))
+            out = q_rescale(acc, word_bits, frac_bits)
+            prev_in = [v] + prev_in[:-1]
+            prev_out = [out] + prev_out[:-1]
+            y.append(out)
+    else:
+        sos = [q[0][i:i + 6] for i in range(0, len(q[0]), 6)]
+        state = [[0, 0, 0, 0] for _ in sos]
+        for v in x:
+            for s, d in zip(sos, state):
+                if c_filter == 'iir-biquad-df2t':
+                    out = q_rescale(s[0] * v + d[0], word_bits, frac_bits)
+                    d[0] = s[1] * v - s[4] * out + d[1]
+                    d[1] = s[2] * v - s[5] * out
+                else:
+                    out = q_rescale(s[0] * v + s[1] * d[0] + s[2] * d[1] - (s[4] * d[2] + s[5] * d[3]), word_bits, frac_bits)
+                    d[:] = [v, d[0], out, d[2]]
+                v = out
+            y.append(v)
+    return np.array(y, dtype=float) / (1 << data_frac_bits)
+
+"""compare_c_q_model - Print how many C outputs differ from the bit exact model of the integer kernels
+The C output is written as text, both signals are rounded back to the integer data words before comparing them.
+@param c_filt - The C filtered signal
+@param q_filt - The modelled signal
+@param warm_up - Number of leading samples the C implementation reports as warm up
+@param math - One of Q_FORMATS
+@return mismatches - The number of outputs that differ"""
+def compare_c_q_model(c_filt, q_filt, warm_up, math):
+    scale = 1 << Q_FORMATS[math][3]
+    end = min(len(c_filt), len(q_filt)) - 1
+    mismatches = int(np.count_nonzero(np.round(c_filt[warm_up:end] * scale) != np.round(q_filt[warm_up:end] * scale)))
+    print(f"Outputs differing from the bit exact {math} model: {mismatches}")
+    return mismatches
+
+"""compare_c_python_filter - Print the worst case difference between the C and Python filter outputs
+@param c_filt - The C filtered signal
+@param py_filt - The Python filtered signal
+@param warm_up - Number of leading samples the C implementation reports as warm up
+@return max_error - The maximum absolute error"""
+def compare_c_python_filter(c_filt, py_filt, warm_up):
+    # The last C sample is not read back, see test_c_filter_impl
+    end = min(len(c_filt), len(py_filt)) - 1
+    if end <= warm_up:
+        return None
+    max_error = np.max(np.abs(c_filt[warm_up:end] - py_filt[warm_up:end]))
+    print(f"Max error vs Python: {max_error}")
+    return max_error
+
+"""compare_c_design - Print the worst case difference between the C design module and the scipy design
+The C CLI designs the filter from a config file of the resolved parameters and writes the coefficients at full
+precision, see filter_runner_write_design() in cmd_line_impl/filter_runner.h. The CLI has to be built.
+@param params - Dictionary of the design config keys and values, None values are left out
+@param reference - Dictionary of the scipy coefficients, 'sos', 'b' and 'a' for an IIR filter or 'b' for a FIR filter
+@return max_error - The maximum difference relative to the largest coefficient of each array, None if the C design failed"""
+def compare_c_design(params, reference):
+    cfg = 'example_data_sets/c_design.cfg'
+    fout = 'example_data_sets/c_design.out'
+    with open(cfg, 'w') as f:
+        for key, value in params.items():
+            if value is not None:
+                f.write(f"{key}={value}\n")
+    if os.system(f"./cmd_line_impl/filter_example -D {cfg} -w {fout}") != 0:
+        print("C design failed")
+        return None
+
+    # One sos line per section, b and a lines of the direct form
+    designed = {}
+    with open(fout, 'r') as f:
+        for line in f:
+            key, value = line.strip().split('=')
+            designed.setdefault(key, []).append([float(v) for v in value.split(',')])
+    max_error = 0.0
+    for key, values in reference.items():
+        c_values = np.array(designed[key] if key == 'sos' else designed[key][0])
+        if c_values.shape != np.shape(values):
+            print(f"C design {key} has shape {c_values.shape}, expected {np.shape(values)}")
+            return None
+        max_error = max(max_error, np.max(np.abs(c_values - values)) / np.max(np.abs(values)))
+    print(f"Max C design error vs scipy: {max_error}")
+    if max_error > C_DESIGN_TOLERANCE:
+        print(f"Warning: the C design differs from scipy by more than {C_DESIGN_TOLERANCE}")
+    return max_error
+
 """fft_wrapper - Wrapper for the FFT
 @param signal - The signal
 @param sampling_rate - The sampling rate
@@ -270,11 +493,12 @@ def fft_wrapper(signal, sampling_rate):
 @param sinusoid - The original signal
 @param c_filt - The C filtered signal
 @param py_filt - The Python filtered signal
-@param sampling_rate - The sampling rate"""
-def fft_filter_compare(sinusoid, c_filt, py_filt, sampling_rate):
+@param sampling_rate - The sampling rate
+@param decimate - The decimation factor of the filtered signals"""
+def fft_filter_compare(sinusoid, c_filt, py_filt, sampling_rate, decimate=1):
     sig_freq, sig_mag = fft_wrapper(sinusoid, sampling_rate)
-    c_freq, c_mag = fft_wrapper(c_filt, sampling_rate)
-    py_freq, py_mag = fft_wrapper(py_filt, sampling_rate)
+    c_freq, c_mag = fft_wrapper(c_filt, sampling_rate / decimate)
+    py_freq, py_mag = fft_wrapper(py_filt, sampling_rate / decimate)
 
     plt.figure()
     plt.plot(sig_freq, sig_mag, 'b', label='Original Signal')
@@ -308,6 +532,11 @@ parser.add_argument('-e', '--config_file', type=str, default="", help="Optional
 parser.add_argument('-l', '--roll_off', type=float, default=None, help="Optional roll off for the FIR filter")
 parser.add_argument('-fr', '--frequency_range', nargs='+', default=None, help="Optional frequency range for firwin2 filter design algorithm")
 parser.add_argument('-fg', '--frequency_gain', nargs='+', default=None, help="Optional frequency gain for firwin2 filter design algorithm")
+parser.add_argument('-b', '--biquad_form', type=str, default='df1', choices=['df1', 'df2t'], help="Optional biquad structure for the C implementation (default: df1)")
+parser.add_argument('-k', '--static', type=bool, default=False, help="Optional, also write header only filters with static const coefficients, see bench/")
+parser.add_argument('-q', '--math', type=str, default='q31', choices=['q31', 'q15', 'float'], help="Optional math mode the C implementation is built and tested with (default: q31)")
+parser.add_argument('-x', '--decimate', type=int, default=1, help="Optional, keep every M'th output, an FIR filter is designed as the anti-alias filter for it (default: 1)")
+parser.add_argument('-y', '--c_design', type=bool, default=False, help="Optional, also design the filter with the C design module of the CLI and compare it against scipy")
 parser.add_argument('-n', '--normalization', type=str, default='phase', choices=['phase', 'delay', 'mag'], help="Optional normalization for the frequency response for a bessel iir filter")
 
 # Parse the arguments
@@ -332,6 +561,11 @@ config_file = args.config_file
 frequency_range = args.frequency_range
 frequency_gain = args.frequency_gain
 norm = args.normalization
+biquad_form = args.biquad_form
+math = args.math
+static = args.static
+decimate = args.decimate
+c_design = args.c_design
 if config_file:
     try:
         with open(config_file, 'r') as f:
@@ -380,6 +614,16 @@ if config_file:
                     frequency_gain = list(map(float, value.split(',')))
                 elif key == 'normalization':
                     norm = value
+                elif key == 'biquad_form':
+                    biquad_form = value
+                elif key == 'math':
+                    math = value
+                elif key == 'static':
+                    static = bool(value)
+                elif key == 'decimate':
+                    decimate = int(value)
+                elif key == 'c_design':
+                    c_design = bool(value)
                 config_success = True
     except Exception as e:
         print(f"Error reading from file: {e}")
@@ -400,12 +644,17 @@ print(f"Sampling Rate: {sampling_rate}")
 print(f"Start Cutoff: {start_cutoff}")
 print(f"Stop Cutoff: {stop_cutoff}")
 print(f"Use SOS: {use_sos}")
+print(f"Biquad Form: {biquad_form}")
 print(f"Ripple: {args.ripple}")
 print(f"Verbose: {verbose}")
 print(f"IIR Filter Type: {iir_filter_type}")
 print(f"FIR Window: {fir_window}")
 print(f"FIR Algorithm: {fir_algorithm}")
 print(f"Debug: {debug}")
+print(f"Math: {math}")
+print(f"Static: {static}")
+print(f"Decimate: {decimate}")
+print(f"C Design: {c_design}")
 
 # Print the scipy version
 import scipy
@@ -415,6 +664,25 @@ print(f"Scipy Version: {scipy.__version__}")
 if filter_mode in ['bandpass', 'bandstop'] and not stop_cutoff:
     raise ValueError("Band pass and band stop filters require a stop cutoff frequency")
 
+# A decimating FIR is the anti-alias filter, everything above the decimated Nyquist frequency has to be gone
+# before the samples are dropped. Unless a lower cut off is asked for, the pass band ends at 90% of the decimated
+# Nyquist frequency and, without an order, the window's transition band is sized to end at the decimated Nyquist
+# frequency
+if decimate > 1:
+    if filter_type not in ['fir', 'fir-custom'] or fir_algorithm != 'firwin':
+        raise ValueError("Decimation is only designed for firwin FIR filters")
+    if filter_mode not in ['lowpass', '']:
+        raise ValueError("The anti-alias filter for decimation is a low pass filter")
+    decimated_nyquist = nyquist / decimate
+    filter_mode = 'lowpass'
+    stop_cutoff = None
+    if not start_cutoff or start_cutoff > 0.9 * decimated_nyquist:
+        start_cutoff = 0.9 * decimated_nyquist
+    if not filter_order:
+        transition_width = {'hamming': 3.3, 'hann': 3.1, 'blackman': 5.5, 'bartlett': 3.1, 'boxcar': 0.9}[fir_window]
+        filter_order = int(np.ceil(transition_width * sampling_rate / (2 * (decimated_nyquist - start_cutoff)))) | 1
+    print(f"Anti-alias Filter: {filter_order} taps, cut off {start_cutoff} Hz, decimated sampling rate {sampling_rate / decimate} Hz")
+
 # Generate filter coefficients for an IIR filter
 if filter_type == 'iir-biquad' or filter_type == 'iir':
 
@@ -502,6 +770,11 @@ if filter_type == 'iir-biquad' or filter_type == 'iir':
     # Write the coefficients to a file
     write_iir_coeffs(sos, b, a, 'impl/iir_filter/iir_coefficients.c')
     write_iir_config(len(sos), filter_order, start_cutoff, stop_cutoff, 'impl/iir_filter/iir_config.h')
+    if static:
+        if use_sos:
+            write_iir_static(sos, biquad_form, 'impl/iir_filter/iir_static_coefficients.h')
+        else:
+            print("Static filters are only generated for iir-biquad and fir filters")
 
 
     # Plot the frequency response of the filter
@@ -513,13 +786,29 @@ if filter_type == 'iir-biquad' or filter_type == 'iir':
     t, sinusoid = synthesize_filter_input(filter_mode, [start_cutoff, stop_cutoff], sampling_rate, iir_signal)
 
     # Test the C filter implementation
-    c_filter = "iir-biquad" if use_sos else "iir"
+    if use_sos:
+        c_filter = "iir-biquad-df2t" if biquad_form == 'df2t' else "iir-biquad"
+    else:
+        c_filter = "iir"
     c_args = f"./cmd_line_impl/filter_example -i {iir_signal} -o {iir_out_signal} -f {c_filter} -s {filter_mode}"
-    filtered_signal = test_c_filter_impl(c_args, iir_out_signal)
+    filtered_signal = test_c_filter_impl(c_args, iir_out_signal, math)
 
     # Test the python filter implementation using the same coefficients
     python_filter = test_iir_python_filter_impl(sos, b, a, sinusoid, use_sos)
 
+    # Validate the C output against scipy once the C filter is out of its warm up window
+    if use_sos:
+        warm_up = 2 * len(sos) if biquad_form == 'df2t' else 4 * len(sos)
+    else:
+        warm_up = len(a) - 1
+    compare_c_python_filter(filtered_signal, python_filter, warm_up)
+    if c_design:
+        compare_c_design({'filter': filter_type, 'mode': filter_mode, 'order': filter_order, 'sampling_rate': sampling_rate,
+                          'start_cutoff': start_cutoff, 'stop_cutoff': stop_cutoff, 'iir_filter_type': iir_filter_type,
+                          'ripple': ripple, 'attenuition': attenuition}, {'sos': sos, 'b': b, 'a': a})
+    if math in Q_FORMATS:
+        compare_c_q_model(filtered_signal, q_filter(c_filter, [sos] if use_sos else [b, a], sinusoid, math), warm_up, math)
+
     # Plot the FFT of different filter implementations and the original signal
     fft_filter_compare(sinusoid, filtered_signal, python_filter, sampling_rate)
 
@@ -583,7 +872,9 @@ elif filter_type == 'fir' or filter_type == 'fir-custom':
 
     # Write the coefficients to a file
     write_fir_coeffs(h, 'impl/fir_filter/fir_coefficients.c')
-    write_fir_config(filter_order, start_cutoff, stop_cutoff, 'impl/fir_filter/fir_config.h')
+    write_fir_config(filter_order, start_cutoff, stop_cutoff, 'impl/fir_filter/fir_config.h', decimate)
+    if static:
+        write_fir_static(h, 'impl/fir_filter/fir_static_coefficients.h')
 
     # Plot the frequency response of the filter
     plot_fir_filter_response(h, sampling_rate)
@@ -594,21 +885,28 @@ elif filter_type == 'fir' or filter_type == 'fir-custom':
     t, sinusoid = synthesize_filter_input(filter_mode, critical_freq, sampling_rate, fir_signal)
 
     # Test the C filter implementation
-    c_args = f"./cmd_line_impl/filter_example -i {fir_signal} -o {fir_out_signal} -f fir -s {filter_mode}"
-    filtered_signal = test_c_filter_impl(c_args, fir_out_signal)
-
-    # Test the python filter implementation using the same coefficients
-    python_filter = test_fir_python_filter_impl(h, sinusoid)
+    c_args = f"./cmd_line_impl/filter_example -i {fir_signal} -o {fir_out_signal} -f fir -s {filter_mode} -d {decimate}"
+    filtered_signal = test_c_filter_impl(c_args, fir_out_signal, math)
+
+    # Test the python filter implementation using the same coefficients, the C filter keeps every decimate'th
+    # output starting with the first
+    python_filter = test_fir_python_filter_impl(h, sinusoid)[::decimate]
+    if math in Q_FORMATS:
+        compare_c_q_model(filtered_signal, q_filter('fir', [h], sinusoid, math)[::decimate], 0, math)
+    if c_design:
+        compare_c_design({'filter': filter_type, 'mode': filter_mode, 'order': filter_order, 'sampling_rate': sampling_rate,
+                          'start_cutoff': start_cutoff, 'stop_cutoff': stop_cutoff, 'window': fir_window,
+                          'fir_algorithm': fir_algorithm, 'roll_off': roll_off}, {'b': h})
 
     # Plot the FFT of different filter implementations and the original signal
-    fft_filter_compare(sinusoid, filtered_signal, python_filter, sampling_rate)
+    fft_filter_compare(sinusoid, filtered_signal, python_filter, sampling_rate, decimate)
 
     # Plot the original and filtered signals
     plt.figure()
     plt.plot(t, sinusoid, 'b', label='Original Signal')
-    plt.plot(t, filtered_signal, 'r', label='Filtered Signal (C)')
+    plt.plot(t[::decimate], filtered_signal, 'r', label='Filtered Signal (C)')
     if debug:
-        plt.plot(t, python_filter, 'g', label='Filtered Signal (Python)')
+        plt.plot(t[::decimate], python_filter, 'g', label='Filtered Signal (Python)')
     plt.legend()
     plt.xlabel('Time (ms)')
     plt.ylabel('Amplitude')
@@ -0,0 +1,109 @@
+#include "cic_filter.h"
+#include <string.h>
+
+size_t cic_filter_state_size(unsigned int num_stages, unsigned int shift)
+{
+    return sizeof(filter_accum_t) * CIC_FILTER_STATE_SIZE((size_t)num_stages, shift);
+}
+
+int cic_filter_init(cic_filter_t *filter, filter_accum_t *state, unsigned int num_stages, unsigned int shift)
+{
+    if (!filter || !state || num_stages == 0 || shift == 0 || shift > CIC_FILTER_MAX_SHIFT ||
+        num_stages > CIC_FILTER_MAX_GAIN_BITS / shift) {
+        return CIC_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->num_stages = num_stages;
+    filter->shift = shift;
+    filter->delay = state;
+    filter->sums = state + ((size_t)num_stages << shift);
+#if !defined(FILTER_USE_INTEGER_MATH)
+    // 2^-(num_stages * shift) is exact, applying it never rounds
+    filter->scale = 1;
+    for (unsigned int i = 0; i < num_stages * shift; i++)
+    {
+        filter->scale *= (filter_accum_t)0.5;
+    }
+#endif /* FILTER_USE_INTEGER_MATH */
+
+    return cic_filter_reset(filter);
+}
+
+int cic_filter_run(cic_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    int ret = cic_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? CIC_FILTER_ERROR_INVALID_OUTPUT : CIC_FILTER_ERROR_OK;
+}
+
+int cic_filter_run_block(cic_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    if (!filter || !input || !output) {
+        return CIC_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    filter_accum_t    *delay = filter->delay;
+    filter_accum_t    *sums = filter->sums;
+    const unsigned int num_stages = filter->num_stages;
+    const unsigned int shift = filter->shift;
+    const unsigned int mask = (1u << shift) - 1;
+    unsigned int       index = filter->index;
+
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        // Each stage adds its newest input and drops the one 2^shift samples old, its sum feeds the next stage
+        filter_accum_t value = (filter_accum_t)input[n];
+        for (unsigned int s = 0; s < num_stages; s++)
+        {
+            filter_accum_t *line = &delay[s << shift];
+            sums[s] += value - line[index];
+            line[index] = value;
+            value = sums[s];
+        }
+        index = (index + 1) & mask;
+
+#if defined(FILTER_USE_FLOAT_MATH)
+        // Rebuild the sums from the delay lines once per pass, one add per stage and sample on average
+        if (index == 0) {
+            for (unsigned int s = 0; s < num_stages; s++)
+            {
+                const filter_accum_t *line = &delay[s << shift];
+                filter_accum_t        sum = 0;
+                for (unsigned int i = 0; i <= mask; i++)
+                {
+                    sum += line[i];
+                }
+                sums[s] = sum;
+            }
+            value = sums[num_stages - 1];
+        }
+#endif /* FILTER_USE_FLOAT_MATH */
+
+        // Remove the gain of every stage
+#if defined(FILTER_USE_INTEGER_MATH)
+        output[n] = filter_saturate(filter_accum_round_shift(value, num_stages * shift));
+#else
+        output[n] = (filter_data_t)(value * filter->scale);
+#endif /* FILTER_USE_INTEGER_MATH */
+    }
+    filter->index = index;
+
+    return (int)filter_warmup_advance(&filter->count, num_stages * mask, num_samples);
+}
+
+int cic_filter_reset(cic_filter_t *filter)
+{
+    if (!filter) {
+        return CIC_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->index = 0;
+    filter->count = 0;
+    memset(filter->delay, 0, sizeof(filter_accum_t) * CIC_FILTER_STATE_SIZE(filter->num_stages, filter->shift));
+
+    return CIC_FILTER_ERROR_OK;
+}
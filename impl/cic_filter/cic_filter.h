@@ -0,0 +1,123 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef CIC_FILTER_H_
+#define CIC_FILTER_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+#define CIC_FILTER_ERROR_OK             0
+#define CIC_FILTER_ERROR_INVALID_PARAM  -1
+#define CIC_FILTER_ERROR_INVALID_OUTPUT -2
+
+// Largest gain num_stages * shift, the running sums of the integer builds then never overflow 64 bits
+#if defined(FILTER_USE_INTEGER_MATH)
+#define CIC_FILTER_MAX_GAIN_BITS (63 - (8 * (unsigned int)sizeof(filter_data_t)))
+#else
+#define CIC_FILTER_MAX_GAIN_BITS 32
+#endif /* FILTER_USE_INTEGER_MATH */
+
+// Longest delay line, 2^CIC_FILTER_MAX_SHIFT inputs
+#define CIC_FILTER_MAX_SHIFT 16
+
+// Number of filter_accum_t entries required for the state, one delay line of 2^shift inputs and one running sum
+// per stage
+#define CIC_FILTER_STATE_SIZE(num_stages, shift) ((num_stages) * ((1u << (shift)) + 1))
+
+/**
+  * @brief Cascaded moving average filter, the comb and integrator of a CIC filter without the rate change
+  * @note Each stage keeps a running sum over the last 2^shift inputs, num_stages stages shape the response from
+  *       a boxcar (1 stage) towards a gaussian. The gain 2^(num_stages * shift) is removed with a rounding shift
+  *       in the integer builds and a multiply by an exact power of two otherwise, there is no division.
+  *       The integer running sums are exact. The floating point build rebuilds each running sum from its delay
+  *       line every 2^shift samples, so the rounding error stays bounded however long the filter runs.
+  *       The group delay is num_stages * (2^shift - 1) / 2 samples.
+  */
+typedef struct
+{
+    filter_accum_t *delay;
+    filter_accum_t *sums;
+    unsigned int    num_stages;
+    unsigned int    shift;
+    unsigned int    index;
+    unsigned int    count;
+#if !defined(FILTER_USE_INTEGER_MATH)
+    filter_accum_t  scale;
+#endif /* FILTER_USE_INTEGER_MATH */
+} cic_filter_t;
+
+/**
+  * @brief Initialize the filter
+  * @param filter Pointer to the filter
+  * @param state Pointer to the state, must hold CIC_FILTER_STATE_SIZE(num_stages, shift) entries
+  * @param num_stages Number of cascaded moving averages, at least 1
+  * @param shift Every stage averages 2^shift inputs, 1 to CIC_FILTER_MAX_SHIFT. num_stages * shift may be at
+  *              most CIC_FILTER_MAX_GAIN_BITS
+  * @return CIC_FILTER_ERROR_OK on success, negative on error
+  */
+int cic_filter_init(cic_filter_t *filter, filter_accum_t *state, unsigned int num_stages, unsigned int shift);
+
+/**
+  * @brief Get the size of the state, CIC_FILTER_STATE_SIZE(num_stages, shift) entries
+  * @param num_stages Number of cascaded moving averages
+  * @param shift Every stage averages 2^shift inputs
+  * @return Size in bytes
+  */
+size_t cic_filter_state_size(unsigned int num_stages, unsigned int shift);
+
+/**
+  * @brief Run the filter on the input value
+  * @param filter Pointer to the filter
+  * @param input Input value
+  * @param output Pointer to the output value
+  * @return CIC_FILTER_ERROR_OK on success, CIC_FILTER_ERROR_INVALID_OUTPUT while the delay lines are filling,
+  *         negative on error
+  */
+int cic_filter_run(cic_filter_t *filter, filter_data_t input, filter_data_t *output);
+
+/**
+  * @brief Run the filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs produced before every delay line filled, num_stages * (2^shift - 1) samples
+  *         in total, negative on error
+  */
+int cic_filter_run_block(cic_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief Reset the filter
+  * @param filter Pointer to the filter
+  * @return CIC_FILTER_ERROR_OK on success, negative on error
+  */
+int cic_filter_reset(cic_filter_t *filter);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CIC_FILTER_H_ */
@@ -0,0 +1,86 @@
+#include "ema_filter.h"
+
+int ema_filter_init(ema_filter_t *filter, unsigned int shift)
+{
+    if (!filter || shift == 0 || shift > EMA_FILTER_MAX_SHIFT) {
+        return EMA_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->shift = shift;
+#if !defined(FILTER_USE_INTEGER_MATH)
+    // 2^-shift is exact
+    filter->alpha = 1;
+    for (unsigned int i = 0; i < shift; i++)
+    {
+        filter->alpha *= (filter_accum_t)0.5;
+    }
+#endif /* FILTER_USE_INTEGER_MATH */
+
+    return ema_filter_reset(filter);
+}
+
+int ema_filter_run(ema_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    return ema_filter_run_block(filter, &input, output, 1);
+}
+
+int ema_filter_run_block(ema_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    if (!filter || !input || !output) {
+        return EMA_FILTER_ERROR_INVALID_PARAM;
+    }
+    if (num_samples == 0) {
+        return 0;
+    }
+
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    filter_accum_t acc = filter->acc;
+    size_t         n = 0;
+
+    // The first input primes the average
+    if (!filter->primed) {
+#if defined(FILTER_USE_INTEGER_MATH)
+        acc = (filter_accum_t)input[0] * ((filter_accum_t)1 << filter->shift);
+#else
+        acc = (filter_accum_t)input[0];
+#endif /* FILTER_USE_INTEGER_MATH */
+        output[0] = input[0];
+        filter->primed = 1;
+        n = 1;
+    }
+
+#if defined(FILTER_USE_INTEGER_MATH)
+    // acc holds the average scaled by 2^shift, acc += x - y is the shifted form of y += (x - y) / 2^shift
+    const unsigned int shift = filter->shift;
+    filter_accum_t     average = filter_accum_round_shift(acc, shift);
+    for (; n < num_samples; n++)
+    {
+        acc += (filter_accum_t)input[n] - average;
+        average = filter_accum_round_shift(acc, shift);
+        output[n] = (filter_data_t)average;
+    }
+#else
+    const filter_accum_t alpha = filter->alpha;
+    for (; n < num_samples; n++)
+    {
+        acc += ((filter_accum_t)input[n] - acc) * alpha;
+        output[n] = (filter_data_t)acc;
+    }
+#endif /* FILTER_USE_INTEGER_MATH */
+    filter->acc = acc;
+
+    // The primed average is valid from the first sample, there is no warm up window to report
+    return 0;
+}
+
+int ema_filter_reset(ema_filter_t *filter)
+{
+    if (!filter) {
+        return EMA_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->acc = 0;
+    filter->primed = 0;
+
+    return EMA_FILTER_ERROR_OK;
+}
@@ -0,0 +1,97 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef EMA_FILTER_H_
+#define EMA_FILTER_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+#define EMA_FILTER_ERROR_OK            0
+#define EMA_FILTER_ERROR_INVALID_PARAM -1
+
+// Largest shift, the integer builds keep the average with shift extra fraction bits in 64 bits
+#if defined(FILTER_USE_INTEGER_MATH)
+#define EMA_FILTER_MAX_SHIFT (62 - (8 * (unsigned int)sizeof(filter_data_t)))
+#else
+#define EMA_FILTER_MAX_SHIFT 31
+#endif /* FILTER_USE_INTEGER_MATH */
+
+/**
+  * @brief Exponential moving average filter, y += (x - y) / 2^shift
+  * @note The smoothing factor is a power of two, so the update is a shift in the integer builds and a multiply by
+  *       an exact power of two otherwise. The integer builds keep the average scaled by 2^shift and round both the
+  *       feedback and the output, the average has no dead band and settles exactly on a constant input. The time
+  *       constant is roughly 2^shift samples. The first input primes the average, every output is valid.
+  */
+typedef struct
+{
+    filter_accum_t acc;
+    unsigned int   shift;
+    unsigned int   primed;
+#if !defined(FILTER_USE_INTEGER_MATH)
+    filter_accum_t alpha;
+#endif /* FILTER_USE_INTEGER_MATH */
+} ema_filter_t;
+
+/**
+  * @brief Initialize the filter
+  * @param filter Pointer to the filter
+  * @param shift Smoothing factor 1 / 2^shift, 1 to EMA_FILTER_MAX_SHIFT
+  * @return EMA_FILTER_ERROR_OK on success, negative on error
+  */
+int ema_filter_init(ema_filter_t *filter, unsigned int shift);
+
+/**
+  * @brief Run the filter on the input value
+  * @param filter Pointer to the filter
+  * @param input Input value
+  * @param output Pointer to the output value
+  * @return EMA_FILTER_ERROR_OK on success, negative on error
+  */
+int ema_filter_run(ema_filter_t *filter, filter_data_t input, filter_data_t *output);
+
+/**
+  * @brief Run the filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs still inside the warm up window (always 0 for the EMA), negative on error
+  */
+int ema_filter_run_block(ema_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief Reset the filter, the next input primes the average again
+  * @param filter Pointer to the filter
+  * @return EMA_FILTER_ERROR_OK on success, negative on error
+  */
+int ema_filter_reset(ema_filter_t *filter);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* EMA_FILTER_H_ */
@@ -0,0 +1,63 @@
+#include "filter_arena.h"
+#include <stdint.h>
+
+int filter_arena_init(filter_arena_t *arena, void *memory, size_t size)
+{
+    if (!arena) {
+        return FILTER_ARENA_ERROR_INVALID_PARAM;
+    }
+
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+    if (!memory) {
+        return FILTER_ARENA_ERROR_OK;
+    }
+
+    // Start on the first cache line boundary, offsets within the arena are then aligned as well
+    size_t skip = FILTER_ARENA_ALIGN_UP((uintptr_t)memory, FILTER_ARENA_ALIGN) - (uintptr_t)memory;
+    if (skip > size) {
+        return FILTER_ARENA_ERROR_INVALID_PARAM;
+    }
+    arena->base = (unsigned char *)memory + skip;
+    arena->size = size - skip;
+
+    return FILTER_ARENA_ERROR_OK;
+}
+
+void *filter_arena_alloc_aligned(filter_arena_t *arena, size_t size, size_t align)
+{
+    if (!arena || align == 0 || align > FILTER_ARENA_ALIGN || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+
+    size_t offset = FILTER_ARENA_ALIGN_UP(arena->used, align);
+    arena->used = offset + size;
+    if (!arena->base || arena->used > arena->size || arena->used < offset) {
+        return NULL;
+    }
+
+    return arena->base + offset;
+}
+
+void *filter_arena_alloc(filter_arena_t *arena, size_t size)
+{
+    return filter_arena_alloc_aligned(arena, size, FILTER_ARENA_ALIGN);
+}
+
+size_t filter_arena_used(const filter_arena_t *arena)
+{
+    return arena ? arena->used : 0;
+}
+
+int filter_arena_valid(const filter_arena_t *arena)
+{
+    return (arena && arena->base && arena->used <= arena->size) ? 1 : 0;
+}
+
+void filter_arena_reset(filter_arena_t *arena)
+{
+    if (arena) {
+        arena->used = 0;
+    }
+}
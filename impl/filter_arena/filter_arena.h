@@ -0,0 +1,115 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_ARENA_H_
+#define FILTER_ARENA_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+#define FILTER_ARENA_ERROR_OK            0
+#define FILTER_ARENA_ERROR_INVALID_PARAM -1
+
+// Alignment of every block handed out by filter_arena_alloc(), one cache line on common targets. Blocks of two
+// arenas, or two blocks of one arena, then never share a line
+#ifndef FILTER_ARENA_ALIGN
+#define FILTER_ARENA_ALIGN 64
+#endif /* FILTER_ARENA_ALIGN */
+
+// Round size up to a multiple of align, a power of two
+#define FILTER_ARENA_ALIGN_UP(size, align) (((size) + (align) - 1) & ~(size_t)((align) - 1))
+
+// Bytes of a buffer with any alignment that holds an arena whose sizing pass used used bytes
+#define FILTER_ARENA_BUFFER_SIZE(used) ((used) + FILTER_ARENA_ALIGN - 1)
+
+/**
+  * @brief Bump allocator the filters and their state are carved from, it never calls malloc
+  * @note The buffer is provided by the caller, a static array on targets without a heap. Blocks are only released
+  *       all at once by filter_arena_reset().
+  *       An arena created without a buffer only counts: every allocation returns NULL and adds its size to used,
+  *       so running the same allocations once without and once with a buffer sizes the buffer exactly, see
+  *       filter_arena_used(). The same holds for an arena whose buffer is too small, used keeps growing past size.
+  */
+typedef struct
+{
+    unsigned char *base;
+    size_t         size;
+    size_t         used;
+} filter_arena_t;
+
+/**
+  * @brief Initialize the arena
+  * @param arena Pointer to the arena
+  * @param memory Pointer to the buffer, the arena starts at the first FILTER_ARENA_ALIGN boundary in it. NULL
+  *               creates an arena that only counts the bytes the allocations need
+  * @param size Size of the buffer in bytes, ignored without a buffer
+  * @return FILTER_ARENA_ERROR_OK on success, negative on error
+  */
+int filter_arena_init(filter_arena_t *arena, void *memory, size_t size);
+
+/**
+  * @brief Allocate a block aligned to FILTER_ARENA_ALIGN
+  * @param arena Pointer to the arena
+  * @param size Size of the block in bytes
+  * @return Pointer to the block, NULL if the arena has no buffer or the block does not fit
+  */
+void *filter_arena_alloc(filter_arena_t *arena, size_t size);
+
+/**
+  * @brief Allocate a block with a smaller alignment, for many small blocks that are only used by one thread
+  * @param arena Pointer to the arena
+  * @param size Size of the block in bytes
+  * @param align Alignment of the block, a power of two no larger than FILTER_ARENA_ALIGN
+  * @return Pointer to the block, NULL if the arena has no buffer, the block does not fit or align is invalid
+  */
+void *filter_arena_alloc_aligned(filter_arena_t *arena, size_t size, size_t align);
+
+/**
+  * @brief Get the bytes allocated so far, including blocks that did not fit
+  * @note After a pass without a buffer this is the size of a FILTER_ARENA_ALIGN aligned buffer that holds the
+  *       same allocations, FILTER_ARENA_BUFFER_SIZE(used) for a buffer with any alignment.
+  * @param arena Pointer to the arena
+  * @return Number of bytes
+  */
+size_t filter_arena_used(const filter_arena_t *arena);
+
+/**
+  * @brief Check that every allocation so far was placed in the buffer
+  * @param arena Pointer to the arena
+  * @return 1 if the arena has a buffer and nothing overflowed it, 0 otherwise
+  */
+int filter_arena_valid(const filter_arena_t *arena);
+
+/**
+  * @brief Release every block at once, the buffer is kept
+  * @param arena Pointer to the arena
+  */
+void filter_arena_reset(filter_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_ARENA_H_ */
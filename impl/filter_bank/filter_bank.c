@@ -0,0 +1,301 @@
+#include "filter_bank.h"
+#include <string.h>
+
+// Dispatch the FIR dot product through the kernel picked at init when SIMD is built in, the same way fir_filter_t does
+#if FILTER_SIMD_ENABLED
+#define FILTER_BANK_DOT(bank, b_coeffs, window, num_coeffs) ((bank)->dot((b_coeffs), (window), (num_coeffs)))
+#else
+#define FILTER_BANK_DOT(bank, b_coeffs, window, num_coeffs) filter_simd_dot_scalar((b_coeffs), (window), (num_coeffs))
+#endif /* FILTER_SIMD_ENABLED */
+
+size_t filter_bank_state_size(unsigned int type, unsigned int num_coeffs, unsigned int num_channels)
+{
+    size_t entries;
+    switch (type)
+    {
+    case FILTER_BANK_TYPE_FIR:
+        entries = FILTER_BANK_FIR_STATE_SIZE((size_t)num_coeffs, num_channels);
+        break;
+    case FILTER_BANK_TYPE_IIR:
+        entries = FILTER_BANK_IIR_STATE_SIZE((size_t)num_coeffs, num_channels);
+        break;
+    case FILTER_BANK_TYPE_IIR_BIQUAD_DF2T:
+        entries = FILTER_BANK_IIR_BIQUAD_DF2T_STATE_SIZE((size_t)num_coeffs, num_channels);
+        break;
+    default:
+        entries = FILTER_BANK_IIR_BIQUAD_STATE_SIZE((size_t)num_coeffs, num_channels);
+        break;
+    }
+
+    return sizeof(filter_accum_t) * entries;
+}
+
+static void filter_bank_setup(filter_bank_t *bank, unsigned int type, filter_accum_t *state, unsigned int num_coeffs,
+                              unsigned int num_channels)
+{
+    bank->type = type;
+    bank->state = state;
+    bank->num_coeffs = num_coeffs;
+    bank->num_channels = num_channels;
+    bank->count = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&bank->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+    bank->index = 0;
+    bank->normalized = 1;
+    bank->b_coeffs = NULL;
+    bank->a_coeffs = NULL;
+    bank->sos_coeffs = NULL;
+    bank->biquad = filter_simd_get_biquad();
+#if FILTER_SIMD_ENABLED
+    bank->dot = filter_simd_get_dot();
+#endif /* FILTER_SIMD_ENABLED */
+    memset(bank->state, 0, filter_bank_state_size(bank->type, bank->num_coeffs, bank->num_channels));
+}
+
+int filter_bank_init_fir(filter_bank_t *bank, filter_coeff_t *b_coeffs, filter_accum_t *state, unsigned int num_coeffs,
+                         unsigned int num_channels)
+{
+    if (!bank || !b_coeffs || !state || num_coeffs == 0 || num_channels == 0) {
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+
+    filter_bank_setup(bank, FILTER_BANK_TYPE_FIR, state, num_coeffs, num_channels);
+    bank->b_coeffs = b_coeffs;
+
+    return FILTER_BANK_ERROR_OK;
+}
+
+int filter_bank_init_iir(filter_bank_t *bank, filter_coeff_t *b_coeffs, filter_coeff_t *a_coeffs, filter_accum_t *state,
+                         unsigned int num_coeffs, unsigned int num_channels)
+{
+    if (!bank || !b_coeffs || !a_coeffs || !state || num_coeffs == 0 || num_channels == 0) {
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+
+    filter_bank_setup(bank, FILTER_BANK_TYPE_IIR, state, num_coeffs, num_channels);
+    bank->b_coeffs = b_coeffs;
+    bank->a_coeffs = a_coeffs;
+
+    return FILTER_BANK_ERROR_OK;
+}
+
+int filter_bank_init_iir_biquad(filter_bank_t *bank, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *state,
+                                unsigned int num_sections, unsigned int num_channels)
+{
+    if (!bank || !sos_coeffs || !state || num_sections == 0 || num_channels == 0) {
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+
+    filter_bank_setup(bank, FILTER_BANK_TYPE_IIR_BIQUAD, state, num_sections, num_channels);
+    bank->sos_coeffs = sos_coeffs;
+
+    return FILTER_BANK_ERROR_OK;
+}
+
+int filter_bank_init_iir_biquad_df2t(filter_bank_t *bank, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *state,
+                                     unsigned int num_sections, unsigned int num_channels)
+{
+    if (!bank || !sos_coeffs || !state || num_sections == 0 || num_channels == 0) {
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+
+    filter_bank_setup(bank, FILTER_BANK_TYPE_IIR_BIQUAD_DF2T, state, num_sections, num_channels);
+    bank->sos_coeffs = sos_coeffs;
+    for (unsigned int i = 0; i < num_sections; i++)
+    {
+        if (sos_coeffs[i][3] == 0) {
+            return FILTER_BANK_ERROR_INVALID_PARAM;
+        }
+        if (sos_coeffs[i][3] != FILTER_COEFF_ONE) {
+#if defined(FILTER_USE_INTEGER_MATH)
+            // The integer kernels never divide, a0 must be exactly one
+            return FILTER_BANK_ERROR_INVALID_PARAM;
+#else
+            bank->normalized = 0;
+#endif /* FILTER_USE_INTEGER_MATH */
+        }
+    }
+
+    return FILTER_BANK_ERROR_OK;
+}
+
+/**
+  * @brief FIR bank, each channel owns a mirrored delay line of 2 * num_coeffs entries, see fir_filter_init_mirrored()
+  * @note The channels run one after the other over the whole block. The window of a channel is then contiguous and
+  *       stays in cache, and the dot product is the kernel fir_filter_t uses, with the sums in registers.
+  */
+static void filter_bank_run_fir(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    const filter_coeff_t *b_coeffs = bank->b_coeffs;
+    const unsigned int    num_coeffs = bank->num_coeffs;
+    const unsigned int    num_channels = bank->num_channels;
+    unsigned int          index = bank->index;
+
+    for (unsigned int c = 0; c < num_channels; c++)
+    {
+        filter_accum_t *delay = bank->state + ((size_t)2 * num_coeffs * c);
+        index = bank->index;
+        for (size_t n = 0; n < num_frames; n++)
+        {
+            size_t         offset = (n * num_channels) + c;
+            filter_accum_t in = (filter_accum_t)input[offset];
+            index = (index == 0) ? (num_coeffs - 1) : (index - 1);
+            delay[index] = in;
+            delay[index + num_coeffs] = in;
+            output[offset] = (filter_data_t)filter_accum_rescale(FILTER_BANK_DOT(bank, b_coeffs, &delay[index], num_coeffs));
+        }
+    }
+
+    bank->index = index;
+}
+
+/**
+  * @brief IIR bank, rows [0, num_coeffs) are the previous inputs and rows [num_coeffs, 2 * num_coeffs) the previous outputs
+  */
+static void filter_bank_run_iir(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    const filter_coeff_t *b_coeffs = bank->b_coeffs;
+    const filter_coeff_t *a_coeffs = bank->a_coeffs;
+    const unsigned int    num_coeffs = bank->num_coeffs;
+    const unsigned int    num_channels = bank->num_channels;
+    const size_t          rows = (size_t)num_coeffs * num_channels;
+    filter_accum_t       *prev_inputs = bank->state;
+    filter_accum_t       *prev_outputs = bank->state + rows;
+    filter_accum_t       *acc = bank->state + (2 * rows);
+
+    for (size_t n = 0; n < num_frames; n++)
+    {
+        for (unsigned int c = 0; c < num_channels; c++)
+        {
+            acc[c] = FILTER_MUL(b_coeffs[0], (filter_accum_t)input[c]);
+        }
+        for (unsigned int i = 1; i <= num_coeffs; i++)
+        {
+            const filter_accum_t *in_row = prev_inputs + ((size_t)(i - 1) * num_channels);
+            const filter_accum_t *out_row = prev_outputs + ((size_t)(i - 1) * num_channels);
+            for (unsigned int c = 0; c < num_channels; c++)
+            {
+                acc[c] += FILTER_MUL(b_coeffs[i], in_row[c]) - FILTER_MUL(a_coeffs[i], out_row[c]);
+            }
+        }
+
+        // Shift the buffer contents, one move per delay line since the rows are contiguous
+        memmove(prev_inputs + num_channels, prev_inputs, sizeof(filter_accum_t) * (rows - num_channels));
+        memmove(prev_outputs + num_channels, prev_outputs, sizeof(filter_accum_t) * (rows - num_channels));
+        for (unsigned int c = 0; c < num_channels; c++)
+        {
+            filter_accum_t new_output = filter_accum_rescale(acc[c]);
+            prev_inputs[c] = (filter_accum_t)input[c];
+            prev_outputs[c] = new_output;
+            output[c] = (filter_data_t)new_output;
+        }
+
+        input += num_channels;
+        output += num_channels;
+    }
+}
+
+/**
+  * @brief DF2T biquad bank, rows 2 * i and 2 * i + 1 hold the two state words of section i and the last row
+  *        carries the output of the previous section across the channels
+  */
+static void filter_bank_run_iir_biquad_df2t(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    filter_coeff_t(*sos_coeffs)[6] = bank->sos_coeffs;
+    const unsigned int num_sections = bank->num_coeffs;
+    const unsigned int num_channels = bank->num_channels;
+    const int          normalized = bank->normalized;
+    filter_accum_t    *acc = bank->state + ((size_t)2 * num_sections * num_channels);
+
+    for (size_t n = 0; n < num_frames; n++)
+    {
+        for (unsigned int c = 0; c < num_channels; c++)
+        {
+            acc[c] = (filter_accum_t)input[c];
+        }
+        filter_accum_t *s1 = bank->state;
+        for (unsigned int i = 0; i < num_sections; i++)
+        {
+            filter_accum_t *s2 = s1 + num_channels;
+            for (unsigned int c = 0; c < num_channels; c++)
+            {
+                filter_accum_t in = acc[c];
+                filter_accum_t new_output = FILTER_MUL(sos_coeffs[i][0], in) + s1[c];
+                if (!normalized) {
+                    new_output /= sos_coeffs[i][3];
+                }
+                new_output = filter_accum_rescale(new_output);
+                s1[c] = FILTER_MUL(sos_coeffs[i][1], in) - FILTER_MUL(sos_coeffs[i][4], new_output) + s2[c];
+                s2[c] = FILTER_MUL(sos_coeffs[i][2], in) - FILTER_MUL(sos_coeffs[i][5], new_output);
+                acc[c] = new_output;
+            }
+            s1 += 2 * num_channels;
+        }
+        for (unsigned int c = 0; c < num_channels; c++)
+        {
+            output[c] = (filter_data_t)acc[c];
+        }
+
+        input += num_channels;
+        output += num_channels;
+    }
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief filter_bank_run() without the instrumentation
+  */
+static int filter_bank_run_kernel(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+#else
+int filter_bank_run(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!bank || !input || !output) {
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+
+    switch (bank->type)
+    {
+    case FILTER_BANK_TYPE_FIR:
+        filter_bank_run_fir(bank, input, output, num_frames);
+        return 0;
+    case FILTER_BANK_TYPE_IIR:
+        filter_bank_run_iir(bank, input, output, num_frames);
+        return (int)filter_warmup_advance(&bank->count, bank->num_coeffs, num_frames);
+    case FILTER_BANK_TYPE_IIR_BIQUAD:
+        bank->biquad(bank->sos_coeffs, bank->num_coeffs, bank->state, bank->num_channels, input, output, num_frames);
+        return (int)filter_warmup_advance(&bank->count, bank->num_coeffs * 4, num_frames);
+    case FILTER_BANK_TYPE_IIR_BIQUAD_DF2T:
+        filter_bank_run_iir_biquad_df2t(bank, input, output, num_frames);
+        return (int)filter_warmup_advance(&bank->count, bank->num_coeffs * 2, num_frames);
+    default:
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int filter_bank_run(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = filter_bank_run_kernel(bank, input, output, num_frames);
+    if (ret >= 0) {
+        filter_stats_end(&bank->stats, &mark, output, num_frames * bank->num_channels, ret * (int)bank->num_channels);
+    }
+    return ret;
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+int filter_bank_reset(filter_bank_t *bank)
+{
+    if (!bank || !bank->state) {
+        return FILTER_BANK_ERROR_INVALID_PARAM;
+    }
+
+    bank->count = 0;
+    bank->index = 0;
+    memset(bank->state, 0, filter_bank_state_size(bank->type, bank->num_coeffs, bank->num_channels));
+
+    return FILTER_BANK_ERROR_OK;
+}
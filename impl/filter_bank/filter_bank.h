@@ -0,0 +1,158 @@
+//MIT License
+//
+//Copyright (c) 2024 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_BANK_H_
+#define FILTER_BANK_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+#include "../filter_stats/filter_stats.h"
+#include "../filter_simd/filter_simd.h"
+
+#define FILTER_BANK_ERROR_OK             0
+#define FILTER_BANK_ERROR_INVALID_PARAM  -1
+#define FILTER_BANK_ERROR_INVALID_OUTPUT -2
+
+// Filter types a bank can run
+#define FILTER_BANK_TYPE_FIR             0
+#define FILTER_BANK_TYPE_IIR             1
+#define FILTER_BANK_TYPE_IIR_BIQUAD      2
+#define FILTER_BANK_TYPE_IIR_BIQUAD_DF2T 3
+
+// Number of filter_accum_t entries required for the state block of each bank type
+#define FILTER_BANK_FIR_STATE_SIZE(num_coeffs, num_channels)               (2 * (num_coeffs) * (num_channels))
+#define FILTER_BANK_IIR_STATE_SIZE(num_coeffs, num_channels)               (((2 * (num_coeffs)) + 1) * (num_channels))
+#define FILTER_BANK_IIR_BIQUAD_STATE_SIZE(num_sections, num_channels)      (4 * (num_sections) * (num_channels))
+#define FILTER_BANK_IIR_BIQUAD_DF2T_STATE_SIZE(num_sections, num_channels) (((2 * (num_sections)) + 1) * (num_channels))
+
+/**
+  * @brief Filter bank structure, runs one set of coefficients over several channels
+  * @note The IIR and biquad state blocks are structures of arrays, row k of the delay line holds entry k for every
+  *       channel next to each other so the inner loops run across channels. The FIR state block holds one mirrored
+  *       delay line per channel instead, so each window is contiguous for the SIMD dot product.
+  */
+typedef struct
+{
+    unsigned int          type;
+    unsigned int          num_channels;
+    unsigned int          num_coeffs;
+    unsigned int          count;
+    unsigned int          index;
+    unsigned int          normalized;
+    filter_coeff_t       *b_coeffs;
+    filter_coeff_t       *a_coeffs;
+    filter_coeff_t(*sos_coeffs)[6];
+    filter_accum_t       *state;
+    filter_simd_biquad_fn biquad;
+#if FILTER_SIMD_ENABLED
+    filter_simd_dot_fn    dot;
+#endif /* FILTER_SIMD_ENABLED */
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t  stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+} filter_bank_t;
+
+/**
+  * @brief Initialize an FIR filter bank
+  * @param bank Pointer to the bank
+  * @param b_coeffs Pointer to the numerator coefficients
+  * @param state Pointer to the state block, must hold FILTER_BANK_FIR_STATE_SIZE(num_coeffs, num_channels) entries
+  * @param num_coeffs The number of coefficients that need to be applied
+  * @param num_channels The number of channels in each frame
+  * @return FILTER_BANK_ERROR_OK on success, negative on error
+  */
+int filter_bank_init_fir(filter_bank_t *bank, filter_coeff_t *b_coeffs, filter_accum_t *state, unsigned int num_coeffs,
+                         unsigned int num_channels);
+
+/**
+  * @brief Initialize an IIR filter bank
+  * @param bank Pointer to the bank
+  * @param b_coeffs Pointer to the numerator coefficients
+  * @param a_coeffs Pointer to the denominator coefficients
+  * @param state Pointer to the state block, must hold FILTER_BANK_IIR_STATE_SIZE(num_coeffs, num_channels) entries
+  * @param num_coeffs The filter order, same meaning as for iir_filter_init
+  * @param num_channels The number of channels in each frame
+  * @return FILTER_BANK_ERROR_OK on success, negative on error
+  */
+int filter_bank_init_iir(filter_bank_t *bank, filter_coeff_t *b_coeffs, filter_coeff_t *a_coeffs, filter_accum_t *state,
+                         unsigned int num_coeffs, unsigned int num_channels);
+
+/**
+  * @brief Initialize an IIR biquad filter bank
+  * @param bank Pointer to the bank
+  * @param sos_coeffs Pointer to the second order section coefficients
+  * @param state Pointer to the state block, must hold FILTER_BANK_IIR_BIQUAD_STATE_SIZE(num_sections, num_channels) entries
+  * @param num_sections The number of second order sections
+  * @param num_channels The number of channels in each frame
+  * @return FILTER_BANK_ERROR_OK on success, negative on error
+  */
+int filter_bank_init_iir_biquad(filter_bank_t *bank, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *state,
+                                unsigned int num_sections, unsigned int num_channels);
+
+/**
+  * @brief Initialize a Direct Form II Transposed IIR biquad filter bank, see iir_biquad_filter_init_df2t
+  * @param bank Pointer to the bank
+  * @param sos_coeffs Pointer to the second order section coefficients
+  * @param state Pointer to the state block, must hold FILTER_BANK_IIR_BIQUAD_DF2T_STATE_SIZE(num_sections, num_channels) entries
+  * @param num_sections The number of second order sections
+  * @param num_channels The number of channels in each frame
+  * @return FILTER_BANK_ERROR_OK on success, negative on error
+  */
+int filter_bank_init_iir_biquad_df2t(filter_bank_t *bank, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *state,
+                                     unsigned int num_sections, unsigned int num_channels);
+
+/**
+  * @brief Get the size of the state block of a bank, see the FILTER_BANK_*_STATE_SIZE macros
+  * @param type One of the FILTER_BANK_TYPE_* types
+  * @param num_coeffs The number of coefficients, the filter order or the number of sections
+  * @param num_channels The number of channels in each frame
+  * @return Size in bytes
+  */
+size_t filter_bank_state_size(unsigned int type, unsigned int num_coeffs, unsigned int num_channels);
+
+/**
+  * @brief Run the bank over a block of interleaved frames
+  * @note Each channel produces exactly the output of the matching single channel IIR, biquad or FIR filter. The FIR
+  *       bank sums with the dot product kernel picked at init, as fir_filter_t does
+  * @param bank Pointer to the bank
+  * @param input Pointer to num_frames frames of num_channels interleaved values
+  * @param output Pointer to the interleaved output frames, may be the same buffer as input
+  * @param num_frames Number of frames to process
+  * @return Number of leading frames still inside the warm up window (0 when every frame is valid), negative on error
+  */
+int filter_bank_run(filter_bank_t *bank, const filter_data_t *input, filter_data_t *output, size_t num_frames);
+
+/**
+  * @brief Reset the state of every channel in the bank
+  * @param bank Pointer to the bank
+  * @return FILTER_BANK_ERROR_OK on success, negative on error
+  */
+int filter_bank_reset(filter_bank_t *bank);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_BANK_H_ */
@@ -0,0 +1,164 @@
+#include "filter_chain.h"
+
+// Adapters from the typed block functions to filter_chain_run_fn
+static int filter_chain_run_sma(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return sma_filter_run_block((sma_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_cic(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return cic_filter_run_block((cic_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_ema(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return ema_filter_run_block((ema_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_median(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return median_filter_run_block((median_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_hampel(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return hampel_filter_run_block((hampel_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_fir(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return fir_filter_run_block((fir_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_iir(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return iir_filter_run_block((iir_filter_t *)filter, input, output, num_samples);
+}
+
+static int filter_chain_run_iir_biquad(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    return iir_biquad_filter_run_block((iir_biquad_filter_t *)filter, input, output, num_samples);
+}
+
+int filter_chain_init(filter_chain_t *chain, filter_chain_stage_t *stages, unsigned int max_stages)
+{
+    if (!chain || !stages || max_stages == 0) {
+        return FILTER_CHAIN_ERROR_INVALID_PARAM;
+    }
+
+    chain->stages = stages;
+    chain->num_stages = 0;
+    chain->max_stages = max_stages;
+    chain->warm = 0;
+
+    return FILTER_CHAIN_ERROR_OK;
+}
+
+int filter_chain_add(filter_chain_t *chain, void *filter, filter_chain_run_fn run)
+{
+    if (!chain || !filter || !run) {
+        return FILTER_CHAIN_ERROR_INVALID_PARAM;
+    }
+    if (chain->num_stages == chain->max_stages) {
+        return FILTER_CHAIN_ERROR_FULL;
+    }
+
+    chain->stages[chain->num_stages].filter = filter;
+    chain->stages[chain->num_stages].run = run;
+    chain->num_stages++;
+
+    return FILTER_CHAIN_ERROR_OK;
+}
+
+int filter_chain_add_sma(filter_chain_t *chain, sma_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_sma);
+}
+
+int filter_chain_add_cic(filter_chain_t *chain, cic_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_cic);
+}
+
+int filter_chain_add_ema(filter_chain_t *chain, ema_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_ema);
+}
+
+int filter_chain_add_median(filter_chain_t *chain, median_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_median);
+}
+
+int filter_chain_add_hampel(filter_chain_t *chain, hampel_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_hampel);
+}
+
+int filter_chain_add_fir(filter_chain_t *chain, fir_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_fir);
+}
+
+int filter_chain_add_iir(filter_chain_t *chain, iir_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_iir);
+}
+
+int filter_chain_add_iir_biquad(filter_chain_t *chain, iir_biquad_filter_t *filter)
+{
+    return filter_chain_add(chain, filter, filter_chain_run_iir_biquad);
+}
+
+int filter_chain_run(filter_chain_t *chain, filter_data_t input, filter_data_t *output)
+{
+    int ret = filter_chain_run_block(chain, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? FILTER_CHAIN_ERROR_INVALID_OUTPUT : FILTER_CHAIN_ERROR_OK;
+}
+
+int filter_chain_run_block(filter_chain_t *chain, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    if (!chain || !input || !output || chain->num_stages == 0) {
+        return FILTER_CHAIN_ERROR_INVALID_PARAM;
+    }
+
+    const filter_chain_stage_t *stages = chain->stages;
+    const unsigned int          num_stages = chain->num_stages;
+    size_t                      invalid = 0;
+
+    for (size_t start = 0; start < num_samples; start += FILTER_CHAIN_BLOCK_SIZE)
+    {
+        size_t count = num_samples - start;
+        if (count > FILTER_CHAIN_BLOCK_SIZE) {
+            count = FILTER_CHAIN_BLOCK_SIZE;
+        }
+
+        // The first stage reads the input, every later stage works in place on the output
+        const filter_data_t *src = &input[start];
+        filter_data_t       *dst = &output[start];
+        size_t               block_invalid = 0;
+        for (unsigned int i = 0; i < num_stages; i++) {
+            int ret = stages[i].run(stages[i].filter, src, dst, count);
+            if (ret < 0) {
+                return ret;
+            }
+            if ((size_t)ret > block_invalid) {
+                block_invalid = (size_t)ret;
+            }
+            src = dst;
+        }
+
+        // Every warm up window is a prefix of the stream, once a block ends past all of them the chain is warm
+        if (!chain->warm) {
+            invalid += block_invalid;
+            chain->warm = (block_invalid < count);
+        }
+    }
+
+    return (int)invalid;
+}
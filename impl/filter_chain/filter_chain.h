@@ -0,0 +1,131 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_CHAIN_H_
+#define FILTER_CHAIN_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+#include "../sma_filter/sma_filter.h"
+#include "../cic_filter/cic_filter.h"
+#include "../ema_filter/ema_filter.h"
+#include "../median_filter/median_filter.h"
+#include "../fir_filter/fir_filter.h"
+#include "../iir_filter/iir_filter.h"
+
+#define FILTER_CHAIN_ERROR_OK             0
+#define FILTER_CHAIN_ERROR_INVALID_PARAM  -1
+#define FILTER_CHAIN_ERROR_INVALID_OUTPUT -2
+#define FILTER_CHAIN_ERROR_FULL           -3
+
+// Samples run through every stage before the next samples enter the first stage, small enough that the block stays
+// in the L1 cache between the stages
+#define FILTER_CHAIN_BLOCK_SIZE 256
+
+/**
+  * @brief Block function of a stage, the signature every *_run_block function shares
+  * @return Number of leading outputs still inside the warm up window, negative on error
+  */
+typedef int (*filter_chain_run_fn)(void *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief One stage of a chain, an initialized filter and the function that runs it
+  */
+typedef struct
+{
+    void               *filter;
+    filter_chain_run_fn run;
+} filter_chain_stage_t;
+
+/**
+  * @brief Runs one channel through a list of filters in order
+  * @note The block function of each stage is resolved when the stage is added, running the chain is a loop of
+  *       indirect calls with no per sample dispatch. Each block is split into FILTER_CHAIN_BLOCK_SIZE samples that
+  *       pass through every stage in place, so the intermediate results never leave the cache. The filters are
+  *       owned by the caller and must stay valid while the chain is used.
+  */
+typedef struct
+{
+    filter_chain_stage_t *stages;
+    unsigned int          num_stages;
+    unsigned int          max_stages;
+    int                   warm;
+} filter_chain_t;
+
+/**
+  * @brief Initialize an empty chain
+  * @param chain Pointer to the chain
+  * @param stages Pointer to max_stages stages
+  * @param max_stages Largest number of stages the chain can hold
+  * @return FILTER_CHAIN_ERROR_OK on success, negative on error
+  */
+int filter_chain_init(filter_chain_t *chain, filter_chain_stage_t *stages, unsigned int max_stages);
+
+/**
+  * @brief Append a stage
+  * @param chain Pointer to the chain
+  * @param filter Pointer to the initialized filter
+  * @param run Block function called with filter
+  * @return FILTER_CHAIN_ERROR_OK on success, FILTER_CHAIN_ERROR_FULL if every stage is taken, negative on error
+  */
+int filter_chain_add(filter_chain_t *chain, void *filter, filter_chain_run_fn run);
+
+/**
+  * @brief Append an initialized filter of one of the types in impl/, see filter_chain_add
+  */
+int filter_chain_add_sma(filter_chain_t *chain, sma_filter_t *filter);
+int filter_chain_add_cic(filter_chain_t *chain, cic_filter_t *filter);
+int filter_chain_add_ema(filter_chain_t *chain, ema_filter_t *filter);
+int filter_chain_add_median(filter_chain_t *chain, median_filter_t *filter);
+int filter_chain_add_hampel(filter_chain_t *chain, hampel_filter_t *filter);
+int filter_chain_add_fir(filter_chain_t *chain, fir_filter_t *filter);
+int filter_chain_add_iir(filter_chain_t *chain, iir_filter_t *filter);
+int filter_chain_add_iir_biquad(filter_chain_t *chain, iir_biquad_filter_t *filter);
+
+/**
+  * @brief Run the chain on the input value
+  * @param chain Pointer to the chain
+  * @param input Input value
+  * @param output Pointer to the output value
+  * @return FILTER_CHAIN_ERROR_OK on success, FILTER_CHAIN_ERROR_INVALID_OUTPUT while any stage is still inside its
+  *         warm up window, negative on error
+  */
+int filter_chain_run(filter_chain_t *chain, filter_data_t input, filter_data_t *output);
+
+/**
+  * @brief Run the chain over a block of input values
+  * @param chain Pointer to the chain
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs for which any stage was still inside its warm up window, negative on error
+  */
+int filter_chain_run_block(filter_chain_t *chain, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_CHAIN_H_ */
@@ -0,0 +1,732 @@
+#include "filter_design.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#define FILTER_DESIGN_PI        3.14159265358979323846
+
+// Poles or zeros of a design, band transforms double the prototype order and the pairing may add one more
+#define FILTER_DESIGN_MAX_ROOTS ((2 * FILTER_DESIGN_MAX_ORDER) + 1)
+
+// Bilinear transform sample rate, the cut offs are normalized to Nyquist = 1 as scipy.signal does
+#define FILTER_DESIGN_BILINEAR_FS 2.0
+
+/**
+  * @brief Complex number, the design runs in double precision whatever the math mode
+  */
+typedef struct
+{
+    double re;
+    double im;
+} filter_design_complex_t;
+
+/**
+  * @brief Zeros, poles and gain of a transfer function
+  */
+typedef struct
+{
+    filter_design_complex_t z[FILTER_DESIGN_MAX_ROOTS];
+    filter_design_complex_t p[FILTER_DESIGN_MAX_ROOTS];
+    unsigned int            num_zeros;
+    unsigned int            num_poles;
+    double                  k;
+} filter_design_zpk_t;
+
+static filter_design_complex_t filter_design_complex(double re, double im)
+{
+    filter_design_complex_t c = { re, im };
+    return c;
+}
+
+static filter_design_complex_t filter_design_add(filter_design_complex_t a, filter_design_complex_t b)
+{
+    return filter_design_complex(a.re + b.re, a.im + b.im);
+}
+
+static filter_design_complex_t filter_design_sub(filter_design_complex_t a, filter_design_complex_t b)
+{
+    return filter_design_complex(a.re - b.re, a.im - b.im);
+}
+
+static filter_design_complex_t filter_design_mul(filter_design_complex_t a, filter_design_complex_t b)
+{
+    return filter_design_complex((a.re * b.re) - (a.im * b.im), (a.re * b.im) + (a.im * b.re));
+}
+
+static filter_design_complex_t filter_design_scale(filter_design_complex_t a, double scale)
+{
+    return filter_design_complex(a.re * scale, a.im * scale);
+}
+
+/**
+  * @brief Divide with Smith's algorithm, it does not overflow for large operands
+  */
+static filter_design_complex_t filter_design_div(filter_design_complex_t a, filter_design_complex_t b)
+{
+    if (fabs(b.re) >= fabs(b.im)) {
+        double ratio = b.im / b.re;
+        double denom = b.re + (b.im * ratio);
+        return filter_design_complex((a.re + (a.im * ratio)) / denom, (a.im - (a.re * ratio)) / denom);
+    }
+    double ratio = b.re / b.im;
+    double denom = (b.re * ratio) + b.im;
+    return filter_design_complex(((a.re * ratio) + a.im) / denom, ((a.im * ratio) - a.re) / denom);
+}
+
+/**
+  * @brief Principal square root, the sign of a zero imaginary part picks the branch like csqrt
+  */
+static filter_design_complex_t filter_design_sqrt(filter_design_complex_t a)
+{
+    double r = hypot(a.re, a.im);
+    double re = sqrt((r + a.re) / 2.0);
+    double im = sqrt((r - a.re) / 2.0);
+    return filter_design_complex(re, copysign(im, a.im));
+}
+
+static double filter_design_abs(filter_design_complex_t a)
+{
+    return hypot(a.re, a.im);
+}
+
+/**
+  * @brief Product of (offset - root) over a set of roots, offset 0 gives the product of -root
+  */
+static filter_design_complex_t filter_design_prod(const filter_design_complex_t *roots, unsigned int count, double offset)
+{
+    filter_design_complex_t prod = filter_design_complex(1.0, 0.0);
+    for (unsigned int i = 0; i < count; i++) {
+        prod = filter_design_mul(prod, filter_design_sub(filter_design_complex(offset, 0.0), roots[i]));
+    }
+    return prod;
+}
+
+/**
+  * @brief Expand roots into the real coefficients of a monic polynomial, highest power first
+  */
+static void filter_design_poly(const filter_design_complex_t *roots, unsigned int count, double *coeffs)
+{
+    filter_design_complex_t poly[FILTER_DESIGN_MAX_ROOTS + 1];
+
+    poly[0] = filter_design_complex(1.0, 0.0);
+    for (unsigned int i = 0; i < count; i++) {
+        poly[i + 1] = filter_design_complex(0.0, 0.0);
+        for (unsigned int j = i + 1; j > 0; j--) {
+            poly[j] = filter_design_sub(poly[j], filter_design_mul(poly[j - 1], roots[i]));
+        }
+    }
+    for (unsigned int i = 0; i <= count; i++) {
+        coeffs[i] = poly[i].re;
+    }
+}
+
+/**
+  * @brief Analog low pass prototype with a cut off of 1 rad/s
+  */
+static int filter_design_prototype(const filter_design_spec_t *spec, filter_design_zpk_t *zpk)
+{
+    const unsigned int N = spec->order;
+
+    zpk->num_zeros = 0;
+    zpk->num_poles = N;
+    zpk->k = 1.0;
+    switch (spec->type)
+    {
+    case FILTER_DESIGN_TYPE_BUTTER:
+        for (unsigned int i = 0; i < N; i++) {
+            double theta = (FILTER_DESIGN_PI * ((2.0 * i) - N + 1.0)) / (2.0 * N);
+            zpk->p[i] = filter_design_complex(-cos(theta), -sin(theta));
+        }
+        break;
+    case FILTER_DESIGN_TYPE_CHEBY1: {
+        if (!(spec->ripple > 0.0)) {
+            return FILTER_DESIGN_ERROR_INVALID_PARAM;
+        }
+        double eps = sqrt(pow(10.0, 0.1 * spec->ripple) - 1.0);
+        double mu = asinh(1.0 / eps) / N;
+        for (unsigned int i = 0; i < N; i++) {
+            double theta = (FILTER_DESIGN_PI * ((2.0 * i) - N + 1.0)) / (2.0 * N);
+            zpk->p[i] = filter_design_complex(-sinh(mu) * cos(theta), -cosh(mu) * sin(theta));
+        }
+        zpk->k = filter_design_prod(zpk->p, N, 0.0).re;
+        if (N % 2 == 0) {
+            zpk->k /= sqrt(1.0 + (eps * eps));
+        }
+        break;
+    }
+    case FILTER_DESIGN_TYPE_CHEBY2: {
+        if (!(spec->attenuation > 0.0)) {
+            return FILTER_DESIGN_ERROR_INVALID_PARAM;
+        }
+        double de = 1.0 / sqrt(pow(10.0, 0.1 * spec->attenuation) - 1.0);
+        double mu = asinh(1.0 / de) / N;
+        for (unsigned int i = 0; i < N; i++) {
+            // An odd order has no zero for the middle pole, it sits at infinity
+            double m = (2.0 * i) - N + 1.0;
+            if (m != 0.0) {
+                zpk->z[zpk->num_zeros++] = filter_design_complex(0.0, 1.0 / sin((m * FILTER_DESIGN_PI) / (2.0 * N)));
+            }
+            double theta = (FILTER_DESIGN_PI * m) / (2.0 * N);
+            zpk->p[i] = filter_design_div(filter_design_complex(-1.0, 0.0),
+                                          filter_design_complex(sinh(mu) * cos(theta), cosh(mu) * sin(theta)));
+        }
+        zpk->k = filter_design_div(filter_design_prod(zpk->p, N, 0.0), filter_design_prod(zpk->z, zpk->num_zeros, 0.0)).re;
+        break;
+    }
+    default:
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+
+    return FILTER_DESIGN_ERROR_OK;
+}
+
+/**
+  * @brief Split each root r into r * scale / 2 +- sqrt((r * scale / 2)^2 - wo^2), all + roots first
+  */
+static void filter_design_split(filter_design_complex_t *roots, unsigned int count, double wo)
+{
+    for (unsigned int i = 0; i < count; i++) {
+        filter_design_complex_t root = roots[i];
+        filter_design_complex_t root_sq = filter_design_mul(root, root);
+        filter_design_complex_t offset = filter_design_sqrt(filter_design_sub(root_sq, filter_design_complex(wo * wo, 0.0)));
+        roots[i] = filter_design_add(root, offset);
+        roots[count + i] = filter_design_sub(root, offset);
+    }
+}
+
+/**
+  * @brief Move the prototype to the band and make it digital with the bilinear transform
+  */
+static int filter_design_digital(const filter_design_spec_t *spec, filter_design_zpk_t *zpk)
+{
+    const double nyquist = spec->sampling_rate / 2.0;
+    const int    two_edges = (spec->band == FILTER_DESIGN_BAND_BANDPASS || spec->band == FILTER_DESIGN_BAND_BANDSTOP);
+
+    if (spec->order == 0 || spec->order > FILTER_DESIGN_MAX_ORDER || !(nyquist > 0.0) || spec->band > FILTER_DESIGN_BAND_BANDSTOP ||
+        !(spec->start_cutoff > 0.0) || !(spec->start_cutoff < nyquist) ||
+        (two_edges && (!(spec->stop_cutoff > spec->start_cutoff) || !(spec->stop_cutoff < nyquist)))) {
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+    int ret = filter_design_prototype(spec, zpk);
+    if (ret != FILTER_DESIGN_ERROR_OK) {
+        return ret;
+    }
+
+    // Pre warp the cut offs so they land on the requested frequencies after the bilinear transform
+    const double fs2 = 2.0 * FILTER_DESIGN_BILINEAR_FS;
+    double       w1 = fs2 * tan((FILTER_DESIGN_PI * (spec->start_cutoff / nyquist)) / FILTER_DESIGN_BILINEAR_FS);
+    double       w2 = two_edges ? fs2 * tan((FILTER_DESIGN_PI * (spec->stop_cutoff / nyquist)) / FILTER_DESIGN_BILINEAR_FS) : 0.0;
+    unsigned int degree = zpk->num_poles - zpk->num_zeros;
+
+    switch (spec->band)
+    {
+    case FILTER_DESIGN_BAND_LOWPASS:
+        for (unsigned int i = 0; i < zpk->num_zeros; i++) {
+            zpk->z[i] = filter_design_scale(zpk->z[i], w1);
+        }
+        for (unsigned int i = 0; i < zpk->num_poles; i++) {
+            zpk->p[i] = filter_design_scale(zpk->p[i], w1);
+        }
+        zpk->k *= pow(w1, (double)degree);
+        break;
+    case FILTER_DESIGN_BAND_HIGHPASS: {
+        zpk->k *= filter_design_div(filter_design_prod(zpk->z, zpk->num_zeros, 0.0), filter_design_prod(zpk->p, zpk->num_poles, 0.0)).re;
+        for (unsigned int i = 0; i < zpk->num_zeros; i++) {
+            zpk->z[i] = filter_design_div(filter_design_complex(w1, 0.0), zpk->z[i]);
+        }
+        for (unsigned int i = 0; i < zpk->num_poles; i++) {
+            zpk->p[i] = filter_design_div(filter_design_complex(w1, 0.0), zpk->p[i]);
+        }
+        for (unsigned int i = 0; i < degree; i++) {
+            zpk->z[zpk->num_zeros++] = filter_design_complex(0.0, 0.0);
+        }
+        break;
+    }
+    case FILTER_DESIGN_BAND_BANDPASS: {
+        double bw = w2 - w1;
+        double wo = sqrt(w1 * w2);
+        for (unsigned int i = 0; i < zpk->num_zeros; i++) {
+            zpk->z[i] = filter_design_scale(zpk->z[i], bw / 2.0);
+        }
+        for (unsigned int i = 0; i < zpk->num_poles; i++) {
+            zpk->p[i] = filter_design_scale(zpk->p[i], bw / 2.0);
+        }
+        filter_design_split(zpk->z, zpk->num_zeros, wo);
+        filter_design_split(zpk->p, zpk->num_poles, wo);
+        zpk->num_zeros *= 2;
+        zpk->num_poles *= 2;
+        for (unsigned int i = 0; i < degree; i++) {
+            zpk->z[zpk->num_zeros++] = filter_design_complex(0.0, 0.0);
+        }
+        zpk->k *= pow(bw, (double)degree);
+        break;
+    }
+    default: {
+        double bw = w2 - w1;
+        double wo = sqrt(w1 * w2);
+        zpk->k *= filter_design_div(filter_design_prod(zpk->z, zpk->num_zeros, 0.0), filter_design_prod(zpk->p, zpk->num_poles, 0.0)).re;
+        for (unsigned int i = 0; i < zpk->num_zeros; i++) {
+            zpk->z[i] = filter_design_div(filter_design_complex(bw / 2.0, 0.0), zpk->z[i]);
+        }
+        for (unsigned int i = 0; i < zpk->num_poles; i++) {
+            zpk->p[i] = filter_design_div(filter_design_complex(bw / 2.0, 0.0), zpk->p[i]);
+        }
+        filter_design_split(zpk->z, zpk->num_zeros, wo);
+        filter_design_split(zpk->p, zpk->num_poles, wo);
+        zpk->num_zeros *= 2;
+        zpk->num_poles *= 2;
+        for (unsigned int i = 0; i < degree; i++) {
+            zpk->z[zpk->num_zeros++] = filter_design_complex(0.0, wo);
+        }
+        for (unsigned int i = 0; i < degree; i++) {
+            zpk->z[zpk->num_zeros++] = filter_design_complex(0.0, -wo);
+        }
+        break;
+    }
+    }
+
+    // Bilinear transform, the zeros at infinity land on z = -1
+    degree = zpk->num_poles - zpk->num_zeros;
+    zpk->k *= filter_design_div(filter_design_prod(zpk->z, zpk->num_zeros, fs2), filter_design_prod(zpk->p, zpk->num_poles, fs2)).re;
+    for (unsigned int i = 0; i < zpk->num_zeros; i++) {
+        zpk->z[i] = filter_design_div(filter_design_add(filter_design_complex(fs2, 0.0), zpk->z[i]),
+                                      filter_design_sub(filter_design_complex(fs2, 0.0), zpk->z[i]));
+    }
+    for (unsigned int i = 0; i < zpk->num_poles; i++) {
+        zpk->p[i] = filter_design_div(filter_design_add(filter_design_complex(fs2, 0.0), zpk->p[i]),
+                                      filter_design_sub(filter_design_complex(fs2, 0.0), zpk->p[i]));
+    }
+    for (unsigned int i = 0; i < degree; i++) {
+        zpk->z[zpk->num_zeros++] = filter_design_complex(-1.0, 0.0);
+    }
+
+    return FILTER_DESIGN_ERROR_OK;
+}
+
+/**
+  * @brief Stable insertion sort by real part, then by the magnitude of the imaginary part
+  * @param by_real Sort by the real part first, otherwise only by the magnitude of the imaginary part
+  */
+static void filter_design_sort(filter_design_complex_t *roots, unsigned int count, int by_real)
+{
+    for (unsigned int i = 1; i < count; i++) {
+        filter_design_complex_t root = roots[i];
+        unsigned int            j = i;
+        while (j > 0) {
+            const filter_design_complex_t *prev = &roots[j - 1];
+            int after = by_real && (prev->re != root.re) ? (prev->re > root.re) : (fabs(prev->im) > fabs(root.im));
+            if (!after) {
+                break;
+            }
+            roots[j] = roots[j - 1];
+            j--;
+        }
+        roots[j] = root;
+    }
+}
+
+/**
+  * @brief Keep one root of each complex conjugate pair, with a positive imaginary part, followed by the real roots
+  * @note The same ordering as scipy.signal's _cplxreal, roots within 100 eps of the real axis count as real
+  * @return Number of roots kept, negative if a complex root has no conjugate
+  */
+static int filter_design_cplxreal(filter_design_complex_t *roots, unsigned int count)
+{
+    filter_design_complex_t zp[FILTER_DESIGN_MAX_ROOTS];
+    filter_design_complex_t zn[FILTER_DESIGN_MAX_ROOTS];
+    filter_design_complex_t zr[FILTER_DESIGN_MAX_ROOTS];
+    unsigned int            num_zp = 0;
+    unsigned int            num_zn = 0;
+    unsigned int            num_zr = 0;
+    const double            tol = 100.0 * DBL_EPSILON;
+
+    filter_design_sort(roots, count, 1);
+    for (unsigned int i = 0; i < count; i++) {
+        if (fabs(roots[i].im) <= tol * filter_design_abs(roots[i])) {
+            zr[num_zr++] = filter_design_complex(roots[i].re, 0.0);
+        } else if (roots[i].im > 0.0) {
+            zp[num_zp++] = roots[i];
+        } else {
+            zn[num_zn++] = roots[i];
+        }
+    }
+    if (num_zp != num_zn) {
+        return -1;
+    }
+
+    // Pairs whose real parts only differ by rounding are matched by the size of their imaginary part
+    for (unsigned int start = 0; start < num_zp;) {
+        unsigned int stop = start;
+        while (stop + 1 < num_zp && (zp[stop + 1].re - zp[stop].re) <= tol * filter_design_abs(zp[stop])) {
+            stop++;
+        }
+        if (stop > start) {
+            filter_design_sort(&zp[start], stop - start + 1, 0);
+            filter_design_sort(&zn[start], stop - start + 1, 0);
+        }
+        start = stop + 1;
+    }
+
+    unsigned int num_roots = 0;
+    for (unsigned int i = 0; i < num_zp; i++) {
+        if (filter_design_abs(filter_design_sub(zp[i], filter_design_complex(zn[i].re, -zn[i].im))) > tol * filter_design_abs(zn[i])) {
+            return -1;
+        }
+        roots[num_roots++] = filter_design_complex((zp[i].re + zn[i].re) / 2.0, (zp[i].im - zn[i].im) / 2.0);
+    }
+    for (unsigned int i = 0; i < num_zr; i++) {
+        roots[num_roots++] = zr[i];
+    }
+
+    return (int)num_roots;
+}
+
+static void filter_design_remove(filter_design_complex_t *roots, unsigned int *count, unsigned int index)
+{
+    memmove(&roots[index], &roots[index + 1], sizeof(filter_design_complex_t) * (*count - index - 1));
+    (*count)--;
+}
+
+/**
+  * @brief Index of the root closest to the unit circle
+  * @param real_only Only consider real roots
+  * @return The index, count if there is none
+  */
+static unsigned int filter_design_worst(const filter_design_complex_t *roots, unsigned int count, int real_only)
+{
+    unsigned int worst = count;
+    double       distance = 0.0;
+    for (unsigned int i = 0; i < count; i++) {
+        double d = fabs(1.0 - filter_design_abs(roots[i]));
+        if ((!real_only || roots[i].im == 0.0) && (worst == count || d < distance)) {
+            worst = i;
+            distance = d;
+        }
+    }
+    return worst;
+}
+
+// Roots filter_design_nearest() may pick
+#define FILTER_DESIGN_PICK_ANY     0
+#define FILTER_DESIGN_PICK_REAL    1
+#define FILTER_DESIGN_PICK_COMPLEX 2
+
+/**
+  * @brief Index of the root nearest to a point
+  * @return The index, count if there is none of the requested kind
+  */
+static unsigned int filter_design_nearest(const filter_design_complex_t *roots, unsigned int count, filter_design_complex_t to, int pick)
+{
+    unsigned int nearest = count;
+    double       distance = 0.0;
+    for (unsigned int i = 0; i < count; i++) {
+        int is_real = (roots[i].im == 0.0);
+        if ((pick == FILTER_DESIGN_PICK_REAL && !is_real) || (pick == FILTER_DESIGN_PICK_COMPLEX && is_real)) {
+            continue;
+        }
+        double d = filter_design_abs(filter_design_sub(roots[i], to));
+        if (nearest == count || d < distance) {
+            nearest = i;
+            distance = d;
+        }
+    }
+    return nearest;
+}
+
+/**
+  * @brief Build one section from up to two zeros and two poles, shorter polynomials are right aligned
+  */
+static void filter_design_section(double *section, const filter_design_complex_t *z, unsigned int num_z,
+                                  const filter_design_complex_t *p, unsigned int num_p)
+{
+    double b[3];
+    double a[3];
+
+    memset(section, 0, sizeof(double) * 6);
+    filter_design_poly(z, num_z, b);
+    filter_design_poly(p, num_p, a);
+    for (unsigned int i = 0; i <= num_z; i++) {
+        section[(2 - num_z) + i] = b[i];
+    }
+    for (unsigned int i = 0; i <= num_p; i++) {
+        section[(5 - num_p) + i] = a[i];
+    }
+}
+
+static unsigned int filter_design_count_real(const filter_design_complex_t *roots, unsigned int count)
+{
+    unsigned int num_real = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        num_real += (roots[i].im == 0.0);
+    }
+    return num_real;
+}
+
+int filter_design_iir_sos(const filter_design_spec_t *spec, double (*sos)[6], unsigned int *num_sections)
+{
+    filter_design_zpk_t zpk;
+
+    if (!spec || !sos || !num_sections) {
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+    int ret = filter_design_digital(spec, &zpk);
+    if (ret != FILTER_DESIGN_ERROR_OK) {
+        return ret;
+    }
+
+    // The digital design has as many zeros as poles, an odd count gets a pole and a zero at the origin
+    const unsigned int n_sections = (zpk.num_poles + 1) / 2;
+    if (zpk.num_poles % 2 == 1) {
+        zpk.p[zpk.num_poles++] = filter_design_complex(0.0, 0.0);
+        zpk.z[zpk.num_zeros++] = filter_design_complex(0.0, 0.0);
+    }
+    int num_z = filter_design_cplxreal(zpk.z, zpk.num_zeros);
+    int num_p = filter_design_cplxreal(zpk.p, zpk.num_poles);
+    if (num_z < 0 || num_p < 0) {
+        return FILTER_DESIGN_ERROR_RANGE;
+    }
+    unsigned int nz = (unsigned int)num_z;
+    unsigned int np = (unsigned int)num_p;
+
+    // Pair the pole closest to the unit circle with its nearest zero, those sections go last
+    for (unsigned int s = n_sections; s-- > 0;) {
+        filter_design_complex_t zeros[2];
+        filter_design_complex_t poles[2];
+        unsigned int            index = filter_design_worst(zpk.p, np, 0);
+        filter_design_complex_t p1 = zpk.p[index];
+        filter_design_remove(zpk.p, &np, index);
+        poles[0] = p1;
+        poles[1] = filter_design_complex(p1.re, -p1.im);
+
+        if (p1.im == 0.0 && filter_design_count_real(zpk.p, np) == 0) {
+            // The last real pole, paired with a pole and a zero at the origin
+            index = filter_design_nearest(zpk.z, nz, p1, FILTER_DESIGN_PICK_REAL);
+            if (index == nz) {
+                return FILTER_DESIGN_ERROR_RANGE;
+            }
+            zeros[0] = zpk.z[index];
+            zeros[1] = filter_design_complex(0.0, 0.0);
+            poles[1] = filter_design_complex(0.0, 0.0);
+            filter_design_remove(zpk.z, &nz, index);
+            filter_design_section(sos[s], zeros, 2, poles, 2);
+        } else if (np + 1 == nz && p1.im != 0.0 && filter_design_count_real(zpk.p, np) == 1 &&
+                   filter_design_count_real(zpk.z, nz) == 1) {
+            // One real pole and one real zero are left, this pole has to take a complex zero
+            index = filter_design_nearest(zpk.z, nz, p1, FILTER_DESIGN_PICK_COMPLEX);
+            if (index == nz) {
+                return FILTER_DESIGN_ERROR_RANGE;
+            }
+            zeros[0] = zpk.z[index];
+            zeros[1] = filter_design_complex(zeros[0].re, -zeros[0].im);
+            filter_design_remove(zpk.z, &nz, index);
+            filter_design_section(sos[s], zeros, 2, poles, 2);
+        } else {
+            if (p1.im == 0.0) {
+                index = filter_design_worst(zpk.p, np, 1);
+                poles[1] = zpk.p[index];
+                filter_design_remove(zpk.p, &np, index);
+            }
+            if (nz == 0) {
+                filter_design_section(sos[s], zeros, 0, poles, 2);
+                continue;
+            }
+            index = filter_design_nearest(zpk.z, nz, p1, FILTER_DESIGN_PICK_ANY);
+            zeros[0] = zpk.z[index];
+            filter_design_remove(zpk.z, &nz, index);
+            if (zeros[0].im != 0.0) {
+                zeros[1] = filter_design_complex(zeros[0].re, -zeros[0].im);
+                filter_design_section(sos[s], zeros, 2, poles, 2);
+            } else if (nz > 0) {
+                index = filter_design_nearest(zpk.z, nz, p1, FILTER_DESIGN_PICK_REAL);
+                if (index == nz) {
+                    return FILTER_DESIGN_ERROR_RANGE;
+                }
+                zeros[1] = zpk.z[index];
+                filter_design_remove(zpk.z, &nz, index);
+                filter_design_section(sos[s], zeros, 2, poles, 2);
+            } else {
+                filter_design_section(sos[s], zeros, 1, poles, 2);
+            }
+        }
+    }
+
+    // The gain goes into the first section
+    for (unsigned int i = 0; i < 3; i++) {
+        sos[0][i] *= zpk.k;
+    }
+    *num_sections = n_sections;
+
+    return FILTER_DESIGN_ERROR_OK;
+}
+
+int filter_design_iir_ba(const filter_design_spec_t *spec, double *b_coeffs, double *a_coeffs)
+{
+    filter_design_zpk_t zpk;
+
+    if (!spec || !b_coeffs || !a_coeffs) {
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+    int ret = filter_design_digital(spec, &zpk);
+    if (ret != FILTER_DESIGN_ERROR_OK) {
+        return ret;
+    }
+
+    filter_design_poly(zpk.z, zpk.num_zeros, b_coeffs);
+    filter_design_poly(zpk.p, zpk.num_poles, a_coeffs);
+    for (unsigned int i = 0; i <= zpk.num_zeros; i++) {
+        b_coeffs[i] *= zpk.k;
+    }
+
+    return FILTER_DESIGN_ERROR_OK;
+}
+
+/**
+  * @brief Modified Bessel function of the first kind and order zero, from its power series
+  */
+static double filter_design_bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (unsigned int k = 1; k < 500; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * DBL_EPSILON) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/**
+  * @brief Symmetric window value of tap n of num_taps
+  * @param beta Kaiser window shape, a negative value selects window instead
+  */
+static double filter_design_window(unsigned int window, double beta, unsigned int n, unsigned int num_taps)
+{
+    if (num_taps == 1) {
+        return 1.0;
+    }
+
+    const double last = (double)(num_taps - 1);
+    if (beta >= 0.0) {
+        double alpha = last / 2.0;
+        double ratio = ((double)n - alpha) / alpha;
+        return filter_design_bessel_i0(beta * sqrt(1.0 - (ratio * ratio))) / filter_design_bessel_i0(beta);
+    }
+
+    // The cosine windows sum cos(k * x) over x from -pi to pi
+    double x = (n == num_taps - 1) ? FILTER_DESIGN_PI : -FILTER_DESIGN_PI + ((double)n * ((2.0 * FILTER_DESIGN_PI) / last));
+    switch (window)
+    {
+    case FILTER_DESIGN_WINDOW_HAMMING:
+        return 0.54 + (0.46 * cos(x));
+    case FILTER_DESIGN_WINDOW_HANN:
+        return 0.5 + (0.5 * cos(x));
+    case FILTER_DESIGN_WINDOW_BLACKMAN:
+        return 0.42 + (0.5 * cos(x)) + (0.08 * cos(2.0 * x));
+    case FILTER_DESIGN_WINDOW_BARTLETT:
+        return ((double)n <= last / 2.0) ? (2.0 * n) / last : 2.0 - ((2.0 * n) / last);
+    default:
+        return 1.0;
+    }
+}
+
+static double filter_design_sinc(double x)
+{
+    return (x == 0.0) ? 1.0 : sin(FILTER_DESIGN_PI * x) / (FILTER_DESIGN_PI * x);
+}
+
+int filter_design_fir(const filter_design_spec_t *spec, double *b_coeffs)
+{
+    if (!spec || !b_coeffs || spec->type != FILTER_DESIGN_TYPE_FIR || spec->order == 0 || spec->order > FILTER_DESIGN_MAX_TAPS ||
+        spec->band > FILTER_DESIGN_BAND_BANDSTOP || spec->window > FILTER_DESIGN_WINDOW_BOXCAR || spec->width < 0.0) {
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+
+    const unsigned int num_taps = spec->order;
+    const double       nyquist = spec->sampling_rate / 2.0;
+    const int          two_edges = (spec->band == FILTER_DESIGN_BAND_BANDPASS || spec->band == FILTER_DESIGN_BAND_BANDSTOP);
+    const int          pass_zero = (spec->band == FILTER_DESIGN_BAND_LOWPASS || spec->band == FILTER_DESIGN_BAND_BANDSTOP);
+    const int          pass_nyquist = (two_edges ? 0 : 1) ^ pass_zero;
+    if (!(nyquist > 0.0) || !(spec->start_cutoff > 0.0) || !(spec->start_cutoff < nyquist) ||
+        (two_edges && (!(spec->stop_cutoff > spec->start_cutoff) || !(spec->stop_cutoff < nyquist))) ||
+        (pass_nyquist && num_taps % 2 == 0)) {
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+
+    // Band edges normalized to Nyquist, in pairs of left and right edges of each pass band
+    double       edges[4];
+    unsigned int num_edges = 0;
+    if (pass_zero) {
+        edges[num_edges++] = 0.0;
+    }
+    edges[num_edges++] = spec->start_cutoff / nyquist;
+    if (two_edges) {
+        edges[num_edges++] = spec->stop_cutoff / nyquist;
+    }
+    if (pass_nyquist) {
+        edges[num_edges++] = 1.0;
+    }
+
+    // A transition width selects a Kaiser window sized for it
+    double beta = -1.0;
+    if (spec->width > 0.0) {
+        double atten = (2.285 * (num_taps - 1.0) * FILTER_DESIGN_PI * (spec->width / nyquist)) + 7.95;
+        if (atten > 50.0) {
+            beta = 0.1102 * (atten - 8.7);
+        } else if (atten > 21.0) {
+            beta = (0.5842 * pow(atten - 21.0, 0.4)) + (0.07886 * (atten - 21.0));
+        } else {
+            beta = 0.0;
+        }
+    }
+
+    // Scale to unity gain at DC, at Nyquist or at the center of the first pass band
+    double scale_frequency = (edges[0] == 0.0) ? 0.0 : (edges[1] == 1.0) ? 1.0 : 0.5 * (edges[0] + edges[1]);
+    double alpha = 0.5 * (num_taps - 1.0);
+    double sum = 0.0;
+    for (unsigned int i = 0; i < num_taps; i++) {
+        double m = (double)i - alpha;
+        double h = 0.0;
+        for (unsigned int e = 0; e < num_edges; e += 2) {
+            h += edges[e + 1] * filter_design_sinc(edges[e + 1] * m);
+            h -= edges[e] * filter_design_sinc(edges[e] * m);
+        }
+        h *= filter_design_window(spec->window, beta, i, num_taps);
+        b_coeffs[i] = h;
+        sum += h * cos(FILTER_DESIGN_PI * m * scale_frequency);
+    }
+    if (sum == 0.0) {
+        return FILTER_DESIGN_ERROR_RANGE;
+    }
+    for (unsigned int i = 0; i < num_taps; i++) {
+        b_coeffs[i] /= sum;
+    }
+
+    return FILTER_DESIGN_ERROR_OK;
+}
+
+int filter_design_to_coeffs(const double *values, filter_coeff_t *coeffs, size_t count)
+{
+    if (!values || !coeffs) {
+        return FILTER_DESIGN_ERROR_INVALID_PARAM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(values[i])) {
+            return FILTER_DESIGN_ERROR_RANGE;
+        }
+#if defined(FILTER_USE_INTEGER_MATH)
+        double scaled = nearbyint(values[i] * (double)FILTER_COEFF_ONE);
+        double limit = ldexp(1.0, (8 * (int)sizeof(filter_coeff_t)) - 1);
+        if (scaled >= limit || scaled < -limit) {
+            return FILTER_DESIGN_ERROR_RANGE;
+        }
+        coeffs[i] = (filter_coeff_t)scaled;
+#else
+        coeffs[i] = (filter_coeff_t)values[i];
+#endif /* FILTER_USE_INTEGER_MATH */
+    }
+
+    return FILTER_DESIGN_ERROR_OK;
+}
@@ -0,0 +1,137 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_DESIGN_H_
+#define FILTER_DESIGN_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+#define FILTER_DESIGN_ERROR_OK            0
+#define FILTER_DESIGN_ERROR_INVALID_PARAM -1
+#define FILTER_DESIGN_ERROR_RANGE         -2
+
+// Design methods, the IIR prototypes match scipy.signal butter, cheby1 and cheby2, FIR matches firwin
+#define FILTER_DESIGN_TYPE_BUTTER   0
+#define FILTER_DESIGN_TYPE_CHEBY1   1
+#define FILTER_DESIGN_TYPE_CHEBY2   2
+#define FILTER_DESIGN_TYPE_FIR      3
+
+// Bands
+#define FILTER_DESIGN_BAND_LOWPASS  0
+#define FILTER_DESIGN_BAND_HIGHPASS 1
+#define FILTER_DESIGN_BAND_BANDPASS 2
+#define FILTER_DESIGN_BAND_BANDSTOP 3
+
+// FIR windows, symmetric as in scipy.signal.get_window(..., fftbins=False)
+#define FILTER_DESIGN_WINDOW_HAMMING  0
+#define FILTER_DESIGN_WINDOW_HANN     1
+#define FILTER_DESIGN_WINDOW_BLACKMAN 2
+#define FILTER_DESIGN_WINDOW_BARTLETT 3
+#define FILTER_DESIGN_WINDOW_BOXCAR   4
+
+// Highest IIR prototype order, band pass and band stop designs have twice as many poles
+#define FILTER_DESIGN_MAX_ORDER     16
+
+// Most FIR taps
+#define FILTER_DESIGN_MAX_TAPS      4096
+
+// Number of poles of an IIR design, band pass and band stop designs double the prototype order
+#define FILTER_DESIGN_NUM_POLES(order, band) \
+    (((band) == FILTER_DESIGN_BAND_BANDPASS || (band) == FILTER_DESIGN_BAND_BANDSTOP) ? (2 * (order)) : (order))
+
+// Number of second order sections of an IIR design
+#define FILTER_DESIGN_NUM_SECTIONS(order, band) ((FILTER_DESIGN_NUM_POLES(order, band) + 1) / 2)
+
+// Number of b and of a coefficients of a direct form IIR design, b0 included
+#define FILTER_DESIGN_NUM_COEFFS(order, band) (FILTER_DESIGN_NUM_POLES(order, band) + 1)
+
+/**
+  * @brief Filter specification, the fields follow the keys of the filter_designer config files
+  */
+typedef struct
+{
+    unsigned int type;
+    unsigned int band;
+    unsigned int order;
+    unsigned int window;
+    double       sampling_rate;
+    double       start_cutoff;
+    double       stop_cutoff;
+    double       ripple;
+    double       attenuation;
+    double       width;
+} filter_design_spec_t;
+
+/**
+  * @brief Design an IIR filter as a cascade of second order sections
+  * @note The analog prototype is moved to the band with the zpk transforms, made digital with the bilinear transform
+  *       (cut offs pre warped) and paired into sections nearest pole to zero as scipy.signal.zpk2sos does, the
+  *       sections closest to the unit circle last and the gain in the first section. Every a0 is 1.
+  * @param spec Pointer to the specification, type one of the IIR types. order 1 to FILTER_DESIGN_MAX_ORDER,
+  *             start_cutoff (and stop_cutoff for band pass and band stop) in Hz below sampling_rate / 2. ripple
+  *             is the cheby1 pass band ripple and attenuation the cheby2 stop band attenuation, both in dB
+  * @param sos Pointer to FILTER_DESIGN_NUM_SECTIONS(order, band) sections, b0 b1 b2 a0 a1 a2 each
+  * @param num_sections Pointer to the number of sections written
+  * @return FILTER_DESIGN_ERROR_OK on success, negative on error
+  */
+int filter_design_iir_sos(const filter_design_spec_t *spec, double (*sos)[6], unsigned int *num_sections);
+
+/**
+  * @brief Design an IIR filter as one direct form transfer function, as scipy.signal with output='ba'
+  * @note High orders are numerically fragile in this form, prefer filter_design_iir_sos()
+  * @param spec Pointer to the specification, see filter_design_iir_sos()
+  * @param b_coeffs Pointer to FILTER_DESIGN_NUM_COEFFS(order, band) numerator coefficients
+  * @param a_coeffs Pointer to FILTER_DESIGN_NUM_COEFFS(order, band) denominator coefficients, a_coeffs[0] is 1
+  * @return FILTER_DESIGN_ERROR_OK on success, negative on error
+  */
+int filter_design_iir_ba(const filter_design_spec_t *spec, double *b_coeffs, double *a_coeffs);
+
+/**
+  * @brief Design a windowed sinc FIR filter, as scipy.signal.firwin
+  * @note A non zero width selects a Kaiser window with a transition band of width Hz instead of spec->window.
+  *       The response is scaled to unity gain at the center of the first pass band.
+  * @param spec Pointer to the specification, type FILTER_DESIGN_TYPE_FIR and order the number of taps, 1 to
+  *             FILTER_DESIGN_MAX_TAPS. High pass and band stop filters need an odd number of taps
+  * @param b_coeffs Pointer to order coefficients
+  * @return FILTER_DESIGN_ERROR_OK on success, negative on error
+  */
+int filter_design_fir(const filter_design_spec_t *spec, double *b_coeffs);
+
+/**
+  * @brief Convert designed coefficients to filter_coeff_t
+  * @note The integer builds round to nearest, ties to even, like the filter_designer tables
+  * @param values Pointer to the designed coefficients
+  * @param coeffs Pointer to count coefficients
+  * @param count Number of coefficients
+  * @return FILTER_DESIGN_ERROR_OK on success, FILTER_DESIGN_ERROR_RANGE if a value does not fit the coefficient format
+  */
+int filter_design_to_coeffs(const double *values, filter_coeff_t *coeffs, size_t count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_DESIGN_H_ */
@@ -0,0 +1,145 @@
+#include "filter_fft.h"
+#include <math.h>
+
+#define FILTER_FFT_PI 3.14159265358979323846
+
+int filter_fft_init(filter_fft_t *fft, unsigned int size, filter_fft_complex_t *twiddles)
+{
+    if (!fft || !twiddles || size < 4 || (size & (size - 1))) {
+        return FILTER_FFT_ERROR_INVALID_PARAM;
+    }
+
+    fft->size = size;
+    fft->twiddles = twiddles;
+
+    // twiddles[k] = exp(-2 * pi * i * k / size)
+    for (unsigned int k = 0; k < FILTER_FFT_TWIDDLE_SIZE(size); k++)
+    {
+        double angle = (-2.0 * FILTER_FFT_PI * (double)k) / (double)size;
+        twiddles[k].re = cos(angle);
+        twiddles[k].im = sin(angle);
+    }
+
+    return FILTER_FFT_ERROR_OK;
+}
+
+/**
+  * @brief In place complex radix-2 decimation in time transform of size / 2 points
+  */
+static void filter_fft_complex(const filter_fft_t *fft, filter_fft_complex_t *data)
+{
+    const unsigned int          n = fft->size / 2;
+    const filter_fft_complex_t *twiddles = fft->twiddles;
+
+    // Bit reversed permutation
+    for (unsigned int i = 1, j = 0; i < n; i++)
+    {
+        unsigned int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            filter_fft_complex_t swap = data[i];
+            data[i] = data[j];
+            data[j] = swap;
+        }
+    }
+
+    // Butterflies, a span of len points uses every (size / len)th entry of the twiddle table
+    for (unsigned int len = 2; len <= n; len <<= 1)
+    {
+        const unsigned int half = len / 2;
+        const unsigned int stride = fft->size / len;
+        for (unsigned int i = 0; i < n; i += len)
+        {
+            filter_fft_complex_t *a = &data[i];
+            filter_fft_complex_t *b = &data[i + half];
+            for (unsigned int k = 0; k < half; k++)
+            {
+                filter_fft_complex_t w = twiddles[k * stride];
+                double tr = (b[k].re * w.re) - (b[k].im * w.im);
+                double ti = (b[k].re * w.im) + (b[k].im * w.re);
+                b[k].re = a[k].re - tr;
+                b[k].im = a[k].im - ti;
+                a[k].re += tr;
+                a[k].im += ti;
+            }
+        }
+    }
+}
+
+void filter_fft_forward(const filter_fft_t *fft, const double *input, filter_fft_complex_t *output)
+{
+    const unsigned int          n = fft->size / 2;
+    const filter_fft_complex_t *twiddles = fft->twiddles;
+
+    // Pack the even samples as the real parts and the odd samples as the imaginary parts
+    for (unsigned int k = 0; k < n; k++)
+    {
+        output[k].re = input[2 * k];
+        output[k].im = input[(2 * k) + 1];
+    }
+    filter_fft_complex(fft, output);
+
+    // Split the packed spectrum Z into the spectra of the even (E) and odd (O) samples and combine them,
+    // X[k] = E[k] + W^k * O[k] and X[n - k] = conj(E[k] - W^k * O[k])
+    filter_fft_complex_t z0 = output[0];
+    output[0].re = z0.re + z0.im;
+    output[0].im = 0;
+    output[n].re = z0.re - z0.im;
+    output[n].im = 0;
+    for (unsigned int k = 1; k <= n / 2; k++)
+    {
+        filter_fft_complex_t zk = output[k];
+        filter_fft_complex_t znk = output[n - k];
+        filter_fft_complex_t w = twiddles[k];
+        double er = 0.5 * (zk.re + znk.re);
+        double ei = 0.5 * (zk.im - znk.im);
+        double odd_re = 0.5 * (zk.im + znk.im);
+        double odd_im = -0.5 * (zk.re - znk.re);
+        double tr = (w.re * odd_re) - (w.im * odd_im);
+        double ti = (w.re * odd_im) + (w.im * odd_re);
+        output[n - k].re = er - tr;
+        output[n - k].im = ti - ei;
+        output[k].re = er + tr;
+        output[k].im = ei + ti;
+    }
+}
+
+void filter_fft_inverse(const filter_fft_t *fft, filter_fft_complex_t *input, double *output)
+{
+    const unsigned int          n = fft->size / 2;
+    const filter_fft_complex_t *twiddles = fft->twiddles;
+
+    // Undo the split, Z[k] = E[k] + i * O[k] with E[k] = X[k] + conj(X[n - k]) and
+    // O[k] = (X[k] - conj(X[n - k])) * conj(W^k), both twice their true value. The packed spectrum is
+    // conjugated on the way so the forward transform computes the inverse.
+    for (unsigned int k = 0; k <= n / 2; k++)
+    {
+        filter_fft_complex_t xk = input[k];
+        filter_fft_complex_t xnk = input[n - k];
+        filter_fft_complex_t w = twiddles[k];
+        double er = xk.re + xnk.re;
+        double ei = xk.im - xnk.im;
+        double dr = xk.re - xnk.re;
+        double di = xk.im + xnk.im;
+        double odd_re = (dr * w.re) + (di * w.im);
+        double odd_im = (di * w.re) - (dr * w.im);
+        if (k != 0 && k != n - k) {
+            input[n - k].re = er + odd_im;
+            input[n - k].im = ei - odd_re;
+        }
+        input[k].re = er - odd_im;
+        input[k].im = -(ei + odd_re);
+    }
+    filter_fft_complex(fft, input);
+
+    // Conjugate back and unpack, the real parts are the even samples and the imaginary parts the odd samples
+    for (unsigned int k = 0; k < n; k++)
+    {
+        output[2 * k] = input[k].re;
+        output[(2 * k) + 1] = -input[k].im;
+    }
+}
@@ -0,0 +1,93 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_FFT_H_
+#define FILTER_FFT_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <stddef.h>
+
+#define FILTER_FFT_ERROR_OK            0
+#define FILTER_FFT_ERROR_INVALID_PARAM -1
+
+// Number of filter_fft_complex_t entries required for the twiddle table of a real FFT of size entries
+#define FILTER_FFT_TWIDDLE_SIZE(size)  ((size) / 2)
+
+// Number of filter_fft_complex_t bins in the spectrum of a real FFT of size entries
+#define FILTER_FFT_NUM_BINS(size)      (((size) / 2) + 1)
+
+/**
+  * @brief Complex value
+  */
+typedef struct
+{
+    double re;
+    double im;
+} filter_fft_complex_t;
+
+/**
+  * @brief Real FFT of a power of two size
+  * @note The real transform of size N runs as a complex radix-2 transform of size N / 2 on the even and odd
+  *       samples packed as real and imaginary parts, followed by a split pass. Every twiddle factor is taken
+  *       from one table of N / 2 entries computed at init.
+  */
+typedef struct
+{
+    unsigned int          size;
+    filter_fft_complex_t *twiddles;
+} filter_fft_t;
+
+/**
+  * @brief Initialize a real FFT
+  * @param fft Pointer to the FFT
+  * @param size Number of real samples, a power of two no smaller than 4
+  * @param twiddles Pointer to the twiddle table, must hold FILTER_FFT_TWIDDLE_SIZE(size) entries
+  * @return FILTER_FFT_ERROR_OK on success, negative on error
+  */
+int filter_fft_init(filter_fft_t *fft, unsigned int size, filter_fft_complex_t *twiddles);
+
+/**
+  * @brief Forward transform of size real samples
+  * @param fft Pointer to the FFT
+  * @param input Pointer to size real samples
+  * @param output Pointer to the spectrum, FILTER_FFT_NUM_BINS(size) bins from DC to Nyquist
+  */
+void filter_fft_forward(const filter_fft_t *fft, const double *input, filter_fft_complex_t *output);
+
+/**
+  * @brief Inverse transform back to size real samples
+  * @note The result is not normalized, it is size times the true inverse. The spectrum is used as scratch
+  *       space and is overwritten.
+  * @param fft Pointer to the FFT
+  * @param input Pointer to the spectrum, FILTER_FFT_NUM_BINS(size) bins from DC to Nyquist
+  * @param output Pointer to size real samples
+  */
+void filter_fft_inverse(const filter_fft_t *fft, filter_fft_complex_t *input, double *output);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_FFT_H_ */
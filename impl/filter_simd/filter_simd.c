@@ -0,0 +1,308 @@
+#include "filter_simd.h"
+
+#include <stdatomic.h>
+
+#if FILTER_SIMD_ENABLED
+#include <immintrin.h>
+
+// The biquad lane kernels must not contract a * b + c into a fused multiply-add, otherwise they are no
+// longer bit exact with the scalar kernel
+#if defined(__clang__)
+#define FILTER_SIMD_NO_CONTRACT
+#else
+#define FILTER_SIMD_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#endif /* __clang__ */
+#endif /* FILTER_SIMD_ENABLED */
+
+#if FILTER_SIMD_FTZ_ENABLED
+#include <xmmintrin.h>
+
+// Flush to zero and denormals are zero bits of MXCSR
+#define FILTER_SIMD_MXCSR_FTZ 0x8000u
+#define FILTER_SIMD_MXCSR_DAZ 0x0040u
+#endif /* FILTER_SIMD_FTZ_ENABLED */
+
+#define FILTER_SIMD_UNRESOLVED 0xFFFFFFFFu
+
+// Resolved on first use by whichever thread initializes a filter first, every thread detects the same level so a
+// relaxed atomic is enough to make the race benign
+static _Atomic unsigned int filter_simd_level = FILTER_SIMD_UNRESOLVED;
+
+static filter_accum_t filter_simd_dot_generic(const filter_coeff_t *b_coeffs, const filter_accum_t *window, unsigned int num_coeffs)
+{
+    return filter_simd_dot_scalar(b_coeffs, window, num_coeffs);
+}
+
+/**
+  * @brief Run the scalar biquad on channels [first, num_channels) of a structure of arrays layout
+  */
+static void filter_simd_biquad_span(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, filter_accum_t *delay_elements,
+                                    unsigned int num_channels, unsigned int first, const filter_data_t *input,
+                                    filter_data_t *output, size_t num_frames)
+{
+    for (size_t n = 0; n < num_frames; n++)
+    {
+        for (unsigned int c = first; c < num_channels; c++)
+        {
+            filter_accum_t  new_output = (filter_accum_t)input[(n * num_channels) + c];
+            filter_accum_t *delay = delay_elements + c;
+            for (unsigned int i = 0; i < num_sections; i++)
+            {
+                // Same equation and evaluation order as iir_biquad_filter_run_block
+                filter_accum_t w0 = FILTER_MUL(sos_coeffs[i][0], new_output) +
+                                    FILTER_MUL(sos_coeffs[i][1], delay[0]) +
+                                    FILTER_MUL(sos_coeffs[i][2], delay[num_channels]);
+                filter_accum_t w1 = FILTER_MUL(sos_coeffs[i][4], delay[2 * num_channels]) +
+                                    FILTER_MUL(sos_coeffs[i][5], delay[3 * num_channels]);
+
+                // Move the delay terms up
+                delay[num_channels] = delay[0];
+                delay[0] = new_output;
+                delay[3 * num_channels] = delay[2 * num_channels];
+
+                // Set the output
+                new_output = filter_accum_rescale(w0 - w1);
+                delay[2 * num_channels] = new_output;
+                delay += 4 * num_channels;
+            }
+            output[(n * num_channels) + c] = (filter_data_t)new_output;
+        }
+    }
+}
+
+void filter_simd_biquad_scalar(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, filter_accum_t *delay_elements,
+                               unsigned int num_channels, const filter_data_t *input, filter_data_t *output, size_t num_frames)
+{
+    filter_simd_biquad_span(sos_coeffs, num_sections, delay_elements, num_channels, 0, input, output, num_frames);
+}
+
+#if FILTER_SIMD_ENABLED
+__attribute__((target("sse2")))
+static filter_accum_t filter_simd_dot_sse2(const filter_coeff_t *b_coeffs, const filter_accum_t *window, unsigned int num_coeffs)
+{
+    __m128d      acc0 = _mm_setzero_pd();
+    __m128d      acc1 = _mm_setzero_pd();
+    unsigned int i = 0;
+    for (; i + 4 <= num_coeffs; i += 4)
+    {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(b_coeffs + i), _mm_loadu_pd(window + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(b_coeffs + i + 2), _mm_loadu_pd(window + i + 2)));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc0);
+    filter_accum_t acc = lanes[0] + lanes[1];
+    for (; i < num_coeffs; i++)
+    {
+        acc += (b_coeffs[i] * window[i]);
+    }
+
+    return acc;
+}
+
+__attribute__((target("avx2,fma")))
+static filter_accum_t filter_simd_dot_avx2(const filter_coeff_t *b_coeffs, const filter_accum_t *window, unsigned int num_coeffs)
+{
+    __m256d      acc0 = _mm256_setzero_pd();
+    __m256d      acc1 = _mm256_setzero_pd();
+    unsigned int i = 0;
+    for (; i + 8 <= num_coeffs; i += 8)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(b_coeffs + i), _mm256_loadu_pd(window + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(b_coeffs + i + 4), _mm256_loadu_pd(window + i + 4), acc1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    double  lanes[2];
+    _mm_storeu_pd(lanes, half);
+    filter_accum_t acc = lanes[0] + lanes[1];
+    for (; i < num_coeffs; i++)
+    {
+        acc += (b_coeffs[i] * window[i]);
+    }
+
+    return acc;
+}
+
+__attribute__((target("avx512f")))
+static filter_accum_t filter_simd_dot_avx512(const filter_coeff_t *b_coeffs, const filter_accum_t *window, unsigned int num_coeffs)
+{
+    __m512d      acc0 = _mm512_setzero_pd();
+    __m512d      acc1 = _mm512_setzero_pd();
+    unsigned int i = 0;
+    for (; i + 16 <= num_coeffs; i += 16)
+    {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(b_coeffs + i), _mm512_loadu_pd(window + i), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(b_coeffs + i + 8), _mm512_loadu_pd(window + i + 8), acc1);
+    }
+    if (i + 8 <= num_coeffs) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(b_coeffs + i), _mm512_loadu_pd(window + i), acc0);
+        i += 8;
+    }
+    acc0 = _mm512_add_pd(acc0, acc1);
+
+    filter_accum_t acc = _mm512_reduce_add_pd(acc0);
+    for (; i < num_coeffs; i++)
+    {
+        acc += (b_coeffs[i] * window[i]);
+    }
+
+    return acc;
+}
+
+// Each lane kernel processes a group of adjacent channels for the whole block, the channels that do not
+// fill a full vector are handed to the scalar kernel with the same structure of arrays layout.
+#define FILTER_SIMD_BIQUAD_LANES(name, target_isa, width, vec_t, load_data, store_data, load, store, set1, mul, add, sub) \
+    __attribute__((target(target_isa))) FILTER_SIMD_NO_CONTRACT \
+    static void name(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, filter_accum_t *delay_elements, \
+                     unsigned int num_channels, const filter_data_t *input, filter_data_t *output, size_t num_frames) \
+    { \
+        unsigned int c = 0; \
+        for (; c + (width) <= num_channels; c += (width)) \
+        { \
+            for (size_t n = 0; n < num_frames; n++) \
+            { \
+                vec_t           new_output = load_data(input + (n * num_channels) + c); \
+                filter_accum_t *delay = delay_elements + c; \
+                for (unsigned int i = 0; i < num_sections; i++) \
+                { \
+                    vec_t d0 = load(delay); \
+                    vec_t d1 = load(delay + num_channels); \
+                    vec_t d2 = load(delay + (2 * num_channels)); \
+                    vec_t d3 = load(delay + (3 * num_channels)); \
+                    vec_t w0 = add(add(mul(set1(sos_coeffs[i][0]), new_output), mul(set1(sos_coeffs[i][1]), d0)), \
+                                   mul(set1(sos_coeffs[i][2]), d1)); \
+                    vec_t w1 = add(mul(set1(sos_coeffs[i][4]), d2), mul(set1(sos_coeffs[i][5]), d3)); \
+                    store(delay + num_channels, d0); \
+                    store(delay, new_output); \
+                    store(delay + (3 * num_channels), d2); \
+                    new_output = sub(w0, w1); \
+                    store(delay + (2 * num_channels), new_output); \
+                    delay += 4 * num_channels; \
+                } \
+                store_data(output + (n * num_channels) + c, new_output); \
+            } \
+        } \
+        if (c < num_channels) { \
+            filter_simd_biquad_span(sos_coeffs, num_sections, delay_elements, num_channels, c, input, output, num_frames); \
+        } \
+    }
+
+// Float to double lane conversions for each vector width
+#define FILTER_SIMD_LOAD2(p)     _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)(p))))
+#define FILTER_SIMD_STORE2(p, v) _mm_storel_pi((__m64 *)(p), _mm_cvtpd_ps(v))
+#define FILTER_SIMD_LOAD4(p)     _mm256_cvtps_pd(_mm_loadu_ps(p))
+#define FILTER_SIMD_STORE4(p, v) _mm_storeu_ps((p), _mm256_cvtpd_ps(v))
+#define FILTER_SIMD_LOAD8(p)     _mm512_cvtps_pd(_mm256_loadu_ps(p))
+#define FILTER_SIMD_STORE8(p, v) _mm256_storeu_ps((p), _mm512_cvtpd_ps(v))
+
+FILTER_SIMD_BIQUAD_LANES(filter_simd_biquad_sse2, "sse2", 2, __m128d, FILTER_SIMD_LOAD2, FILTER_SIMD_STORE2,
+                         _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_mul_pd, _mm_add_pd, _mm_sub_pd)
+FILTER_SIMD_BIQUAD_LANES(filter_simd_biquad_avx2, "avx2", 4, __m256d, FILTER_SIMD_LOAD4, FILTER_SIMD_STORE4,
+                         _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_mul_pd, _mm256_add_pd, _mm256_sub_pd)
+FILTER_SIMD_BIQUAD_LANES(filter_simd_biquad_avx512, "avx512f", 8, __m512d, FILTER_SIMD_LOAD8, FILTER_SIMD_STORE8,
+                         _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_mul_pd, _mm512_add_pd, _mm512_sub_pd)
+#endif /* FILTER_SIMD_ENABLED */
+
+unsigned int filter_simd_detect(void)
+{
+#if FILTER_SIMD_ENABLED
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return FILTER_SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return FILTER_SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return FILTER_SIMD_SSE2;
+    }
+#endif /* FILTER_SIMD_ENABLED */
+
+    return FILTER_SIMD_SCALAR;
+}
+
+unsigned int filter_simd_set_level(unsigned int level)
+{
+    unsigned int supported = filter_simd_detect();
+    unsigned int resolved = (level < supported) ? level : supported;
+    atomic_store_explicit(&filter_simd_level, resolved, memory_order_relaxed);
+
+    return resolved;
+}
+
+unsigned int filter_simd_get_level(void)
+{
+    unsigned int level = atomic_load_explicit(&filter_simd_level, memory_order_relaxed);
+    if (level == FILTER_SIMD_UNRESOLVED) {
+        level = filter_simd_detect();
+        atomic_store_explicit(&filter_simd_level, level, memory_order_relaxed);
+    }
+
+    return level;
+}
+
+filter_simd_dot_fn filter_simd_get_dot(void)
+{
+    switch (filter_simd_get_level())
+    {
+#if FILTER_SIMD_ENABLED
+    case FILTER_SIMD_AVX512:
+        return filter_simd_dot_avx512;
+    case FILTER_SIMD_AVX2:
+        return filter_simd_dot_avx2;
+    case FILTER_SIMD_SSE2:
+        return filter_simd_dot_sse2;
+#endif /* FILTER_SIMD_ENABLED */
+    default:
+        return filter_simd_dot_generic;
+    }
+}
+
+filter_simd_biquad_fn filter_simd_get_biquad(void)
+{
+    switch (filter_simd_get_level())
+    {
+#if FILTER_SIMD_ENABLED
+    case FILTER_SIMD_AVX512:
+        return filter_simd_biquad_avx512;
+    case FILTER_SIMD_AVX2:
+        return filter_simd_biquad_avx2;
+    case FILTER_SIMD_SSE2:
+        return filter_simd_biquad_sse2;
+#endif /* FILTER_SIMD_ENABLED */
+    default:
+        return filter_simd_biquad_scalar;
+    }
+}
+
+int filter_simd_ftz_enter(filter_simd_ftz_scope_t *scope)
+{
+    if (!scope) {
+        return 0;
+    }
+
+#if FILTER_SIMD_FTZ_ENABLED
+    scope->control = _mm_getcsr();
+    scope->active = 1;
+    _mm_setcsr(scope->control | FILTER_SIMD_MXCSR_FTZ | FILTER_SIMD_MXCSR_DAZ);
+#else
+    scope->control = 0;
+    scope->active = 0;
+#endif /* FILTER_SIMD_FTZ_ENABLED */
+
+    return (int)scope->active;
+}
+
+void filter_simd_ftz_exit(const filter_simd_ftz_scope_t *scope)
+{
+#if FILTER_SIMD_FTZ_ENABLED
+    if (scope && scope->active) {
+        _mm_setcsr(scope->control);
+    }
+#else
+    (void)scope;
+#endif /* FILTER_SIMD_FTZ_ENABLED */
+}
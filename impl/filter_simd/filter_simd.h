@@ -0,0 +1,167 @@
+//MIT License
+//
+//Copyright (c) 2024 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_SIMD_H_
+#define FILTER_SIMD_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+// SIMD kernels are only built for the floating point math build on x86 with a GCC compatible compiler.
+// Define FILTER_DISABLE_SIMD at compile time to force the portable scalar kernels everywhere.
+#if defined(FILTER_USE_FLOAT_MATH) && !defined(FILTER_DISABLE_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define FILTER_SIMD_ENABLED 1
+#else
+#define FILTER_SIMD_ENABLED 0
+#endif /* FILTER_USE_FLOAT_MATH */
+
+// Flush to zero and denormals are zero are bits of the SSE control register, which holds for every double operation
+// of the floating point math build on x86-64 whether or not the SIMD kernels are built. Elsewhere the FTZ scope does
+// nothing, the integer builds have no subnormal values
+#if defined(FILTER_USE_FLOAT_MATH) && defined(__GNUC__) && (defined(__x86_64__) || defined(__SSE2_MATH__))
+#define FILTER_SIMD_FTZ_ENABLED 1
+#else
+#define FILTER_SIMD_FTZ_ENABLED 0
+#endif /* FILTER_USE_FLOAT_MATH */
+
+// Kernel levels, ordered from least to most capable
+#define FILTER_SIMD_SCALAR 0
+#define FILTER_SIMD_SSE2   1
+#define FILTER_SIMD_AVX2   2
+#define FILTER_SIMD_AVX512 3
+
+// The vector FIR kernels split the tap sum across lanes and the AVX2 and AVX-512 kernels fuse each multiply
+// and add, so their rounding differs from the scalar kernel. Any order of the sum, fused or not, is within
+// num_coeffs * DBL_EPSILON / 2 * sum(|b[i] * x[i]|) of the exact result, so two kernels never differ by more
+// than FILTER_SIMD_FIR_ULP_TOLERANCE * num_coeffs * DBL_EPSILON * sum(|b[i] * x[i]|). The bound is relative
+// to the sum of the magnitudes, not to the output: when the products cancel the outputs can differ in many of
+// their own ULPs, also after rounding to a float filter_data_t. The biquad lane kernels perform the scalar
+// operations in the same order and without fused multiply-add, so they are bit exact with the scalar kernel.
+// make -C bench test checks every level the CPU supports against both.
+#define FILTER_SIMD_FIR_ULP_TOLERANCE 2
+
+/**
+  * @brief FIR dot product kernel, window[0] holds the newest input
+  */
+typedef filter_accum_t (*filter_simd_dot_fn)(const filter_coeff_t *b_coeffs, const filter_accum_t *window, unsigned int num_coeffs);
+
+/**
+  * @brief Multi channel Direct Form I biquad kernel
+  * @note delay_elements is laid out as a structure of arrays, entry k of section s for channel c lives
+  *       at delay_elements[(s * 4 + k) * num_channels + c]. Input and output are interleaved frames of
+  *       num_channels values.
+  */
+typedef void (*filter_simd_biquad_fn)(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, filter_accum_t *delay_elements,
+                                      unsigned int num_channels, const filter_data_t *input, filter_data_t *output, size_t num_frames);
+
+/**
+  * @brief Portable scalar FIR dot product, this is the reference the vector kernels are checked against
+  * @param b_coeffs Pointer to the coefficients
+  * @param window Pointer to the newest num_coeffs inputs, newest first
+  * @param num_coeffs Number of coefficients
+  * @return The filter output before filter_accum_rescale and conversion to filter_data_t
+  */
+static inline filter_accum_t filter_simd_dot_scalar(const filter_coeff_t *b_coeffs, const filter_accum_t *window, unsigned int num_coeffs)
+{
+    filter_accum_t acc = FILTER_MUL(b_coeffs[0], window[0]);
+    for (unsigned int i = 1; i < num_coeffs; i++)
+    {
+        acc += FILTER_MUL(b_coeffs[i], window[i]);
+    }
+
+    return acc;
+}
+
+/**
+  * @brief Portable scalar multi channel biquad kernel, see filter_simd_biquad_fn for the layout
+  */
+void filter_simd_biquad_scalar(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, filter_accum_t *delay_elements,
+                               unsigned int num_channels, const filter_data_t *input, filter_data_t *output, size_t num_frames);
+
+/**
+  * @brief Query the best kernel level supported by this CPU
+  * @return One of the FILTER_SIMD_* levels, FILTER_SIMD_SCALAR when SIMD is not built in
+  */
+unsigned int filter_simd_detect(void);
+
+/**
+  * @brief Cap the kernel level picked up by filters initialized after this call
+  * @param level One of the FILTER_SIMD_* levels, clamped to what the CPU supports
+  * @return The level that will actually be used
+  */
+unsigned int filter_simd_set_level(unsigned int level);
+
+/**
+  * @brief Get the kernel level filters will be initialized with
+  * @return One of the FILTER_SIMD_* levels
+  */
+unsigned int filter_simd_get_level(void);
+
+/**
+  * @brief Get the FIR dot product kernel for the current level
+  * @return Pointer to the kernel, never NULL
+  */
+filter_simd_dot_fn filter_simd_get_dot(void);
+
+/**
+  * @brief Get the multi channel biquad kernel for the current level
+  * @return Pointer to the kernel, never NULL
+  */
+filter_simd_biquad_fn filter_simd_get_biquad(void);
+
+/**
+  * @brief Control register of the calling thread saved by filter_simd_ftz_enter()
+  */
+typedef struct
+{
+    unsigned int control;
+    unsigned int active;
+} filter_simd_ftz_scope_t;
+
+/**
+  * @brief Flush subnormal results and operands to zero on the calling thread until filter_simd_ftz_exit()
+  * @note A decaying IIR tail that reaches the subnormal range, below 2.2e-308 in double, costs ten to a hundred times
+  *       more per operation on x86, and a DF1 biquad can keep cycling on the smallest subnormal forever once its
+  *       input goes quiet. Inside the scope those values read and compute as zero at full speed. Results that would
+  *       be subnormal become zero, nothing else changes. The setting belongs to the thread, enter the scope on every
+  *       thread that runs filters, e.g. around each block call or for the whole life of a worker. Scopes nest.
+  *       See iir_filter_set_flush_denormals() for a portable alternative that does not touch the control register.
+  * @param scope Pointer to the saved state, pass it to filter_simd_ftz_exit()
+  * @return 1 if flushing is on inside the scope, 0 where the build or target has no such control
+  */
+int filter_simd_ftz_enter(filter_simd_ftz_scope_t *scope);
+
+/**
+  * @brief Restore the control register saved by filter_simd_ftz_enter() on the same thread
+  * @param scope Pointer to the saved state
+  */
+void filter_simd_ftz_exit(const filter_simd_ftz_scope_t *scope);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_SIMD_H_ */
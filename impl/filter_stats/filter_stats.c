@@ -0,0 +1,102 @@
+#include "filter_stats.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define FILTER_STATS_HAVE_TSC 1
+#else
+#define FILTER_STATS_HAVE_TSC 0
+#endif /* __GNUC__ */
+
+#if FILTER_INSTRUMENTATION_ENABLED
+_Thread_local uint64_t filter_stats_saturated;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+static filter_stats_clock_fn filter_stats_clock_hook;
+
+void filter_stats_reset(filter_stats_t *stats)
+{
+    if (stats) {
+        memset(stats, 0, sizeof(filter_stats_t));
+    }
+}
+
+void filter_stats_merge(filter_stats_t *total, const filter_stats_t *stats)
+{
+    if (!total || !stats) {
+        return;
+    }
+
+    // Either side may not have seen a finite output yet, its min and max are then meaningless
+    if (stats->num_samples > stats->num_non_finite) {
+        if (total->num_samples == total->num_non_finite) {
+            total->min = stats->min;
+            total->max = stats->max;
+        } else {
+            total->min = (stats->min < total->min) ? stats->min : total->min;
+            total->max = (stats->max > total->max) ? stats->max : total->max;
+        }
+    }
+    total->num_calls += stats->num_calls;
+    total->num_samples += stats->num_samples;
+    total->num_warmup += stats->num_warmup;
+    total->num_saturated += stats->num_saturated;
+    total->num_non_finite += stats->num_non_finite;
+    total->cycles += stats->cycles;
+}
+
+void filter_stats_set_clock(filter_stats_clock_fn clock)
+{
+    filter_stats_clock_hook = clock;
+}
+
+uint64_t filter_stats_clock(void)
+{
+    if (filter_stats_clock_hook) {
+        return filter_stats_clock_hook();
+    }
+#if FILTER_STATS_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif /* FILTER_STATS_HAVE_TSC */
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+void filter_stats_end(filter_stats_t *stats, const filter_stats_mark_t *mark, const filter_data_t *output, size_t num_samples, int ret)
+{
+    uint64_t now = filter_stats_clock();
+    if (!stats || ret < 0) {
+        return;
+    }
+
+    // min and max start from the first finite output the filter sees
+    int           have_range = (stats->num_samples > stats->num_non_finite);
+    filter_data_t min = stats->min;
+    filter_data_t max = stats->max;
+    for (size_t n = 0; n < num_samples; n++) {
+        filter_data_t value = output[n];
+#if defined(FILTER_USE_FLOAT_MATH)
+        if (!isfinite(value)) {
+            stats->num_non_finite++;
+            continue;
+        }
+#endif /* FILTER_USE_FLOAT_MATH */
+        if (!have_range) {
+            min = value;
+            max = value;
+            have_range = 1;
+        }
+        min = (value < min) ? value : min;
+        max = (value > max) ? value : max;
+    }
+    stats->min = min;
+    stats->max = max;
+    stats->num_calls++;
+    stats->num_samples += num_samples;
+    stats->num_warmup += (uint64_t)ret;
+    stats->num_saturated += filter_stats_saturated - mark->saturated;
+    stats->cycles += now - mark->cycles;
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
@@ -0,0 +1,131 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FILTER_STATS_H_
+#define FILTER_STATS_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+// Instrumentation is opt in, define FILTER_ENABLE_INSTRUMENTATION at compile time to give fir_filter_t,
+// fir_fft_filter_t, fir_polyphase_filter_t, iir_filter_t, iir_biquad_filter_t, sma_filter_t and filter_bank_t a
+// filter_stats_t. Without it the filters carry no stats field and their block functions contain no instrumentation
+// code.
+#if defined(FILTER_ENABLE_INSTRUMENTATION)
+#define FILTER_INSTRUMENTATION_ENABLED 1
+#else
+#define FILTER_INSTRUMENTATION_ENABLED 0
+#endif /* FILTER_ENABLE_INSTRUMENTATION */
+
+/**
+  * @brief Clock the block functions are timed with, any monotonic counter
+  * @return The current count
+  */
+typedef uint64_t (*filter_stats_clock_fn)(void);
+
+/**
+  * @brief Counters of one filter, updated by every call of its block function
+  * @note num_samples counts every output value, a bank counts one value per channel and frame. num_warmup counts the
+  *       outputs reported inside the warm up window, the ones the per sample functions flag as INVALID_OUTPUT.
+  *       num_saturated counts the values the integer kernels clamped to the range of filter_data_t, see
+  *       filter_saturate(). num_non_finite counts NaN and Inf outputs of the floating point build. min and max
+  *       cover the finite outputs and are only valid when num_samples > num_non_finite. cycles is the time spent in
+  *       the block function in units of the clock, see filter_stats_set_clock().
+  */
+typedef struct
+{
+    uint64_t      num_calls;
+    uint64_t      num_samples;
+    uint64_t      num_warmup;
+    uint64_t      num_saturated;
+    uint64_t      num_non_finite;
+    uint64_t      cycles;
+    filter_data_t min;
+    filter_data_t max;
+} filter_stats_t;
+
+/**
+  * @brief Clock and saturation count at the start of a block call
+  */
+typedef struct
+{
+    uint64_t cycles;
+    uint64_t saturated;
+} filter_stats_mark_t;
+
+/**
+  * @brief Clear the counters
+  * @param stats Pointer to the counters
+  */
+void filter_stats_reset(filter_stats_t *stats);
+
+/**
+  * @brief Add the counters of one filter to a total, e.g. to sum the channels of a log
+  * @param total Pointer to the total
+  * @param stats Pointer to the counters to add
+  */
+void filter_stats_merge(filter_stats_t *total, const filter_stats_t *stats);
+
+/**
+  * @brief Replace the clock the block functions are timed with
+  * @note The default is the time stamp counter on x86 with a GCC compatible compiler and no clock (cycles stay 0)
+  *       everywhere else. Set it once before any filter runs, it is shared by every thread.
+  * @param clock Clock function, NULL restores the default
+  */
+void filter_stats_set_clock(filter_stats_clock_fn clock);
+
+/**
+  * @brief Read the clock the block functions are timed with
+  * @return The current count, 0 without a clock
+  */
+uint64_t filter_stats_clock(void);
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief Start timing a block call
+  * @param mark Pointer to the mark passed to filter_stats_end()
+  */
+static inline void filter_stats_begin(filter_stats_mark_t *mark)
+{
+    mark->saturated = filter_stats_saturated;
+    mark->cycles = filter_stats_clock();
+}
+
+/**
+  * @brief Record a finished block call
+  * @param stats Pointer to the counters of the filter
+  * @param mark Pointer to the mark taken by filter_stats_begin()
+  * @param output Pointer to the num_samples output values of the call
+  * @param num_samples Number of output values
+  * @param ret Return value of the block function, calls that failed are not recorded
+  */
+void filter_stats_end(filter_stats_t *stats, const filter_stats_mark_t *mark, const filter_data_t *output, size_t num_samples, int ret);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FILTER_STATS_H_ */
@@ -28,20 +28,180 @@
 
 // Define FILTER_USE_FLOAT_MATH at compile time to utilize floating point math.
 // Define FILTER_USE_FIXED_LIB at compile time to utilize a builtin fixed point math library.
+// Otherwise the portable integer kernels are used, define FILTER_USE_Q15_MATH for 16 bit data and coefficients,
+// the default is FILTER_USE_Q31_MATH with 32 bit data and coefficients. Both sum their products in 64 bits.
 #if defined(FILTER_USE_FLOAT_MATH)
 #undef FILTER_USE_FIXED_LIB
 typedef double        filter_coeff_t;
 typedef float         filter_data_t;
 typedef double        filter_accum_t;
+#define FILTER_COEFF_ONE 1
 #elif defined(FILTER_USE_FIXED_LIB)
 typedef long _Accum   filter_coeff_t;
 typedef _Accum        filter_data_t;
 typedef long _Accum   filter_accum_t;
+#define FILTER_COEFF_ONE 1
 #else
-#warning "No fractional math defined, this could result in incorrect coefficients being generated."
-typedef long        filter_coeff_t;
-typedef int         filter_data_t;
-typedef long        filter_accum_t;
+#define FILTER_USE_INTEGER_MATH
+#if defined(FILTER_USE_Q15_MATH)
+#undef FILTER_USE_Q31_MATH
+typedef int16_t       filter_coeff_t;
+typedef int16_t       filter_data_t;
+typedef int64_t       filter_accum_t;
+#define FILTER_DATA_MIN INT16_MIN
+#define FILTER_DATA_MAX INT16_MAX
+// Coefficients are Q2.13, enough headroom for the +-2 terms of a biquad section
+#ifndef FILTER_COEFF_FRAC_BITS
+#define FILTER_COEFF_FRAC_BITS 13
+#endif /* FILTER_COEFF_FRAC_BITS */
+#ifndef FILTER_DATA_FRAC_BITS
+#define FILTER_DATA_FRAC_BITS  4
+#endif /* FILTER_DATA_FRAC_BITS */
+#else
+#ifndef FILTER_USE_Q31_MATH
+#define FILTER_USE_Q31_MATH
+#endif /* FILTER_USE_Q31_MATH */
+typedef int32_t       filter_coeff_t;
+typedef int32_t       filter_data_t;
+typedef int64_t       filter_accum_t;
+#define FILTER_DATA_MIN INT32_MIN
+#define FILTER_DATA_MAX INT32_MAX
+// Coefficients are Q4.27, enough headroom for the direct form coefficients of a 4th order filter
+#ifndef FILTER_COEFF_FRAC_BITS
+#define FILTER_COEFF_FRAC_BITS 27
+#endif /* FILTER_COEFF_FRAC_BITS */
+#ifndef FILTER_DATA_FRAC_BITS
+#define FILTER_DATA_FRAC_BITS  12
+#endif /* FILTER_DATA_FRAC_BITS */
+#endif /* FILTER_USE_Q15_MATH */
+#define FILTER_COEFF_ONE ((filter_coeff_t)1 << FILTER_COEFF_FRAC_BITS)
 #endif /* FILTER_USE_FP_MATH */
 
+// Product of a coefficient and a value held in an accumulator. The integer kernels only ever multiply values
+// that fit filter_data_t, narrowing the operand lets 32 bit targets use a single widening multiply.
+#if defined(FILTER_USE_INTEGER_MATH)
+#define FILTER_MUL(coeff, value) ((filter_accum_t)(coeff) * (filter_accum_t)(filter_data_t)(value))
+#else
+#define FILTER_MUL(coeff, value) ((coeff) * (value))
+#endif /* FILTER_USE_INTEGER_MATH */
+
+#if defined(FILTER_ENABLE_INSTRUMENTATION)
+// Values clamped by filter_saturate() on the calling thread, the block functions attribute them to their filter,
+// see filter_stats_t
+#if defined(__cplusplus)
+extern thread_local uint64_t filter_stats_saturated;
+#else
+extern _Thread_local uint64_t filter_stats_saturated;
+#endif /* __cplusplus */
+#endif /* FILTER_ENABLE_INSTRUMENTATION */
+
+/**
+  * @brief Clamp an accumulator to the range of filter_data_t
+  * @param value Value to clamp
+  * @return The clamped value
+  */
+static inline filter_data_t filter_saturate(filter_accum_t value)
+{
+#if defined(FILTER_USE_INTEGER_MATH)
+    if (value > FILTER_DATA_MAX) {
+#if defined(FILTER_ENABLE_INSTRUMENTATION)
+        filter_stats_saturated++;
+#endif /* FILTER_ENABLE_INSTRUMENTATION */
+        return FILTER_DATA_MAX;
+    }
+    if (value < FILTER_DATA_MIN) {
+#if defined(FILTER_ENABLE_INSTRUMENTATION)
+        filter_stats_saturated++;
+#endif /* FILTER_ENABLE_INSTRUMENTATION */
+        return FILTER_DATA_MIN;
+    }
+#endif /* FILTER_USE_INTEGER_MATH */
+    return (filter_data_t)value;
+}
+
+#if defined(FILTER_USE_INTEGER_MATH)
+/**
+  * @brief Divide an accumulator by 2^shift, rounding half up
+  * @note The floor shift is written so it does not depend on how the compiler shifts negative values
+  * @param acc Accumulator
+  * @param shift Number of bits to shift out, at least 1
+  * @return The rounded quotient
+  */
+static inline filter_accum_t filter_accum_round_shift(filter_accum_t acc, unsigned int shift)
+{
+    acc += (filter_accum_t)1 << (shift - 1);
+    return (acc >= 0) ? (acc >> shift) : ~(~acc >> shift);
+}
+#endif /* FILTER_USE_INTEGER_MATH */
+
+/**
+  * @brief Bring a sum of coefficient products back to the scale of the data
+  * @note The integer kernels round half up, shift out the coefficient fraction and saturate, see
+  *       filter_accum_round_shift(). Every other build returns the sum unchanged.
+  * @param acc Sum of FILTER_MUL products
+  * @return The value at data scale, it always fits filter_data_t in the integer builds
+  */
+static inline filter_accum_t filter_accum_rescale(filter_accum_t acc)
+{
+#if defined(FILTER_USE_INTEGER_MATH)
+    return (filter_accum_t)filter_saturate(filter_accum_round_shift(acc, FILTER_COEFF_FRAC_BITS));
+#else
+    return acc;
+#endif /* FILTER_USE_INTEGER_MATH */
+}
+
+/**
+  * @brief Convert a real value to filter_data_t
+  * @note The integer builds scale by 2^FILTER_DATA_FRAC_BITS, round half away from zero and saturate.
+  * @param value Value to convert
+  * @return The converted value
+  */
+static inline filter_data_t filter_data_from_double(double value)
+{
+#if defined(FILTER_USE_INTEGER_MATH)
+    double scaled = value * (double)((int64_t)1 << FILTER_DATA_FRAC_BITS);
+    if (scaled != scaled) {
+        return 0;
+    }
+    if (scaled >= (double)FILTER_DATA_MAX) {
+        return FILTER_DATA_MAX;
+    }
+    if (scaled <= (double)FILTER_DATA_MIN) {
+        return FILTER_DATA_MIN;
+    }
+    return (filter_data_t)((scaled < 0) ? (scaled - 0.5) : (scaled + 0.5));
+#else
+    return (filter_data_t)value;
+#endif /* FILTER_USE_INTEGER_MATH */
+}
+
+/**
+  * @brief Convert a filter_data_t to a real value, the inverse of filter_data_from_double
+  * @param value Value to convert
+  * @return The converted value
+  */
+static inline double filter_data_to_double(filter_data_t value)
+{
+#if defined(FILTER_USE_INTEGER_MATH)
+    return (double)value / (double)((int64_t)1 << FILTER_DATA_FRAC_BITS);
+#else
+    return (double)value;
+#endif /* FILTER_USE_INTEGER_MATH */
+}
+
+/**
+  * @brief Advance a warm up counter across a block of samples
+  * @param count Pointer to the warm up counter, saturates at length
+  * @param length Number of samples in the warm up window
+  * @param num_samples Number of samples in the block
+  * @return Number of leading samples in the block that fall inside the warm up window
+  */
+static inline size_t filter_warmup_advance(unsigned int *count, unsigned int length, size_t num_samples)
+{
+    size_t remaining = (*count < length) ? (size_t)(length - *count) : 0;
+    size_t invalid = (remaining < num_samples) ? remaining : num_samples;
+    *count += (unsigned int)invalid;
+    return invalid;
+}
+
 #endif /* FILTER_TYPES_H_ */
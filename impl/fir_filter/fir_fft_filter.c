@@ -0,0 +1,233 @@
+#include "fir_fft_filter.h"
+#include <string.h>
+
+// Same dispatch as fir_filter.c for the direct form head of the partitioned mode
+#if FILTER_SIMD_ENABLED
+#define FIR_FFT_FILTER_DOT(filter, b_coeffs, window, num_coeffs) ((filter)->dot((b_coeffs), (window), (num_coeffs)))
+#else
+#define FIR_FFT_FILTER_DOT(filter, b_coeffs, window, num_coeffs) filter_simd_dot_scalar((b_coeffs), (window), (num_coeffs))
+#endif /* FILTER_SIMD_ENABLED */
+
+// Smallest and largest block sizes fir_fft_filter_block_size() picks for the partitioned mode
+#define FIR_FFT_FILTER_MIN_BLOCK_SIZE 16
+#define FIR_FFT_FILTER_MAX_BLOCK_SIZE 4096
+
+int fir_fft_filter_recommended(unsigned int num_coeffs)
+{
+    return (FIR_FFT_FILTER_ENABLED && num_coeffs >= FIR_FFT_FILTER_CROSSOVER) ? 1 : 0;
+}
+
+unsigned int fir_fft_filter_block_size(unsigned int num_coeffs, unsigned int mode)
+{
+    unsigned int block_size = 2;
+    if (mode == FIR_FFT_FILTER_MODE_BLOCK) {
+        while (block_size < num_coeffs) {
+            block_size <<= 1;
+        }
+        return block_size;
+    }
+
+    // Rough cost per sample, the SIMD direct form head, the two FFTs of the block and one complex multiply add
+    // per partition, weighted from timings of the float build
+    unsigned int best = FIR_FFT_FILTER_MIN_BLOCK_SIZE;
+    unsigned int best_cost = 0;
+    unsigned int log2_size = 5;
+    for (block_size = FIR_FFT_FILTER_MIN_BLOCK_SIZE; block_size <= FIR_FFT_FILTER_MAX_BLOCK_SIZE; block_size <<= 1) {
+        unsigned int cost = (block_size / 4) + (8 * log2_size) + (8 * FIR_FFT_FILTER_NUM_PARTITIONS(num_coeffs, block_size));
+        if (block_size == FIR_FFT_FILTER_MIN_BLOCK_SIZE || cost < best_cost) {
+            best = block_size;
+            best_cost = cost;
+        }
+        log2_size++;
+    }
+
+    return best;
+}
+
+size_t fir_fft_filter_state_size(unsigned int num_coeffs, unsigned int block_size)
+{
+    return sizeof(double) * FIR_FFT_FILTER_STATE_SIZE((size_t)num_coeffs, (size_t)block_size);
+}
+
+int fir_fft_filter_init(fir_fft_filter_t *filter, filter_coeff_t *b_coeffs, unsigned int num_coeffs, unsigned int block_size,
+                        unsigned int mode, double *state)
+{
+    if (!FIR_FFT_FILTER_ENABLED || !filter || !b_coeffs || !state || num_coeffs == 0 || block_size < 2 ||
+        (block_size & (block_size - 1)) || mode > FIR_FFT_FILTER_MODE_BLOCK) {
+        return FIR_FFT_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    const unsigned int num_partitions = FIR_FFT_FILTER_NUM_PARTITIONS(num_coeffs, block_size);
+    const unsigned int num_bins = FILTER_FFT_NUM_BINS(2 * block_size);
+
+    filter->mode = mode;
+    filter->b_coeffs = b_coeffs;
+    filter->num_coeffs = num_coeffs;
+    filter->block_size = block_size;
+    filter->num_partitions = num_partitions;
+    filter->first_partition = (mode == FIR_FFT_FILTER_MODE_PARTITIONED) ? 1 : 0;
+    filter->head_size = (mode == FIR_FFT_FILTER_MODE_PARTITIONED) ? ((num_coeffs < block_size) ? num_coeffs : block_size) : 0;
+    filter->index = 0;
+    filter->head_index = 0;
+    filter->fdl_index = 0;
+    filter->count = 0;
+#if FILTER_SIMD_ENABLED
+    filter->dot = filter_simd_get_dot();
+#endif /* FILTER_SIMD_ENABLED */
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+    // Carve the state block, see FIR_FFT_FILTER_STATE_SIZE
+    filter_fft_complex_t *twiddles = (filter_fft_complex_t *)state;
+    filter->spectra = twiddles + FILTER_FFT_TWIDDLE_SIZE(2 * block_size);
+    filter->fdl = filter->spectra + ((size_t)num_partitions * num_bins);
+    filter->acc = filter->fdl + ((size_t)num_partitions * num_bins);
+    filter->frame = (double *)(filter->acc + num_bins);
+    filter->work = filter->frame + (2 * block_size);
+    filter->head = (filter_accum_t *)(filter->work + (2 * block_size));
+    filter_fft_init(&filter->fft, 2 * block_size, twiddles);
+
+    // Transform each partition zero padded to the FFT size, the inverse transform is not normalized so the
+    // 1 / (2 * block_size) scale is folded into the spectra
+    const double scale = 1.0 / (double)(2 * block_size);
+    for (unsigned int p = 0; p < num_partitions; p++)
+    {
+        for (unsigned int i = 0; i < 2 * block_size; i++)
+        {
+            unsigned int tap = (p * block_size) + i;
+            filter->frame[i] = (i < block_size && tap < num_coeffs) ? ((double)b_coeffs[tap] * scale) : 0.0;
+        }
+        filter_fft_forward(&filter->fft, filter->frame, filter->spectra + ((size_t)p * num_bins));
+    }
+
+    memset(filter->fdl, 0, sizeof(filter_fft_complex_t) * num_partitions * num_bins);
+    memset(filter->frame, 0, sizeof(double) * 4 * block_size);
+    memset(filter->head, 0, sizeof(filter_accum_t) * 2 * block_size);
+
+    return FIR_FFT_FILTER_ERROR_OK;
+}
+
+unsigned int fir_fft_filter_latency(const fir_fft_filter_t *filter)
+{
+    return (filter->mode == FIR_FFT_FILTER_MODE_BLOCK) ? filter->block_size : 0;
+}
+
+/**
+  * @brief Convolve the block that just filled up, the result covers the outputs of the next block
+  */
+static void fir_fft_filter_process_block(fir_fft_filter_t *filter)
+{
+    const unsigned int block_size = filter->block_size;
+    const unsigned int num_partitions = filter->num_partitions;
+    const unsigned int first = filter->first_partition;
+    const unsigned int num_bins = FILTER_FFT_NUM_BINS(2 * block_size);
+
+    // The direct form head covers every tap
+    if (num_partitions <= first) {
+        return;
+    }
+
+    // Transform the newest two blocks into the front of the frequency domain delay line, then keep the
+    // newest block as the older half of the next frame
+    filter->fdl_index = (filter->fdl_index == 0) ? (num_partitions - 1) : (filter->fdl_index - 1);
+    filter_fft_forward(&filter->fft, filter->frame, filter->fdl + ((size_t)filter->fdl_index * num_bins));
+    memcpy(filter->frame, filter->frame + block_size, sizeof(double) * block_size);
+
+    // Partition p meets the input spectrum p - first blocks back
+    filter_fft_complex_t *acc = filter->acc;
+    memset(acc, 0, sizeof(filter_fft_complex_t) * num_bins);
+    for (unsigned int p = first; p < num_partitions; p++)
+    {
+        unsigned int slot = filter->fdl_index + p - first;
+        if (slot >= num_partitions) {
+            slot -= num_partitions;
+        }
+        const filter_fft_complex_t *h = filter->spectra + ((size_t)p * num_bins);
+        const filter_fft_complex_t *x = filter->fdl + ((size_t)slot * num_bins);
+        for (unsigned int k = 0; k < num_bins; k++)
+        {
+            acc[k].re += (h[k].re * x[k].re) - (h[k].im * x[k].im);
+            acc[k].im += (h[k].re * x[k].im) + (h[k].im * x[k].re);
+        }
+    }
+
+    // Only the second half of the circular convolution is the linear convolution, it is read from work + block_size
+    filter_fft_inverse(&filter->fft, acc, filter->work);
+}
+
+int fir_fft_filter_run(fir_fft_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    int ret = fir_fft_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? FIR_FFT_FILTER_ERROR_INVALID_OUTPUT : FIR_FFT_FILTER_ERROR_OK;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief fir_fft_filter_run_block() without the instrumentation
+  */
+static int fir_fft_filter_run_kernel(fir_fft_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#else
+int fir_fft_filter_run_block(fir_fft_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!filter || !input || !output) {
+        return FIR_FFT_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    const filter_coeff_t *b_coeffs = filter->b_coeffs;
+    filter_accum_t       *head = filter->head;
+    double               *frame = filter->frame + filter->block_size;
+    const double         *tail = filter->work + filter->block_size;
+    const unsigned int    block_size = filter->block_size;
+    const unsigned int    head_size = filter->head_size;
+    unsigned int          index = filter->index;
+    unsigned int          head_index = filter->head_index;
+
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        filter_accum_t in = (filter_accum_t)input[n];
+        filter_accum_t new_output = tail[index];
+
+        // The first partition runs as a mirrored direct form FIR, see fir_filter_init_mirrored
+        if (head_size) {
+            head_index = (head_index == 0) ? (head_size - 1) : (head_index - 1);
+            head[head_index] = in;
+            head[head_index + head_size] = in;
+            new_output += FIR_FFT_FILTER_DOT(filter, b_coeffs, &head[head_index], head_size);
+        }
+
+        frame[index] = (double)in;
+        output[n] = (filter_data_t)new_output;
+        if (++index == block_size) {
+            fir_fft_filter_process_block(filter);
+            index = 0;
+        }
+    }
+    filter->index = index;
+    filter->head_index = head_index;
+
+    if (filter->mode == FIR_FFT_FILTER_MODE_BLOCK) {
+        return (int)filter_warmup_advance(&filter->count, block_size, num_samples);
+    }
+
+    return 0;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int fir_fft_filter_run_block(fir_fft_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = fir_fft_filter_run_kernel(filter, input, output, num_samples);
+    if (ret >= 0) {
+        filter_stats_end(&filter->stats, &mark, output, num_samples, ret);
+    }
+    return ret;
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
@@ -0,0 +1,179 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FIR_FFT_FILTER_H_
+#define FIR_FFT_FILTER_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+#include "../filter_simd/filter_simd.h"
+#include "../filter_fft/filter_fft.h"
+#include "../filter_stats/filter_stats.h"
+
+// The FFT convolution works on doubles, it is only built for the floating point math build. The integer builds
+// keep the bit exact direct form for every tap count.
+#if defined(FILTER_USE_FLOAT_MATH)
+#define FIR_FFT_FILTER_ENABLED 1
+#else
+#define FIR_FFT_FILTER_ENABLED 0
+#endif /* FILTER_USE_FLOAT_MATH */
+
+#define FIR_FFT_FILTER_ERROR_OK             0
+#define FIR_FFT_FILTER_ERROR_INVALID_PARAM  -1
+#define FIR_FFT_FILTER_ERROR_INVALID_OUTPUT -2
+
+// Convolution modes
+#define FIR_FFT_FILTER_MODE_PARTITIONED     0
+#define FIR_FFT_FILTER_MODE_BLOCK           1
+
+// Tap count from which the partitioned FFT convolution beats the direct form, see fir_fft_filter_recommended().
+// The two break even near 512 taps on x86-64 with AVX2, at 1024 taps the FFT is already about 1.5x faster.
+#ifndef FIR_FFT_FILTER_CROSSOVER
+#define FIR_FFT_FILTER_CROSSOVER            768
+#endif /* FIR_FFT_FILTER_CROSSOVER */
+
+// Number of block_size tap partitions the coefficients are split into
+#define FIR_FFT_FILTER_NUM_PARTITIONS(num_coeffs, block_size) (((num_coeffs) + (block_size) - 1) / (block_size))
+
+// Number of doubles required for the state of a filter, see fir_fft_filter_init()
+#define FIR_FFT_FILTER_STATE_SIZE(num_coeffs, block_size)                                      \
+    ((2 * FILTER_FFT_TWIDDLE_SIZE(2 * (block_size))) +                                         \
+     (4 * FIR_FFT_FILTER_NUM_PARTITIONS(num_coeffs, block_size) * FILTER_FFT_NUM_BINS(2 * (block_size))) + \
+     (2 * FILTER_FFT_NUM_BINS(2 * (block_size))) + (6 * (block_size)))
+
+/**
+  * @brief Overlap-save FFT convolution FIR filter
+  * @note The coefficients are split into partitions of block_size taps whose spectra are computed once at
+  *       init. Every block_size inputs the newest block is transformed with a 2 * block_size point real FFT
+  *       and multiplied against the partition spectra through a frequency domain delay line.
+  *       In FIR_FFT_FILTER_MODE_PARTITIONED the first partition runs as a direct form FIR on each sample and
+  *       the FFT only covers the later partitions, whose inputs are always a full block old. The output lines
+  *       up sample for sample with fir_filter_t, there is no added latency and every sample costs block_size
+  *       multiply adds plus its share of two FFTs per block.
+  *       In FIR_FFT_FILTER_MODE_BLOCK every partition goes through the FFT, the output is delayed by
+  *       block_size samples and reported as warm up. With block_size no smaller than num_coeffs this is
+  *       classic single partition overlap-save, the cheapest way to run a long filter offline.
+  */
+typedef struct
+{
+    unsigned int          mode;
+    unsigned int          num_coeffs;
+    unsigned int          block_size;
+    unsigned int          num_partitions;
+    unsigned int          first_partition;
+    unsigned int          head_size;
+    unsigned int          index;
+    unsigned int          head_index;
+    unsigned int          fdl_index;
+    unsigned int          count;
+    filter_coeff_t       *b_coeffs;
+    filter_fft_t          fft;
+    filter_fft_complex_t *spectra;
+    filter_fft_complex_t *fdl;
+    filter_fft_complex_t *acc;
+    double               *frame;
+    double               *work;
+    filter_accum_t       *head;
+#if FILTER_SIMD_ENABLED
+    filter_simd_dot_fn    dot;
+#endif /* FILTER_SIMD_ENABLED */
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t        stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+} fir_fft_filter_t;
+
+/**
+  * @brief Check if the FFT convolution is the faster way to run a filter
+  * @param num_coeffs The number of coefficients
+  * @return 1 if num_coeffs is at least FIR_FFT_FILTER_CROSSOVER and the FFT convolution is built, 0 otherwise
+  */
+int fir_fft_filter_recommended(unsigned int num_coeffs);
+
+/**
+  * @brief Pick a block size for a filter
+  * @note FIR_FFT_FILTER_MODE_BLOCK gets the smallest power of two covering every tap. The partitioned mode
+  *       balances the per sample direct form against the FFT and frequency domain work, which puts the block
+  *       size near the square root of the tap count.
+  * @param num_coeffs The number of coefficients
+  * @param mode One of the FIR_FFT_FILTER_MODE_* modes
+  * @return A power of two block size, also the latency of FIR_FFT_FILTER_MODE_BLOCK
+  */
+unsigned int fir_fft_filter_block_size(unsigned int num_coeffs, unsigned int mode);
+
+/**
+  * @brief Initialize the filter
+  * @note The coefficients are read once, the partition spectra keep their own copy for the FFT partitions.
+  * @param filter Pointer to the filter
+  * @param b_coeffs Pointer to the numerator coefficients
+  * @param num_coeffs The number of coefficients that need to be applied
+  * @param block_size Partition size, a power of two no smaller than 2, see fir_fft_filter_block_size()
+  * @param mode One of the FIR_FFT_FILTER_MODE_* modes
+  * @param state Pointer to the state, must hold FIR_FFT_FILTER_STATE_SIZE(num_coeffs, block_size) doubles
+  * @return FIR_FFT_FILTER_ERROR_OK on success, negative on error
+  */
+int fir_fft_filter_init(fir_fft_filter_t *filter, filter_coeff_t *b_coeffs, unsigned int num_coeffs, unsigned int block_size,
+                        unsigned int mode, double *state);
+
+/**
+  * @brief Get the size of the state, FIR_FFT_FILTER_STATE_SIZE(num_coeffs, block_size) doubles
+  * @param num_coeffs The number of coefficients
+  * @param block_size Partition size
+  * @return Size in bytes
+  */
+size_t fir_fft_filter_state_size(unsigned int num_coeffs, unsigned int block_size);
+
+/**
+  * @brief Get the delay the filter adds on top of the direct form
+  * @param filter Pointer to the filter
+  * @return 0 in FIR_FFT_FILTER_MODE_PARTITIONED, block_size in FIR_FFT_FILTER_MODE_BLOCK
+  */
+unsigned int fir_fft_filter_latency(const fir_fft_filter_t *filter);
+
+/**
+  * @brief Run the filter on the input value
+  * @param filter Pointer to the filter
+  * @param input Input value
+  * @param output Pointer to the output value
+  * @return FIR_FFT_FILTER_ERROR_OK on success, FIR_FFT_FILTER_ERROR_INVALID_OUTPUT while the output is still
+  *         delayed, negative on error
+  */
+int fir_fft_filter_run(fir_fft_filter_t *filter, filter_data_t input, filter_data_t *output);
+
+/**
+  * @brief Run the filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers, does not need to match block_size
+  * @return Number of leading outputs that only hold the latency delay (always 0 in
+  *         FIR_FFT_FILTER_MODE_PARTITIONED), negative on error
+  */
+int fir_fft_filter_run_block(fir_fft_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FIR_FFT_FILTER_H_ */
@@ -1,6 +1,21 @@
 #include "fir_filter.h"
+#include "../filter_simd/filter_simd.h"
 #include <string.h>
 
+// Dispatch the dot product through the kernel picked at init when SIMD is built in, otherwise inline the
+// scalar kernel. The scalar kernel keeps the original summation order so both delay line modes are bit exact.
+#if FILTER_SIMD_ENABLED
+#define FIR_FILTER_DOT(filter, b_coeffs, window, num_coeffs) ((filter)->dot((b_coeffs), (window), (num_coeffs)))
+#else
+#define FIR_FILTER_DOT(filter, b_coeffs, window, num_coeffs) filter_simd_dot_scalar((b_coeffs), (window), (num_coeffs))
+#endif /* FILTER_SIMD_ENABLED */
+
+size_t fir_filter_state_size(unsigned int num_coeffs, unsigned int delay_mode)
+{
+    size_t entries = (delay_mode == FIR_FILTER_DELAY_MIRRORED) ? FIR_FILTER_MIRRORED_STATE_SIZE((size_t)num_coeffs) : num_coeffs;
+    return sizeof(filter_accum_t) * entries;
+}
+
 int fir_filter_init(fir_filter_t *filter, filter_coeff_t *b_coeffs, filter_accum_t *prev_inputs, unsigned int num_coeffs)
 {
     if (!filter || !b_coeffs || !prev_inputs || num_coeffs == 0) {
@@ -11,33 +26,113 @@ int fir_filter_init(fir_filter_t *filter, filter_coeff_t *b_coeffs, filter_accum
     filter->prev_inputs = prev_inputs;
     filter->num_coeffs = num_coeffs;
     filter->count = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+    filter->index = 0;
+    filter->delay_mode = FIR_FILTER_DELAY_SHIFT;
+#if FILTER_SIMD_ENABLED
+    filter->dot = filter_simd_get_dot();
+#endif /* FILTER_SIMD_ENABLED */
     memset(filter->prev_inputs, 0, sizeof(filter_accum_t) * num_coeffs);
 
     return FIR_FILTER_ERROR_OK;
 }
 
-int fir_filter_run(fir_filter_t *filter, filter_data_t input, filter_data_t *output)
+int fir_filter_init_mirrored(fir_filter_t *filter, filter_coeff_t *b_coeffs, filter_accum_t *prev_inputs, unsigned int num_coeffs)
 {
-    if (!filter || !output) {
+    if (!filter || !b_coeffs || !prev_inputs || num_coeffs == 0) {
         return FIR_FILTER_ERROR_INVALID_PARAM;
     }
 
-    filter_accum_t in = (filter_accum_t)input;
-    filter_accum_t new_output = (filter->b_coeffs[0] * in);
-    for (int i = 1; i < filter->num_coeffs; i++)
-    {
-        new_output += (filter->b_coeffs[i] * filter->prev_inputs[i - 1]);
+    filter->b_coeffs = b_coeffs;
+    filter->prev_inputs = prev_inputs;
+    filter->num_coeffs = num_coeffs;
+    filter->count = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+    filter->index = 0;
+    filter->delay_mode = FIR_FILTER_DELAY_MIRRORED;
+#if FILTER_SIMD_ENABLED
+    filter->dot = filter_simd_get_dot();
+#endif /* FILTER_SIMD_ENABLED */
+    memset(filter->prev_inputs, 0, sizeof(filter_accum_t) * FIR_FILTER_MIRRORED_STATE_SIZE(num_coeffs));
+
+    return FIR_FILTER_ERROR_OK;
+}
+
+int fir_filter_run(fir_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    int ret = fir_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
     }
 
-    // Shift the buffer contents
-    for (int i = filter->num_coeffs - 1; i > 0; i--)
-    {
-        filter->prev_inputs[i] = filter->prev_inputs[i - 1];
+    return (ret > 0) ? FIR_FILTER_ERROR_INVALID_OUTPUT : FIR_FILTER_ERROR_OK;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief fir_filter_run_block() without the instrumentation
+  */
+static int fir_filter_run_kernel(fir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#else
+int fir_filter_run_block(fir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!filter || !input || !output) {
+        return FIR_FILTER_ERROR_INVALID_PARAM;
     }
-    filter->prev_inputs[0] = in;
 
-    // Assign the calculated output
-    *output = (filter_data_t)new_output;
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    const filter_coeff_t *b_coeffs = filter->b_coeffs;
+    filter_accum_t       *prev_inputs = filter->prev_inputs;
+    const unsigned int    num_coeffs = filter->num_coeffs;
 
-    return FIR_FILTER_ERROR_OK;
+    if (filter->delay_mode == FIR_FILTER_DELAY_MIRRORED) {
+        unsigned int index = filter->index;
+        for (size_t n = 0; n < num_samples; n++)
+        {
+            // Walk the write position backwards and store the input in both halves, the newest
+            // num_coeffs inputs are then always contiguous starting at the write position
+            index = (index == 0) ? (num_coeffs - 1) : (index - 1);
+            filter_accum_t in = (filter_accum_t)input[n];
+            prev_inputs[index] = in;
+            prev_inputs[index + num_coeffs] = in;
+
+            // Assign the calculated output
+            output[n] = (filter_data_t)filter_accum_rescale(FIR_FILTER_DOT(filter, b_coeffs, &prev_inputs[index], num_coeffs));
+        }
+        filter->index = index;
+    } else {
+        for (size_t n = 0; n < num_samples; n++)
+        {
+            // Shift the buffer contents
+            for (unsigned int i = num_coeffs - 1; i > 0; i--)
+            {
+                prev_inputs[i] = prev_inputs[i - 1];
+            }
+            prev_inputs[0] = (filter_accum_t)input[n];
+
+            // Assign the calculated output
+            output[n] = (filter_data_t)filter_accum_rescale(FIR_FILTER_DOT(filter, b_coeffs, prev_inputs, num_coeffs));
+        }
+    }
+
+    // The FIR output is valid from the first sample, there is no warm up window to report
+    return 0;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int fir_filter_run_block(fir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = fir_filter_run_kernel(filter, input, output, num_samples);
+    if (ret >= 0) {
+        filter_stats_end(&filter->stats, &mark, output, num_samples, ret);
+    }
+    return ret;
 }
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
@@ -28,24 +28,42 @@ extern "C" {
 #endif /* __cplusplus */
 
 #include "../filter_types.h"
+#include "../filter_stats/filter_stats.h"
+#include "../filter_simd/filter_simd.h"
 
 #define FIR_FILTER_ERROR_OK             0
 #define FIR_FILTER_ERROR_INVALID_PARAM  -1
 #define FIR_FILTER_ERROR_INVALID_OUTPUT -2
 
+// Delay line modes
+#define FIR_FILTER_DELAY_SHIFT          0
+#define FIR_FILTER_DELAY_MIRRORED       1
+
+// Number of filter_accum_t entries required for the prev_inputs buffer of a mirrored delay line
+#define FIR_FILTER_MIRRORED_STATE_SIZE(num_coeffs) (2 * (num_coeffs))
+
 /**
-  * @brief IIR filter structure
+  * @brief FIR filter structure
   */
 typedef struct
 {
     unsigned int    num_coeffs;
     unsigned int    count;
+    unsigned int    index;
+    unsigned int    delay_mode;
     filter_coeff_t *b_coeffs;
     filter_accum_t *prev_inputs;
+#if FILTER_SIMD_ENABLED
+    filter_simd_dot_fn dot;
+#endif /* FILTER_SIMD_ENABLED */
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t  stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 } fir_filter_t;
 
 /**
   * @brief Initialize the filter
+  * @note In the floating point build the dot product kernel is chosen here, see filter_simd_set_level()
   * @param filter Pointer to the filter
   * @param b_coeffs Pointer to the numerator coefficients
   * @param prev_inputs Pointer to the previous inputs
@@ -54,6 +72,26 @@ typedef struct
   */
 int fir_filter_init(fir_filter_t *filter, filter_coeff_t *b_coeffs, filter_accum_t *prev_inputs, unsigned int num_coeffs);
 
+/**
+  * @brief Initialize the filter with a double length mirrored delay line
+  * @note Every input is written twice, num_coeffs apart, so the newest num_coeffs inputs are always
+  *       contiguous and nothing has to be shifted per sample. Output is bit exact with fir_filter_init.
+  * @param filter Pointer to the filter
+  * @param b_coeffs Pointer to the numerator coefficients
+  * @param prev_inputs Pointer to the previous inputs, must hold FIR_FILTER_MIRRORED_STATE_SIZE(num_coeffs) entries
+  * @param num_coeffs The number of coefficients that need to be applied
+  * @return FIR_FILTER_ERROR_OK on success, negative on error
+  */
+int fir_filter_init_mirrored(fir_filter_t *filter, filter_coeff_t *b_coeffs, filter_accum_t *prev_inputs, unsigned int num_coeffs);
+
+/**
+  * @brief Get the size of the prev_inputs buffer
+  * @param num_coeffs The number of coefficients
+  * @param delay_mode FIR_FILTER_DELAY_SHIFT for fir_filter_init(), FIR_FILTER_DELAY_MIRRORED for fir_filter_init_mirrored()
+  * @return Size in bytes
+  */
+size_t fir_filter_state_size(unsigned int num_coeffs, unsigned int delay_mode);
+
 /**
   * @brief Run an FIR filter on the input value
   * @param filter Pointer to the filter
@@ -63,6 +101,16 @@ int fir_filter_init(fir_filter_t *filter, filter_coeff_t *b_coeffs, filter_accum
   */
 int fir_filter_run(fir_filter_t *filter, filter_data_t input, filter_data_t *output);
 
+/**
+  * @brief Run an FIR filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs still inside the warm up window (always 0 for the FIR), negative on error
+  */
+int fir_filter_run_block(fir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,84 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FIR_FILTER_STATIC_H_
+#define FIR_FILTER_STATIC_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "fir_filter.h"
+#include <string.h>
+
+/**
+  * @brief Define a FIR filter specialized for one static const coefficient table
+  * @note Expands to a filter type name##_t holding its own mirrored delay line, plus name##_init() and
+  *       name##_run_block(). With b_coeffs a static const array and num_coeffs a constant expression the
+  *       compiler sees every tap, so the dot product can be fully unrolled with the coefficients folded in.
+  *       The summation order is the same as filter_simd_dot_scalar(), the output is bit exact with the
+  *       runtime fir_filter_t using the scalar kernel. filter_designer.py emits this form with --static.
+  * @param name Prefix of the generated type and functions
+  * @param b_coeffs The static const coefficient table
+  * @param num_coeffs The number of coefficients, a constant expression
+  */
+#define FIR_FILTER_STATIC_DEFINE(name, b_coeffs, num_coeffs)                                                        \
+    typedef struct                                                                                                  \
+    {                                                                                                               \
+        unsigned int   index;                                                                                       \
+        filter_accum_t prev_inputs[FIR_FILTER_MIRRORED_STATE_SIZE(num_coeffs)];                                     \
+    } name##_t;                                                                                                     \
+                                                                                                                    \
+    static inline void name##_init(name##_t *filter)                                                                \
+    {                                                                                                               \
+        memset(filter, 0, sizeof(name##_t));                                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline int name##_run_block(name##_t *filter, const filter_data_t *input, filter_data_t *output,         \
+                                       size_t num_samples)                                                          \
+    {                                                                                                               \
+        unsigned int index = filter->index;                                                                         \
+        for (size_t n = 0; n < num_samples; n++)                                                                    \
+        {                                                                                                           \
+            index = (index == 0) ? ((num_coeffs) - 1) : (index - 1);                                                \
+            filter_accum_t in = (filter_accum_t)input[n];                                                           \
+            filter->prev_inputs[index] = in;                                                                        \
+            filter->prev_inputs[index + (num_coeffs)] = in;                                                         \
+                                                                                                                    \
+            const filter_accum_t *window = &filter->prev_inputs[index];                                             \
+            filter_accum_t        acc = FILTER_MUL((b_coeffs)[0], window[0]);                                       \
+            for (unsigned int i = 1; i < (num_coeffs); i++)                                                         \
+            {                                                                                                       \
+                acc += FILTER_MUL((b_coeffs)[i], window[i]);                                                        \
+            }                                                                                                       \
+            output[n] = (filter_data_t)filter_accum_rescale(acc);                                                   \
+        }                                                                                                           \
+        filter->index = index;                                                                                      \
+                                                                                                                    \
+        return 0;                                                                                                   \
+    }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FIR_FILTER_STATIC_H_ */
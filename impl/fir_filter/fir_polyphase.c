@@ -0,0 +1,128 @@
+#include "fir_polyphase.h"
+#include <string.h>
+
+// Same dispatch as fir_filter.c, a decimator is then bit exact with the full rate fir_filter_t
+#if FILTER_SIMD_ENABLED
+#define FIR_POLYPHASE_FILTER_DOT(filter, b_coeffs, window, num_coeffs) ((filter)->dot((b_coeffs), (window), (num_coeffs)))
+#else
+#define FIR_POLYPHASE_FILTER_DOT(filter, b_coeffs, window, num_coeffs) filter_simd_dot_scalar((b_coeffs), (window), (num_coeffs))
+#endif /* FILTER_SIMD_ENABLED */
+
+size_t fir_polyphase_filter_state_size(unsigned int num_coeffs, unsigned int interpolation)
+{
+    return sizeof(filter_accum_t) * FIR_POLYPHASE_FILTER_STATE_SIZE((size_t)num_coeffs, interpolation);
+}
+
+int fir_polyphase_filter_init(fir_polyphase_filter_t *filter, const filter_coeff_t *b_coeffs, unsigned int num_coeffs,
+                              unsigned int interpolation, unsigned int decimation, filter_coeff_t *phase_coeffs,
+                              filter_accum_t *prev_inputs)
+{
+    if (!filter || !b_coeffs || !prev_inputs || num_coeffs == 0 || interpolation == 0 || decimation == 0 ||
+        (!phase_coeffs && interpolation != 1)) {
+        return FIR_POLYPHASE_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    const unsigned int phase_length = FIR_POLYPHASE_FILTER_PHASE_LENGTH(num_coeffs, interpolation);
+
+    filter->num_coeffs = num_coeffs;
+    filter->interpolation = interpolation;
+    filter->decimation = decimation;
+    filter->phase_length = phase_length;
+    filter->phase = 0;
+    filter->index = 0;
+    filter->prev_inputs = prev_inputs;
+#if FILTER_SIMD_ENABLED
+    filter->dot = filter_simd_get_dot();
+#endif /* FILTER_SIMD_ENABLED */
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+    // Phase p holds the taps p, p + L, p + 2L, ..., zero padded to phase_length so every phase has the same length
+    if (phase_coeffs) {
+        for (unsigned int p = 0; p < interpolation; p++)
+        {
+            for (unsigned int j = 0; j < phase_length; j++)
+            {
+                unsigned int tap = p + (j * interpolation);
+                phase_coeffs[(p * phase_length) + j] = (tap < num_coeffs) ? b_coeffs[tap] : 0;
+            }
+        }
+        filter->phase_coeffs = phase_coeffs;
+    } else {
+        filter->phase_coeffs = b_coeffs;
+    }
+    memset(filter->prev_inputs, 0, sizeof(filter_accum_t) * FIR_POLYPHASE_FILTER_STATE_SIZE(num_coeffs, interpolation));
+
+    return FIR_POLYPHASE_FILTER_ERROR_OK;
+}
+
+int fir_polyphase_filter_run(fir_polyphase_filter_t *filter, filter_data_t input, filter_data_t *output, size_t *num_outputs)
+{
+    return fir_polyphase_filter_run_block(filter, &input, 1, output, num_outputs);
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief fir_polyphase_filter_run_block() without the instrumentation
+  */
+static int fir_polyphase_filter_run_kernel(fir_polyphase_filter_t *filter, const filter_data_t *input, size_t num_samples,
+                                           filter_data_t *output, size_t *num_outputs)
+#else
+int fir_polyphase_filter_run_block(fir_polyphase_filter_t *filter, const filter_data_t *input, size_t num_samples,
+                                   filter_data_t *output, size_t *num_outputs)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!filter || !input || !output || !num_outputs) {
+        return FIR_POLYPHASE_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    const filter_coeff_t *phase_coeffs = filter->phase_coeffs;
+    filter_accum_t       *prev_inputs = filter->prev_inputs;
+    const unsigned int    phase_length = filter->phase_length;
+    const unsigned int    interpolation = filter->interpolation;
+    const unsigned int    decimation = filter->decimation;
+    unsigned int          phase = filter->phase;
+    unsigned int          index = filter->index;
+    size_t                count = 0;
+
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        // Mirrored delay line, see fir_filter_init_mirrored
+        index = (index == 0) ? (phase_length - 1) : (index - 1);
+        filter_accum_t in = (filter_accum_t)input[n];
+        prev_inputs[index] = in;
+        prev_inputs[index + phase_length] = in;
+
+        // phase is the offset of the next kept output from this input on the interpolated time line, every
+        // output that falls before the next input is computed here
+        while (phase < interpolation)
+        {
+            output[count++] = (filter_data_t)filter_accum_rescale(
+                FIR_POLYPHASE_FILTER_DOT(filter, &phase_coeffs[phase * phase_length], &prev_inputs[index], phase_length));
+            phase += decimation;
+        }
+        phase -= interpolation;
+    }
+    filter->phase = phase;
+    filter->index = index;
+    *num_outputs = count;
+
+    return FIR_POLYPHASE_FILTER_ERROR_OK;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int fir_polyphase_filter_run_block(fir_polyphase_filter_t *filter, const filter_data_t *input, size_t num_samples,
+                                   filter_data_t *output, size_t *num_outputs)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = fir_polyphase_filter_run_kernel(filter, input, num_samples, output, num_outputs);
+    if (ret >= 0) {
+        // Only the kept outputs are computed, they are the samples the call produced
+        filter_stats_end(&filter->stats, &mark, output, *num_outputs, ret);
+    }
+    return ret;
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
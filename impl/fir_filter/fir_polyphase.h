@@ -0,0 +1,135 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef FIR_POLYPHASE_H_
+#define FIR_POLYPHASE_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+#include "../filter_simd/filter_simd.h"
+#include "../filter_stats/filter_stats.h"
+
+#define FIR_POLYPHASE_FILTER_ERROR_OK             0
+#define FIR_POLYPHASE_FILTER_ERROR_INVALID_PARAM  -1
+#define FIR_POLYPHASE_FILTER_ERROR_INVALID_OUTPUT -2
+
+// Number of taps in each of the interpolation phases
+#define FIR_POLYPHASE_FILTER_PHASE_LENGTH(num_coeffs, interpolation) (((num_coeffs) + (interpolation) - 1) / (interpolation))
+
+// Number of filter_coeff_t entries required for the phase_coeffs buffer
+#define FIR_POLYPHASE_FILTER_COEFF_SIZE(num_coeffs, interpolation) \
+    ((interpolation) * FIR_POLYPHASE_FILTER_PHASE_LENGTH(num_coeffs, interpolation))
+
+// Number of filter_accum_t entries required for the prev_inputs buffer, a mirrored delay line of one phase
+#define FIR_POLYPHASE_FILTER_STATE_SIZE(num_coeffs, interpolation) (2 * FIR_POLYPHASE_FILTER_PHASE_LENGTH(num_coeffs, interpolation))
+
+// Most outputs a block of num_samples inputs can produce
+#define FIR_POLYPHASE_FILTER_MAX_OUTPUTS(num_samples, interpolation, decimation) \
+    ((((num_samples) * (interpolation)) + (decimation) - 1) / (decimation))
+
+/**
+  * @brief Polyphase FIR filter resampling by a rational factor interpolation / decimation
+  * @note The coefficients are the prototype filter running at interpolation times the input rate, in the same
+  *       layout as fir_filter_t. The input is conceptually zero stuffed by interpolation, filtered and every
+  *       decimation'th sample is kept, starting with the first one. Only the kept outputs are computed and the
+  *       zero stuffed inputs are never multiplied: each output is one phase_length tap dot product of phase
+  *       (t mod interpolation) against the newest inputs.
+  *       With interpolation == 1 this is a decimator whose output is bit exact with running fir_filter_t at the
+  *       full rate and keeping every decimation'th output. With decimation == 1 it is an interpolator, scale the
+  *       prototype by interpolation to keep the pass band gain at one.
+  */
+typedef struct
+{
+    unsigned int          num_coeffs;
+    unsigned int          interpolation;
+    unsigned int          decimation;
+    unsigned int          phase_length;
+    unsigned int          phase;
+    unsigned int          index;
+    const filter_coeff_t *phase_coeffs;
+    filter_accum_t       *prev_inputs;
+#if FILTER_SIMD_ENABLED
+    filter_simd_dot_fn    dot;
+#endif /* FILTER_SIMD_ENABLED */
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t        stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+} fir_polyphase_filter_t;
+
+/**
+  * @brief Initialize the filter
+  * @note In the floating point build the dot product kernel is chosen here, see filter_simd_set_level()
+  * @param filter Pointer to the filter
+  * @param b_coeffs Pointer to the prototype filter coefficients
+  * @param num_coeffs The number of coefficients
+  * @param interpolation Upsampling factor L, 1 for a pure decimator
+  * @param decimation Downsampling factor M, 1 for a pure interpolator
+  * @param phase_coeffs Pointer to FIR_POLYPHASE_FILTER_COEFF_SIZE(num_coeffs, interpolation) coefficients that
+  *                     receive the coefficients reordered by phase, may be NULL when interpolation is 1 and
+  *                     b_coeffs is then used in place
+  * @param prev_inputs Pointer to the previous inputs, must hold FIR_POLYPHASE_FILTER_STATE_SIZE(num_coeffs, interpolation) entries
+  * @return FIR_POLYPHASE_FILTER_ERROR_OK on success, negative on error
+  */
+int fir_polyphase_filter_init(fir_polyphase_filter_t *filter, const filter_coeff_t *b_coeffs, unsigned int num_coeffs,
+                              unsigned int interpolation, unsigned int decimation, filter_coeff_t *phase_coeffs,
+                              filter_accum_t *prev_inputs);
+
+/**
+  * @brief Get the size of the prev_inputs buffer, FIR_POLYPHASE_FILTER_STATE_SIZE(num_coeffs, interpolation) entries
+  * @note The phase_coeffs buffer holds FIR_POLYPHASE_FILTER_COEFF_SIZE(num_coeffs, interpolation) coefficients.
+  * @param num_coeffs The number of coefficients
+  * @param interpolation Upsampling factor
+  * @return Size in bytes
+  */
+size_t fir_polyphase_filter_state_size(unsigned int num_coeffs, unsigned int interpolation);
+
+/**
+  * @brief Run the filter on the input value
+  * @param filter Pointer to the filter
+  * @param input Input value
+  * @param output Pointer to the output values, must hold FIR_POLYPHASE_FILTER_MAX_OUTPUTS(1, interpolation, decimation) values
+  * @param num_outputs Pointer to the number of outputs written, 0 for inputs that are decimated away
+  * @return FIR_POLYPHASE_FILTER_ERROR_OK on success, negative on error
+  */
+int fir_polyphase_filter_run(fir_polyphase_filter_t *filter, filter_data_t input, filter_data_t *output, size_t *num_outputs);
+
+/**
+  * @brief Run the filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param num_samples Number of input values
+  * @param output Pointer to the output values, must hold FIR_POLYPHASE_FILTER_MAX_OUTPUTS(num_samples, interpolation,
+  *               decimation) values. May be the same buffer as input when interpolation <= decimation
+  * @param num_outputs Pointer to the number of outputs written
+  * @return FIR_POLYPHASE_FILTER_ERROR_OK on success, negative on error
+  */
+int fir_polyphase_filter_run_block(fir_polyphase_filter_t *filter, const filter_data_t *input, size_t num_samples,
+                                   filter_data_t *output, size_t *num_outputs);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FIR_POLYPHASE_H_ */
@@ -1,6 +1,31 @@
 #include "iir_filter.h"
+#include <math.h>
 #include <string.h>
 
+size_t iir_filter_state_size(unsigned int num_coeffs)
+{
+    return sizeof(filter_accum_t) * num_coeffs;
+}
+
+size_t iir_biquad_filter_state_size(unsigned int num_sections, unsigned int form)
+{
+    size_t entries = (form == IIR_BIQUAD_FORM_DF2T) ? IIR_BIQUAD_DF2T_STATE_SIZE((size_t)num_sections) :
+                                                      IIR_BIQUAD_DF1_STATE_SIZE((size_t)num_sections);
+    return sizeof(filter_accum_t) * entries;
+}
+
+/**
+  * @brief Snap an output below IIR_FILTER_FLUSH_THRESHOLD to zero, see iir_filter_set_flush_denormals()
+  */
+static inline filter_accum_t iir_filter_flush(filter_accum_t value)
+{
+#if defined(FILTER_USE_FLOAT_MATH)
+    return (fabs(value) < IIR_FILTER_FLUSH_THRESHOLD) ? 0.0 : value;
+#else
+    return value;
+#endif /* FILTER_USE_FLOAT_MATH */
+}
+
 int iir_filter_init(iir_filter_t *filter, filter_coeff_t *b_coeffs, filter_coeff_t *a_coeffs, filter_accum_t *prev_inputs, filter_accum_t *prev_outputs, unsigned int filter_order)
 {
     if (!filter || !b_coeffs || !a_coeffs || !prev_inputs || !prev_outputs || filter_order == 0) {
@@ -13,45 +38,112 @@ int iir_filter_init(iir_filter_t *filter, filter_coeff_t *b_coeffs, filter_coeff
     filter->prev_outputs = prev_outputs;
     filter->num_coeffs = filter_order;
     filter->count = 0;
+    filter->flush_denormals = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
     memset(filter->prev_inputs, 0, sizeof(filter_accum_t) * filter_order);
     memset(filter->prev_outputs, 0, sizeof(filter_accum_t) * filter_order);
 
     return IIR_FILTER_ERROR_OK;
 }
 
-int iir_filter_run(iir_filter_t *filter, filter_data_t input, filter_data_t *output)
+int iir_filter_set_flush_denormals(iir_filter_t *filter, unsigned int enable)
 {
-    if (!filter || !output) {
+    if (!filter) {
         return IIR_FILTER_ERROR_INVALID_PARAM;
     }
+    filter->flush_denormals = enable ? 1 : 0;
 
-    filter_accum_t in = (filter_accum_t)input;
-    filter_accum_t new_output = (filter->b_coeffs[0] * in);
-    for (int i = 1; i <= filter->num_coeffs; i++)
-    {
-        new_output += (filter->b_coeffs[i] * filter->prev_inputs[i - 1]) - (filter->a_coeffs[i] * filter->prev_outputs[i - 1]);
+    return IIR_FILTER_ERROR_OK;
+}
+
+int iir_filter_run(iir_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    int ret = iir_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
     }
 
-    // Shift the buffer contents
-    for (int i = filter->num_coeffs - 1; i > 0; i--)
+    return (ret > 0) ? IIR_FILTER_ERROR_INVALID_OUTPUT : IIR_FILTER_ERROR_OK;
+}
+
+/**
+  * @brief Direct form recursion, the previous inputs and outputs are shifted down on every sample
+  */
+static inline void iir_filter_run_direct(iir_filter_t *filter, const filter_data_t *input, filter_data_t *output,
+                                         size_t num_samples, const unsigned int flush)
+{
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    const filter_coeff_t *b_coeffs = filter->b_coeffs;
+    const filter_coeff_t *a_coeffs = filter->a_coeffs;
+    filter_accum_t       *prev_inputs = filter->prev_inputs;
+    filter_accum_t       *prev_outputs = filter->prev_outputs;
+    const unsigned int    num_coeffs = filter->num_coeffs;
+
+    for (size_t n = 0; n < num_samples; n++)
     {
-        filter->prev_inputs[i] = filter->prev_inputs[i - 1];
-        filter->prev_outputs[i] = filter->prev_outputs[i - 1];
+        filter_accum_t in = (filter_accum_t)input[n];
+        filter_accum_t new_output = FILTER_MUL(b_coeffs[0], in);
+        for (unsigned int i = 1; i <= num_coeffs; i++)
+        {
+            new_output += FILTER_MUL(b_coeffs[i], prev_inputs[i - 1]) - FILTER_MUL(a_coeffs[i], prev_outputs[i - 1]);
+        }
+        new_output = filter_accum_rescale(new_output);
+        if (flush) {
+            new_output = iir_filter_flush(new_output);
+        }
+
+        // Shift the buffer contents
+        for (unsigned int i = num_coeffs - 1; i > 0; i--)
+        {
+            prev_inputs[i] = prev_inputs[i - 1];
+            prev_outputs[i] = prev_outputs[i - 1];
+        }
+        prev_inputs[0] = in;
+        prev_outputs[0] = new_output;
+
+        // Assign the calculated output
+        output[n] = (filter_data_t)new_output;
     }
-    filter->prev_inputs[0] = in;
-    filter->prev_outputs[0] = new_output;
+}
 
-    // Assign the calculated output
-    *output = (filter_data_t)new_output;
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief iir_filter_run_block() without the instrumentation
+  */
+static int iir_filter_run_kernel(iir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#else
+int iir_filter_run_block(iir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!filter || !input || !output) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
 
-    // Increment the state up to the filter order
-    if (filter->count < filter->num_coeffs) {
-        filter->count++;
-        return IIR_FILTER_ERROR_INVALID_OUTPUT;
+    // flush is a constant at each call so the exact kernel has no snap at all
+    if (filter->flush_denormals) {
+        iir_filter_run_direct(filter, input, output, num_samples, 1);
+    } else {
+        iir_filter_run_direct(filter, input, output, num_samples, 0);
     }
 
-    return IIR_FILTER_ERROR_OK;
+    // Report the warm up boundary once for the whole block, the first num_coeffs outputs are invalid
+    return (int)filter_warmup_advance(&filter->count, filter->num_coeffs, num_samples);
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int iir_filter_run_block(iir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = iir_filter_run_kernel(filter, input, output, num_samples);
+    if (ret >= 0) {
+        filter_stats_end(&filter->stats, &mark, output, num_samples, ret);
+    }
+    return ret;
 }
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 
 #include "iir_config.h"
 #include <stdio.h>
@@ -65,49 +157,481 @@ int iir_biquad_filter_init(iir_biquad_filter_t *filter, filter_coeff_t (*sos_coe
     filter->delay_elements = delay_elements;
     filter->num_coeffs = filter_order;
     filter->count = 0;
-    memset(filter->delay_elements, 0, sizeof(filter_accum_t) * (filter->num_coeffs * 4));
+    filter->flush_denormals = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+    filter->form = IIR_BIQUAD_FORM_DF1;
+    filter->normalized = 1;
+    memset(filter->delay_elements, 0, sizeof(filter_accum_t) * IIR_BIQUAD_DF1_STATE_SIZE(filter->num_coeffs));
+
+    return IIR_FILTER_ERROR_OK;
+}
+
+int iir_biquad_filter_init_df2t(iir_biquad_filter_t *filter, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *delay_elements, unsigned int num_sections)
+{
+    if (!filter || !sos_coeffs || !delay_elements || num_sections == 0) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->sos_coeffs = sos_coeffs;
+    filter->delay_elements = delay_elements;
+    filter->num_coeffs = num_sections;
+    filter->count = 0;
+    filter->flush_denormals = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+    filter->form = IIR_BIQUAD_FORM_DF2T;
+
+    // Only pay for the a0 division when a section actually needs it
+    filter->normalized = 1;
+    for (unsigned int i = 0; i < num_sections; i++)
+    {
+        if (sos_coeffs[i][3] == 0) {
+            return IIR_FILTER_ERROR_INVALID_PARAM;
+        }
+        if (sos_coeffs[i][3] != FILTER_COEFF_ONE) {
+#if defined(FILTER_USE_INTEGER_MATH)
+            // The integer kernels never divide, a0 must be exactly one
+            return IIR_FILTER_ERROR_INVALID_PARAM;
+#else
+            filter->normalized = 0;
+#endif /* FILTER_USE_INTEGER_MATH */
+        }
+    }
+    memset(filter->delay_elements, 0, sizeof(filter_accum_t) * IIR_BIQUAD_DF2T_STATE_SIZE(num_sections));
+
+    return IIR_FILTER_ERROR_OK;
+}
+
+/**
+  * @brief Direct Form II Transposed biquad cascade, two state words per section
+  */
+static inline int iir_biquad_filter_run_df2t(iir_biquad_filter_t *filter, const filter_data_t *input, filter_data_t *output,
+                                             size_t num_samples, const unsigned int flush)
+{
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    filter_coeff_t(*sos_coeffs)[6] = filter->sos_coeffs;
+    filter_accum_t    *delay_elements = filter->delay_elements;
+    const unsigned int num_sections = filter->num_coeffs;
+    const int          normalized = filter->normalized;
+
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        filter_accum_t  new_output = (filter_accum_t)input[n];
+        filter_accum_t *state = delay_elements;
+        for (unsigned int i = 0; i < num_sections; i++)
+        {
+            // y = (b0 * x + s1) / a0, s1 = b1 * x - a1 * y + s2, s2 = b2 * x - a2 * y
+            filter_accum_t in = new_output;
+            new_output = FILTER_MUL(sos_coeffs[i][0], in) + state[0];
+            if (!normalized) {
+                new_output /= sos_coeffs[i][3];
+            }
+            new_output = filter_accum_rescale(new_output);
+            if (flush) {
+                new_output = iir_filter_flush(new_output);
+            }
+            state[0] = FILTER_MUL(sos_coeffs[i][1], in) - FILTER_MUL(sos_coeffs[i][4], new_output) + state[1];
+            state[1] = FILTER_MUL(sos_coeffs[i][2], in) - FILTER_MUL(sos_coeffs[i][5], new_output);
+            state += 2;
+        }
+
+        // Assign the calculated output
+        output[n] = (filter_data_t)new_output;
+    }
+
+    // Report the warm up boundary once for the whole block, the DF2T cascade settles after its filter order
+    return (int)filter_warmup_advance(&filter->count, num_sections * 2, num_samples);
+}
+
+int iir_biquad_filter_set_flush_denormals(iir_biquad_filter_t *filter, unsigned int enable)
+{
+    if (!filter) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+    filter->flush_denormals = enable ? 1 : 0;
 
     return IIR_FILTER_ERROR_OK;
 }
 
 int iir_biquad_filter_run(iir_biquad_filter_t *filter, filter_data_t input, filter_data_t *output)
 {
-    if (!filter || !output) {
+    int ret = iir_biquad_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? IIR_FILTER_ERROR_INVALID_OUTPUT : IIR_FILTER_ERROR_OK;
+}
+
+/**
+  * @brief Direct Form I biquad cascade, four state words per section
+  */
+static inline int iir_biquad_filter_run_df1(iir_biquad_filter_t *filter, const filter_data_t *input, filter_data_t *output,
+                                            size_t num_samples, const unsigned int flush)
+{
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    filter_coeff_t(*sos_coeffs)[6] = filter->sos_coeffs;
+    filter_accum_t    *delay_elements = filter->delay_elements;
+    const unsigned int num_sections = filter->num_coeffs;
+
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        filter_accum_t new_output = (filter_accum_t)input[n];
+        filter_accum_t *delay = delay_elements;
+        for (unsigned int i = 0; i < num_sections; i++)
+        {
+            // This is the filter equation
+            // output = b0 * input + b1 * delay0 + b2 * delay1 - a1 * delay0 - a2 * delay1
+            filter_accum_t w0 = FILTER_MUL(sos_coeffs[i][0], new_output) +
+                                FILTER_MUL(sos_coeffs[i][1], delay[0]) +
+                                FILTER_MUL(sos_coeffs[i][2], delay[1]);
+            filter_accum_t w1 = FILTER_MUL(sos_coeffs[i][4], delay[2]) +
+                                FILTER_MUL(sos_coeffs[i][5], delay[3]);
+
+            // Move the delay terms up
+            delay[1] = delay[0];
+            delay[0] = new_output;
+            delay[3] = delay[2];
+
+            // Set the output
+            new_output = filter_accum_rescale(w0 - w1);
+            if (flush) {
+                new_output = iir_filter_flush(new_output);
+            }
+            delay[2] = new_output;
+            delay += 4;
+        }
+
+        // Assign the calculated output
+        output[n] = (filter_data_t)new_output;
+    }
+
+    // Report the warm up boundary once for the whole block
+    return (int)filter_warmup_advance(&filter->count, num_sections * 4, num_samples);
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief iir_biquad_filter_run_block() without the instrumentation
+  */
+static int iir_biquad_filter_run_kernel(iir_biquad_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#else
+int iir_biquad_filter_run_block(iir_biquad_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!filter || !input || !output) {
         return IIR_FILTER_ERROR_INVALID_PARAM;
     }
 
-    filter_accum_t in = (filter_accum_t)input;
-    filter_accum_t new_output = in;
-    int            delay_index = 0;
-    for (int i = 0; i < filter->num_coeffs; i++)
+    // flush is a constant at each call so the exact kernels have no snap at all
+    if (filter->form == IIR_BIQUAD_FORM_DF2T) {
+        return filter->flush_denormals ? iir_biquad_filter_run_df2t(filter, input, output, num_samples, 1) :
+                                         iir_biquad_filter_run_df2t(filter, input, output, num_samples, 0);
+    }
+
+    return filter->flush_denormals ? iir_biquad_filter_run_df1(filter, input, output, num_samples, 1) :
+                                     iir_biquad_filter_run_df1(filter, input, output, num_samples, 0);
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int iir_biquad_filter_run_block(iir_biquad_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = iir_biquad_filter_run_kernel(filter, input, output, num_samples);
+    if (ret >= 0) {
+        filter_stats_end(&filter->stats, &mark, output, num_samples, ret);
+    }
+    return ret;
+}
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+
+// State below this fraction of the peak of the impulse response is taken as settled
+#define IIR_FILTER_SETTLE_EPSILON 1e-20
+
+static double iir_filter_coeff_to_double(filter_coeff_t coeff)
+{
+    return (double)coeff / (double)FILTER_COEFF_ONE;
+}
+
+/**
+  * @brief Impulse response of a direct form or biquad filter in double precision, one sample per call
+  */
+typedef struct
+{
+    unsigned int order;
+    unsigned int num_sections;
+    double       b[IIR_FILTER_SETTLE_MAX_ORDER + 1];
+    double       a[IIR_FILTER_SETTLE_MAX_ORDER + 1];
+    double       outputs[IIR_FILTER_SETTLE_MAX_ORDER];
+    double       sos[IIR_FILTER_SETTLE_MAX_SECTIONS][6];
+    double       state[IIR_FILTER_SETTLE_MAX_SECTIONS][2];
+    size_t       n;
+} iir_filter_impulse_t;
+
+static void iir_filter_impulse_reset(iir_filter_impulse_t *impulse)
+{
+    memset(impulse->outputs, 0, sizeof(impulse->outputs));
+    memset(impulse->state, 0, sizeof(impulse->state));
+    impulse->n = 0;
+}
+
+/**
+  * @brief Get the next sample of the impulse response
+  * @param state Set to the largest magnitude of the state after the sample
+  */
+static double iir_filter_impulse_next(iir_filter_impulse_t *impulse, double *state)
+{
+    double x = (impulse->n == 0) ? 1.0 : 0.0;
+    double y;
+    *state = 0.0;
+
+    if (impulse->num_sections == 0) {
+        // The inputs of an impulse are only non zero at n = 0, so the numerator adds b[n]
+        y = (impulse->n <= impulse->order) ? impulse->b[impulse->n] : 0.0;
+        for (unsigned int i = 1; i <= impulse->order; i++)
+        {
+            y -= impulse->a[i] * impulse->outputs[i - 1];
+        }
+        for (unsigned int i = impulse->order - 1; i > 0; i--)
+        {
+            impulse->outputs[i] = impulse->outputs[i - 1];
+        }
+        impulse->outputs[0] = y;
+        for (unsigned int i = 0; i < impulse->order; i++)
+        {
+            *state = fmax(*state, fabs(impulse->outputs[i]));
+        }
+        // The numerator still has inputs to add
+        if (impulse->n < impulse->order) {
+            *state = INFINITY;
+        }
+    } else {
+        // Transposed direct form II, the structure does not change the response
+        y = x;
+        for (unsigned int i = 0; i < impulse->num_sections; i++)
+        {
+            const double *c = impulse->sos[i];
+            double       *s = impulse->state[i];
+            double        out = (c[0] * y) + s[0];
+            s[0] = (c[1] * y) - (c[4] * out) + s[1];
+            s[1] = (c[2] * y) - (c[5] * out);
+            *state = fmax(*state, fmax(fabs(s[0]), fabs(s[1])));
+            y = out;
+        }
+    }
+    impulse->n++;
+
+    return y;
+}
+
+/**
+  * @brief Follow an impulse response from its start until the state has decayed and sum its magnitude
+  * @param total Set to the sum of |h[n]|
+  * @param length Set to the number of samples followed
+  * @return IIR_FILTER_ERROR_OK, IIR_FILTER_ERROR_INVALID_OUTPUT if the response does not decay
+  */
+static int iir_filter_impulse_sum(iir_filter_impulse_t *impulse, double *total, size_t *length)
+{
+    double compensation = 0.0;
+    double peak = 0.0;
+    *total = 0.0;
+    *length = 0;
+    for (;;)
     {
-        // This is the filter equation
-        // output = b0 * input + b1 * delay0 + b2 * delay1 - a1 * delay0 - a2 * delay1
-        filter_accum_t w0 = (filter->sos_coeffs[i][0] * new_output) +
-                            (filter->sos_coeffs[i][1] * filter->delay_elements[delay_index]) +
-                            (filter->sos_coeffs[i][2] * filter->delay_elements[delay_index + 1]);
-        filter_accum_t w1 = (filter->sos_coeffs[i][4] * filter->delay_elements[delay_index + 2]) +
-                            (filter->sos_coeffs[i][5] * filter->delay_elements[delay_index + 3]);
-
-        // Move the delay terms up
-        filter->delay_elements[delay_index + 1] = filter->delay_elements[delay_index];
-        filter->delay_elements[delay_index] = new_output;
-        filter->delay_elements[delay_index + 3] = filter->delay_elements[delay_index + 2];
-
-        // Set the output
-        new_output = w0 - w1;
-        filter->delay_elements[delay_index + 2] = new_output;
-        delay_index += 4;
-    }
-
-    // Assign the calculated output
-    *output = (filter_data_t)new_output;
-
-    // Increment the state up to the filter order
-    if (filter->count < (filter->num_coeffs * 4)) {
-        filter->count++;
+        double state;
+        double h = fabs(iir_filter_impulse_next(impulse, &state));
+        if (!isfinite(h) || *length >= IIR_FILTER_SETTLE_MAX_LENGTH) {
+            return IIR_FILTER_ERROR_INVALID_OUTPUT;
+        }
+        double term = h - compensation;
+        double sum = *total + term;
+        compensation = (sum - *total) - term;
+        *total = sum;
+        peak = fmax(peak, h);
+        (*length)++;
+        if (state <= IIR_FILTER_SETTLE_EPSILON * peak) {
+            return IIR_FILTER_ERROR_OK;
+        }
+    }
+}
+
+static int iir_filter_settle(iir_filter_impulse_t *impulse, double tolerance)
+{
+    // First pass, follow the response until the state has decayed and sum its magnitude
+    double total;
+    size_t length;
+    if (iir_filter_impulse_sum(impulse, &total, &length) != IIR_FILTER_ERROR_OK) {
         return IIR_FILTER_ERROR_INVALID_OUTPUT;
     }
 
+    // Second pass, the settle length is where the rest of the sum drops to the tolerance
+    double prefix = 0.0;
+    double compensation = 0.0;
+    iir_filter_impulse_reset(impulse);
+    for (size_t n = 0; n < length; n++)
+    {
+        if (total - prefix <= tolerance) {
+            return (int)n;
+        }
+        double state;
+        double term = fabs(iir_filter_impulse_next(impulse, &state)) - compensation;
+        double sum = prefix + term;
+        compensation = (sum - prefix) - term;
+        prefix = sum;
+    }
+
+    return (int)length;
+}
+
+/**
+  * @brief Set up the impulse response of a direct form filter
+  * @return IIR_FILTER_ERROR_OK, negative on error
+  */
+static int iir_filter_impulse_init(iir_filter_impulse_t *impulse, const filter_coeff_t *b_coeffs,
+                                   const filter_coeff_t *a_coeffs, unsigned int num_coeffs)
+{
+    if (!b_coeffs || !a_coeffs || num_coeffs == 0 || num_coeffs > IIR_FILTER_SETTLE_MAX_ORDER) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    impulse->order = num_coeffs;
+    impulse->num_sections = 0;
+    for (unsigned int i = 0; i <= num_coeffs; i++)
+    {
+        impulse->b[i] = iir_filter_coeff_to_double(b_coeffs[i]);
+        impulse->a[i] = iir_filter_coeff_to_double(a_coeffs[i]);
+    }
+    iir_filter_impulse_reset(impulse);
+
+    return IIR_FILTER_ERROR_OK;
+}
+
+/**
+  * @brief Set up the impulse response of a biquad cascade, every section divided by its a0 in the DF2T form
+  * @return IIR_FILTER_ERROR_OK, negative on error
+  */
+static int iir_filter_impulse_init_sos(iir_filter_impulse_t *impulse, filter_coeff_t (*sos_coeffs)[6],
+                                       unsigned int num_sections, unsigned int form)
+{
+    if (!sos_coeffs || num_sections == 0 || num_sections > IIR_FILTER_SETTLE_MAX_SECTIONS ||
+        (form != IIR_BIQUAD_FORM_DF1 && form != IIR_BIQUAD_FORM_DF2T)) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    impulse->order = 0;
+    impulse->num_sections = num_sections;
+    for (unsigned int i = 0; i < num_sections; i++)
+    {
+        double a0 = (form == IIR_BIQUAD_FORM_DF2T) ? iir_filter_coeff_to_double(sos_coeffs[i][3]) : 1.0;
+        if (a0 == 0.0) {
+            return IIR_FILTER_ERROR_INVALID_PARAM;
+        }
+        for (unsigned int j = 0; j < 6; j++)
+        {
+            impulse->sos[i][j] = iir_filter_coeff_to_double(sos_coeffs[i][j]) / a0;
+        }
+    }
+    iir_filter_impulse_reset(impulse);
+
+    return IIR_FILTER_ERROR_OK;
+}
+
+int iir_filter_settle_length(const filter_coeff_t *b_coeffs, const filter_coeff_t *a_coeffs, unsigned int num_coeffs,
+                             double tolerance)
+{
+    iir_filter_impulse_t impulse;
+
+    if (!(tolerance > 0.0)) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+    int ret = iir_filter_impulse_init(&impulse, b_coeffs, a_coeffs, num_coeffs);
+    if (ret != IIR_FILTER_ERROR_OK) {
+        return ret;
+    }
+
+    return iir_filter_settle(&impulse, tolerance);
+}
+
+int iir_biquad_filter_settle_length(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, unsigned int form,
+                                    double tolerance)
+{
+    iir_filter_impulse_t impulse;
+
+    if (!(tolerance > 0.0)) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+    int ret = iir_filter_impulse_init_sos(&impulse, sos_coeffs, num_sections, form);
+    if (ret != IIR_FILTER_ERROR_OK) {
+        return ret;
+    }
+
+    return iir_filter_settle(&impulse, tolerance);
+}
+
+int iir_filter_gain(const filter_coeff_t *b_coeffs, const filter_coeff_t *a_coeffs, unsigned int num_coeffs,
+                    unsigned int source, double *gain)
+{
+    iir_filter_impulse_t impulse;
+    size_t               length;
+
+    if (!gain || (source != IIR_FILTER_GAIN_INPUT && source != IIR_FILTER_GAIN_ROUNDING)) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+    int ret = iir_filter_impulse_init(&impulse, b_coeffs, a_coeffs, num_coeffs);
+    if (ret != IIR_FILTER_ERROR_OK) {
+        return ret;
+    }
+
+    // The output is rounded after the numerator is added, its error only goes through 1 / A(z)
+    if (source == IIR_FILTER_GAIN_ROUNDING) {
+        memset(impulse.b, 0, sizeof(impulse.b));
+        impulse.b[0] = 1.0;
+    }
+
+    return iir_filter_impulse_sum(&impulse, gain, &length);
+}
+
+int iir_biquad_filter_gain(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, unsigned int form,
+                           unsigned int source, double *gain)
+{
+    iir_filter_impulse_t impulse;
+    double               sections[IIR_FILTER_SETTLE_MAX_SECTIONS][6];
+    size_t               length;
+
+    if (!gain || (source != IIR_FILTER_GAIN_INPUT && source != IIR_FILTER_GAIN_ROUNDING)) {
+        return IIR_FILTER_ERROR_INVALID_PARAM;
+    }
+    int ret = iir_filter_impulse_init_sos(&impulse, sos_coeffs, num_sections, form);
+    if (ret != IIR_FILTER_ERROR_OK) {
+        return ret;
+    }
+    if (source == IIR_FILTER_GAIN_INPUT) {
+        return iir_filter_impulse_sum(&impulse, gain, &length);
+    }
+
+    // Each section rounds its output once, that error goes through 1 / A(z) of the section and then through every
+    // later section
+    memcpy(sections, impulse.sos, sizeof(sections));
+    *gain = 0.0;
+    for (unsigned int i = 0; i < num_sections; i++)
+    {
+        double section_gain;
+        impulse.num_sections = num_sections - i;
+        memcpy(impulse.sos, &sections[i], sizeof(sections[0]) * (num_sections - i));
+        impulse.sos[0][0] = 1.0;
+        impulse.sos[0][1] = 0.0;
+        impulse.sos[0][2] = 0.0;
+        iir_filter_impulse_reset(&impulse);
+        ret = iir_filter_impulse_sum(&impulse, &section_gain, &length);
+        if (ret != IIR_FILTER_ERROR_OK) {
+            return ret;
+        }
+        *gain += section_gain;
+    }
+
     return IIR_FILTER_ERROR_OK;
 }
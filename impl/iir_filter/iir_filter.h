@@ -28,11 +28,35 @@ extern "C" {
 #endif /* __cplusplus */
 
 #include "../filter_types.h"
+#include "../filter_stats/filter_stats.h"
 
 #define IIR_FILTER_ERROR_OK             0
 #define IIR_FILTER_ERROR_INVALID_PARAM  -1
 #define IIR_FILTER_ERROR_INVALID_OUTPUT -2
 
+// Biquad structures
+#define IIR_BIQUAD_FORM_DF1             0
+#define IIR_BIQUAD_FORM_DF2T            1
+
+// Number of filter_accum_t entries required for the delay elements of each biquad structure
+#define IIR_BIQUAD_DF1_STATE_SIZE(num_sections)  (4 * (num_sections))
+#define IIR_BIQUAD_DF2T_STATE_SIZE(num_sections) (2 * (num_sections))
+
+// Smallest output magnitude a filter with iir_filter_set_flush_denormals() keeps, smaller outputs are snapped to zero.
+// Far above the subnormal range of double and of float, far below any signal the float build filters
+#define IIR_FILTER_FLUSH_THRESHOLD 1e-30
+
+// Longest impulse response iir_filter_settle_length() and iir_biquad_filter_settle_length() follow, and the largest
+// order and number of sections they accept, their state lives on the stack
+#define IIR_FILTER_SETTLE_MAX_LENGTH   (1 << 22)
+#define IIR_FILTER_SETTLE_MAX_ORDER    32
+#define IIR_FILTER_SETTLE_MAX_SECTIONS 32
+
+// Sources iir_filter_gain() and iir_biquad_filter_gain() measure the output against, the input or the rounding of
+// every output
+#define IIR_FILTER_GAIN_INPUT    0
+#define IIR_FILTER_GAIN_ROUNDING 1
+
 /**
   * @brief IIR filter structure
   */
@@ -40,10 +64,14 @@ typedef struct
 {
     unsigned int    num_coeffs;
     unsigned int    count;
+    unsigned int    flush_denormals;
     filter_coeff_t *b_coeffs;
     filter_coeff_t *a_coeffs;
     filter_accum_t *prev_inputs;
     filter_accum_t *prev_outputs;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t  stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 } iir_filter_t;
 
 /**
@@ -53,8 +81,14 @@ typedef struct
 {
     unsigned int num_coeffs;
     unsigned int count;
+    unsigned int form;
+    unsigned int normalized;
+    unsigned int flush_denormals;
     filter_coeff_t(*sos_coeffs)[6];
     filter_accum_t(*delay_elements);
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t  stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 } iir_biquad_filter_t;
 
 /**
@@ -69,6 +103,13 @@ typedef struct
   */
 int iir_filter_init(iir_filter_t *filter, filter_coeff_t *b_coeffs, filter_coeff_t *a_coeffs, filter_accum_t *prev_inputs, filter_accum_t *prev_outputs, unsigned int num_coeffs);
 
+/**
+  * @brief Get the size of each of the prev_inputs and prev_outputs buffers
+  * @param num_coeffs The number of coefficients that need to be applied, the filter order
+  * @return Size in bytes
+  */
+size_t iir_filter_state_size(unsigned int num_coeffs);
+
 /**
   * @brief Run an IIR filter on the input
   * @param filter Pointer to the filter
@@ -78,6 +119,31 @@ int iir_filter_init(iir_filter_t *filter, filter_coeff_t *b_coeffs, filter_coeff
   */
 int iir_filter_run(iir_filter_t *filter, filter_data_t input, filter_data_t *output);
 
+/**
+  * @brief Run an IIR filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs still inside the warm up window (0 when every output is valid), negative on error
+  */
+int iir_filter_run_block(iir_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief Snap the decaying tail of the filter to zero before it reaches the subnormal range
+  * @note Once the input goes quiet the outputs of a stable filter decay towards zero. In the floating point math
+  *       build they end up as subnormal doubles, which cost ten to a hundred times more per operation on x86.
+  *       With flushing on, every output smaller than IIR_FILTER_FLUSH_THRESHOLD is written and kept in the
+  *       state as exactly zero, so a quiet input runs at full speed. Outputs only change where the exact response
+  *       is within a small multiple of the threshold of zero. This costs one compare per output and works on
+  *       every target, unlike filter_simd_ftz_enter(). The integer builds have no subnormal values and ignore it.
+  *       Off after iir_filter_init().
+  * @param filter Pointer to the filter
+  * @param enable 1 to snap the tail to zero, 0 for the exact recursion
+  * @return IIR_FILTER_ERROR_OK on success, negative on error
+  */
+int iir_filter_set_flush_denormals(iir_filter_t *filter, unsigned int enable);
+
 /**
   * @brief Initialize the biquad filter
   * @param filter Pointer to the filter
@@ -87,6 +153,37 @@ int iir_filter_run(iir_filter_t *filter, filter_data_t input, filter_data_t *out
   */
 int iir_biquad_filter_init(iir_biquad_filter_t *filter, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *delay_elements, unsigned int num_coeffs);
 
+/**
+  * @brief Initialize the biquad filter as a Direct Form II Transposed cascade
+  * @note DF2T keeps two state words per section instead of four and honors a0 (sos_coeffs[i][3]). The
+  *       integer builds reject any a0 other than FILTER_COEFF_ONE. The first 2 * num_sections outputs are
+  *       reported as warm up.
+  * @param filter Pointer to the filter
+  * @param sos_coeffs Pointer to the second order section coefficients, b0 b1 b2 a0 a1 a2 per section
+  * @param delay_elements Pointer to the state, must hold IIR_BIQUAD_DF2T_STATE_SIZE(num_sections) entries
+  * @param num_sections The number of second order sections
+  * @return IIR_FILTER_ERROR_OK on success, negative on error
+  */
+int iir_biquad_filter_init_df2t(iir_biquad_filter_t *filter, filter_coeff_t (*sos_coeffs)[6], filter_accum_t *delay_elements, unsigned int num_sections);
+
+/**
+  * @brief Get the size of the delay elements of a biquad cascade
+  * @param num_sections The number of second order sections
+  * @param form IIR_BIQUAD_FORM_DF1 for iir_biquad_filter_init(), IIR_BIQUAD_FORM_DF2T for iir_biquad_filter_init_df2t()
+  * @return Size in bytes
+  */
+size_t iir_biquad_filter_state_size(unsigned int num_sections, unsigned int form);
+
+/**
+  * @brief Snap the decaying tail of every section to zero before it reaches the subnormal range
+  * @note See iir_filter_set_flush_denormals(), the output of every section is snapped. A DF1 cascade with a quiet
+  *       input otherwise keeps cycling on the smallest subnormal double forever. Off after initialization.
+  * @param filter Pointer to the filter
+  * @param enable 1 to snap the tail to zero, 0 for the exact recursion
+  * @return IIR_FILTER_ERROR_OK on success, negative on error
+  */
+int iir_biquad_filter_set_flush_denormals(iir_biquad_filter_t *filter, unsigned int enable);
+
 /**
   * @brief Run a biquad filter on the input
   * @param filter Pointer to the filter
@@ -96,6 +193,82 @@ int iir_biquad_filter_init(iir_biquad_filter_t *filter, filter_coeff_t (*sos_coe
   */
 int iir_biquad_filter_run(iir_biquad_filter_t *filter, filter_data_t input, filter_data_t *output);
 
+/**
+  * @brief Run a biquad filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs still inside the warm up window (0 when every output is valid), negative on error
+  */
+int iir_biquad_filter_run_block(iir_biquad_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief Get the number of samples after which the state an IIR filter started with no longer matters
+  * @note The sum of |h[n]| for n >= the settle length is at most tolerance, h being the impulse response computed
+  *       in double precision. A filter started from zero state settle length samples before an output therefore
+  *       differs from the same filter run from the start of the signal by at most tolerance * max |x| at that
+  *       output and every later one. The integer builds round the output, which adds at most the rounding gain of
+  *       iir_filter_gain() in units of the data format, see there. This lets a long
+  *       signal be cut into chunks that are filtered in parallel, each chunk starting settle length samples early.
+  *       The impulse response is followed until the state falls below 1e-20 of its peak.
+  * @param b_coeffs Pointer to the num_coeffs + 1 numerator coefficients
+  * @param a_coeffs Pointer to the num_coeffs + 1 denominator coefficients, a_coeffs[0] is taken as one
+  * @param num_coeffs The filter order, at most IIR_FILTER_SETTLE_MAX_ORDER
+  * @param tolerance Largest error relative to the largest input, above 0
+  * @return Settle length in samples, IIR_FILTER_ERROR_INVALID_OUTPUT if the filter does not settle within
+  *         IIR_FILTER_SETTLE_MAX_LENGTH samples (an unstable or marginally stable filter), negative on error
+  */
+int iir_filter_settle_length(const filter_coeff_t *b_coeffs, const filter_coeff_t *a_coeffs, unsigned int num_coeffs,
+                             double tolerance);
+
+/**
+  * @brief Get the number of samples after which the state a biquad cascade started with no longer matters
+  * @note See iir_filter_settle_length() for the error bound
+  * @param sos_coeffs Pointer to the second order section coefficients, b0 b1 b2 a0 a1 a2 per section
+  * @param num_sections The number of second order sections, at most IIR_FILTER_SETTLE_MAX_SECTIONS
+  * @param form IIR_BIQUAD_FORM_DF1, which takes a0 as one, or IIR_BIQUAD_FORM_DF2T, which divides by a0
+  * @param tolerance Largest error relative to the largest input, above 0
+  * @return Settle length in samples, IIR_FILTER_ERROR_INVALID_OUTPUT if the cascade does not settle within
+  *         IIR_FILTER_SETTLE_MAX_LENGTH samples, negative on error
+  */
+int iir_biquad_filter_settle_length(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, unsigned int form,
+                                    double tolerance);
+
+/**
+  * @brief Get the largest output of an IIR filter per unit of input or per unit of rounding
+  * @note With IIR_FILTER_GAIN_INPUT the gain is the sum of |h[n]|, no output exceeds it times the largest input.
+  *       With IIR_FILTER_GAIN_ROUNDING it is the sum of |g[n]|, g being the response of 1 / A(z) that the rounding
+  *       of every output goes through. The integer builds round each output to the nearest unit of the data format,
+  *       so two runs of the same filter on the same input from different states, once the state has settled (see
+  *       iir_filter_settle_length()), differ by at most this gain in units, saturation aside. Computed in double
+  *       precision like the settle length.
+  * @param b_coeffs Pointer to the num_coeffs + 1 numerator coefficients
+  * @param a_coeffs Pointer to the num_coeffs + 1 denominator coefficients, a_coeffs[0] is taken as one
+  * @param num_coeffs The filter order, at most IIR_FILTER_SETTLE_MAX_ORDER
+  * @param source IIR_FILTER_GAIN_INPUT or IIR_FILTER_GAIN_ROUNDING
+  * @param gain Set to the gain
+  * @return IIR_FILTER_ERROR_OK, IIR_FILTER_ERROR_INVALID_OUTPUT if the response does not decay within
+  *         IIR_FILTER_SETTLE_MAX_LENGTH samples, negative on error
+  */
+int iir_filter_gain(const filter_coeff_t *b_coeffs, const filter_coeff_t *a_coeffs, unsigned int num_coeffs,
+                    unsigned int source, double *gain);
+
+/**
+  * @brief Get the largest output of a biquad cascade per unit of input or per unit of rounding
+  * @note See iir_filter_gain(). Every section rounds its output, the rounding gain adds up the response of each
+  *       section's 1 / A(z) followed by every later section.
+  * @param sos_coeffs Pointer to the second order section coefficients, b0 b1 b2 a0 a1 a2 per section
+  * @param num_sections The number of second order sections, at most IIR_FILTER_SETTLE_MAX_SECTIONS
+  * @param form IIR_BIQUAD_FORM_DF1, which takes a0 as one, or IIR_BIQUAD_FORM_DF2T, which divides by a0
+  * @param source IIR_FILTER_GAIN_INPUT or IIR_FILTER_GAIN_ROUNDING
+  * @param gain Set to the gain
+  * @return IIR_FILTER_ERROR_OK, IIR_FILTER_ERROR_INVALID_OUTPUT if the response does not decay within
+  *         IIR_FILTER_SETTLE_MAX_LENGTH samples, negative on error
+  */
+int iir_biquad_filter_gain(filter_coeff_t (*sos_coeffs)[6], unsigned int num_sections, unsigned int form,
+                           unsigned int source, double *gain);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
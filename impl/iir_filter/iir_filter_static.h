@@ -0,0 +1,139 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef IIR_FILTER_STATIC_H_
+#define IIR_FILTER_STATIC_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "iir_filter.h"
+#include <string.h>
+
+/**
+  * @brief Define a Direct Form I biquad cascade specialized for one static const coefficient table
+  * @note Expands to a filter type name##_t holding its own delay elements, plus name##_init() and
+  *       name##_run_block(). With a constant number of sections the section loop is unrolled and every
+  *       coefficient is folded into the code. Output and warm up are bit exact with iir_biquad_filter_init().
+  * @param name Prefix of the generated type and functions
+  * @param sos_coeffs The static const second order section table, b0 b1 b2 a0 a1 a2 per section
+  * @param num_sections The number of second order sections, a constant expression
+  */
+#define IIR_BIQUAD_STATIC_DEFINE(name, sos_coeffs, num_sections)                                                    \
+    typedef struct                                                                                                  \
+    {                                                                                                               \
+        unsigned int   count;                                                                                       \
+        filter_accum_t delay_elements[IIR_BIQUAD_DF1_STATE_SIZE(num_sections)];                                     \
+    } name##_t;                                                                                                     \
+                                                                                                                    \
+    static inline void name##_init(name##_t *filter)                                                                \
+    {                                                                                                               \
+        memset(filter, 0, sizeof(name##_t));                                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline int name##_run_block(name##_t *filter, const filter_data_t *input, filter_data_t *output,         \
+                                       size_t num_samples)                                                          \
+    {                                                                                                               \
+        for (size_t n = 0; n < num_samples; n++)                                                                    \
+        {                                                                                                           \
+            filter_accum_t  new_output = (filter_accum_t)input[n];                                                  \
+            filter_accum_t *delay = filter->delay_elements;                                                         \
+            for (unsigned int i = 0; i < (num_sections); i++)                                                       \
+            {                                                                                                       \
+                filter_accum_t w0 = FILTER_MUL((sos_coeffs)[i][0], new_output) +                                    \
+                                    FILTER_MUL((sos_coeffs)[i][1], delay[0]) +                                      \
+                                    FILTER_MUL((sos_coeffs)[i][2], delay[1]);                                       \
+                filter_accum_t w1 = FILTER_MUL((sos_coeffs)[i][4], delay[2]) +                                      \
+                                    FILTER_MUL((sos_coeffs)[i][5], delay[3]);                                       \
+                delay[1] = delay[0];                                                                                \
+                delay[0] = new_output;                                                                              \
+                delay[3] = delay[2];                                                                                \
+                new_output = filter_accum_rescale(w0 - w1);                                                         \
+                delay[2] = new_output;                                                                              \
+                delay += 4;                                                                                         \
+            }                                                                                                       \
+            output[n] = (filter_data_t)new_output;                                                                  \
+        }                                                                                                           \
+                                                                                                                    \
+        return (int)filter_warmup_advance(&filter->count, (num_sections) * 4, num_samples);                         \
+    }
+
+// Divide by a0 in the floating point builds, a0 is a constant so the test folds away per section
+#if defined(FILTER_USE_INTEGER_MATH)
+#define IIR_BIQUAD_STATIC_DF2T_NORMALIZE(new_output, a0)
+#else
+#define IIR_BIQUAD_STATIC_DF2T_NORMALIZE(new_output, a0) \
+    if ((a0) != FILTER_COEFF_ONE) {                      \
+        (new_output) /= (a0);                            \
+    }
+#endif /* FILTER_USE_INTEGER_MATH */
+
+/**
+  * @brief Define a Direct Form II Transposed biquad cascade specialized for one static const coefficient table
+  * @note Same as IIR_BIQUAD_STATIC_DEFINE for the structure of iir_biquad_filter_init_df2t(). The a0 division
+  *       is only compiled into sections whose a0 is not one, the integer builds expect every a0 to be
+  *       FILTER_COEFF_ONE.
+  * @param name Prefix of the generated type and functions
+  * @param sos_coeffs The static const second order section table, b0 b1 b2 a0 a1 a2 per section
+  * @param num_sections The number of second order sections, a constant expression
+  */
+#define IIR_BIQUAD_DF2T_STATIC_DEFINE(name, sos_coeffs, num_sections)                                               \
+    typedef struct                                                                                                  \
+    {                                                                                                               \
+        unsigned int   count;                                                                                       \
+        filter_accum_t delay_elements[IIR_BIQUAD_DF2T_STATE_SIZE(num_sections)];                                    \
+    } name##_t;                                                                                                     \
+                                                                                                                    \
+    static inline void name##_init(name##_t *filter)                                                                \
+    {                                                                                                               \
+        memset(filter, 0, sizeof(name##_t));                                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline int name##_run_block(name##_t *filter, const filter_data_t *input, filter_data_t *output,         \
+                                       size_t num_samples)                                                          \
+    {                                                                                                               \
+        for (size_t n = 0; n < num_samples; n++)                                                                    \
+        {                                                                                                           \
+            filter_accum_t  new_output = (filter_accum_t)input[n];                                                  \
+            filter_accum_t *state = filter->delay_elements;                                                         \
+            for (unsigned int i = 0; i < (num_sections); i++)                                                       \
+            {                                                                                                       \
+                filter_accum_t in = new_output;                                                                     \
+                new_output = FILTER_MUL((sos_coeffs)[i][0], in) + state[0];                                         \
+                IIR_BIQUAD_STATIC_DF2T_NORMALIZE(new_output, (sos_coeffs)[i][3])                                    \
+                new_output = filter_accum_rescale(new_output);                                                      \
+                state[0] = FILTER_MUL((sos_coeffs)[i][1], in) - FILTER_MUL((sos_coeffs)[i][4], new_output) + state[1]; \
+                state[1] = FILTER_MUL((sos_coeffs)[i][2], in) - FILTER_MUL((sos_coeffs)[i][5], new_output);         \
+                state += 2;                                                                                         \
+            }                                                                                                       \
+            output[n] = (filter_data_t)new_output;                                                                  \
+        }                                                                                                           \
+                                                                                                                    \
+        return (int)filter_warmup_advance(&filter->count, (num_sections) * 2, num_samples);                         \
+    }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* IIR_FILTER_STATIC_H_ */
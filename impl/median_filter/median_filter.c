@@ -0,0 +1,351 @@
+#include "median_filter.h"
+#include <string.h>
+
+// End of a level, also the width of a link to it is counted up to one past the last node
+#define MEDIAN_FILTER_NIL 0xFFFF
+
+// The list head, sample nodes start at 1
+#define MEDIAN_FILTER_HEAD 0
+
+/**
+  * @brief Order of two nodes, by value and then by node index so equal values still have a strict order
+  * @note NaN sorts above every number in the floating point build, the order has to stay total for the list links
+  */
+static inline int median_filter_less(const median_filter_node_t *nodes, unsigned int a, unsigned int b)
+{
+    filter_data_t va = nodes[a].value;
+    filter_data_t vb = nodes[b].value;
+#if defined(FILTER_USE_FLOAT_MATH)
+    if (va != va || vb != vb) {
+        if (va == va) {
+            return 1;
+        }
+        if (vb == vb) {
+            return 0;
+        }
+        return a < b;
+    }
+#endif /* FILTER_USE_FLOAT_MATH */
+    return (va < vb) || (va == vb && a < b);
+}
+
+/**
+  * @brief Link a node into the list, its value is already set
+  */
+static void median_filter_insert(median_filter_node_t *nodes, unsigned int node)
+{
+    unsigned int update[MEDIAN_FILTER_MAX_LEVELS];
+    unsigned int rank_at[MEDIAN_FILTER_MAX_LEVELS];
+    unsigned int x = MEDIAN_FILTER_HEAD;
+    unsigned int rank = 0;
+
+    for (int l = MEDIAN_FILTER_MAX_LEVELS - 1; l >= 0; l--)
+    {
+        while (nodes[x].next[l] != MEDIAN_FILTER_NIL && median_filter_less(nodes, nodes[x].next[l], node)) {
+            rank += nodes[x].width[l];
+            x = nodes[x].next[l];
+        }
+        update[l] = x;
+        rank_at[l] = rank;
+    }
+
+    // The new node lands at rank + 1, links above its height just get one step longer
+    const unsigned int levels = nodes[node].levels;
+    for (unsigned int l = 0; l < MEDIAN_FILTER_MAX_LEVELS; l++)
+    {
+        median_filter_node_t *prev = &nodes[update[l]];
+        if (l < levels) {
+            unsigned int before = rank - rank_at[l];
+            nodes[node].next[l] = prev->next[l];
+            nodes[node].width[l] = (uint16_t)(prev->width[l] - before);
+            prev->next[l] = (uint16_t)node;
+            prev->width[l] = (uint16_t)(before + 1);
+        } else {
+            prev->width[l]++;
+        }
+    }
+}
+
+/**
+  * @brief Unlink a node from the list
+  */
+static void median_filter_remove(median_filter_node_t *nodes, unsigned int node)
+{
+    unsigned int x = MEDIAN_FILTER_HEAD;
+
+    for (int l = MEDIAN_FILTER_MAX_LEVELS - 1; l >= 0; l--)
+    {
+        while (nodes[x].next[l] != MEDIAN_FILTER_NIL && median_filter_less(nodes, nodes[x].next[l], node)) {
+            x = nodes[x].next[l];
+        }
+
+        median_filter_node_t *prev = &nodes[x];
+        if (prev->next[l] == node) {
+            prev->width[l] = (uint16_t)(prev->width[l] + nodes[node].width[l] - 1);
+            prev->next[l] = nodes[node].next[l];
+        } else {
+            prev->width[l]--;
+        }
+    }
+}
+
+/**
+  * @brief Find the value at a rank
+  * @param rank 1 based rank, 1 is the smallest value
+  */
+static filter_data_t median_filter_select(const median_filter_node_t *nodes, unsigned int rank)
+{
+    unsigned int x = MEDIAN_FILTER_HEAD;
+    unsigned int position = 0;
+
+    for (int l = MEDIAN_FILTER_MAX_LEVELS - 1; l >= 0; l--)
+    {
+        while (nodes[x].next[l] != MEDIAN_FILTER_NIL && position + nodes[x].width[l] <= rank) {
+            position += nodes[x].width[l];
+            x = nodes[x].next[l];
+        }
+    }
+
+    return nodes[x].value;
+}
+
+/**
+  * @brief Replace the oldest sample of the window with a new one
+  */
+static void median_filter_push(median_filter_t *filter, filter_data_t input)
+{
+    median_filter_node_t *nodes = filter->nodes;
+    unsigned int          node = filter->index + 1;
+
+    if (filter->count == filter->size) {
+        median_filter_remove(nodes, node);
+    } else {
+        filter->count++;
+    }
+    nodes[node].value = input;
+    median_filter_insert(nodes, node);
+
+    filter->index = (filter->index + 1 == filter->size) ? 0 : (filter->index + 1);
+}
+
+/**
+  * @brief Median of the samples in the window, even counts average the two middle values
+  */
+static filter_data_t median_filter_median(const median_filter_t *filter)
+{
+    const unsigned int count = filter->count;
+    filter_data_t      upper = median_filter_select(filter->nodes, (count / 2) + 1);
+
+    if (count & 1) {
+        return upper;
+    }
+
+    filter_accum_t sum = (filter_accum_t)median_filter_select(filter->nodes, count / 2) + (filter_accum_t)upper;
+#if defined(FILTER_USE_INTEGER_MATH)
+    return (filter_data_t)filter_accum_round_shift(sum, 1);
+#else
+    return (filter_data_t)(sum * (filter_accum_t)0.5);
+#endif /* FILTER_USE_INTEGER_MATH */
+}
+
+size_t median_filter_state_size(unsigned int size)
+{
+    return sizeof(median_filter_node_t) * MEDIAN_FILTER_NUM_NODES((size_t)size);
+}
+
+int median_filter_init(median_filter_t *filter, median_filter_node_t *nodes, unsigned int size)
+{
+    if (!filter || !nodes || size == 0 || size > MEDIAN_FILTER_MAX_SIZE) {
+        return MEDIAN_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->nodes = nodes;
+    filter->size = size;
+
+    // Draw the node heights once, each level keeps one in four nodes of the level below. A fixed xorshift seed
+    // keeps the list shape, and so the run time, the same from run to run
+    uint32_t seed = 0x9E3779B9u;
+    nodes[MEDIAN_FILTER_HEAD].levels = MEDIAN_FILTER_MAX_LEVELS;
+    for (unsigned int i = 1; i <= size; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        uint8_t  levels = 1;
+        uint32_t bits = seed;
+        while (levels < MEDIAN_FILTER_MAX_LEVELS && (bits & 3) == 0) {
+            levels++;
+            bits >>= 2;
+        }
+        nodes[i].levels = levels;
+    }
+
+    return median_filter_reset(filter);
+}
+
+int median_filter_run(median_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    int ret = median_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? MEDIAN_FILTER_ERROR_INVALID_OUTPUT : MEDIAN_FILTER_ERROR_OK;
+}
+
+int median_filter_run_block(median_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    if (!filter || !input || !output) {
+        return MEDIAN_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    // An output is only valid once the window is full, work out the boundary for the whole block up front
+    size_t invalid = (filter->count < filter->size) ? (size_t)(filter->size - filter->count - 1) : 0;
+    if (invalid > num_samples) {
+        invalid = num_samples;
+    }
+
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        median_filter_push(filter, input[n]);
+        output[n] = median_filter_median(filter);
+    }
+
+    return (int)invalid;
+}
+
+int median_filter_reset(median_filter_t *filter)
+{
+    if (!filter) {
+        return MEDIAN_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    // An empty list, every head link runs to the end one step past the last node
+    median_filter_node_t *head = &filter->nodes[MEDIAN_FILTER_HEAD];
+    for (unsigned int l = 0; l < MEDIAN_FILTER_MAX_LEVELS; l++)
+    {
+        head->next[l] = MEDIAN_FILTER_NIL;
+        head->width[l] = 1;
+    }
+    filter->index = 0;
+    filter->count = 0;
+
+    return MEDIAN_FILTER_ERROR_OK;
+}
+
+/**
+  * @brief Median absolute deviation of a full odd window around its median
+  * @note The distances below the median grow as the rank falls and the distances above it grow as the rank
+  *       rises, the MAD is the (size + 1) / 2'th smallest of the two sorted runs. It is found with a binary search
+  *       on how many distances come from the lower run, each probe selects two ranks.
+  */
+static filter_accum_t hampel_filter_mad(const median_filter_t *filter, filter_data_t median)
+{
+    const median_filter_node_t *nodes = filter->nodes;
+    const unsigned int          middle = (filter->size + 1) / 2;
+    const unsigned int          num_lower = middle;
+    const unsigned int          num_upper = filter->size - middle;
+    const unsigned int          k = middle;
+
+    // lower[i] = median - value at rank middle - i, upper[j] = value at rank middle + 1 + j - median
+#define HAMPEL_LOWER(i) ((filter_accum_t)median - (filter_accum_t)median_filter_select(nodes, middle - (i)))
+#define HAMPEL_UPPER(j) ((filter_accum_t)median_filter_select(nodes, middle + 1 + (j)) - (filter_accum_t)median)
+    unsigned int lo = (k > num_upper) ? (k - num_upper) : 0;
+    unsigned int hi = (k < num_lower) ? k : num_lower;
+    for (;;)
+    {
+        unsigned int i = lo + ((hi - lo) / 2);
+        unsigned int j = k - i;
+        if (i > 0 && j < num_upper && HAMPEL_LOWER(i - 1) > HAMPEL_UPPER(j)) {
+            hi = i - 1;
+        } else if (j > 0 && i < num_lower && HAMPEL_UPPER(j - 1) > HAMPEL_LOWER(i)) {
+            lo = i + 1;
+        } else {
+            filter_accum_t from_lower = (i > 0) ? HAMPEL_LOWER(i - 1) : 0;
+            filter_accum_t from_upper = (j > 0) ? HAMPEL_UPPER(j - 1) : 0;
+            return (from_lower > from_upper) ? from_lower : from_upper;
+        }
+    }
+#undef HAMPEL_LOWER
+#undef HAMPEL_UPPER
+}
+
+int hampel_filter_init(hampel_filter_t *filter, median_filter_node_t *nodes, unsigned int size, unsigned int threshold)
+{
+    if (!filter || size < 3 || !(size & 1)) {
+        return MEDIAN_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    int ret = median_filter_init(&filter->median, nodes, size);
+    if (ret != MEDIAN_FILTER_ERROR_OK) {
+        return ret;
+    }
+    filter->threshold = threshold;
+
+    return hampel_filter_reset(filter);
+}
+
+int hampel_filter_run(hampel_filter_t *filter, filter_data_t input, filter_data_t *output)
+{
+    int ret = hampel_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? MEDIAN_FILTER_ERROR_INVALID_OUTPUT : MEDIAN_FILTER_ERROR_OK;
+}
+
+int hampel_filter_run_block(hampel_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    if (!filter || !input || !output) {
+        return MEDIAN_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    median_filter_t   *median = &filter->median;
+    const unsigned int size = median->size;
+    const unsigned int half = size / 2;
+    const filter_accum_t threshold = (filter_accum_t)filter->threshold;
+
+    size_t invalid = filter_warmup_advance(&filter->count, size - 1, num_samples);
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        median_filter_push(median, input[n]);
+        if (n < invalid) {
+            output[n] = 0;
+            continue;
+        }
+
+        // The center sample went in half samples ago, index already points one past the newest
+        unsigned int center = median->index + size - 1 - half;
+        if (center >= size) {
+            center -= size;
+        }
+        filter_data_t  value = median->nodes[center + 1].value;
+        filter_data_t  middle = median_filter_select(median->nodes, half + 1);
+        filter_accum_t deviation = (filter_accum_t)value - (filter_accum_t)middle;
+        if (deviation < 0) {
+            deviation = -deviation;
+        }
+
+        // |x - median| > threshold / 256 * MAD, kept in integers so the integer builds never divide
+        if (deviation * 256 > threshold * hampel_filter_mad(median, middle)) {
+            value = middle;
+            filter->num_outliers++;
+        }
+        output[n] = value;
+    }
+
+    return (int)invalid;
+}
+
+int hampel_filter_reset(hampel_filter_t *filter)
+{
+    if (!filter) {
+        return MEDIAN_FILTER_ERROR_INVALID_PARAM;
+    }
+
+    filter->count = 0;
+    filter->num_outliers = 0;
+
+    return median_filter_reset(&filter->median);
+}
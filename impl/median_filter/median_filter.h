@@ -0,0 +1,177 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef MEDIAN_FILTER_H_
+#define MEDIAN_FILTER_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+#define MEDIAN_FILTER_ERROR_OK             0
+#define MEDIAN_FILTER_ERROR_INVALID_PARAM  -1
+#define MEDIAN_FILTER_ERROR_INVALID_OUTPUT -2
+
+// Skiplist levels, each level links roughly a quarter of the nodes of the level below
+#define MEDIAN_FILTER_MAX_LEVELS 8
+
+// Largest window, node links are 16 bit
+#define MEDIAN_FILTER_MAX_SIZE   65534
+
+// Number of median_filter_node_t entries required for a window of size samples, the extra node is the list head
+#define MEDIAN_FILTER_NUM_NODES(size) ((size) + 1)
+
+// Hampel threshold in units of 1/256 of the MAD for a limit of n_sigmas standard deviations, the MAD of normally
+// distributed data is 1 / 1.4826 standard deviations
+#define HAMPEL_FILTER_THRESHOLD(n_sigmas) ((unsigned int)(((n_sigmas) * 1.4826 * 256.0) + 0.5))
+
+/**
+  * @brief Node of the indexable skiplist, one per sample in the window
+  * @note next[l] is the following node on level l and width[l] the number of level 0 steps that link covers
+  */
+typedef struct
+{
+    filter_data_t value;
+    uint16_t      next[MEDIAN_FILTER_MAX_LEVELS];
+    uint16_t      width[MEDIAN_FILTER_MAX_LEVELS];
+    uint8_t       levels;
+} median_filter_node_t;
+
+/**
+  * @brief Running median filter
+  * @note The window is kept sorted in an indexable skiplist, each sample removes the oldest value, inserts the new
+  *       one and selects the middle rank, all in O(log size). Node i + 1 always holds the sample in ring slot i
+  *       and the node levels are drawn once at init from a fixed seed, so the filter never allocates and runs the
+  *       same on every target. Even windows average the two middle values.
+  */
+typedef struct
+{
+    median_filter_node_t *nodes;
+    unsigned int          size;
+    unsigned int          index;
+    unsigned int          count;
+} median_filter_t;
+
+/**
+  * @brief Hampel outlier filter
+  * @note Each sample is compared against the median and the median absolute deviation (MAD) of the window of
+  *       size samples centered on it. A sample further than threshold / 256 MADs from the median is replaced with
+  *       the median, every other sample passes through unchanged. Centering the window delays the output by
+  *       size / 2 samples. The MAD is selected from the two sorted halves of the window around the median in
+  *       O(log^2 size).
+  */
+typedef struct
+{
+    median_filter_t median;
+    unsigned int    threshold;
+    unsigned int    count;
+    unsigned int    num_outliers;
+} hampel_filter_t;
+
+/**
+  * @brief Initialize the filter
+  * @param filter Pointer to the filter
+  * @param nodes Pointer to MEDIAN_FILTER_NUM_NODES(size) nodes
+  * @param size Number of samples in the window, 1 to MEDIAN_FILTER_MAX_SIZE
+  * @return MEDIAN_FILTER_ERROR_OK on success, negative on error
+  */
+int median_filter_init(median_filter_t *filter, median_filter_node_t *nodes, unsigned int size);
+
+/**
+  * @brief Get the size of the nodes of a median or Hampel filter, MEDIAN_FILTER_NUM_NODES(size) nodes
+  * @param size Number of samples in the window
+  * @return Size in bytes
+  */
+size_t median_filter_state_size(unsigned int size);
+
+/**
+  * @brief Run the filter on the input value
+  * @param filter Pointer to the filter
+  * @param input Input value
+  * @param output Pointer to the output value
+  * @return MEDIAN_FILTER_ERROR_OK on success, MEDIAN_FILTER_ERROR_INVALID_OUTPUT until the window is full,
+  *         negative on error
+  */
+int median_filter_run(median_filter_t *filter, filter_data_t input, filter_data_t *output);
+
+/**
+  * @brief Run the filter over a block of input values
+  * @note Outputs before the window is full are the median of the samples seen so far
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs produced before the window filled (0 when every output is valid), negative on error
+  */
+int median_filter_run_block(median_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief Reset the filter
+  * @param filter Pointer to the filter
+  * @return MEDIAN_FILTER_ERROR_OK on success, negative on error
+  */
+int median_filter_reset(median_filter_t *filter);
+
+/**
+  * @brief Initialize the filter
+  * @param filter Pointer to the filter
+  * @param nodes Pointer to MEDIAN_FILTER_NUM_NODES(size) nodes
+  * @param size Number of samples in the window, an odd number from 3 to MEDIAN_FILTER_MAX_SIZE
+  * @param threshold Outlier limit in units of 1/256 of the MAD, see HAMPEL_FILTER_THRESHOLD()
+  * @return MEDIAN_FILTER_ERROR_OK on success, negative on error
+  */
+int hampel_filter_init(hampel_filter_t *filter, median_filter_node_t *nodes, unsigned int size, unsigned int threshold);
+
+/**
+  * @brief Run the filter on the input value
+  * @param filter Pointer to the filter
+  * @param input Input value
+  * @param output Pointer to the output value, the sample size / 2 inputs back or the median that replaced it
+  * @return MEDIAN_FILTER_ERROR_OK on success, MEDIAN_FILTER_ERROR_INVALID_OUTPUT while the output is still
+  *         delayed, negative on error
+  */
+int hampel_filter_run(hampel_filter_t *filter, filter_data_t input, filter_data_t *output);
+
+/**
+  * @brief Run the filter over a block of input values
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs that only hold the size - 1 sample window fill (written as 0), negative on error
+  */
+int hampel_filter_run_block(hampel_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
+/**
+  * @brief Reset the filter
+  * @param filter Pointer to the filter
+  * @return MEDIAN_FILTER_ERROR_OK on success, negative on error
+  */
+int hampel_filter_reset(hampel_filter_t *filter);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* MEDIAN_FILTER_H_ */
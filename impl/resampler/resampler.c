@@ -0,0 +1,311 @@
+#include "resampler.h"
+#include <math.h>
+#include <string.h>
+
+#define RESAMPLER_PI 3.14159265358979323846
+
+// Smallest sum of the windowed sinc weights, as a fraction of the sum of their magnitudes, that is normalized.
+// Below it the output is cubic interpolated
+#define RESAMPLER_SINC_MIN_SUM 0.5
+
+/**
+  * @brief Ring slot of the input at a position, 0 is the oldest kept input
+  */
+static inline unsigned int resampler_slot(const resampler_t *resampler, unsigned int position)
+{
+    unsigned int slot = resampler->index + position;
+    return (slot >= resampler->history) ? (slot - resampler->history) : slot;
+}
+
+static inline double resampler_time(const resampler_t *resampler, int position)
+{
+    // Positions outside the kept inputs take the nearest input
+    if (position < 0) {
+        position = 0;
+    } else if (position >= (int)resampler->count) {
+        position = (int)resampler->count - 1;
+    }
+    return resampler->times[resampler_slot(resampler, (unsigned int)position)];
+}
+
+static inline double resampler_sinc(double x)
+{
+    if (x == 0.0) {
+        return 1.0;
+    }
+    return sin(RESAMPLER_PI * x) / (RESAMPLER_PI * x);
+}
+
+/**
+  * @brief Check if the kept inputs can produce the next output
+  */
+static int resampler_ready(const resampler_t *resampler)
+{
+    if (resampler->count == 0) {
+        return 0;
+    }
+
+    const double time = resampler->start + ((double)resampler->next * resampler->period);
+    if (resampler->finished) {
+        return time <= resampler_time(resampler, (int)resampler->count - 1);
+    }
+
+    // Enough inputs after the output time have to be kept, the inputs before it are already there
+    return resampler->count >= resampler->after &&
+           resampler_time(resampler, (int)(resampler->count - resampler->after)) > time;
+}
+
+/**
+  * @brief Linear interpolation weights between the inputs at positions j and j + 1
+  */
+static unsigned int resampler_linear_weights(const resampler_t *resampler, double time, int j, int *positions, double *weights)
+{
+    double t0 = resampler_time(resampler, j);
+    double t1 = resampler_time(resampler, j + 1);
+    double s = (t1 > t0) ? ((time - t0) / (t1 - t0)) : 0.0;
+
+    positions[0] = j;
+    weights[0] = 1.0 - s;
+    positions[1] = j + 1;
+    weights[1] = s;
+
+    return 2;
+}
+
+/**
+  * @brief Cubic Hermite weights on [t_j, t_j+1], the slope at each end is the difference across its neighbours
+  */
+static unsigned int resampler_cubic_weights(const resampler_t *resampler, double time, int j, int *positions, double *weights)
+{
+    double tm = resampler_time(resampler, j - 1);
+    double t0 = resampler_time(resampler, j);
+    double t1 = resampler_time(resampler, j + 1);
+    double t2 = resampler_time(resampler, j + 2);
+    double h = t1 - t0;
+    if (!(h > 0.0)) {
+        return resampler_linear_weights(resampler, time, j, positions, weights);
+    }
+
+    double s = (time - t0) / h;
+    double s2 = s * s;
+    double s3 = s2 * s;
+    double h00 = (2.0 * s3) - (3.0 * s2) + 1.0;
+    double h10 = s3 - (2.0 * s2) + s;
+    double h01 = (3.0 * s2) - (2.0 * s3);
+    double h11 = s3 - s2;
+
+    // m_j = (x_j+1 - x_j-1) / (t_j+1 - t_j-1), the spline is linear in the inputs
+    double a = (t1 > tm) ? ((h10 * h) / (t1 - tm)) : 0.0;
+    double b = (t2 > t0) ? ((h11 * h) / (t2 - t0)) : 0.0;
+
+    positions[0] = j - 1;
+    weights[0] = -a;
+    positions[1] = j;
+    weights[1] = h00 - b;
+    positions[2] = j + 1;
+    weights[2] = h01 + a;
+    positions[3] = j + 2;
+    weights[3] = b;
+
+    return 4;
+}
+
+/**
+  * @brief Lanczos windowed sinc weights over the inputs around the output, normalized to a sum of one
+  */
+static unsigned int resampler_sinc_weights(const resampler_t *resampler, double time, int j, int *positions, double *weights)
+{
+    unsigned int num_weights = 0;
+    double       sum = 0.0;
+
+    // Inside a gap longer than the period there is nothing to band limit, the sinc would only ring across it
+    if (resampler_time(resampler, j + 1) - resampler_time(resampler, j) > resampler->period) {
+        return resampler_cubic_weights(resampler, time, j, positions, weights);
+    }
+
+    // The window reaches RESAMPLER_SINC_HALF_WIDTH periods, or as far as the kept inputs reach when the input is
+    // much denser than the grid. The ends of the stream do not narrow it
+    const int first = j - RESAMPLER_SINC_HALF_WIDTH + 1;
+    const int last = j + RESAMPLER_SINC_HALF_WIDTH;
+    double    width = (double)RESAMPLER_SINC_HALF_WIDTH;
+    if (first >= 0 && (time - resampler_time(resampler, first)) / resampler->period < width) {
+        width = (time - resampler_time(resampler, first)) / resampler->period;
+    }
+    if (last < (int)resampler->count && (resampler_time(resampler, last) - time) / resampler->period < width) {
+        width = (resampler_time(resampler, last) - time) / resampler->period;
+    }
+    if (width < 1.0) {
+        width = 1.0;
+    }
+
+    double magnitude = 0.0;
+    for (int p = first; p <= last; p++)
+    {
+        if (p < 0 || p >= (int)resampler->count) {
+            continue;
+        }
+        double x = (time - resampler_time(resampler, p)) / resampler->period;
+        if (fabs(x) >= width) {
+            continue;
+        }
+        double w = resampler_sinc(x) * resampler_sinc(x / width);
+        positions[num_weights] = p;
+        weights[num_weights++] = w;
+        sum += w;
+        magnitude += fabs(w);
+    }
+
+    // The negative lobes only take a little off the sum for evenly spaced inputs, inputs bunched up on one side of
+    // a gap can cancel each other out and the normalization would then blow up
+    if (!(sum > RESAMPLER_SINC_MIN_SUM * magnitude)) {
+        return resampler_cubic_weights(resampler, time, j, positions, weights);
+    }
+    for (unsigned int i = 0; i < num_weights; i++) {
+        weights[i] /= sum;
+    }
+
+    return num_weights;
+}
+
+int resampler_init(resampler_t *resampler, int mode, unsigned int num_channels, double period, double *times,
+                   filter_data_t *values)
+{
+    if (!resampler || !times || !values || num_channels == 0 || !(period > 0.0) ||
+        (mode != RESAMPLER_MODE_LINEAR && mode != RESAMPLER_MODE_CUBIC && mode != RESAMPLER_MODE_SINC)) {
+        return RESAMPLER_ERROR_INVALID_PARAM;
+    }
+
+    resampler->mode = mode;
+    resampler->num_channels = num_channels;
+    resampler->history = RESAMPLER_HISTORY_SIZE(mode);
+    resampler->after = resampler->history / 2;
+    resampler->period = period;
+    resampler->times = times;
+    resampler->values = values;
+
+    return resampler_reset(resampler);
+}
+
+int resampler_push(resampler_t *resampler, double time, const filter_data_t *frame)
+{
+    if (!resampler || !frame || resampler->finished) {
+        return RESAMPLER_ERROR_INVALID_PARAM;
+    }
+    if (resampler->count > 0 && !(time > resampler_time(resampler, (int)resampler->count - 1))) {
+        return RESAMPLER_ERROR_TIME;
+    }
+
+    // Once the pending outputs are pulled the oldest input is no longer needed, see resampler_ready
+    if (resampler_ready(resampler)) {
+        return RESAMPLER_ERROR_PENDING;
+    }
+
+    unsigned int slot;
+    if (resampler->count == 0) {
+        resampler->start = time;
+        resampler->next = 0;
+    }
+    if (resampler->count == resampler->history) {
+        slot = resampler->index;
+        resampler->index = resampler_slot(resampler, 1);
+    } else {
+        slot = resampler_slot(resampler, resampler->count++);
+    }
+    resampler->times[slot] = time;
+    memcpy(&resampler->values[slot * resampler->num_channels], frame, sizeof(filter_data_t) * resampler->num_channels);
+
+    return RESAMPLER_ERROR_OK;
+}
+
+int resampler_pull(resampler_t *resampler, double *time, filter_data_t *frame)
+{
+    if (!resampler || !time || !frame) {
+        return RESAMPLER_ERROR_INVALID_PARAM;
+    }
+    if (!resampler_ready(resampler)) {
+        return RESAMPLER_ERROR_NO_OUTPUT;
+    }
+
+    // The last input at or before the output time
+    const double t = resampler->start + ((double)resampler->next * resampler->period);
+    int          j = (int)resampler->count - 1;
+    while (j > 0 && resampler_time(resampler, j) > t) {
+        j--;
+    }
+
+    int          positions[2 * RESAMPLER_SINC_HALF_WIDTH];
+    double       weights[2 * RESAMPLER_SINC_HALF_WIDTH];
+    unsigned int num_weights;
+    if (resampler->mode == RESAMPLER_MODE_LINEAR) {
+        num_weights = resampler_linear_weights(resampler, t, j, positions, weights);
+    } else if (resampler->mode == RESAMPLER_MODE_CUBIC) {
+        num_weights = resampler_cubic_weights(resampler, t, j, positions, weights);
+    } else {
+        num_weights = resampler_sinc_weights(resampler, t, j, positions, weights);
+    }
+
+    // Weights that fall outside the kept inputs go to the nearest input
+    const filter_data_t *rows[2 * RESAMPLER_SINC_HALF_WIDTH];
+    for (unsigned int i = 0; i < num_weights; i++) {
+        int p = positions[i];
+        p = (p < 0) ? 0 : (p >= (int)resampler->count) ? ((int)resampler->count - 1) : p;
+        rows[i] = &resampler->values[resampler_slot(resampler, (unsigned int)p) * resampler->num_channels];
+    }
+    for (unsigned int c = 0; c < resampler->num_channels; c++)
+    {
+        double acc = 0.0;
+        for (unsigned int i = 0; i < num_weights; i++) {
+            acc += weights[i] * filter_data_to_double(rows[i][c]);
+        }
+        frame[c] = filter_data_from_double(acc);
+    }
+
+    *time = t;
+    resampler->next++;
+
+    return RESAMPLER_ERROR_OK;
+}
+
+int resampler_finish(resampler_t *resampler)
+{
+    if (!resampler) {
+        return RESAMPLER_ERROR_INVALID_PARAM;
+    }
+
+    resampler->finished = 1;
+
+    return RESAMPLER_ERROR_OK;
+}
+
+int resampler_reset(resampler_t *resampler)
+{
+    if (!resampler) {
+        return RESAMPLER_ERROR_INVALID_PARAM;
+    }
+
+    resampler->start = 0.0;
+    resampler->next = 0;
+    resampler->index = 0;
+    resampler->count = 0;
+    resampler->finished = 0;
+
+    return RESAMPLER_ERROR_OK;
+}
+
+uint64_t resampler_num_outputs(double first, double last, double period)
+{
+    if (!(period > 0.0) || !(last >= first)) {
+        return 0;
+    }
+
+    // Count the grid points exactly the way resampler_pull computes them
+    uint64_t k = (uint64_t)((last - first) / period);
+    while (first + ((double)(k + 1) * period) <= last) {
+        k++;
+    }
+    while (k > 0 && first + ((double)k * period) > last) {
+        k--;
+    }
+
+    return k + 1;
+}
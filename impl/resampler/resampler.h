@@ -0,0 +1,147 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef RESAMPLER_H_
+#define RESAMPLER_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+
+#define RESAMPLER_ERROR_OK            0
+#define RESAMPLER_ERROR_INVALID_PARAM -1
+#define RESAMPLER_ERROR_PENDING       -2
+#define RESAMPLER_ERROR_TIME          -3
+#define RESAMPLER_ERROR_NO_OUTPUT     -4
+
+// Interpolation modes
+#define RESAMPLER_MODE_LINEAR 0
+#define RESAMPLER_MODE_CUBIC  1
+#define RESAMPLER_MODE_SINC   2
+
+// Input samples the windowed sinc uses on each side of an output
+#define RESAMPLER_SINC_HALF_WIDTH 8
+
+// Number of input samples the resampler keeps, linear interpolation needs the two samples around an output,
+// cubic interpolation one more on each side
+#define RESAMPLER_HISTORY_SIZE(mode) (((mode) == RESAMPLER_MODE_LINEAR) ? 2 : ((mode) == RESAMPLER_MODE_CUBIC) ? 4 : \
+                                      (2 * RESAMPLER_SINC_HALF_WIDTH))
+
+// Number of filter_data_t entries required for the kept input frames
+#define RESAMPLER_VALUES_SIZE(mode, num_channels) (RESAMPLER_HISTORY_SIZE(mode) * (num_channels))
+
+/**
+  * @brief Streaming resampler, puts frames with arbitrary time stamps on a uniform time grid
+  * @note The grid starts at the time of the first input and has one output every period. Inputs are pushed one
+  *       frame at a time and every output that the kept inputs can produce is pulled before the next push, so
+  *       the memory use is fixed however long the stream or the gaps in it are.
+  *       RESAMPLER_MODE_LINEAR interpolates between the two inputs around each output. RESAMPLER_MODE_CUBIC
+  *       fits a cubic Hermite spline whose slopes are the differences across the neighbouring inputs, which
+  *       handles uneven spacing. RESAMPLER_MODE_SINC weights the RESAMPLER_SINC_HALF_WIDTH inputs on each side
+  *       by a Lanczos windowed sinc with its cut off at half the output rate and normalizes the weights, so it
+  *       also acts as the anti alias filter when the grid is coarser than the input. When the grid is more than
+  *       RESAMPLER_SINC_HALF_WIDTH / 2 times coarser the window narrows to the kept inputs, down to one period
+  *       on each side. Outputs inside a gap longer
+  *       than the period, or where uneven spacing leaves the weights far from summing to one, are cubic
+  *       interpolated instead.
+  *       Inputs before the first or after the last input are taken as the nearest input. The interpolation is
+  *       computed in double precision in every math mode, integer outputs saturate.
+  */
+typedef struct
+{
+    int            mode;
+    unsigned int   num_channels;
+    unsigned int   history;
+    unsigned int   after;
+    double         period;
+    double         start;
+    uint64_t       next;
+    double        *times;
+    filter_data_t *values;
+    unsigned int   index;
+    unsigned int   count;
+    int            finished;
+} resampler_t;
+
+/**
+  * @brief Initialize the resampler
+  * @param resampler Pointer to the resampler
+  * @param mode One of the RESAMPLER_MODE_* modes
+  * @param num_channels Number of values in each frame
+  * @param period Time between two outputs, in the unit of the input time stamps
+  * @param times Pointer to RESAMPLER_HISTORY_SIZE(mode) time stamps
+  * @param values Pointer to RESAMPLER_VALUES_SIZE(mode, num_channels) values
+  * @return RESAMPLER_ERROR_OK on success, negative on error
+  */
+int resampler_init(resampler_t *resampler, int mode, unsigned int num_channels, double period, double *times,
+                   filter_data_t *values);
+
+/**
+  * @brief Add an input frame
+  * @param resampler Pointer to the resampler
+  * @param time Time stamp of the frame, after the time stamp of the previous frame
+  * @param frame Pointer to num_channels values
+  * @return RESAMPLER_ERROR_OK on success, RESAMPLER_ERROR_PENDING if outputs still have to be pulled,
+  *         RESAMPLER_ERROR_TIME if the time stamp does not advance (the frame is dropped), negative on error
+  */
+int resampler_push(resampler_t *resampler, double time, const filter_data_t *frame);
+
+/**
+  * @brief Get the next output frame
+  * @param resampler Pointer to the resampler
+  * @param time Pointer to the time of the output on the grid
+  * @param frame Pointer to num_channels output values
+  * @return RESAMPLER_ERROR_OK if an output was written, RESAMPLER_ERROR_NO_OUTPUT if more inputs are needed (or
+  *         every output was pulled after resampler_finish), negative on error
+  */
+int resampler_pull(resampler_t *resampler, double *time, filter_data_t *frame);
+
+/**
+  * @brief Mark the end of the input, the outputs up to the last input time can then be pulled
+  * @param resampler Pointer to the resampler
+  * @return RESAMPLER_ERROR_OK on success, negative on error
+  */
+int resampler_finish(resampler_t *resampler);
+
+/**
+  * @brief Reset the resampler, the next input starts a new grid
+  * @param resampler Pointer to the resampler
+  * @return RESAMPLER_ERROR_OK on success, negative on error
+  */
+int resampler_reset(resampler_t *resampler);
+
+/**
+  * @brief Number of outputs for a stream, the grid points from first to last
+  * @param first Time of the first input
+  * @param last Time of the last input
+  * @param period Time between two outputs
+  * @return Number of outputs, 0 if the arguments are invalid
+  */
+uint64_t resampler_num_outputs(double first, double last, double period);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* RESAMPLER_H_ */
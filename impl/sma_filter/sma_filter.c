@@ -1,6 +1,11 @@
 #include "sma_filter.h"
 #include <string.h>
 
+size_t sma_filter_state_size(unsigned int size)
+{
+    return sizeof(filter_data_t) * size;
+}
+
 int sma_filter_init(sma_filter_t *filter, filter_data_t *data, unsigned int size)
 {
     if (!filter || !data || !size) {
@@ -12,6 +17,9 @@ int sma_filter_init(sma_filter_t *filter, filter_data_t *data, unsigned int size
     filter->index = 0;
     filter->sum = 0;
     filter->count = 0;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_reset(&filter->stats);
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
     memset(filter->data, 0, size * sizeof(filter_data_t));
 
     return SMA_FILTER_ERROR_OK;
@@ -19,31 +27,95 @@ int sma_filter_init(sma_filter_t *filter, filter_data_t *data, unsigned int size
 
 int sma_filter_run(sma_filter_t *filter, filter_data_t input, filter_data_t *output)
 {
-    if (!filter || !output) {
+    int ret = sma_filter_run_block(filter, &input, output, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (ret > 0) ? SMA_FILTER_ERROR_INVALID_OUTPUT : SMA_FILTER_ERROR_OK;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+/**
+  * @brief sma_filter_run_block() without the instrumentation
+  */
+static int sma_filter_run_kernel(sma_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#else
+int sma_filter_run_block(sma_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
+{
+    if (!filter || !input || !output) {
         return SMA_FILTER_ERROR_INVALID_PARAM;
     }
 
-    // Add the new value to the sum
-    filter->sum += input;
+    // Pull the filter state into locals so it can stay in registers for the whole block
+    filter_data_t     *data = filter->data;
+    const unsigned int size = filter->size;
+    unsigned int       index = filter->index;
+    unsigned int       count = filter->count;
+    filter_accum_t     sum = filter->sum;
 
-    // If we are at the max size, subtract the oldest value from the sum
-    if (filter->count == filter->size) {
-        filter->sum -= filter->data[filter->index];
-    } else {
-        filter->count++;
+    // An output is only valid once the window is full, work out the boundary for the whole block up front
+    size_t invalid = (count < size) ? (size_t)(size - count - 1) : 0;
+    if (invalid > num_samples) {
+        invalid = num_samples;
     }
 
-    // Store the new value in the data array
-    filter->data[filter->index] = input;
+    for (size_t n = 0; n < num_samples; n++)
+    {
+        filter_data_t in = input[n];
+
+        // Add the new value to the sum
+        sum += in;
 
-    // Increment the index
-    filter->index = (filter->index + 1) % filter->size;
+        // If we are at the max size, subtract the oldest value from the sum
+        if (count == size) {
+            sum -= data[index];
+        } else {
+            count++;
+        }
 
-    // Calculate the average
-    *output = (filter_data_t)(filter->sum / (filter_data_t)filter->count);
+        // Store the new value in the data array
+        data[index] = in;
 
-    return (filter->count == filter->size) ? SMA_FILTER_ERROR_OK : SMA_FILTER_ERROR_INVALID_OUTPUT;
+        // Increment the index
+        index = (index + 1) % size;
+
+#if defined(FILTER_USE_FLOAT_MATH)
+        // The floating point sum picks up a rounding error on every add and subtract, rebuild it from the window
+        // once per pass so the error stays bounded on long runs. The integer sums are exact.
+        if (index == 0 && count == size) {
+            sum = 0;
+            for (unsigned int i = 0; i < size; i++)
+            {
+                sum += data[i];
+            }
+        }
+#endif /* FILTER_USE_FLOAT_MATH */
+
+        // Calculate the average
+        output[n] = (filter_data_t)(sum / (filter_data_t)count);
+    }
+
+    filter->index = index;
+    filter->count = count;
+    filter->sum = sum;
+
+    return (int)invalid;
+}
+
+#if FILTER_INSTRUMENTATION_ENABLED
+int sma_filter_run_block(sma_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples)
+{
+    filter_stats_mark_t mark;
+    filter_stats_begin(&mark);
+    int ret = sma_filter_run_kernel(filter, input, output, num_samples);
+    if (ret >= 0) {
+        filter_stats_end(&filter->stats, &mark, output, num_samples, ret);
+    }
+    return ret;
 }
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 
 int sma_filter_reset(sma_filter_t *filter)
 {
@@ -28,6 +28,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 #include "../filter_types.h"
+#include "../filter_stats/filter_stats.h"
 
 #define SMA_FILTER_ERROR_OK             0
 #define SMA_FILTER_ERROR_INVALID_PARAM  -1
@@ -35,6 +36,9 @@ extern "C" {
 
 /**
   * @brief SMA filter structure
+  * @note The running sum is exact in the integer builds. The floating point build rebuilds it from the window every
+  *       size samples, which costs one add per sample on average and keeps the rounding error from growing over
+  *       long runs. See cic_filter_t for a moving average without the per sample division.
   */
 typedef struct
 {
@@ -43,6 +47,9 @@ typedef struct
     unsigned int   index;
     filter_accum_t sum;
     unsigned int   count;
+#if FILTER_INSTRUMENTATION_ENABLED
+    filter_stats_t  stats;
+#endif /* FILTER_INSTRUMENTATION_ENABLED */
 } sma_filter_t;
 
 /**
@@ -54,6 +61,13 @@ typedef struct
   */
 int sma_filter_init(sma_filter_t *filter, filter_data_t *data, unsigned int size);
 
+/**
+  * @brief Get the size of the data array
+  * @param size Number of samples in the window
+  * @return Size in bytes
+  */
+size_t sma_filter_state_size(unsigned int size);
+
 /**
   * @brief Run the filter on the input
   * @param filter Pointer to the filter
@@ -63,6 +77,16 @@ int sma_filter_init(sma_filter_t *filter, filter_data_t *data, unsigned int size
   */
 int sma_filter_run(sma_filter_t *filter, filter_data_t input, filter_data_t *output);
 
+/**
+  * @brief Run the filter over a block of inputs
+  * @param filter Pointer to the filter
+  * @param input Pointer to the input values
+  * @param output Pointer to the output values, may be the same buffer as input
+  * @param num_samples Number of values in the input and output buffers
+  * @return Number of leading outputs produced before the window filled (0 when every output is valid), negative on error
+  */
+int sma_filter_run_block(sma_filter_t *filter, const filter_data_t *input, filter_data_t *output, size_t num_samples);
+
 /**
   * @brief Reset the filter
   * @param filter Pointer to the filter
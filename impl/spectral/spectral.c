@@ -0,0 +1,213 @@
+#include "spectral.h"
+#include <math.h>
+#include <string.h>
+
+#define SPECTRAL_PI 3.14159265358979323846
+
+int spectral_goertzel_init(spectral_goertzel_t *goertzel, double frequency, double sampling_rate, unsigned int block_size)
+{
+    if (!goertzel || !(sampling_rate > 0.0) || !(frequency >= 0.0) || frequency > sampling_rate / 2.0 || block_size == 0) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    // The recursion ends on the DFT rotated by the phase of the last sample, e^(-j w (block_size - 1)) undoes it
+    double w = (2.0 * SPECTRAL_PI * frequency) / sampling_rate;
+    goertzel->cos_w = cos(w);
+    goertzel->sin_w = sin(w);
+    goertzel->coeff = 2.0 * goertzel->cos_w;
+    goertzel->rotate_re = cos(w * (block_size - 1.0));
+    goertzel->rotate_im = -sin(w * (block_size - 1.0));
+    goertzel->block_size = block_size;
+
+    return spectral_goertzel_reset(goertzel);
+}
+
+int spectral_goertzel_run(spectral_goertzel_t *goertzel, filter_data_t input, filter_fft_complex_t *bin)
+{
+    if (!goertzel || !bin) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    double s0 = filter_data_to_double(input) + (goertzel->coeff * goertzel->s1) - goertzel->s2;
+    goertzel->s2 = goertzel->s1;
+    goertzel->s1 = s0;
+    if (++goertzel->count < goertzel->block_size) {
+        return SPECTRAL_ERROR_INVALID_OUTPUT;
+    }
+
+    // s1 - e^(-j w) s2 is the DFT seen from the last sample of the block
+    double re = goertzel->s1 - (goertzel->cos_w * goertzel->s2);
+    double im = goertzel->sin_w * goertzel->s2;
+    bin->re = (re * goertzel->rotate_re) - (im * goertzel->rotate_im);
+    bin->im = (re * goertzel->rotate_im) + (im * goertzel->rotate_re);
+
+    return spectral_goertzel_reset(goertzel);
+}
+
+int spectral_goertzel_reset(spectral_goertzel_t *goertzel)
+{
+    if (!goertzel) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    goertzel->s1 = 0.0;
+    goertzel->s2 = 0.0;
+    goertzel->count = 0;
+
+    return SPECTRAL_ERROR_OK;
+}
+
+int spectral_sdft_init(spectral_sdft_t *sdft, unsigned int size, const unsigned int *bins, unsigned int num_bins, double *state)
+{
+    if (!sdft || !bins || !state || size == 0 || num_bins == 0) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+    for (unsigned int i = 0; i < num_bins; i++) {
+        if (bins[i] >= size) {
+            return SPECTRAL_ERROR_INVALID_PARAM;
+        }
+    }
+
+    sdft->size = size;
+    sdft->num_bins = num_bins;
+    sdft->bins = bins;
+    sdft->history = state;
+    sdft->twiddles = (filter_fft_complex_t *)&state[size];
+    sdft->sums = (filter_fft_complex_t *)&state[3 * size];
+
+    // twiddles[i] = e^(-j 2 pi i / size), bin k of sample n uses entry k * n modulo size
+    for (unsigned int i = 0; i < size; i++) {
+        double angle = (2.0 * SPECTRAL_PI * i) / size;
+        sdft->twiddles[i].re = cos(angle);
+        sdft->twiddles[i].im = -sin(angle);
+    }
+
+    return spectral_sdft_reset(sdft);
+}
+
+size_t spectral_sdft_state_size(unsigned int size, unsigned int num_bins)
+{
+    return sizeof(double) * SPECTRAL_SDFT_STATE_SIZE((size_t)size, (size_t)num_bins);
+}
+
+int spectral_sdft_run(spectral_sdft_t *sdft, filter_data_t input, filter_fft_complex_t *output)
+{
+    if (!sdft || !output) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    // The sample leaving the window was rotated by the same twiddle when it entered, size samples ago
+    const unsigned int size = sdft->size;
+    const unsigned int index = sdft->index;
+    const unsigned int next = (index + 1 == size) ? 0 : index + 1;
+    double             value = filter_data_to_double(input);
+    double             delta = value - sdft->history[index];
+    sdft->history[index] = value;
+    sdft->index = next;
+    for (unsigned int i = 0; i < sdft->num_bins; i++) {
+        const unsigned long long     bin = sdft->bins[i];
+        const filter_fft_complex_t  *twiddle = &sdft->twiddles[(bin * index) % size];
+        const filter_fft_complex_t  *phase = &sdft->twiddles[(bin * next) % size];
+        filter_fft_complex_t        *sum = &sdft->sums[i];
+        sum->re += delta * twiddle->re;
+        sum->im += delta * twiddle->im;
+
+        // Rotate the sum so that the oldest sample of the window is at n = 0
+        output[i].re = (sum->re * phase->re) + (sum->im * phase->im);
+        output[i].im = (sum->im * phase->re) - (sum->re * phase->im);
+    }
+    if (sdft->count < size) {
+        sdft->count++;
+        return (sdft->count == size) ? SPECTRAL_ERROR_OK : SPECTRAL_ERROR_INVALID_OUTPUT;
+    }
+
+    return SPECTRAL_ERROR_OK;
+}
+
+int spectral_sdft_reset(spectral_sdft_t *sdft)
+{
+    if (!sdft) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(sdft->history, 0, sizeof(double) * sdft->size);
+    memset(sdft->sums, 0, sizeof(filter_fft_complex_t) * sdft->num_bins);
+    sdft->index = 0;
+    sdft->count = 0;
+
+    return SPECTRAL_ERROR_OK;
+}
+
+int spectral_stft_init(spectral_stft_t *stft, unsigned int size, unsigned int hop, unsigned int window, double *state)
+{
+    if (!stft || !state || hop == 0 || window > SPECTRAL_WINDOW_BLACKMAN) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+    if (filter_fft_init(&stft->fft, size, (filter_fft_complex_t *)&state[3 * size]) != FILTER_FFT_ERROR_OK) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    stft->size = size;
+    stft->hop = hop;
+    stft->history = state;
+    stft->window = &state[size];
+    stft->frame = &state[2 * size];
+
+    // Generalized cosine windows, sum of a[k] * cos(2 pi k n / size) with alternating signs
+    static const double coeffs[][3] = {
+        { 1.0, 0.0, 0.0 }, { 0.5, 0.5, 0.0 }, { 0.54, 0.46, 0.0 }, { 0.42, 0.5, 0.08 }
+    };
+    stft->window_sum = 0.0;
+    for (unsigned int i = 0; i < size; i++) {
+        double angle = (2.0 * SPECTRAL_PI * i) / size;
+        stft->window[i] = coeffs[window][0] - (coeffs[window][1] * cos(angle)) + (coeffs[window][2] * cos(2.0 * angle));
+        stft->window_sum += stft->window[i];
+    }
+
+    return spectral_stft_reset(stft);
+}
+
+size_t spectral_stft_state_size(unsigned int size)
+{
+    return sizeof(double) * SPECTRAL_STFT_STATE_SIZE((size_t)size);
+}
+
+int spectral_stft_run(spectral_stft_t *stft, filter_data_t input, filter_fft_complex_t *spectrum)
+{
+    if (!stft || !spectrum) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    const unsigned int size = stft->size;
+    stft->history[stft->index] = filter_data_to_double(input);
+    stft->index = (stft->index + 1 == size) ? 0 : stft->index + 1;
+    if (--stft->count > 0) {
+        return SPECTRAL_ERROR_INVALID_OUTPUT;
+    }
+    stft->count = stft->hop;
+
+    // The oldest sample sits at the write position, unwrap the ring into the frame as it is windowed
+    const unsigned int split = size - stft->index;
+    for (unsigned int i = 0; i < split; i++) {
+        stft->frame[i] = stft->history[stft->index + i] * stft->window[i];
+    }
+    for (unsigned int i = split; i < size; i++) {
+        stft->frame[i] = stft->history[i - split] * stft->window[i];
+    }
+    filter_fft_forward(&stft->fft, stft->frame, spectrum);
+
+    return SPECTRAL_ERROR_OK;
+}
+
+int spectral_stft_reset(spectral_stft_t *stft)
+{
+    if (!stft) {
+        return SPECTRAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(stft->history, 0, sizeof(double) * stft->size);
+    stft->index = 0;
+    stft->count = stft->size;
+
+    return SPECTRAL_ERROR_OK;
+}
@@ -0,0 +1,206 @@
+//MIT License
+//
+//Copyright (c) 2023 budgettsfrog
+//
+//Permission is hereby granted, free of charge, to any person obtaining a copy
+//of this software and associated documentation files (the "Software"), to deal
+//in the Software without restriction, including without limitation the rights
+//to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//copies of the Software, and to permit persons to whom the Software is
+//furnished to do so, subject to the following conditions:
+//
+//The above copyright notice and this permission notice shall be included in all
+//copies or substantial portions of the Software.
+//
+//THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//SOFTWARE.
+#ifndef SPECTRAL_H_
+#define SPECTRAL_H_
+
+// Protect against C++ compilers
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "../filter_types.h"
+#include "../filter_fft/filter_fft.h"
+
+#define SPECTRAL_ERROR_OK             0
+#define SPECTRAL_ERROR_INVALID_PARAM  -1
+#define SPECTRAL_ERROR_INVALID_OUTPUT -2
+
+// STFT windows, periodic so that overlapping frames at the usual hops sum to a constant
+#define SPECTRAL_WINDOW_RECTANGULAR   0
+#define SPECTRAL_WINDOW_HANN          1
+#define SPECTRAL_WINDOW_HAMMING       2
+#define SPECTRAL_WINDOW_BLACKMAN      3
+
+// Number of doubles required for the state of a sliding DFT, see spectral_sdft_init()
+#define SPECTRAL_SDFT_STATE_SIZE(size, num_bins) ((3 * (size)) + (2 * (num_bins)))
+
+// Number of doubles required for the state of a STFT, see spectral_stft_init()
+#define SPECTRAL_STFT_STATE_SIZE(size) ((3 * (size)) + (2 * FILTER_FFT_TWIDDLE_SIZE(size)))
+
+/**
+  * @brief Goertzel detector of one frequency over blocks of block_size samples
+  * @note Every sample costs one multiply and two adds, the DFT of the block at the frequency is available once
+  *       the block is complete. The frequency does not have to fall on a DFT bin.
+  */
+typedef struct
+{
+    double       coeff;
+    double       cos_w;
+    double       sin_w;
+    double       rotate_re;
+    double       rotate_im;
+    double       s1;
+    double       s2;
+    unsigned int block_size;
+    unsigned int count;
+} spectral_goertzel_t;
+
+/**
+  * @brief Sliding DFT of a few bins over the last size samples, updated on every sample
+  * @note This is the modulated sliding DFT: each bin keeps a running sum of the inputs rotated by a twiddle
+  *       looked up from a table, rather than rotating the sum on every sample. Rounding errors therefore do not
+  *       grow with the length of the stream. Every sample costs one complex multiply add per bin.
+  */
+typedef struct
+{
+    unsigned int          size;
+    unsigned int          num_bins;
+    const unsigned int   *bins;
+    unsigned int          index;
+    unsigned int          count;
+    double               *history;
+    filter_fft_complex_t *twiddles;
+    filter_fft_complex_t *sums;
+} spectral_sdft_t;
+
+/**
+  * @brief Short time Fourier transform, one windowed real FFT of the last size samples every hop samples
+  * @note A sample costs one store plus its share of one size point FFT per hop, O(log size) per sample for a hop
+  *       proportional to size. Scale a bin by 2 / window_sum to get the amplitude of a sinusoid.
+  */
+typedef struct
+{
+    filter_fft_t fft;
+    unsigned int size;
+    unsigned int hop;
+    unsigned int index;
+    unsigned int count;
+    double       window_sum;
+    double      *history;
+    double      *window;
+    double      *frame;
+} spectral_stft_t;
+
+/**
+  * @brief Initialize a Goertzel detector
+  * @param goertzel Pointer to the detector
+  * @param frequency Frequency to detect, 0 to sampling_rate / 2
+  * @param sampling_rate Sampling rate, in the same unit as frequency
+  * @param block_size Number of samples in each block
+  * @return SPECTRAL_ERROR_OK on success, negative on error
+  */
+int spectral_goertzel_init(spectral_goertzel_t *goertzel, double frequency, double sampling_rate, unsigned int block_size);
+
+/**
+  * @brief Add a sample to the detector
+  * @param goertzel Pointer to the detector
+  * @param input Input sample
+  * @param bin Pointer to the DFT of the block at the frequency, sum of x[n] * e^(-j w n), written when a block
+  *            completes. Scale it by 2 / block_size to get the amplitude of a sinusoid
+  * @return SPECTRAL_ERROR_OK when a block completed, SPECTRAL_ERROR_INVALID_OUTPUT otherwise, negative on error
+  */
+int spectral_goertzel_run(spectral_goertzel_t *goertzel, filter_data_t input, filter_fft_complex_t *bin);
+
+/**
+  * @brief Drop the samples of the current block
+  * @param goertzel Pointer to the detector
+  * @return SPECTRAL_ERROR_OK on success, negative on error
+  */
+int spectral_goertzel_reset(spectral_goertzel_t *goertzel);
+
+/**
+  * @brief Initialize a sliding DFT
+  * @param sdft Pointer to the sliding DFT
+  * @param size Number of samples in the window, bin k is at k * sampling rate / size
+  * @param bins Pointer to num_bins bin numbers below size, kept by the sliding DFT
+  * @param num_bins Number of bins
+  * @param state Pointer to the state, must hold SPECTRAL_SDFT_STATE_SIZE(size, num_bins) doubles
+  * @return SPECTRAL_ERROR_OK on success, negative on error
+  */
+int spectral_sdft_init(spectral_sdft_t *sdft, unsigned int size, const unsigned int *bins, unsigned int num_bins, double *state);
+
+/**
+  * @brief Get the state size of a sliding DFT
+  * @param size Number of samples in the window
+  * @param num_bins Number of bins
+  * @return Size of the state in bytes, see SPECTRAL_SDFT_STATE_SIZE
+  */
+size_t spectral_sdft_state_size(unsigned int size, unsigned int num_bins);
+
+/**
+  * @brief Add a sample and update every bin
+  * @param sdft Pointer to the sliding DFT
+  * @param input Input sample
+  * @param output Pointer to num_bins DFT values of the last size samples, the oldest sample at n = 0. Scale them by
+  *               2 / size to get the amplitude of a sinusoid
+  * @return SPECTRAL_ERROR_OK on success, SPECTRAL_ERROR_INVALID_OUTPUT until size samples were added, negative on
+  *         error
+  */
+int spectral_sdft_run(spectral_sdft_t *sdft, filter_data_t input, filter_fft_complex_t *output);
+
+/**
+  * @brief Clear the window of a sliding DFT
+  * @param sdft Pointer to the sliding DFT
+  * @return SPECTRAL_ERROR_OK on success, negative on error
+  */
+int spectral_sdft_reset(spectral_sdft_t *sdft);
+
+/**
+  * @brief Initialize a STFT
+  * @param stft Pointer to the STFT
+  * @param size Number of samples in each frame, a power of two no smaller than 4
+  * @param hop Number of samples between two frames, at least 1
+  * @param window One of the SPECTRAL_WINDOW_* windows
+  * @param state Pointer to the state, must hold SPECTRAL_STFT_STATE_SIZE(size) doubles
+  * @return SPECTRAL_ERROR_OK on success, negative on error
+  */
+int spectral_stft_init(spectral_stft_t *stft, unsigned int size, unsigned int hop, unsigned int window, double *state);
+
+/**
+  * @brief Get the state size of a STFT
+  * @param size Number of samples in each frame
+  * @return Size of the state in bytes, see SPECTRAL_STFT_STATE_SIZE
+  */
+size_t spectral_stft_state_size(unsigned int size);
+
+/**
+  * @brief Add a sample, the first frame is transformed once size samples were added and then every hop samples
+  * @param stft Pointer to the STFT
+  * @param input Input sample
+  * @param spectrum Pointer to FILTER_FFT_NUM_BINS(size) bins from DC to Nyquist, written when a frame is
+  *                 transformed
+  * @return SPECTRAL_ERROR_OK when a frame was transformed, SPECTRAL_ERROR_INVALID_OUTPUT otherwise, negative on error
+  */
+int spectral_stft_run(spectral_stft_t *stft, filter_data_t input, filter_fft_complex_t *spectrum);
+
+/**
+  * @brief Clear the frame of a STFT
+  * @param stft Pointer to the STFT
+  * @return SPECTRAL_ERROR_OK on success, negative on error
+  */
+int spectral_stft_reset(spectral_stft_t *stft);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SPECTRAL_H_ */
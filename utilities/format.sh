@@ -6,4 +6,8 @@ uncrustify -c utilities/format.cfg --no-backup impl/iir_filter/*.c
 uncrustify -c utilities/format.cfg --no-backup impl/iir_filter/*.h
 uncrustify -c utilities/format.cfg --no-backup impl/fir_filter/*.c
 uncrustify -c utilities/format.cfg --no-backup impl/fir_filter/*.h
-uncrustify -c utilities/format.cfg --no-backup impl/*.h
\ No newline at end of file
+uncrustify -c utilities/format.cfg --no-backup impl/*.h
+uncrustify -c utilities/format.cfg --no-backup impl/filter_simd/*.c
+uncrustify -c utilities/format.cfg --no-backup impl/filter_simd/*.h
+uncrustify -c utilities/format.cfg --no-backup impl/filter_bank/*.c
+uncrustify -c utilities/format.cfg --no-backup impl/filter_bank/*.h
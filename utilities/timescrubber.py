@@ -1,6 +1,7 @@
 # This is a utility script that converts time stamps in the sample logs (Flume format)
 # from steps to milliseconds.
 
+import os
 import sys
 
 if len(sys.argv) < 2:
@@ -10,6 +11,15 @@ if len(sys.argv) < 2:
 file_path = sys.argv[1]
 out_file_path = file_path + ".out"
 
+# Binary columnar logs are scrubbed in place of a copy, the data columns are kept as they are
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'filter_analysis'))
+import fcol
+if os.path.isfile(file_path) and fcol.is_fcol(file_path):
+    log = fcol.load(file_path)
+    out_file_path = file_path + ".out.fcol"
+    fcol.save(out_file_path, log.names, log.time >> 8, log.columns, log.columns[0].dtype if log.columns else 'float32', log.time_base)
+    sys.exit(0)
+
 try:
     with open(file_path, 'r') as file:
         line_count = 0